@@ -11,6 +11,9 @@ debug {
 
 CONFIG(debug,debug|release):DEFINES += OPENTODOLIST_DEBUG_BUILD
 
+# Collecting statistics about database queries can be disabled using CONFIG+=no_query_statistics
+no_query_statistics:DEFINES += OPENTODOLIST_NO_QUERY_STATISTICS
+
 # Install Application Icons on UNIX:
 !android|!macx|!ios {
     icons.source = icons
@@ -121,7 +124,21 @@ HEADERS += \
     src/database/queries/disposetodo.h \
     src/database/queries/disposetask.h \
     src/database/databaseconnection.h \
-    src/models/private/objectmodel.h
+    src/models/private/objectmodel.h \
+    src/database/statementcache.h \
+    src/database/queryscheduler.h \
+    src/database/rowcursor.h \
+    src/database/migrationbatch.h \
+    src/database/slowquerylog.h \
+    src/database/querystatistics.h \
+    src/database/queries/private/insertobjects.h \
+    src/database/queries/insertaccounts.h \
+    src/database/queries/inserttodolists.h \
+    src/database/queries/inserttodos.h \
+    src/database/queries/inserttasks.h \
+    src/database/changeset.h \
+    src/database/objectcache.h \
+    src/core/tracer.h
 
 SOURCES += \
     src/main.cpp \
@@ -174,7 +191,20 @@ SOURCES += \
     src/database/queries/disposetodo.cpp \
     src/database/queries/disposetask.cpp \
     src/database/databaseconnection.cpp \
-    src/models/private/objectmodel.cpp
+    src/models/private/objectmodel.cpp \
+    src/database/statementcache.cpp \
+    src/database/queryscheduler.cpp \
+    src/database/rowcursor.cpp \
+    src/database/migrationbatch.cpp \
+    src/database/slowquerylog.cpp \
+    src/database/querystatistics.cpp \
+    src/database/queries/insertaccounts.cpp \
+    src/database/queries/inserttodolists.cpp \
+    src/database/queries/inserttodos.cpp \
+    src/database/queries/inserttasks.cpp \
+    src/database/changeset.cpp \
+    src/database/objectcache.cpp \
+    src/core/tracer.cpp
 
 RESOURCES += OpenTodoList.qrc
 
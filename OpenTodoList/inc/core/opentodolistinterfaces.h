@@ -20,12 +20,15 @@
 #define OPENTODOLISTINTERFACES_H
 
 #include <QDateTime>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QUuid>
 #include <QSet>
 #include <QVariantMap>
 
+#include <functional>
+
 namespace OpenTodoList {
 
 /**
@@ -486,6 +489,39 @@ public:
    */
   virtual ITask* getTask( const QUuid &uuid ) = 0;
 
+  /**
+     @brief Reads the accounts with the given @p uuids from the database
+
+     This works like calling getAccount() for each of the @p uuids, but looks up all of them
+     at once. The returned hash maps the UUIDs to the accounts found; UUIDs for which no account
+     exists are not contained. The backend shall delete the returned objects once it is done.
+   */
+  virtual QHash<QUuid, IAccount*> getAccounts( const QList<QUuid> &uuids ) = 0;
+
+  /**
+     @brief Reads the todo lists with the given @p uuids from the database
+
+     @sa getTodoList()
+     @sa getAccounts( const QList<QUuid>& )
+   */
+  virtual QHash<QUuid, ITodoList*> getTodoLists( const QList<QUuid> &uuids ) = 0;
+
+  /**
+     @brief Reads the todos with the given @p uuids from the database
+
+     @sa getTodo()
+     @sa getAccounts( const QList<QUuid>& )
+   */
+  virtual QHash<QUuid, ITodo*> getTodos( const QList<QUuid> &uuids ) = 0;
+
+  /**
+     @brief Reads the tasks with the given @p uuids from the database
+
+     @sa getTask()
+     @sa getAccounts( const QList<QUuid>& )
+   */
+  virtual QHash<QUuid, ITask*> getTasks( const QList<QUuid> &uuids ) = 0;
+
   /**
      @brief Gets accounts from the database
 
@@ -496,12 +532,31 @@ public:
      objects starting at the given offset are returned.
 
      @note The backend is responsible to delete the returned objects.
+     @note Paging with an offset gets slower the deeper the page is. Prefer the overload
+           taking a cursor.
    */
   virtual QList<IAccount*> getAccounts(
       QueryFlags flags = QueryAny,
       int maxAccounts = 0,
       int offset = 0 ) = 0;
 
+  /**
+     @brief Gets the next page of accounts from the database
+
+     This works like the offset based overload, but continues after the position stored in the
+     @p cursor. Pass an invalid QVariant to get the first page. On return, the cursor is moved
+     behind the last returned account, so calling this repeatedly pages through all matching
+     accounts until an empty list is returned. Each page costs the same, no matter how many
+     accounts have been read before. Objects which are deleted or no longer match in between
+     (e.g. because they have been saved) do not shift the following pages.
+
+     @note The backend is responsible to delete the returned objects.
+   */
+  virtual QList<IAccount*> getAccounts(
+      QueryFlags flags,
+      int maxAccounts,
+      QVariant &cursor ) = 0;
+
   /**
      @brief Gets todo lists from the database
 
@@ -518,6 +573,16 @@ public:
       int maxTodoLists = 0,
       int offset = 0 ) = 0;
 
+  /**
+     @brief Gets the next page of todo lists from the database
+
+     @sa getAccounts( QueryFlags, int, QVariant& )
+   */
+  virtual QList<ITodoList*> getTodoLists(
+      QueryFlags flags,
+      int maxTodoLists,
+      QVariant &cursor ) = 0;
+
   /**
      @brief Gets todos from the database
 
@@ -534,6 +599,16 @@ public:
       int maxTodos = 0,
       int offset = 0 ) = 0;
 
+  /**
+     @brief Gets the next page of todos from the database
+
+     @sa getAccounts( QueryFlags, int, QVariant& )
+   */
+  virtual QList<ITodo*> getTodos(
+      QueryFlags flags,
+      int maxTodos,
+      QVariant &cursor ) = 0;
+
   /**
      @brief Gets tasks from the database
 
@@ -550,6 +625,16 @@ public:
       int maxTasks = 0,
       int offset = 0 ) = 0;
 
+  /**
+     @brief Gets the next page of tasks from the database
+
+     @sa getAccounts( QueryFlags, int, QVariant& )
+   */
+  virtual QList<ITask*> getTasks(
+      QueryFlags flags,
+      int maxTasks,
+      QVariant &cursor ) = 0;
+
   /**
        @brief Insert or update an account
 
@@ -602,6 +687,45 @@ public:
      */
   virtual bool insertTask( ITask *task ) = 0;
 
+  /**
+     @brief Inserts or updates many @p accounts at once
+
+     This works like calling insertAccount() for each of the @p accounts, but writes all of
+     them in one go, which is considerably faster when e.g. importing lots of objects. The
+     backend keeps ownership of the accounts.
+   */
+  virtual bool insertAccounts( const QList<IAccount*> &accounts ) = 0;
+
+  /**
+     @brief Inserts or updates many todo @p lists at once
+
+     @sa insertTodoList()
+     @sa insertAccounts()
+   */
+  virtual bool insertTodoLists( const QList<ITodoList*> &lists ) = 0;
+
+  /**
+     @brief Inserts or updates many @p todos at once
+
+     The todo lists the todos belong to must be in the database already (or be inserted by
+     an earlier call).
+
+     @sa insertTodo()
+     @sa insertAccounts()
+   */
+  virtual bool insertTodos( const QList<ITodo*> &todos ) = 0;
+
+  /**
+     @brief Inserts or updates many @p tasks at once
+
+     The todos the tasks belong to must be in the database already (or be inserted by
+     an earlier call).
+
+     @sa insertTask()
+     @sa insertAccounts()
+   */
+  virtual bool insertTasks( const QList<ITask*> &tasks ) = 0;
+
   /**
      @brief Mark an account as saved
 
@@ -667,6 +791,174 @@ public:
      */
   virtual bool deleteTask( ITask *task ) = 0;
 
+  /**
+     @brief A function called once an asynchronous operation is done
+
+     Continuations are run in the thread of the backend which issued the operation. This
+     happens once the backend returns to its event loop or while it waits in
+     waitForPendingOperations().
+   */
+  typedef std::function<void()> Continuation;
+
+  typedef std::function<void(IAccount*)> AccountContinuation;   //!< Receives a read account
+  typedef std::function<void(ITodoList*)> TodoListContinuation; //!< Receives a read todo list
+  typedef std::function<void(ITodo*)> TodoContinuation;         //!< Receives a read todo
+  typedef std::function<void(ITask*)> TaskContinuation;         //!< Receives a read task
+
+  /**
+     @brief Inserts or updates an @p account without waiting for the database
+
+     This works like insertAccount(), but returns immediately. The operation is queued and
+     run together with other pending operations, so a backend can issue many of them at once
+     without paying for a round trip to the database each time. The database takes over
+     ownership of the @p account and deletes it once the operation has been run. Afterwards,
+     @p done (if given) is called.
+
+     Writes to the same object are run in the order they have been issued.
+   */
+  virtual void insertAccountAsync( IAccount *account, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Inserts or updates a todo @p list without waiting for the database
+
+     @sa insertTodoList()
+     @sa insertAccountAsync()
+   */
+  virtual void insertTodoListAsync( ITodoList *list, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Inserts or updates a @p todo without waiting for the database
+
+     @sa insertTodo()
+     @sa insertAccountAsync()
+   */
+  virtual void insertTodoAsync( ITodo *todo, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Inserts or updates a @p task without waiting for the database
+
+     @sa insertTask()
+     @sa insertAccountAsync()
+   */
+  virtual void insertTaskAsync( ITask *task, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Marks an @p account as saved without waiting for the database
+
+     The database takes over ownership of the @p account.
+
+     @sa onAccountSaved()
+     @sa insertAccountAsync()
+   */
+  virtual void onAccountSavedAsync( IAccount *account, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Marks a @p todoList as saved without waiting for the database
+
+     @sa onTodoListSaved()
+     @sa onAccountSavedAsync()
+   */
+  virtual void onTodoListSavedAsync( ITodoList *todoList, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Marks a @p todo as saved without waiting for the database
+
+     @sa onTodoSaved()
+     @sa onAccountSavedAsync()
+   */
+  virtual void onTodoSavedAsync( ITodo *todo, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Marks a @p task as saved without waiting for the database
+
+     @sa onTaskSaved()
+     @sa onAccountSavedAsync()
+   */
+  virtual void onTaskSavedAsync( ITask *task, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Deletes an @p account without waiting for the database
+
+     The database takes over ownership of the @p account.
+
+     @sa deleteAccount()
+     @sa insertAccountAsync()
+   */
+  virtual void deleteAccountAsync( IAccount *account, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Deletes a todo @p list without waiting for the database
+
+     @sa deleteTodoList()
+     @sa deleteAccountAsync()
+   */
+  virtual void deleteTodoListAsync( ITodoList *list, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Deletes a @p todo without waiting for the database
+
+     @sa deleteTodo()
+     @sa deleteAccountAsync()
+   */
+  virtual void deleteTodoAsync( ITodo *todo, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Deletes a @p task without waiting for the database
+
+     @sa deleteTask()
+     @sa deleteAccountAsync()
+   */
+  virtual void deleteTaskAsync( ITask *task, Continuation done = Continuation() ) = 0;
+
+  /**
+     @brief Reads an account without waiting for the database
+
+     This works like getAccount(), but returns immediately. Once the account has been read,
+     @p done is called with it (or with a nullptr if no account with the given @p uuid exists).
+     The continuation is responsible to delete the account.
+
+     @note Reads are not ordered with respect to pending writes. Call
+           waitForPendingOperations() first if the read depends on them.
+   */
+  virtual void getAccountAsync( const QUuid &uuid, AccountContinuation done ) = 0;
+
+  /**
+     @brief Reads a todo list without waiting for the database
+
+     @sa getTodoList()
+     @sa getAccountAsync()
+   */
+  virtual void getTodoListAsync( const QUuid &uuid, TodoListContinuation done ) = 0;
+
+  /**
+     @brief Reads a todo without waiting for the database
+
+     @sa getTodo()
+     @sa getAccountAsync()
+   */
+  virtual void getTodoAsync( const QUuid &uuid, TodoContinuation done ) = 0;
+
+  /**
+     @brief Reads a task without waiting for the database
+
+     @sa getTask()
+     @sa getAccountAsync()
+   */
+  virtual void getTaskAsync( const QUuid &uuid, TaskContinuation done ) = 0;
+
+  /**
+     @brief Returns the number of asynchronous operations which are not done yet
+   */
+  virtual int pendingOperations() const = 0;
+
+  /**
+     @brief Waits until all asynchronous operations are done
+
+     This blocks until every operation issued so far (including the ones issued by
+     continuations in the meantime) has been run and its continuation has been called.
+   */
+  virtual void waitForPendingOperations() = 0;
+
 };
 
 /**
@@ -820,7 +1112,8 @@ public:
 
 } /* namespace OpenTodoList */
 
-Q_DECLARE_INTERFACE(OpenTodoList::IBackend, "net.rpdev.OpenTodoList.IBackend/1.0")
+// Backends are handed an IDatabase, so bump the version whenever IBackend or IDatabase change
+Q_DECLARE_INTERFACE(OpenTodoList::IBackend, "net.rpdev.OpenTodoList.IBackend/2.0")
 
 
 #endif // OPENTODOLISTINTERFACES_H
@@ -0,0 +1,246 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/tracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+namespace OpenTodoList {
+
+namespace Core {
+
+const char *Tracer::DefaultCategory = "startup";
+
+/**
+   @brief Starts recording an event named @p name in the given @p category
+
+   The optional @p detail is shown as argument of the event.
+ */
+Tracer::Scope::Scope(const char *name, const char *category, const QString &detail) :
+  m_name( name ),
+  m_category( category ),
+  m_detail(),
+  m_start( -1 )
+{
+  Tracer *tracer = Tracer::instance();
+  if ( tracer->isEnabled() ) {
+    m_detail = detail;
+    m_start = tracer->now();
+  }
+}
+
+/**
+   @brief Finishes the event
+ */
+Tracer::Scope::~Scope()
+{
+  if ( m_start >= 0 ) {
+    Tracer *tracer = Tracer::instance();
+    tracer->addCompleteEvent( m_name, m_category, m_start, tracer->now() - m_start, m_detail );
+  }
+}
+
+/**
+   @brief Returns the process wide tracer
+
+   The tracer's clock starts when this is called for the first time.
+ */
+Tracer *Tracer::instance()
+{
+  static Tracer tracer;
+  return &tracer;
+}
+
+/**
+   @brief The file the trace is written to
+
+   If the file is empty, tracing is disabled.
+ */
+QString Tracer::outputFile() const
+{
+  QMutexLocker l( &m_lock );
+  return m_outputFile;
+}
+
+/**
+   @brief Sets the @p outputFile and enables tracing if it is not empty
+
+   @sa outputFile()
+ */
+void Tracer::setOutputFile(const QString &outputFile)
+{
+  QMutexLocker l( &m_lock );
+  m_outputFile = outputFile;
+  m_enabled.store( m_outputFile.isEmpty() ? 0 : 1 );
+}
+
+/**
+   @brief Returns the current time in microseconds since the tracer has been created
+ */
+qint64 Tracer::now() const
+{
+  return m_clock.nsecsElapsed() / 1000;
+}
+
+/**
+   @brief Records an event which started at @p start and took @p duration microseconds
+ */
+void Tracer::addCompleteEvent(const char *name, const char *category, qint64 start,
+                              qint64 duration, const QString &detail)
+{
+  if ( isEnabled() ) {
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'X';
+    event.timestamp = start;
+    event.duration = duration;
+    event.detail = detail;
+    addEvent( event );
+  }
+}
+
+/**
+   @brief Records that something happened right now
+ */
+void Tracer::addInstantEvent(const char *name, const char *category)
+{
+  if ( isEnabled() ) {
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.phase = 'i';
+    event.timestamp = now();
+    event.duration = 0;
+    addEvent( event );
+  }
+}
+
+/**
+   @brief Writes the events recorded so far to the outputFile()
+
+   Returns true on success.
+ */
+bool Tracer::write()
+{
+  QMutexLocker l( &m_lock );
+  if ( m_outputFile.isEmpty() ) {
+    return false;
+  }
+  qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray events;
+  for ( int i = 0; i < m_threadNames.size(); ++i ) {
+    QJsonObject args;
+    args.insert( "name", m_threadNames.at( i ) );
+    QJsonObject event;
+    event.insert( "name", QString( "thread_name" ) );
+    event.insert( "ph", QString( "M" ) );
+    event.insert( "pid", pid );
+    event.insert( "tid", i );
+    event.insert( "args", args );
+    events.append( event );
+  }
+  for ( const Event &e : m_events ) {
+    QJsonObject event;
+    event.insert( "name", QString( e.name ) );
+    event.insert( "cat", QString( e.category ) );
+    event.insert( "ph", QString( QChar( e.phase ) ) );
+    event.insert( "ts", e.timestamp );
+    if ( e.phase == 'X' ) {
+      event.insert( "dur", e.duration );
+    } else {
+      event.insert( "s", QString( "p" ) );
+    }
+    event.insert( "pid", pid );
+    event.insert( "tid", e.thread );
+    if ( !e.detail.isEmpty() ) {
+      QJsonObject args;
+      args.insert( "detail", e.detail );
+      event.insert( "args", args );
+    }
+    events.append( event );
+  }
+  QJsonObject trace;
+  trace.insert( "traceEvents", events );
+  trace.insert( "displayTimeUnit", QString( "ms" ) );
+
+  QFile file( m_outputFile );
+  if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+    qWarning() << "Failed to open trace file" << m_outputFile << ":" << file.errorString();
+    return false;
+  }
+  file.write( QJsonDocument( trace ).toJson( QJsonDocument::Compact ) );
+  file.close();
+  return true;
+}
+
+Tracer::Tracer() :
+  m_enabled( 0 ),
+  m_clock(),
+  m_lock(),
+  m_outputFile(),
+  m_events(),
+  m_threads(),
+  m_threadNames()
+{
+  m_clock.start();
+  setOutputFile( QString::fromLocal8Bit( qgetenv( "OPENTODOLIST_TRACE_FILE" ) ) );
+}
+
+void Tracer::addEvent(Event event)
+{
+  QMutexLocker l( &m_lock );
+  event.thread = currentThread();
+  m_events.append( event );
+}
+
+/*
+ * Returns a small number identifying the calling thread. Must be called with m_lock held.
+ */
+int Tracer::currentThread()
+{
+  void *handle = QThread::currentThreadId();
+  auto it = m_threads.constFind( handle );
+  if ( it != m_threads.constEnd() ) {
+    return it.value();
+  }
+  int result = m_threadNames.size();
+  QThread *thread = QThread::currentThread();
+  QString name = thread ? thread->objectName() : QString();
+  if ( name.isEmpty() ) {
+    if ( thread && QCoreApplication::instance() &&
+         thread == QCoreApplication::instance()->thread() ) {
+      name = "main";
+    } else {
+      name = QString( "thread%1" ).arg( result );
+    }
+  }
+  m_threads.insert( handle, result );
+  m_threadNames.append( name );
+  return result;
+}
+
+} /* Core */
+
+} /* OpenTodoList */
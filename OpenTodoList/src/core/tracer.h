@@ -0,0 +1,122 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_CORE_TRACER_H
+#define OPENTODOLIST_CORE_TRACER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace OpenTodoList {
+
+namespace Core {
+
+/**
+   @brief Records the phases the application goes through in Chrome trace format
+
+   The tracer collects timed events from all threads of the application and writes them as
+   JSON file, which can be loaded into chrome://tracing (or any other viewer understanding the
+   Trace Event Format). Tracing is disabled by default; it is enabled by setting an output
+   file, either via setOutputFile() or via the OPENTODOLIST_TRACE_FILE environment variable.
+
+   Phases are usually recorded using a Tracer::Scope, which records the time from its
+   construction to its destruction:
+
+   @code
+   {
+     Core::Tracer::Scope scope( "Database::startBackends" );
+     // ...
+   }
+   @endcode
+
+   When tracing is disabled, scopes cost a single check of an atomic flag.
+ */
+class Tracer
+{
+public:
+
+  /**
+     @brief Records the duration of the enclosing block as an event
+   */
+  class Scope
+  {
+  public:
+    explicit Scope( const char *name, const char *category = DefaultCategory,
+                    const QString &detail = QString() );
+    ~Scope();
+
+  private:
+    const char *m_name;
+    const char *m_category;
+    QString     m_detail;
+    qint64      m_start;
+  };
+
+  static const char *DefaultCategory;
+
+  static Tracer *instance();
+
+  bool isEnabled() const { return m_enabled.load() != 0; }
+
+  QString outputFile() const;
+  void setOutputFile( const QString &outputFile );
+
+  qint64 now() const;
+
+  void addCompleteEvent( const char *name, const char *category, qint64 start, qint64 duration,
+                         const QString &detail = QString() );
+  void addInstantEvent( const char *name, const char *category = DefaultCategory );
+
+  bool write();
+
+private:
+
+  struct Event {
+    const char *name;
+    const char *category;
+    char        phase;
+    qint64      timestamp;
+    qint64      duration;
+    int         thread;
+    QString     detail;
+  };
+
+  QAtomicInt          m_enabled;
+  QElapsedTimer       m_clock;
+  mutable QMutex      m_lock;
+  QString             m_outputFile;
+  QVector< Event >    m_events;
+  QHash< void*, int > m_threads;
+  QVector< QString >  m_threadNames;
+
+  Tracer();
+
+  void addEvent( Event event );
+  int currentThread();
+
+};
+
+} /* Core */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_CORE_TRACER_H
@@ -18,21 +18,28 @@
 
 #include "backendwrapper.h"
 
+#include "core/tracer.h"
+
 #include "datamodel/account.h"
 #include "datamodel/todolist.h"
 #include "datamodel/todo.h"
 #include "datamodel/task.h"
 
 #include "database/database.h"
+#include "database/storagequery.h"
 
 #include "database/queries/deleteaccount.h"
 #include "database/queries/deletetask.h"
 #include "database/queries/deletetodo.h"
 #include "database/queries/deletetodolist.h"
 #include "database/queries/insertaccount.h"
+#include "database/queries/insertaccounts.h"
 #include "database/queries/inserttodolist.h"
+#include "database/queries/inserttodolists.h"
 #include "database/queries/inserttodo.h"
+#include "database/queries/inserttodos.h"
 #include "database/queries/inserttask.h"
+#include "database/queries/inserttasks.h"
 #include "database/queries/readaccount.h"
 #include "database/queries/readtask.h"
 #include "database/queries/readtodo.h"
@@ -43,17 +50,81 @@
 #include "database/queries/savetodolist.h"
 
 #include <QDebug>
+#include <QEventLoop>
+#include <QSharedPointer>
 
 namespace OpenTodoList {
 
 namespace DataBase {
 
+namespace {
+
+/**
+   @brief Sets up a query reading up to @p maxObjects objects of the @p backend
+
+   The @p flags are translated to the corresponding filters of the query.
+ */
+template<typename Query>
+void prepareRead( Query &query, IDatabase::QueryFlags flags, int maxObjects,
+                  const QString &backend )
+{
+  if ( flags & IDatabase::QueryDirty ) {
+    query.setOnlyModified( true );
+  }
+  if ( flags & IDatabase::QueryDisposed ) {
+    query.setOnlyDeleted( true );
+  }
+  query.setLimit( maxObjects );
+  query.setIncludeDeleted( true );
+  typename Query::Condition c;
+  c.condition = "backend.name=:searchBackendName";
+  c.arguments.insert( "searchBackendName", backend );
+  query.addCondition( c );
+}
+
+/**
+   @brief Returns true if the @p changes contain objects which are dirty or disposed
+
+   Deleted objects are not looked at, as they are gone from the database already.
+ */
+bool needsSync( const ChangeSet &changes )
+{
+  for ( int type = ChangeSet::AccountObject; type < ChangeSet::NumObjectTypes; ++type ) {
+    ChangeSet::ObjectType objectType = static_cast< ChangeSet::ObjectType >( type );
+    for ( const QVariant &object : changes.changed( objectType ) ) {
+      QVariantMap map = object.toMap();
+      if ( map.value( "dirty" ).toInt() > 0 || map.value( "disposed" ).toBool() ) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+   @brief Casts the @p objects handed in by a backend to their data model type
+ */
+template<typename Object, typename Interface>
+QList<Object*> downcast( const QList<Interface*> &objects )
+{
+  QList<Object*> result;
+  result.reserve( objects.size() );
+  for ( Interface *object : objects ) {
+    result.append( static_cast< Object* >( object ) );
+  }
+  return result;
+}
+
+}
+
 BackendWrapper::BackendWrapper(QObject *parent) :
   QObject( parent ),
   m_database( 0 ),
   m_backend( 0 ),
   m_status( Invalid ),
-  m_syncTimer( nullptr )
+  m_syncTimer( nullptr ),
+  m_syncing( false ),
+  m_pendingOperations( 0 )
 {
 }
 
@@ -61,7 +132,10 @@ BackendWrapper::BackendWrapper(Database *database, IBackend *backend, QObject *p
   QObject(parent),
   m_database( database ),
   m_backend( backend ),
-  m_status( Stopped )
+  m_status( Stopped ),
+  m_syncTimer( nullptr ),
+  m_syncing( false ),
+  m_pendingOperations( 0 )
 {
   Q_ASSERT( m_database );
   Q_ASSERT( m_backend );
@@ -71,8 +145,8 @@ BackendWrapper::BackendWrapper(Database *database, IBackend *backend, QObject *p
 
 BackendWrapper::~BackendWrapper()
 {
-  // Don't do this! The actual backend is released when the plugin's
-  // QObject instance is destroyed!
+  // Don't do this! The actual backend is released by the Database together with the
+  // plugin's QObject instance!
   //delete m_backend;
 }
 
@@ -80,7 +154,7 @@ bool BackendWrapper::insertAccount(IAccount *account)
 {
   DataModel::Account *acc = static_cast< DataModel::Account* >( account );
   Queries::InsertAccount q( acc, false );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -88,7 +162,7 @@ bool BackendWrapper::insertTodoList(ITodoList *list)
 {
   DataModel::TodoList *todoList = static_cast< DataModel::TodoList* >( list );
   Queries::InsertTodoList q( todoList, false );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -96,7 +170,7 @@ bool BackendWrapper::insertTodo(ITodo *todo)
 {
   DataModel::Todo *t = static_cast< DataModel::Todo* >( todo );
   Queries::InsertTodo q( t, false );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -104,7 +178,35 @@ bool BackendWrapper::insertTask(ITask *task)
 {
   DataModel::Task *t = static_cast< DataModel::Task* >( task );
   Queries::InsertTask q( t, false );
-  m_database->runQuery( &q );
+  runQuery( &q );
+  return true;
+}
+
+bool BackendWrapper::insertAccounts(const QList<IAccount *> &accounts)
+{
+  Queries::InsertAccounts q( downcast<DataModel::Account>( accounts ) );
+  runQuery( &q );
+  return true;
+}
+
+bool BackendWrapper::insertTodoLists(const QList<ITodoList *> &lists)
+{
+  Queries::InsertTodoLists q( downcast<DataModel::TodoList>( lists ) );
+  runQuery( &q );
+  return true;
+}
+
+bool BackendWrapper::insertTodos(const QList<ITodo *> &todos)
+{
+  Queries::InsertTodos q( downcast<DataModel::Todo>( todos ) );
+  runQuery( &q );
+  return true;
+}
+
+bool BackendWrapper::insertTasks(const QList<ITask *> &tasks)
+{
+  Queries::InsertTasks q( downcast<DataModel::Task>( tasks ) );
+  runQuery( &q );
   return true;
 }
 
@@ -112,7 +214,7 @@ bool BackendWrapper::deleteAccount(IAccount *account)
 {
   DataModel::Account *t = static_cast<DataModel::Account*>( account );
   Queries::DeleteAccount q( t );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -120,7 +222,7 @@ bool BackendWrapper::deleteTodoList(ITodoList *list)
 {
   DataModel::TodoList *t = static_cast<DataModel::TodoList*>( list );
   Queries::DeleteTodoList q( t );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -128,7 +230,7 @@ bool BackendWrapper::deleteTodo(ITodo *todo)
 {
   DataModel::Todo *t = static_cast<DataModel::Todo*>( todo );
   Queries::DeleteTodo q( t );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -136,7 +238,7 @@ bool BackendWrapper::deleteTask(ITask *task)
 {
   DataModel::Task *t = static_cast<DataModel::Task*>( task );
   Queries::DeleteTask q( t );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -167,7 +269,7 @@ IAccount *BackendWrapper::getAccount(const QUuid &uuid)
   Queries::ReadAccount q;
   q.setUuid( uuid );
   q.setIncludeDeleted(true);
-  m_database->runQuery( &q );
+  runQuery( &q );
   if ( q.objects().isEmpty() ) {
     return nullptr;
   } else {
@@ -182,7 +284,7 @@ ITodoList *BackendWrapper::getTodoList(const QUuid &uuid)
   Queries::ReadTodoList q;
   q.setUuid( uuid );
   q.setIncludeDeleted(true);
-  m_database->runQuery( &q );
+  runQuery( &q );
   if ( q.objects().isEmpty() ) {
     return nullptr;
   } else {
@@ -197,7 +299,7 @@ ITodo *BackendWrapper::getTodo(const QUuid &uuid)
   Queries::ReadTodo q;
   q.setUuid( uuid );
   q.setIncludeDeleted(true);
-  m_database->runQuery( &q );
+  runQuery( &q );
   if ( q.objects().isEmpty() ) {
     return nullptr;
   } else {
@@ -212,7 +314,7 @@ ITask *BackendWrapper::getTask(const QUuid &uuid)
   Queries::ReadTask q;
   q.setUuid( uuid );
   q.setIncludeDeleted(true);
-  m_database->runQuery( &q );
+  runQuery( &q );
   if ( q.objects().isEmpty() ) {
     return nullptr;
   } else {
@@ -222,28 +324,55 @@ ITask *BackendWrapper::getTask(const QUuid &uuid)
   }
 }
 
+QHash<QUuid, IAccount *> BackendWrapper::getAccounts(const QList<QUuid> &uuids)
+{
+  return readObjects< Queries::ReadAccount, DataModel::Account, IAccount >( uuids );
+}
+
+QHash<QUuid, ITodoList *> BackendWrapper::getTodoLists(const QList<QUuid> &uuids)
+{
+  return readObjects< Queries::ReadTodoList, DataModel::TodoList, ITodoList >( uuids );
+}
+
+QHash<QUuid, ITodo *> BackendWrapper::getTodos(const QList<QUuid> &uuids)
+{
+  return readObjects< Queries::ReadTodo, DataModel::Todo, ITodo >( uuids );
+}
+
+QHash<QUuid, ITask *> BackendWrapper::getTasks(const QList<QUuid> &uuids)
+{
+  return readObjects< Queries::ReadTask, DataModel::Task, ITask >( uuids );
+}
+
 QList<IAccount *> BackendWrapper::getAccounts(QueryFlags flags, int maxAccounts, int offset)
 {
   Queries::ReadAccount q;
-  if ( flags & QueryDirty ) {
-    q.setOnlyModified( true );
+  prepareRead( q, flags, maxAccounts, m_backend->name() );
+  q.setOffset( offset );
+  runQuery( &q );
+  QList<IAccount*> result;
+  for ( DataModel::Account *account : q.objects() ) {
+    IAccount *a = createAccount();
+    static_cast<DataModel::Account*>( a )->fromVariant( account->toVariant() );
+    result << a;
   }
-  if ( flags & QueryDisposed ) {
-    q.setOnlyDeleted( true );
+  return result;
+}
+
+QList<IAccount *> BackendWrapper::getAccounts(QueryFlags flags, int maxAccounts, QVariant &cursor)
+{
+  Queries::ReadAccount q;
+  prepareRead( q, flags, maxAccounts, m_backend->name() );
+  if ( cursor.isValid() ) {
+    q.setAfterId( cursor.toInt() );
   }
-  q.setLimit( maxAccounts );
-  q.setOffset( offset );
-  q.setIncludeDeleted(true);
-  Queries::ReadAccount::Condition c;
-  c.condition = "backend.name=:searchBackendName";
-  c.arguments.insert( "searchBackendName", m_backend->name() );
-  q.addCondition(c);
-  m_database->runQuery(&q);
+  runQuery( &q );
   QList<IAccount*> result;
   for ( DataModel::Account *account : q.objects() ) {
     IAccount *a = createAccount();
     static_cast<DataModel::Account*>( a )->fromVariant( account->toVariant() );
     result << a;
+    cursor = account->id();
   }
   return result;
 }
@@ -251,25 +380,32 @@ QList<IAccount *> BackendWrapper::getAccounts(QueryFlags flags, int maxAccounts,
 QList<ITodoList *> BackendWrapper::getTodoLists(QueryFlags flags, int maxTodoLists, int offset)
 {
   Queries::ReadTodoList q;
-  if ( flags & QueryDirty ) {
-    q.setOnlyModified( true );
+  prepareRead( q, flags, maxTodoLists, m_backend->name() );
+  q.setOffset( offset );
+  runQuery( &q );
+  QList<ITodoList*> result;
+  for ( DataModel::TodoList *todoList : q.objects() ) {
+    ITodoList *tl = createTodoList();
+    static_cast<DataModel::TodoList*>( tl )->fromVariant( todoList->toVariant() );
+    result << tl;
   }
-  if ( flags & QueryDisposed ) {
-    q.setOnlyDeleted( true );
+  return result;
+}
+
+QList<ITodoList *> BackendWrapper::getTodoLists(QueryFlags flags, int maxTodoLists, QVariant &cursor)
+{
+  Queries::ReadTodoList q;
+  prepareRead( q, flags, maxTodoLists, m_backend->name() );
+  if ( cursor.isValid() ) {
+    q.setAfterId( cursor.toInt() );
   }
-  q.setLimit( maxTodoLists );
-  q.setOffset( offset );
-  q.setIncludeDeleted(true);
-  Queries::ReadTodoList::Condition c;
-  c.condition = "backend.name=:searchBackendName";
-  c.arguments.insert( "searchBackendName", m_backend->name() );
-  q.addCondition(c);
-  m_database->runQuery(&q);
+  runQuery( &q );
   QList<ITodoList*> result;
   for ( DataModel::TodoList *todoList : q.objects() ) {
     ITodoList *tl = createTodoList();
     static_cast<DataModel::TodoList*>( tl )->fromVariant( todoList->toVariant() );
     result << tl;
+    cursor = todoList->id();
   }
   return result;
 }
@@ -277,25 +413,32 @@ QList<ITodoList *> BackendWrapper::getTodoLists(QueryFlags flags, int maxTodoLis
 QList<ITodo *> BackendWrapper::getTodos(QueryFlags flags, int maxTodos, int offset)
 {
   Queries::ReadTodo q;
-  if ( flags & QueryDirty ) {
-    q.setOnlyModified( true );
+  prepareRead( q, flags, maxTodos, m_backend->name() );
+  q.setOffset( offset );
+  runQuery( &q );
+  QList<ITodo*> result;
+  for ( DataModel::Todo *todo : q.objects() ) {
+    ITodo *t = createTodo();
+    static_cast<DataModel::Todo*>( t )->fromVariant( todo->toVariant() );
+    result << t;
   }
-  if ( flags & QueryDisposed ) {
-    q.setOnlyDeleted( true );
+  return result;
+}
+
+QList<ITodo *> BackendWrapper::getTodos(QueryFlags flags, int maxTodos, QVariant &cursor)
+{
+  Queries::ReadTodo q;
+  prepareRead( q, flags, maxTodos, m_backend->name() );
+  if ( cursor.isValid() ) {
+    q.setAfterId( cursor.toInt() );
   }
-  q.setLimit( maxTodos );
-  q.setOffset( offset );
-  q.setIncludeDeleted(true);
-  Queries::ReadTodo::Condition c;
-  c.condition = "backend.name=:searchBackendName";
-  c.arguments.insert( "searchBackendName", m_backend->name() );
-  q.addCondition(c);
-  m_database->runQuery(&q);
+  runQuery( &q );
   QList<ITodo*> result;
   for ( DataModel::Todo *todo : q.objects() ) {
     ITodo *t = createTodo();
     static_cast<DataModel::Todo*>( t )->fromVariant( todo->toVariant() );
     result << t;
+    cursor = todo->id();
   }
   return result;
 }
@@ -303,25 +446,32 @@ QList<ITodo *> BackendWrapper::getTodos(QueryFlags flags, int maxTodos, int offs
 QList<ITask *> BackendWrapper::getTasks(QueryFlags flags, int maxTasks, int offset)
 {
   Queries::ReadTask q;
-  if ( flags & QueryDirty ) {
-    q.setOnlyModified( true );
+  prepareRead( q, flags, maxTasks, m_backend->name() );
+  q.setOffset( offset );
+  runQuery( &q );
+  QList<ITask*> result;
+  for ( DataModel::Task *task : q.objects() ) {
+    ITask *t = createTask();
+    static_cast<DataModel::Task*>( t )->fromVariant( task->toVariant() );
+    result << t;
   }
-  if ( flags & QueryDisposed ) {
-    q.setOnlyDeleted( true );
+  return result;
+}
+
+QList<ITask *> BackendWrapper::getTasks(QueryFlags flags, int maxTasks, QVariant &cursor)
+{
+  Queries::ReadTask q;
+  prepareRead( q, flags, maxTasks, m_backend->name() );
+  if ( cursor.isValid() ) {
+    q.setAfterId( cursor.toInt() );
   }
-  q.setLimit( maxTasks );
-  q.setOffset( offset );
-  q.setIncludeDeleted(true);
-  Queries::ReadTask::Condition c;
-  c.condition = "backend.name=:searchBackendName";
-  c.arguments.insert( "searchBackendName", m_backend->name() );
-  q.addCondition(c);
-  m_database->runQuery(&q);
+  runQuery( &q );
   QList<ITask*> result;
   for ( DataModel::Task *task : q.objects() ) {
     ITask *t = createTask();
     static_cast<DataModel::Task*>( t )->fromVariant( task->toVariant() );
     result << t;
+    cursor = task->id();
   }
   return result;
 }
@@ -330,7 +480,7 @@ bool BackendWrapper::onAccountSaved(IAccount *account)
 {
   DataModel::Account *tmp = static_cast< DataModel::Account* >( account );
   Queries::SaveAccount q( tmp );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -338,7 +488,7 @@ bool BackendWrapper::onTodoListSaved(ITodoList *todoList)
 {
   DataModel::TodoList *tmp = static_cast< DataModel::TodoList* >( todoList );
   Queries::SaveTodoList q( tmp );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -346,7 +496,7 @@ bool BackendWrapper::onTodoSaved(ITodo *todo)
 {
   DataModel::Todo *tmp = static_cast< DataModel::Todo* >( todo );
   Queries::SaveTodo q( tmp );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
@@ -354,10 +504,122 @@ bool BackendWrapper::onTaskSaved(ITask *task)
 {
   DataModel::Task *tmp = static_cast< DataModel::Task* >( task );
   Queries::SaveTask q( tmp );
-  m_database->runQuery( &q );
+  runQuery( &q );
   return true;
 }
 
+void BackendWrapper::insertAccountAsync(IAccount *account, Continuation done)
+{
+  DataModel::Account *acc = static_cast< DataModel::Account* >( account );
+  scheduleQuery( new Queries::InsertAccount( acc, false ), acc, done );
+}
+
+void BackendWrapper::insertTodoListAsync(ITodoList *list, Continuation done)
+{
+  DataModel::TodoList *todoList = static_cast< DataModel::TodoList* >( list );
+  scheduleQuery( new Queries::InsertTodoList( todoList, false ), todoList, done );
+}
+
+void BackendWrapper::insertTodoAsync(ITodo *todo, Continuation done)
+{
+  DataModel::Todo *t = static_cast< DataModel::Todo* >( todo );
+  scheduleQuery( new Queries::InsertTodo( t, false ), t, done );
+}
+
+void BackendWrapper::insertTaskAsync(ITask *task, Continuation done)
+{
+  DataModel::Task *t = static_cast< DataModel::Task* >( task );
+  scheduleQuery( new Queries::InsertTask( t, false ), t, done );
+}
+
+void BackendWrapper::onAccountSavedAsync(IAccount *account, Continuation done)
+{
+  DataModel::Account *tmp = static_cast< DataModel::Account* >( account );
+  scheduleQuery( new Queries::SaveAccount( tmp ), tmp, done );
+}
+
+void BackendWrapper::onTodoListSavedAsync(ITodoList *todoList, Continuation done)
+{
+  DataModel::TodoList *tmp = static_cast< DataModel::TodoList* >( todoList );
+  scheduleQuery( new Queries::SaveTodoList( tmp ), tmp, done );
+}
+
+void BackendWrapper::onTodoSavedAsync(ITodo *todo, Continuation done)
+{
+  DataModel::Todo *tmp = static_cast< DataModel::Todo* >( todo );
+  scheduleQuery( new Queries::SaveTodo( tmp ), tmp, done );
+}
+
+void BackendWrapper::onTaskSavedAsync(ITask *task, Continuation done)
+{
+  DataModel::Task *tmp = static_cast< DataModel::Task* >( task );
+  scheduleQuery( new Queries::SaveTask( tmp ), tmp, done );
+}
+
+void BackendWrapper::deleteAccountAsync(IAccount *account, Continuation done)
+{
+  DataModel::Account *acc = static_cast< DataModel::Account* >( account );
+  scheduleQuery( new Queries::DeleteAccount( acc ), acc, done );
+}
+
+void BackendWrapper::deleteTodoListAsync(ITodoList *list, Continuation done)
+{
+  DataModel::TodoList *todoList = static_cast< DataModel::TodoList* >( list );
+  scheduleQuery( new Queries::DeleteTodoList( todoList ), todoList, done );
+}
+
+void BackendWrapper::deleteTodoAsync(ITodo *todo, Continuation done)
+{
+  DataModel::Todo *t = static_cast< DataModel::Todo* >( todo );
+  scheduleQuery( new Queries::DeleteTodo( t ), t, done );
+}
+
+void BackendWrapper::deleteTaskAsync(ITask *task, Continuation done)
+{
+  DataModel::Task *t = static_cast< DataModel::Task* >( task );
+  scheduleQuery( new Queries::DeleteTask( t ), t, done );
+}
+
+void BackendWrapper::getAccountAsync(const QUuid &uuid, AccountContinuation done)
+{
+  scheduleRead< Queries::ReadAccount, DataModel::Account >( uuid, done );
+}
+
+void BackendWrapper::getTodoListAsync(const QUuid &uuid, TodoListContinuation done)
+{
+  scheduleRead< Queries::ReadTodoList, DataModel::TodoList >( uuid, done );
+}
+
+void BackendWrapper::getTodoAsync(const QUuid &uuid, TodoContinuation done)
+{
+  scheduleRead< Queries::ReadTodo, DataModel::Todo >( uuid, done );
+}
+
+void BackendWrapper::getTaskAsync(const QUuid &uuid, TaskContinuation done)
+{
+  scheduleRead< Queries::ReadTask, DataModel::Task >( uuid, done );
+}
+
+int BackendWrapper::pendingOperations() const
+{
+  return m_pendingOperations;
+}
+
+/**
+   @brief Waits until all asynchronous operations are done
+
+   This runs a local event loop (so that the continuations of the operations are called) until
+   no more operations are pending.
+ */
+void BackendWrapper::waitForPendingOperations()
+{
+  if ( m_pendingOperations > 0 ) {
+    QEventLoop loop;
+    connect( this, &BackendWrapper::pendingOperationsFinished, &loop, &QEventLoop::quit );
+    loop.exec();
+  }
+}
+
 void BackendWrapper::setLocalStorageDirectory(const QString &directory)
 {
   if ( m_status != Invalid )
@@ -399,19 +661,23 @@ bool BackendWrapper::start()
   case Invalid: return false;
   case Running: return true;
   case Stopped:
+  {
+    Core::Tracer::Scope scope( "BackendWrapper::start", Core::Tracer::DefaultCategory, name() );
     if ( m_backend->start() ) {
       setStatus( Running );
       m_syncTimer = new QTimer( this );
-      // TODO: Look for more intelligent ways of syncing
       m_syncTimer->setInterval( 1 ); // Save as soon as we reach event loop
       m_syncTimer->setSingleShot( true );
       connect( m_syncTimer, &QTimer::timeout, [this] { this->sync(); } );
       m_syncTimer->start();
+      connect( m_database, &Database::changesAvailable,
+               this, &BackendWrapper::onChangesAvailable );
       return true;
     } else {
       return false;
     }
   }
+  }
   qWarning() << "Unhandled status in BackendWrapper::start():" << m_status;
   return false;
 }
@@ -422,9 +688,12 @@ bool BackendWrapper::stop()
   case Invalid: return false;
   case Stopped: return true;
   case Running:
+    disconnect( m_database, &Database::changesAvailable,
+                this, &BackendWrapper::onChangesAvailable );
     delete m_syncTimer;
     m_syncTimer = nullptr;
     if ( m_backend->stop() ) {
+      waitForPendingOperations();
       setStatus( Stopped );
       return true;
     } else {
@@ -437,13 +706,46 @@ bool BackendWrapper::stop()
 
 void BackendWrapper::sync()
 {
+  if ( m_syncing ) {
+    // Triggered from within the event loop waiting for a running sync; try again later
+    scheduleSync();
+    return;
+  }
+  m_syncing = true;
   qDebug() << "Sync tick in backend" << m_backend->name() << "started";
   m_backend->sync();
-  m_syncTimer->setInterval( 10 * 60 * 1000 ); // Save every 10 minutes
-  m_syncTimer->start();
+  m_syncing = false;
   qDebug() << "Sync tick in backend" << m_backend->name() << "finished";
 }
 
+/**
+   @brief Schedules a sync of the backend after changes in the database
+
+   Changes are collected for SyncDelay milliseconds, so a burst of changes results in a
+   single sync.
+ */
+void BackendWrapper::scheduleSync()
+{
+  if ( m_syncTimer && !m_syncTimer->isActive() ) {
+    m_syncTimer->setInterval( SyncDelay );
+    m_syncTimer->start();
+  }
+}
+
+/**
+   @brief Schedules a sync if the @p changes affect objects the backend has to write
+
+   Only objects which have been modified (i.e. are dirty) or disposed in the database need
+   to be synced. Other changes, like the ones done by the backend itself when importing
+   objects, are ignored.
+ */
+void BackendWrapper::onChangesAvailable(const ChangeSet &changes)
+{
+  if ( needsSync( changes ) ) {
+    scheduleSync();
+  }
+}
+
 void BackendWrapper::doStart()
 {
   if ( !start() ) {
@@ -479,6 +781,100 @@ void BackendWrapper::setDatabase(IDatabase *database)
   Q_UNUSED( database );
 }
 
+/**
+   @brief Runs the @p query on behalf of the backend
+
+   Queries issued by backends are run with background priority, so that they do not delay
+   queries the user is waiting for.
+ */
+void BackendWrapper::runQuery(StorageQuery *query)
+{
+  query->setPriority( StorageQuery::BackgroundSyncPriority );
+  m_database->runQuery( query );
+}
+
+/**
+   @brief Schedules the @p query on behalf of the backend without waiting for it
+
+   The query is run with background priority. Together with the query, the @p object it
+   operates on is deleted once it has been run. Afterwards, @p done is called in the
+   thread of the wrapper. As the Database might merge the query into an earlier one
+   still waiting to be run (in which case the query is not run itself, but deleted together
+   with the query it has been merged into), completion is tracked via the destruction of the
+   query.
+ */
+void BackendWrapper::scheduleQuery(StorageQuery *query, QObject *object, Continuation done)
+{
+  Q_ASSERT( query != nullptr );
+  query->setPriority( StorageQuery::BackgroundSyncPriority );
+  if ( object ) {
+    object->setParent( query );
+  }
+  ++m_pendingOperations;
+  connect( query, &QObject::destroyed, this, [this,done] {
+    if ( done ) {
+      done();
+    }
+    if ( --m_pendingOperations == 0 ) {
+      emit pendingOperationsFinished();
+    }
+  }, Qt::QueuedConnection );
+  m_database->scheduleQuery( query );
+}
+
+/**
+   @brief Reads the objects with the given @p uuids
+
+   The objects are looked up in batches of up to ReadObject::MaxUuids objects, each using
+   a single query.
+ */
+template<typename Query, typename Object, typename Interface>
+QHash<QUuid, Interface*> BackendWrapper::readObjects(const QList<QUuid> &uuids)
+{
+  QHash<QUuid, Interface*> result;
+  for ( int i = 0; i < uuids.size(); i += Query::MaxUuids ) {
+    Query q;
+    q.setUuids( uuids.mid( i, Query::MaxUuids ) );
+    q.setIncludeDeleted( true );
+    runQuery( &q );
+    for ( Object *object : q.objects() ) {
+      Object *copy = new Object();
+      copy->fromVariant( object->toVariant() );
+      result.insert( copy->uuid(), copy );
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Reads the object with the given @p uuid without waiting for the database
+
+   The object is copied while still in the worker thread and handed to @p done (or a nullptr,
+   if no such object exists).
+ */
+template<typename Query, typename Object, typename Interface>
+void BackendWrapper::scheduleRead(const QUuid &uuid, std::function<void(Interface*)> done)
+{
+  Q_ASSERT( done );
+  Query *query = new Query();
+  query->setUuid( uuid );
+  query->setIncludeDeleted( true );
+  QSharedPointer<QVariant> result( new QVariant() );
+  connect( query, &StorageQuery::queryFinished, [query,result] {
+    if ( !query->objects().isEmpty() ) {
+      *result = query->objects().first()->toVariant();
+    }
+  });
+  scheduleQuery( query, nullptr, [result,done] {
+    Object *object = nullptr;
+    if ( result->isValid() ) {
+      object = new Object();
+      object->fromVariant( *result );
+    }
+    done( object );
+  });
+}
+
 void BackendWrapper::setStatus(BackendWrapper::Status newStatus)
 {
   if ( m_status != newStatus ) {
@@ -20,6 +20,7 @@
 #define BACKENDWRAPPER_H
 
 #include "core/opentodolistinterfaces.h"
+#include "database/changeset.h"
 
 #include <QObject>
 #include <QTimer>
@@ -30,6 +31,7 @@ namespace OpenTodoList {
 namespace DataBase {
 
 class Database;
+class StorageQuery;
 
 /**
    @brief Convenience class to wrap a IBackend object
@@ -76,6 +78,10 @@ public:
     bool insertTodoList(ITodoList *list) override;
     bool insertTodo(ITodo *todo) override;
     bool insertTask(ITask *task) override;
+    bool insertAccounts(const QList<IAccount*> &accounts) override;
+    bool insertTodoLists(const QList<ITodoList*> &lists) override;
+    bool insertTodos(const QList<ITodo*> &todos) override;
+    bool insertTasks(const QList<ITask*> &tasks) override;
     bool deleteAccount(IAccount *account) override;
     bool deleteTodoList(ITodoList *list) override;
     bool deleteTodo(ITodo *todo) override;
@@ -88,26 +94,64 @@ public:
     ITodoList *getTodoList(const QUuid &uuid) override;
     ITodo *getTodo(const QUuid &uuid) override;
     ITask *getTask(const QUuid &uuid) override;
+    QHash<QUuid, IAccount *> getAccounts(const QList<QUuid> &uuids) override;
+    QHash<QUuid, ITodoList *> getTodoLists(const QList<QUuid> &uuids) override;
+    QHash<QUuid, ITodo *> getTodos(const QList<QUuid> &uuids) override;
+    QHash<QUuid, ITask *> getTasks(const QList<QUuid> &uuids) override;
     QList<IAccount *> getAccounts(
         QueryFlags flags = QueryAny,
         int maxAccounts = 0,
         int offset = 0 ) override;
+    QList<IAccount *> getAccounts(
+        QueryFlags flags,
+        int maxAccounts,
+        QVariant &cursor ) override;
     QList<ITodoList *> getTodoLists(
         QueryFlags flags = QueryAny,
         int maxTodoLists = 0,
         int offset = 0 ) override;
+    QList<ITodoList *> getTodoLists(
+        QueryFlags flags,
+        int maxTodoLists,
+        QVariant &cursor ) override;
     QList<ITodo *> getTodos(
         QueryFlags flags = QueryAny,
         int maxTodos = 0,
         int offset = 0 ) override;
+    QList<ITodo *> getTodos(
+        QueryFlags flags,
+        int maxTodos,
+        QVariant &cursor ) override;
     QList<ITask *> getTasks(
         QueryFlags flags = QueryAny,
         int maxTasks = 0,
         int offset = 0 ) override;
+    QList<ITask *> getTasks(
+        QueryFlags flags,
+        int maxTasks,
+        QVariant &cursor ) override;
     bool onAccountSaved(IAccount *account) override;
     bool onTodoListSaved(ITodoList *todoList) override;
     bool onTodoSaved(ITodo *todo) override;
     bool onTaskSaved(ITask *task) override;
+    void insertAccountAsync(IAccount *account, Continuation done) override;
+    void insertTodoListAsync(ITodoList *list, Continuation done) override;
+    void insertTodoAsync(ITodo *todo, Continuation done) override;
+    void insertTaskAsync(ITask *task, Continuation done) override;
+    void onAccountSavedAsync(IAccount *account, Continuation done) override;
+    void onTodoListSavedAsync(ITodoList *todoList, Continuation done) override;
+    void onTodoSavedAsync(ITodo *todo, Continuation done) override;
+    void onTaskSavedAsync(ITask *task, Continuation done) override;
+    void deleteAccountAsync(IAccount *account, Continuation done) override;
+    void deleteTodoListAsync(ITodoList *list, Continuation done) override;
+    void deleteTodoAsync(ITodo *todo, Continuation done) override;
+    void deleteTaskAsync(ITask *task, Continuation done) override;
+    void getAccountAsync(const QUuid &uuid, AccountContinuation done) override;
+    void getTodoListAsync(const QUuid &uuid, TodoListContinuation done) override;
+    void getTodoAsync(const QUuid &uuid, TodoContinuation done) override;
+    void getTaskAsync(const QUuid &uuid, TaskContinuation done) override;
+    int pendingOperations() const override;
+    void waitForPendingOperations() override;
 
     // IBackend interface
     void setLocalStorageDirectory(const QString &directory) override;
@@ -126,22 +170,42 @@ signals:
 
     void statusChanged();
 
+    /**
+       @brief All asynchronous operations of the backend are done
+     */
+    void pendingOperationsFinished();
+
 public slots:
 
     void doStart();
     void doStop();
 
+private slots:
+
+    void scheduleSync();
+    void onChangesAvailable( const OpenTodoList::DataBase::ChangeSet &changes );
+
 private:
 
+    static const int SyncDelay = 500;
+
     Database  *m_database;
     IBackend  *m_backend;
     Status     m_status;
     QTimer    *m_syncTimer;
+    bool       m_syncing;
+    int        m_pendingOperations;
 
     // BackendInterface interface
     void setDatabase(IDatabase *database) override;
 
     void setStatus( Status newStatus );
+    void runQuery( StorageQuery *query );
+    void scheduleQuery( StorageQuery *query, QObject *object, Continuation done );
+    template<typename Query, typename Object, typename Interface>
+    QHash<QUuid, Interface*> readObjects( const QList<QUuid> &uuids );
+    template<typename Query, typename Object, typename Interface>
+    void scheduleRead( const QUuid &uuid, std::function<void(Interface*)> done );
 
 };
 
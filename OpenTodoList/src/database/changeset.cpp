@@ -0,0 +1,173 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "changeset.h"
+
+#include "datamodel/account.h"
+#include "datamodel/backend.h"
+#include "datamodel/objectinfo.h"
+#include "datamodel/task.h"
+#include "datamodel/todo.h"
+#include "datamodel/todolist.h"
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+ChangeSet::ChangeSet() :
+  m_changes( NumObjectTypes )
+{
+}
+
+/**
+   @brief Returns true if the change set contains no changes at all
+ */
+bool ChangeSet::isEmpty() const
+{
+  return size() == 0;
+}
+
+/**
+   @brief Returns the number of changed or deleted objects in the set
+ */
+int ChangeSet::size() const
+{
+  int result = 0;
+  for ( const Changes &changes : m_changes ) {
+    result += changes.changes.size();
+  }
+  return result;
+}
+
+/**
+   @brief Returns the number of changed or deleted objects of the given @p type
+ */
+int ChangeSet::size(ChangeSet::ObjectType type) const
+{
+  return m_changes.at( type ).changes.size();
+}
+
+/**
+   @brief Records that the @p object of the given @p type has been inserted or updated
+
+   The @p object is expected in the format returned by the toVariant() methods of the data
+   model classes.
+ */
+void ChangeSet::addChanged(ChangeSet::ObjectType type, const QVariant &object)
+{
+  add( type, object, false );
+}
+
+/**
+   @brief Records that the @p object of the given @p type has been deleted
+ */
+void ChangeSet::addDeleted(ChangeSet::ObjectType type, const QVariant &object)
+{
+  add( type, object, true );
+}
+
+/**
+   @brief Adds the changes in @p other to this set
+
+   Changes in @p other are considered to be newer than the ones in this set.
+ */
+void ChangeSet::merge(const ChangeSet &other)
+{
+  for ( int type = 0; type < NumObjectTypes; ++type ) {
+    for ( const Change &change : other.m_changes.at( type ).changes ) {
+      add( static_cast< ObjectType >( type ), change.object, change.deleted );
+    }
+  }
+}
+
+/**
+   @brief Removes all changes from the set
+ */
+void ChangeSet::clear()
+{
+  m_changes = QVector<Changes>( NumObjectTypes );
+}
+
+/**
+   @brief Returns the inserted or updated objects of the given @p type
+
+   The objects are returned in the order they have been changed first.
+ */
+QVariantList ChangeSet::changed(ChangeSet::ObjectType type) const
+{
+  QVariantList result;
+  for ( const Change &change : m_changes.at( type ).changes ) {
+    if ( !change.deleted ) {
+      result << change.object;
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Returns the deleted objects of the given @p type
+ */
+QVariantList ChangeSet::deleted(ChangeSet::ObjectType type) const
+{
+  QVariantList result;
+  for ( const Change &change : m_changes.at( type ).changes ) {
+    if ( change.deleted ) {
+      result << change.object;
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Returns the key identifying the @p object of the given @p type
+
+   This is the value of the UUID property of the object's class (e.g. the name for backends).
+ */
+QString ChangeSet::keyOf(ChangeSet::ObjectType type, const QVariant &object)
+{
+  static const char* UuidProperties[ NumObjectTypes ] = {
+    DataModel::ObjectInfo<DataModel::Backend>::classUuidProperty(),
+    DataModel::ObjectInfo<DataModel::Account>::classUuidProperty(),
+    DataModel::ObjectInfo<DataModel::TodoList>::classUuidProperty(),
+    DataModel::ObjectInfo<DataModel::Todo>::classUuidProperty(),
+    DataModel::ObjectInfo<DataModel::Task>::classUuidProperty()
+  };
+  return object.toMap().value( UuidProperties[ type ] ).toString();
+}
+
+void ChangeSet::add(ChangeSet::ObjectType type, const QVariant &object, bool deleted)
+{
+  Changes &changes = m_changes[ type ];
+  QString key = keyOf( type, object );
+  auto it = changes.index.constFind( key );
+  if ( it != changes.index.constEnd() ) {
+    Change &change = changes.changes[ it.value() ];
+    change.object = object;
+    change.deleted = deleted;
+  } else {
+    Change change;
+    change.object = object;
+    change.deleted = deleted;
+    changes.index.insert( key, changes.changes.size() );
+    changes.changes.append( change );
+  }
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
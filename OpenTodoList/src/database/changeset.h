@@ -0,0 +1,102 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_CHANGESET_H
+#define OPENTODOLIST_DATABASE_CHANGESET_H
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief A set of changes done to objects in the database
+
+   Instead of announcing each changed object on its own, the DatabaseWorker collects all changes
+   done within a transaction in a ChangeSet and publishes them at once (see
+   Database::changesAvailable()). Within a change set, changes are coalesced per object: Only the
+   latest state of each object is kept, and an object deleted after being changed is only
+   reported as deleted.
+
+   Change sets are implicitly shared, so passing them around (e.g. via queued connections)
+   is cheap.
+ */
+class ChangeSet
+{
+public:
+
+  /**
+     @brief The types of objects a change set can contain
+   */
+  enum ObjectType {
+    BackendObject = 0,
+    AccountObject,
+    TodoListObject,
+    TodoObject,
+    TaskObject
+  };
+
+  static const int NumObjectTypes = TaskObject + 1;
+
+  ChangeSet();
+
+  bool isEmpty() const;
+  int size() const;
+  int size( ObjectType type ) const;
+
+  void addChanged( ObjectType type, const QVariant &object );
+  void addDeleted( ObjectType type, const QVariant &object );
+  void merge( const ChangeSet &other );
+  void clear();
+
+  QVariantList changed( ObjectType type ) const;
+  QVariantList deleted( ObjectType type ) const;
+
+  static QString keyOf( ObjectType type, const QVariant &object );
+
+private:
+
+  struct Change {
+    QVariant object;
+    bool     deleted;
+  };
+
+  struct Changes {
+    QList<Change>       changes;
+    QHash<QString, int> index;
+  };
+
+  QVector<Changes> m_changes;
+
+  void add( ObjectType type, const QVariant &object, bool deleted );
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+Q_DECLARE_METATYPE( OpenTodoList::DataBase::ChangeSet )
+
+#endif // OPENTODOLIST_DATABASE_CHANGESET_H
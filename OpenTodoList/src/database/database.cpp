@@ -19,13 +19,20 @@
 #include "database/database.h"
 #include "database/storagequery.h"
 #include "database/databaseworker.h"
+#include "database/querystatistics.h"
+#include "database/slowquerylog.h"
 
 #include "database/queries/insertbackend.h"
 
+#include "core/settings.h"
+#include "core/tracer.h"
+
 #include "datamodel/backend.h"
 
 #include <QDebug>
 #include <QJsonDocument>
+#include <QThread>
+#include <QTimer>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
@@ -43,32 +50,60 @@ namespace DataBase {
 Database::Database(QObject *parent) :
     QObject(parent),
     m_workerThread(),
-    m_worker( new DatabaseWorker( localStorageLocation() + "/database.db") ),
-    m_backendPlugins( new PluginsLoader<IBackend>( "opentodobackends", this ) ),
+    m_worker( new DatabaseWorker( localStorageLocation() + "/database.db",
+                                  DatabaseWorker::profileFromString( databaseProfile() ) ) ),
+    m_readerThreads(),
+    m_readers(),
+    m_readersInitialized( 0 ),
+    m_nextReader( 0 ),
+    m_migrationProgress( 0.0 ),
+    m_migrationDescription(),
+    m_slowQueryLog( nullptr ),
+    m_objectCache( new ObjectCache( this ) ),
+    m_backendPlugins( nullptr ),
     m_backendsThread(),
-    m_backends()
+    m_backends(),
+    m_backendObjects(),
+    m_fastStart( fastStart() ),
+    m_backendsReady( false ),
+    m_backendsReleased( false )
 {
+    Core::Tracer::Scope scope( "Database::Database" );
+
+    int threshold = slowQueryThreshold();
+    if ( threshold > 0 ) {
+        m_slowQueryLog = new SlowQueryLog( localStorageLocation() + "/slowqueries.log", threshold );
+        m_worker->setSlowQueryLog( m_slowQueryLog );
+    }
+
     qDebug() << "Starting Database Worker thread";
+    m_workerThread.setObjectName( "database" );
     m_workerThread.start();
 
     qDebug() << "Initialiying database";
     m_worker->moveToThread( &m_workerThread );
     connect( m_worker, &DatabaseWorker::initialized, this, &Database::startBackends, Qt::QueuedConnection );
+    connect( m_worker, &DatabaseWorker::initialized, this, &Database::initReaders, Qt::QueuedConnection );
+    connect( m_worker, &DatabaseWorker::migrationProgress,
+             this, &Database::onMigrationProgress, Qt::QueuedConnection );
     QMetaObject::invokeMethod( m_worker, "init", Qt::QueuedConnection );
 
+    createReaders( localStorageLocation() + "/database.db", m_worker->profile() );
+
     // setup event broadcasting
-    connect( m_worker, &DatabaseWorker::backendChanged, this, &Database::backendChanged );
-    connect( m_worker, &DatabaseWorker::accountChanged, this, &Database::accountChanged );
-    connect( m_worker, &DatabaseWorker::todoListChanged, this, &Database::todoListChanged );
-    connect( m_worker, &DatabaseWorker::todoChanged, this, &Database::todoChanged );
-    connect( m_worker, &DatabaseWorker::taskChanged, this, &Database::taskChanged );
-    connect( m_worker, &DatabaseWorker::accountDeleted, this, &Database::accountDeleted );
-    connect( m_worker, &DatabaseWorker::todoListDeleted, this, &Database::todoListDeleted );
-    connect( m_worker, &DatabaseWorker::todoDeleted, this, &Database::todoDeleted );
-    connect( m_worker, &DatabaseWorker::taskDeleted, this, &Database::taskDeleted );
+    qRegisterMetaType< ChangeSet >();
+    connect( m_worker, &DatabaseWorker::changesAvailable, this, &Database::onChangesAvailable,
+             Qt::QueuedConnection );
+
+    qDebug() << "Loading backend plugins...";
+    {
+        Core::Tracer::Scope scope( "Database::loadPlugins" );
+        m_backendPlugins = new PluginsLoader<IBackend>( "opentodobackends", this );
+    }
 
     qDebug() << "Initializing backends...";
     m_backends.reserve( m_backendPlugins->plugins().size() );
+    m_backendsThread.setObjectName( "backends" );
     m_backendsThread.start();
     for ( IBackend *interface : m_backendPlugins->plugins() ) {
         qDebug() << "Initializing backend" << interface->title();
@@ -76,6 +111,15 @@ Database::Database(QObject *parent) :
         wrapper->setLocalStorageDirectory( localStorageLocation( wrapper->name() ) );
         wrapper->moveToThread( &m_backendsThread );
         m_backends << wrapper;
+        // The backend is only ever called from its wrapper, so let it live in the same thread;
+        // that way, objects it creates can use it as parent and connection context. Objects
+        // with a parent cannot be moved, so the Database takes over ownership:
+        QObject *backendObject = dynamic_cast< QObject* >( interface );
+        if ( backendObject ) {
+            backendObject->setParent( nullptr );
+            backendObject->moveToThread( &m_backendsThread );
+            m_backendObjects << backendObject;
+        }
     }
 }
 
@@ -100,6 +144,19 @@ Database::~Database()
     foreach ( BackendWrapper* wrapper, m_backends ) {
         delete wrapper;
     }
+    qDeleteAll( m_backendObjects );
+
+    qDebug() << "Running pending queries";
+    QMetaObject::invokeMethod( m_worker, "flush", Qt::BlockingQueuedConnection );
+
+    qDebug() << "Stopping Database Reader Threads";
+    for ( int i = 0; i < m_readers.size(); ++i ) {
+        QMetaObject::invokeMethod( m_readers.at( i ), "flush", Qt::BlockingQueuedConnection );
+        m_readerThreads.at( i )->quit();
+        m_readerThreads.at( i )->wait();
+        delete m_readers.at( i );
+        delete m_readerThreads.at( i );
+    }
 
     qDebug() << "Stopping Database Thread";
     m_workerThread.quit();
@@ -107,6 +164,8 @@ Database::~Database()
 
     qDebug() << "Deleting Database";
     delete m_worker;
+    delete m_slowQueryLog;
+    delete m_objectCache;
 }
 
 /**
@@ -120,7 +179,7 @@ void Database::runQuery(StorageQuery *query)
 {
     qDebug() << "Running query" << query;
     Q_ASSERT( query != nullptr );
-    m_worker->run( query );
+    workerForQuery( query )->run( query );
 }
 
 /**
@@ -134,8 +193,110 @@ void Database::scheduleQuery(StorageQuery *query)
 {
     qDebug() << "Scheduling query" << query << "for execution";
     Q_ASSERT( query != nullptr );
-    query->moveToThread( &m_workerThread );
-    m_worker->schedule( query );
+    DatabaseWorker *worker = workerForQuery( query );
+    query->moveToThread( worker->thread() );
+    worker->schedule( query );
+}
+
+/**
+   @brief Returns statistics about the queries waiting to be run
+
+   The returned map contains an entry "writer" with the statistics of the writing worker's
+   scheduler (see QueryScheduler::statistics()) and one entry "reader<N>" per reader connection.
+ */
+QVariantMap Database::schedulerStatistics() const
+{
+    QVariantMap result;
+    result.insert( "writer", m_worker->scheduler().statistics() );
+    for ( int i = 0; i < m_readers.size(); ++i ) {
+        result.insert( QString( "reader%1" ).arg( i ),
+                       m_readers.at( i )->scheduler().statistics() );
+    }
+    return result;
+}
+
+/**
+   @brief Returns the number of slow statements per query class
+
+   See SlowQueryLog::statistics(). The map is empty if slow statements are not recorded.
+ */
+QVariantMap Database::slowQueryStatistics() const
+{
+    return m_slowQueryLog ? m_slowQueryLog->statistics() : QVariantMap();
+}
+
+/**
+   @brief Returns statistics about the database
+
+   The returned map contains the following entries:
+
+   - "queries": The statements run per query class, combined over all connections (see
+     QueryStatistics::toVariant()).
+   - "queues": The queues of the connections (see schedulerStatistics()).
+   - "slowQueries": The slow statements per query class (see slowQueryStatistics()).
+   - "objectCache": Statistics about the shared objects (see ObjectCache::statistics()).
+
+   The statistics are collected when this is called. Bindings in QML are only re-evaluated
+   when refreshStats() is called.
+ */
+QVariantMap Database::stats() const
+{
+    QueryStatistics::Entries queries = m_worker->queryStatistics().entries();
+    for ( DatabaseWorker *reader : m_readers ) {
+        QueryStatistics::merge( queries, reader->queryStatistics().entries() );
+    }
+    QVariantMap result;
+    result.insert( "queries", QueryStatistics::toVariant( queries ) );
+    result.insert( "queues", schedulerStatistics() );
+    result.insert( "slowQueries", slowQueryStatistics() );
+    result.insert( "objectCache", m_objectCache->statistics() );
+    return result;
+}
+
+/**
+   @brief The identity map holding the objects shown in the application
+
+   Models request their objects from the cache, so that each object exists only once no
+   matter in how many views it is shown.
+ */
+ObjectCache *Database::objectCache() const
+{
+    return m_objectCache;
+}
+
+/**
+   @brief Notifies users of the stats property that the statistics shall be read again
+ */
+void Database::refreshStats()
+{
+    emit statsChanged();
+}
+
+/**
+   @brief Is the database schema currently being upgraded?
+
+   This is true while schema migrations (including their background work) are run. Queries can
+   be run nevertheless; however, they might be slower than usual.
+ */
+bool Database::isMigrating() const
+{
+    return m_migrationProgress < 1.0;
+}
+
+/**
+   @brief The progress of upgrading the database schema (from 0 to 1)
+ */
+double Database::migrationProgress() const
+{
+    return m_migrationProgress;
+}
+
+/**
+   @brief A description of the schema migration currently being run
+ */
+QString Database::migrationDescription() const
+{
+    return m_migrationDescription;
 }
 
 /**
@@ -146,6 +307,75 @@ QString Database::localStorageDir()
   return localStorageLocation();
 }
 
+/**
+   @brief Returns the name of the profile used to configure the database
+
+   The profile can be set via the OPENTODOLIST_DATABASE_PROFILE environment variable. If
+   it is not set, the "databaseProfile" value from the application settings is used. Valid
+   values are "safe", "balanced" and "fast". If neither is set, the balanced profile is used.
+ */
+QString Database::databaseProfile()
+{
+  QString profile( qgetenv( "OPENTODOLIST_DATABASE_PROFILE" ) );
+  if ( profile.isEmpty() ) {
+    Core::Settings settings;
+    profile = settings.getValue(
+          "databaseProfile",
+          DatabaseWorker::profileToString( DatabaseWorker::DefaultProfile ) ).toString();
+  }
+  bool ok = false;
+  DatabaseWorker::profileFromString( profile, &ok );
+  if ( !ok ) {
+    qWarning() << "Unknown database profile" << profile << "- using default profile";
+    profile = DatabaseWorker::profileToString( DatabaseWorker::DefaultProfile );
+  }
+  return profile;
+}
+
+/**
+   @brief Returns the duration (in ms) from which on statements are recorded as slow
+
+   The threshold can be set via the OPENTODOLIST_SLOW_QUERY_THRESHOLD environment variable. If it
+   is not set, the "slowQueryThreshold" value from the application settings is used. Slow
+   statements are written to the slowqueries.log file in the localStorageDir(). A value of 0
+   disables recording slow statements.
+ */
+int Database::slowQueryThreshold()
+{
+  QString value( qgetenv( "OPENTODOLIST_SLOW_QUERY_THRESHOLD" ) );
+  if ( value.isEmpty() ) {
+    Core::Settings settings;
+    value = settings.getValue( "slowQueryThreshold",
+                               SlowQueryLog::DefaultThreshold ).toString();
+  }
+  bool ok = false;
+  int threshold = value.toInt( &ok );
+  if ( !ok || threshold < 0 ) {
+    qWarning() << "Invalid slow query threshold" << value << "- using default threshold";
+    threshold = SlowQueryLog::DefaultThreshold;
+  }
+  return threshold;
+}
+
+/**
+   @brief Whether the application shall start in fast start mode
+
+   In fast start mode, the backends are started only after the user interface has been shown
+   (see releaseBackends()), so the user interface is populated from the database right away
+   instead of competing with the initial scan of the backends. The mode is enabled by setting
+   the OPENTODOLIST_FAST_START environment variable to 1 or, if the variable is not set, by the
+   "fastStart" value in the application settings.
+ */
+bool Database::fastStart()
+{
+  QString value( qgetenv( "OPENTODOLIST_FAST_START" ) );
+  if ( value.isEmpty() ) {
+    Core::Settings settings;
+    return settings.getValue( "fastStart", false ).toBool();
+  }
+  return value == "1" || value.compare( "true", Qt::CaseInsensitive ) == 0;
+}
+
 #ifdef Q_OS_ANDROID
 /**
    @brief Returns the external data location on Android
@@ -200,8 +430,88 @@ QString Database::localStorageLocation(const QString &type)
     return QString();
 }
 
+/**
+   @brief Returns the worker which shall run the @p query
+
+   Read-only queries are distributed round-robin over the reader connections (once these are
+   up). All other queries are run by the single writer.
+ */
+DatabaseWorker *Database::workerForQuery(StorageQuery *query)
+{
+    if ( query->isReadOnly() && !m_readers.isEmpty() &&
+         m_readersInitialized.load() == m_readers.size() ) {
+        int index = m_nextReader.fetchAndAddRelaxed( 1 );
+        return m_readers.at( qAbs( index % m_readers.size() ) );
+    }
+    return m_worker;
+}
+
+/**
+   @brief Creates the pool of read-only database connections
+
+   Each reader runs in its own thread. Readers are only used if the database uses a
+   write-ahead log (i.e. with any but the safe profile), as otherwise readers and the writer
+   would block each other.
+ */
+void Database::createReaders(const QString &dbLocation, int profile)
+{
+    if ( profile == DatabaseWorker::SafeProfile ) {
+        qDebug() << "Not using reader connections with safe database profile";
+        return;
+    }
+    int numReaders = qBound( 1, QThread::idealThreadCount() - 1, 3 );
+    qDebug() << "Starting" << numReaders << "database reader threads";
+    for ( int i = 0; i < numReaders; ++i ) {
+        QThread *thread = new QThread();
+        thread->setObjectName( QString( "reader%1" ).arg( i ) );
+        DatabaseWorker *reader = new DatabaseWorker(
+                    dbLocation, static_cast< DatabaseWorker::Profile >( profile ), true );
+        reader->setSlowQueryLog( m_slowQueryLog );
+        thread->start();
+        reader->moveToThread( thread );
+        connect( reader, &DatabaseWorker::initialized,
+                 this, &Database::onReaderInitialized, Qt::QueuedConnection );
+        m_readerThreads << thread;
+        m_readers << reader;
+    }
+}
+
+/**
+   @brief Initializes the reader connections
+
+   This is done once the writer has set up the database schema.
+ */
+void Database::initReaders()
+{
+    for ( DatabaseWorker *reader : m_readers ) {
+        QMetaObject::invokeMethod( reader, "init", Qt::QueuedConnection );
+    }
+}
+
+void Database::onReaderInitialized()
+{
+    m_readersInitialized.ref();
+}
+
+void Database::onMigrationProgress(const QString &description, double progress)
+{
+    m_migrationDescription = description;
+    m_migrationProgress = progress;
+    emit migrationProgressChanged();
+}
+
+/**
+   @brief Updates the cached objects with the @p changes before broadcasting them
+ */
+void Database::onChangesAvailable(const ChangeSet &changes)
+{
+    m_objectCache->applyChanges( changes );
+    emit changesAvailable( changes );
+}
+
 void Database::startBackends()
 {
+    Core::Tracer::Scope scope( "Database::startBackends" );
     qDebug() << "Starting backends";
     for ( BackendWrapper* wrapper : m_backends ) {
         qDebug() << "Inserting/updating backend data in DB";
@@ -213,7 +523,37 @@ void Database::startBackends()
         Queries::InsertBackend *query = new Queries::InsertBackend( backend );
         m_worker->run( query );
         delete query;
+    }
+    m_backendsReady = true;
+    if ( !m_fastStart || m_backendsReleased ) {
+        runBackends();
+    } else {
+        qDebug() << "Fast start: Deferring start of backends";
+        QTimer::singleShot( FastStartTimeout, this, SLOT(releaseBackends()) );
+    }
+}
+
+/**
+   @brief Starts the backends, if this has been deferred
 
+   In fast start mode (see fastStart()), the backends are not started together with the
+   database. Instead, the application shall call this method once the user interface has been
+   shown. If this does not happen within FastStartTimeout milliseconds after the database
+   has been initialized, the backends are started nevertheless.
+ */
+void Database::releaseBackends()
+{
+    if ( !m_backendsReleased ) {
+        m_backendsReleased = true;
+        if ( m_fastStart && m_backendsReady ) {
+            runBackends();
+        }
+    }
+}
+
+void Database::runBackends()
+{
+    for ( BackendWrapper* wrapper : m_backends ) {
         qDebug() << "Starting backend" << wrapper->name();
         if ( !QMetaObject::invokeMethod( wrapper, "doStart", Qt::QueuedConnection ) ) {
             qWarning() << "Failed to start backend" << wrapper->name();
@@ -21,11 +21,15 @@
 
 #include "core/opentodolistinterfaces.h"
 #include "database/backendwrapper.h"
+#include "database/changeset.h"
+#include "database/objectcache.h"
 #include "pluginsloader.h"
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QQueue>
 #include <QThread>
+#include <QVariantMap>
 
 namespace OpenTodoList {
 
@@ -33,6 +37,7 @@ namespace DataBase {
 
 class StorageQuery;
 class DatabaseWorker;
+class SlowQueryLog;
 
 /**
    @brief Provides the todo list storage for the application
@@ -50,6 +55,10 @@ class DatabaseWorker;
 class Database : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY( bool migrating READ isMigrating NOTIFY migrationProgressChanged )
+    Q_PROPERTY( double migrationProgress READ migrationProgress NOTIFY migrationProgressChanged )
+    Q_PROPERTY( QString migrationDescription READ migrationDescription NOTIFY migrationProgressChanged )
+    Q_PROPERTY( QVariantMap stats READ stats NOTIFY statsChanged )
 public:
     explicit Database(QObject *parent = 0);
     virtual ~Database();
@@ -57,30 +66,66 @@ public:
     void runQuery( StorageQuery *query );
     void scheduleQuery( StorageQuery *query );
 
+    Q_INVOKABLE QVariantMap schedulerStatistics() const;
+    Q_INVOKABLE QVariantMap slowQueryStatistics() const;
+    QVariantMap stats() const;
+
+    ObjectCache *objectCache() const;
+    Q_INVOKABLE void refreshStats();
+
+    bool isMigrating() const;
+    double migrationProgress() const;
+    QString migrationDescription() const;
+
     static QString localStorageDir();
+    static QString databaseProfile();
+    static int slowQueryThreshold();
+    static bool fastStart();
+
+    static const int FastStartTimeout = 3000;
+
+public slots:
+
+    void releaseBackends();
 
 signals:
 
-    void backendChanged( const QVariant &backend );
-    void accountChanged( const QVariant &account );
-    void todoListChanged( const QVariant &todoList );
-    void todoChanged( const QVariant &todo );
-    void taskChanged( const QVariant &task );
-    void accountDeleted( const QVariant &account );
-    void todoListDeleted( const QVariant &todoList );
-    void todoDeleted( const QVariant &todo );
-    void taskDeleted( const QVariant &task );
+    /**
+       @brief Objects in the database have been inserted, updated or deleted
+
+       The @p changes contain all objects changed within one transaction. Clients shall
+       apply them in one go.
+     */
+    void changesAvailable( const OpenTodoList::DataBase::ChangeSet &changes );
+
+    void migrationProgressChanged();
+    void statsChanged();
 
 private:
 
     QThread                          m_workerThread;
     DatabaseWorker                  *m_worker;
+    QVector< QThread* >              m_readerThreads;
+    QVector< DatabaseWorker* >       m_readers;
+    QAtomicInt                       m_readersInitialized;
+    QAtomicInt                       m_nextReader;
+    double                           m_migrationProgress;
+    QString                          m_migrationDescription;
+    SlowQueryLog                    *m_slowQueryLog;
+    ObjectCache                     *m_objectCache;
     PluginsLoader<IBackend>         *m_backendPlugins;
 
     QThread                          m_backendsThread;
     QVector< BackendWrapper* >       m_backends;
+    QVector< QObject* >              m_backendObjects;
+    bool                             m_fastStart;
+    bool                             m_backendsReady;
+    bool                             m_backendsReleased;
 
     BackendWrapper* backendByName( const QString &backend ) const;
+    DatabaseWorker* workerForQuery( StorageQuery *query );
+    void createReaders( const QString &dbLocation, int profile );
+    void runBackends();
 
 #ifdef Q_OS_ANDROID
     static QString androidExtStorageLocation();
@@ -90,6 +135,10 @@ private:
 private slots:
 
     void startBackends();
+    void initReaders();
+    void onReaderInitialized();
+    void onMigrationProgress( const QString &description, double progress );
+    void onChangesAvailable( const OpenTodoList::DataBase::ChangeSet &changes );
 
 };
 
@@ -65,25 +65,13 @@ void DatabaseConnection::setDatabase(Database *database)
 {
   if ( m_database != database ) {
     if ( m_database ) {
-      disconnect( m_database, &Database::accountChanged,
-               this, &DatabaseConnection::onDatabaseAccountUpdate );
-      disconnect( m_database, &Database::todoListChanged,
-               this, &DatabaseConnection::onDatabaseTodoListUpdate );
-      disconnect( m_database, &Database::todoChanged,
-               this, &DatabaseConnection::onDatabaseTodoUpdate );
-      disconnect( m_database, &Database::taskChanged,
-               this, &DatabaseConnection::onDatabaseTaskUpdate );
+      disconnect( m_database, &Database::changesAvailable,
+                  this, &DatabaseConnection::onDatabaseChanges );
     }
     m_database = database;
     if ( m_database ) {
-      connect( m_database, &Database::accountChanged,
-               this, &DatabaseConnection::onDatabaseAccountUpdate );
-      connect( m_database, &Database::todoListChanged,
-               this, &DatabaseConnection::onDatabaseTodoListUpdate );
-      connect( m_database, &Database::todoChanged,
-               this, &DatabaseConnection::onDatabaseTodoUpdate );
-      connect( m_database, &Database::taskChanged,
-               this, &DatabaseConnection::onDatabaseTaskUpdate );
+      connect( m_database, &Database::changesAvailable,
+               this, &DatabaseConnection::onDatabaseChanges );
     }
     emit databaseChanged();
   }
@@ -295,6 +283,22 @@ void DatabaseConnection::onObjectInstanceUpdate()
   }
 }
 
+void DatabaseConnection::onDatabaseChanges(const ChangeSet &changes)
+{
+  for ( const QVariant &account : changes.changed( ChangeSet::AccountObject ) ) {
+    onDatabaseAccountUpdate( account );
+  }
+  for ( const QVariant &todoList : changes.changed( ChangeSet::TodoListObject ) ) {
+    onDatabaseTodoListUpdate( todoList );
+  }
+  for ( const QVariant &todo : changes.changed( ChangeSet::TodoObject ) ) {
+    onDatabaseTodoUpdate( todo );
+  }
+  for ( const QVariant &task : changes.changed( ChangeSet::TaskObject ) ) {
+    onDatabaseTaskUpdate( task );
+  }
+}
+
 void DatabaseConnection::onDatabaseAccountUpdate(const QVariant &account)
 {
   onDatabaseUpdateImpl<Account>(account);
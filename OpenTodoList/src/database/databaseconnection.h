@@ -150,6 +150,7 @@ private:
 private slots:
 
   void onObjectInstanceUpdate();
+  void onDatabaseChanges(const ChangeSet &changes);
   void onDatabaseAccountUpdate(const QVariant &account);
   void onDatabaseTodoListUpdate(const QVariant &todoList);
   void onDatabaseTodoUpdate(const QVariant &todo);
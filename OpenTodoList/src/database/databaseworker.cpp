@@ -16,66 +16,309 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "core/tracer.h"
 #include "database/databaseworker.h"
+#include "database/migrationbatch.h"
+#include "database/rowcursor.h"
+#include "database/slowquerylog.h"
 #include "database/storagequery.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonDocument>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QSqlQuery>
+#include <QStringList>
+#include <QThread>
 
 namespace OpenTodoList {
 
 namespace DataBase {
 
+/**
+   @brief Returns the profile with the given @p profile name
+
+   Valid names are "safe", "balanced" and "fast" (case insensitive). If the name is unknown,
+   DefaultProfile is returned and @p ok (if given) is set to false.
+ */
+DatabaseWorker::Profile DatabaseWorker::profileFromString(const QString &profile, bool *ok)
+{
+  QString name = profile.trimmed().toLower();
+  bool valid = true;
+  Profile result = DefaultProfile;
+  if ( name == "safe" ) {
+    result = SafeProfile;
+  } else if ( name == "balanced" ) {
+    result = BalancedProfile;
+  } else if ( name == "fast" ) {
+    result = FastProfile;
+  } else {
+    valid = false;
+  }
+  if ( ok ) {
+    *ok = valid;
+  }
+  return result;
+}
+
+/**
+   @brief Returns the name of the @p profile
+ */
+QString DatabaseWorker::profileToString(DatabaseWorker::Profile profile)
+{
+  switch ( profile ) {
+  case SafeProfile: return "safe";
+  case BalancedProfile: return "balanced";
+  case FastProfile: return "fast";
+  }
+  return QString();
+}
+
 /**
    @brief Constructor
+
+   Creates a worker for the database stored at @p dbLocation. The database connection will be
+   configured according to the @p profile.
+
+   If @p readOnly is true, the worker uses its own, read-only connection to the database. Such
+   workers can only run queries which return true in StorageQuery::isReadOnly(). They do not
+   create or upgrade the database schema, so they must be initialized after the writing worker
+   has been initialized.
  */
-DatabaseWorker::DatabaseWorker(const QString &dbLocation) :
+DatabaseWorker::DatabaseWorker(const QString &dbLocation, Profile profile, bool readOnly) :
   QObject(),
   m_dataBase(),
   m_dataBaseFile( dbLocation ),
+  m_profile( profile ),
+  m_readOnly( readOnly ),
+  m_connectionName( readOnly ?
+                      QString( "OpenTodoListReader%1" ).arg(
+                        reinterpret_cast< quintptr >( this ) ) :
+                      QString( QSqlDatabase::defaultConnection ) ),
   m_initialized( false ),
-  m_queue(),
+  m_scheduler(),
   m_queueLock(),
-  m_runLock()
+  m_runLock(),
+  m_statementCache(),
+  m_queryStatistics(),
+  m_maxBatchSize( 100 ),
+  m_maxBatchLatency( 5 ),
+  m_batchTimer( new QTimer( this ) ),
+  m_schemaVersion( -1 ),
+  m_failedStatements( 0 ),
+  m_stopping( false ),
+  m_pendingMigrations(),
+  m_pendingMigrationsTotal( 0 ),
+  m_migrationRowsDone( 0 ),
+  m_fullTextSearch( false ),
+  m_slowQueryLog( nullptr )
 {
+  m_batchTimer->setSingleShot( true );
+  connect( m_batchTimer, &QTimer::timeout, this, &DatabaseWorker::next );
 }
 
 /**
    @brief Destructor
  */
 DatabaseWorker::~DatabaseWorker() {
+  m_statementCache.clear();
   m_dataBase.close();
   qDebug() << "Closed database";
-  m_dataBaseFile.close();
-  qDebug() << "Closed database file";
+  if ( m_readOnly ) {
+    m_dataBase = QSqlDatabase();
+    QSqlDatabase::removeDatabase( m_connectionName );
+  } else {
+    m_dataBaseFile.close();
+    qDebug() << "Closed database file";
+  }
+}
+
+/**
+   @brief The cache of prepared statements used by the worker
+
+   This can be used to inspect the cache's hit and miss counters.
+ */
+const StatementCache &DatabaseWorker::statementCache() const
+{
+  return m_statementCache;
+}
+
+/**
+   @brief The durability/performance profile used by the worker
+ */
+DatabaseWorker::Profile DatabaseWorker::profile() const
+{
+  return m_profile;
+}
+
+/**
+   @brief Does the worker use a read-only connection?
+ */
+bool DatabaseWorker::isReadOnly() const
+{
+  return m_readOnly;
+}
+
+/**
+   @brief The maximum number of scheduled queries committed together
+
+   @sa setMaxBatchSize()
+ */
+int DatabaseWorker::maxBatchSize() const
+{
+  QMutexLocker l( &m_queueLock );
+  return m_maxBatchSize;
+}
+
+/**
+   @brief Sets the maximum number of scheduled queries committed together
+
+   Scheduled queries are run in groups inside a single transaction. As soon as @p maxBatchSize
+   queries are waiting, they are run without waiting for further queries.
+ */
+void DatabaseWorker::setMaxBatchSize( int maxBatchSize )
+{
+  QMutexLocker l( &m_queueLock );
+  m_maxBatchSize = qMax( 1, maxBatchSize );
+}
+
+/**
+   @brief The maximum time (in ms) a scheduled query waits for others to be committed with
+
+   @sa setMaxBatchLatency()
+ */
+int DatabaseWorker::maxBatchLatency() const
+{
+  QMutexLocker l( &m_queueLock );
+  return m_maxBatchLatency;
+}
+
+/**
+   @brief Sets the maximum time (in ms) a scheduled query waits for others
+
+   When a query is scheduled into an empty queue, the worker waits at most
+   @p maxBatchLatency milliseconds for further queries before running the batch. A value of 0
+   runs queries as soon as the worker's event loop gets to them.
+ */
+void DatabaseWorker::setMaxBatchLatency( int maxBatchLatency )
+{
+  QMutexLocker l( &m_queueLock );
+  m_maxBatchLatency = qMax( 0, maxBatchLatency );
+}
+
+/**
+   @brief The scheduler holding the queries waiting to be run
+
+   This can be used to inspect the scheduler's statistics.
+ */
+const QueryScheduler &DatabaseWorker::scheduler() const
+{
+  return m_scheduler;
 }
 
 /**
    @brief Runs a query
 
-   This will run the @p query. Execution happens in the calling thread. The query will not be
+   This will run the @p query and block until it is done. The query will not be
    deleted after execution (in contrary to using DatabaseWorker::schedule()).
+
+   If called from the worker's thread, the query is run immediately in its own transaction.
+   Otherwise, the query is passed to the scheduler (so it is ordered according to its
+   priority) and the calling thread waits until the worker has run it.
  */
 void DatabaseWorker::run(StorageQuery *query)
 {
-  runQuery( query );
+  if ( QThread::currentThread() == thread() ) {
+    runNow( query );
+  } else {
+    QSemaphore finished;
+    {
+      QMutexLocker l( &m_queueLock );
+      m_scheduler.enqueue( query, &finished );
+      scheduleNext( true );
+    }
+    finished.acquire();
+  }
+}
+
+/**
+   @brief Runs the @p query immediately in the calling thread and in its own transaction
+ */
+void DatabaseWorker::runNow(StorageQuery *query)
+{
+  bool succeeded = false;
+  {
+    QMutexLocker l( &m_runLock );
+    connectQuery( query );
+    bool transaction = runStatement( beginTransactionStatement() );
+    succeeded = runQuery( query );
+    if ( transaction ) {
+      if ( succeeded ) {
+        succeeded = runStatement( "COMMIT;" );
+      }
+      if ( !succeeded ) {
+        runStatement( "ROLLBACK;" );
+      }
+    }
+  }
+  if ( !succeeded ) {
+    disconnectChangeSignals( query );
+  }
+  emit query->queryFinished();
+  publishChanges();
 }
 
 /**
    @brief Schedules a query
 
    Calling this method will enqueue the @p query and execute it later in the
-   Database worker's thread.
+   Database worker's thread. Queries scheduled within maxBatchLatency() are run
+   together in one transaction.
  */
 void DatabaseWorker::schedule(StorageQuery *query)
 {
   QMutexLocker l( &m_queueLock );
   if ( query ) {
-    m_queue.enqueue( query );
+    StorageQuery *mergedInto = nullptr;
+    if ( m_scheduler.enqueue( query, nullptr, &mergedInto ) ) {
+      scheduleNext( query->priority() == StorageQuery::InteractivePriority );
+    } else {
+      // The query has been merged into an earlier one which is still waiting. Keep it until
+      // that one has been run, as its owner considers the write done once it is destroyed
+      // (see BackendWrapper::scheduleQuery()):
+      query->setParent( mergedInto );
+    }
+  }
+}
+
+/**
+   @brief Makes sure the worker gets to the waiting queries
+
+   If @p urgent is true (or enough queries are waiting to fill a batch), the next batch
+   is run as soon as the worker's event loop gets to it. Otherwise, the worker waits up to
+   maxBatchLatency() for further queries.
+
+   @note Must be called with the queue lock being held.
+ */
+void DatabaseWorker::scheduleNext(bool urgent)
+{
+  if ( urgent || m_scheduler.size() >= m_maxBatchSize || m_maxBatchLatency == 0 ) {
     QMetaObject::invokeMethod( this, "next", Qt::QueuedConnection );
+  } else {
+    QMetaObject::invokeMethod( this, "armBatchTimer", Qt::QueuedConnection,
+                               Q_ARG( int, m_maxBatchLatency ) );
+  }
+}
+
+/**
+   @brief Makes sure the next batch is run at the latest after @p msec milliseconds
+ */
+void DatabaseWorker::armBatchTimer(int msec)
+{
+  if ( !m_batchTimer->isActive() || m_batchTimer->remainingTime() > msec ) {
+    m_batchTimer->start( msec );
   }
 }
 
@@ -86,10 +329,11 @@ void DatabaseWorker::init() {
   if ( m_initialized ) {
     return;
   }
+  Core::Tracer::Scope scope( m_readOnly ? "DatabaseWorker::init (reader)" : "DatabaseWorker::init" );
 
-  m_dataBase = QSqlDatabase::addDatabase( "QSQLITE" );
+  m_dataBase = QSqlDatabase::addDatabase( "QSQLITE", m_connectionName );
 
-  if ( !m_dataBaseFile.open( QIODevice::ReadWrite ) ) {
+  if ( !m_readOnly && !m_dataBaseFile.open( QIODevice::ReadWrite ) ) {
     qWarning() << "Failed to open" << m_dataBaseFile.fileName()
                << "because of:" << m_dataBaseFile.errorString();
   } else {
@@ -105,43 +349,304 @@ void DatabaseWorker::init() {
       // NOTE: Needs to be run on every connection to the database (not just once when
       //       creating the tables).
       runSimpleQuery( "PRAGMA foreign_keys=ON;", "Failed to enable foreign key support" );
+      applyProfile();
 
-      // Read schema version
-      QSqlQuery readSchemaVersionQuery( m_dataBase );
-      int version = -1;
-      if ( readSchemaVersionQuery.exec( "SELECT version FROM schemaVersion LIMIT 1;" ) &&
-           readSchemaVersionQuery.next() ) {
-        version = readSchemaVersionQuery.record().value( "version" ).toInt();
-        readSchemaVersionQuery.finish();
+      if ( m_readOnly ) {
+        runSimpleQuery( "PRAGMA query_only=ON;", "Failed to make connection read-only" );
+      } else {
+        updateSchema();
+        startBackgroundMigrations();
       }
+    }
+
+    m_initialized = true;
+  }
+
+  emit initialized();
+}
+
+/**
+   @brief The registered schema migrations, ordered by version
+ */
+const QVector< DatabaseWorker::Migration > &DatabaseWorker::migrations()
+{
+  static const QVector< Migration > Migrations = {
+    { 0, "Creating database", &DatabaseWorker::updateToSchemaVersion0,
+      QString(), QString() },
+    { 1, "Adding indexes", &DatabaseWorker::updateToSchemaVersion1,
+      "ANALYZE;", QString() },
+    { 2, "Building search index", &DatabaseWorker::updateToSchemaVersion2,
+      "DELETE FROM searchIndexPending WHERE rowid IN "
+      "( SELECT rowid FROM searchIndexPending LIMIT :batchSize );",
+      "SELECT COUNT(*) FROM searchIndexPending;" },
+    { 3, "Adding paging indexes", &DatabaseWorker::updateToSchemaVersion3,
+      "ANALYZE;", QString() }
+  };
+  return Migrations;
+}
+
+/**
+   @brief The schema version created by the last registered migration
+ */
+int DatabaseWorker::latestSchemaVersion()
+{
+  return migrations().last().version;
+}
+
+/**
+   @brief The schema version of the database
+
+   This is -1 if the worker has not been initialized yet or uses a read-only connection.
+ */
+int DatabaseWorker::schemaVersion() const
+{
+  return m_schemaVersion;
+}
+
+/**
+   @brief Can todos be searched using the full text search index?
+
+   This is the case if the SQLite library supports FTS5 and the search index has been built
+   completely (see updateToSchemaVersion2()). Otherwise, queries have to fall back to scanning
+   the todos and tasks.
+
+   @note Must be called from the worker's thread.
+ */
+bool DatabaseWorker::hasFullTextSearch() const
+{
+  // Once the index is complete, triggers keep it up to date, so the result can be cached:
+  if ( !m_fullTextSearch && m_dataBase.isOpen() ) {
+    QSqlQuery query( m_dataBase );
+    if ( query.exec( "SELECT EXISTS ( SELECT 1 FROM sqlite_master "
+                     "WHERE type = 'table' AND name = 'todoSearch' ) "
+                     "AND NOT EXISTS ( SELECT 1 FROM searchIndexPending );" ) &&
+         query.next() ) {
+      m_fullTextSearch = query.value( 0 ).toBool();
+    }
+    query.finish();
+  }
+  return m_fullTextSearch;
+}
+
+/**
+   @brief Statistics about the statements run by the worker
+
+   @note If the application has been built with OPENTODOLIST_NO_QUERY_STATISTICS, no
+         statistics are collected.
+ */
+const QueryStatistics &DatabaseWorker::queryStatistics() const
+{
+  return m_queryStatistics;
+}
+
+/**
+   @brief The log slow statements are recorded in
+
+   This is nullptr if slow statements are not recorded.
+ */
+SlowQueryLog *DatabaseWorker::slowQueryLog() const
+{
+  return m_slowQueryLog;
+}
+
+/**
+   @brief Sets the log to record slow statements in
+
+   The log is not owned by the worker. This must be called before the worker is started.
+ */
+void DatabaseWorker::setSlowQueryLog(SlowQueryLog *slowQueryLog)
+{
+  m_slowQueryLog = slowQueryLog;
+}
+
+/**
+   @brief Creates or upgrades the database schema
 
-      switch ( version ) {
-      case -1:
-        updateToSchemaVersion0();
-        break;
+   All migrations to versions newer than the one of the database are applied in order. If
+   one of them fails, the database is left at the last version that could be reached.
+ */
+void DatabaseWorker::updateSchema()
+{
+  // Read schema version
+  QSqlQuery readSchemaVersionQuery( m_dataBase );
+  int version = -1;
+  if ( readSchemaVersionQuery.exec( "SELECT version FROM schemaVersion LIMIT 1;" ) &&
+       readSchemaVersionQuery.next() ) {
+    version = readSchemaVersionQuery.record().value( "version" ).toInt();
+    readSchemaVersionQuery.finish();
+  }
+  m_schemaVersion = version;
+
+  if ( version > latestSchemaVersion() ) {
+    qCritical() << "The used database appears to use schema version" << version
+                << "of the application. This version belongs to a future version of"
+                << "the application! Please update the application.";
+    return;
+  }
+
+  runSimpleQuery( "CREATE TABLE IF NOT EXISTS schemaBackgroundMigration ("
+                  " version INTEGER NOT NULL,"
+                  " PRIMARY KEY ( version ) );",
+                  "Failed to create table schemaBackgroundMigration" );
+
+  if ( version == latestSchemaVersion() ) {
+    qDebug() << "DB uses schema version" << version << "- nothing to be done to upgrade.";
+    return;
+  }
+
+  QList< const Migration* > steps;
+  for ( const Migration &entry : migrations() ) {
+    if ( entry.version > version ) {
+      steps << &entry;
+    }
+  }
+  for ( int i = 0; i < steps.size(); ++i ) {
+    const Migration *step = steps.at( i );
+    qDebug() << "Upgrading DB to schema version" << step->version;
+    emit migrationProgress( step->description, static_cast< double >( i ) / steps.size() );
+    if ( !applyMigration( *step ) ) {
+      qCritical() << "Failed to upgrade DB to schema version" << step->version;
+      break;
+    }
+    m_schemaVersion = step->version;
+  }
+}
 
-      case 0:
-        qDebug() << "DB uses schema version 0. Nothing to be done to upgrade.";
-        break;
+/**
+   @brief Applies the @p migration in a single transaction
+
+   Besides changing the schema, this stores the new schema version and records the background
+   work of the migration (if any). Returns false (and rolls back all changes) if any of
+   the statements failed.
+ */
+bool DatabaseWorker::applyMigration(const Migration &migration)
+{
+  Core::Tracer::Scope scope( "DatabaseWorker::applyMigration", Core::Tracer::DefaultCategory,
+                             migration.description );
+  int failedStatements = m_failedStatements;
+  runSimpleQuery( "BEGIN IMMEDIATE;", "Failed to start schema migration" );
+  ( this->*migration.apply )();
+  runSimpleQuery( "DELETE FROM schemaVersion;", "Failed to reset schema version" );
+  runSimpleQuery( QString( "INSERT INTO schemaVersion ( version ) VALUES ( %1 );" )
+                  .arg( migration.version ),
+                  "Failed to save current schema version" );
+  if ( !migration.backgroundStatement.isEmpty() ) {
+    runSimpleQuery( QString( "INSERT OR IGNORE INTO schemaBackgroundMigration ( version ) "
+                             "VALUES ( %1 );" ).arg( migration.version ),
+                    "Failed to record background migration" );
+  }
+  if ( m_failedStatements != failedStatements ) {
+    runSimpleQuery( "ROLLBACK;" );
+    return false;
+  }
+  runSimpleQuery( "COMMIT;", "Failed to commit schema migration" );
+  return m_failedStatements == failedStatements;
+}
 
-      default:
-        qCritical() << "The used database appears to use schema version" << version
-                    << "of the application. This version belongs to a future version of"
-                    << "the application! Please update the application.";
-        break;
+/**
+   @brief Resumes the background work of migrations applied earlier
+ */
+void DatabaseWorker::startBackgroundMigrations()
+{
+  m_pendingMigrations.clear();
+  QSqlQuery query( m_dataBase );
+  if ( query.exec( "SELECT version FROM schemaBackgroundMigration ORDER BY version;" ) ) {
+    while ( query.next() ) {
+      int version = query.value( 0 ).toInt();
+      if ( migration( version ) != nullptr ) {
+        m_pendingMigrations << version;
+      } else {
+        qWarning() << "Skipping unknown background migration to schema version" << version;
       }
     }
+  }
+  query.finish();
+  m_pendingMigrationsTotal = m_pendingMigrations.size();
+  m_migrationRowsDone = 0;
+  if ( m_pendingMigrations.isEmpty() ) {
+    emit migrationProgress( QString(), 1.0 );
+  } else {
+    emit migrationProgress( migration( m_pendingMigrations.first() )->description, 0.0 );
+    scheduleMigrationBatch();
+  }
+}
 
-    m_initialized = true;
+/**
+   @brief Schedules the next batch of the first pending background migration
+ */
+void DatabaseWorker::scheduleMigrationBatch()
+{
+  if ( m_stopping || m_pendingMigrations.isEmpty() ) {
+    return;
   }
+  const Migration *pending = migration( m_pendingMigrations.first() );
+  MigrationBatch *batch = new MigrationBatch( pending->version,
+                                              pending->backgroundStatement,
+                                              pending->remainingStatement,
+                                              MigrationBatchSize );
+  // Note: Not using the worker as context, as change signals of failed queries are
+  //       disconnected from it.
+  connect( batch, &StorageQuery::queryFinished, [this, batch] {
+    migrationBatchFinished( batch );
+  } );
+  schedule( batch );
+}
 
-  emit initialized();
+/**
+   @brief Reports progress after the @p batch has been run and schedules the next one
+ */
+void DatabaseWorker::migrationBatchFinished(MigrationBatch *batch)
+{
+  if ( !batch->isSucceeded() ) {
+    qWarning() << "Background migration to schema version" << batch->version()
+               << "failed. It will be retried on next start.";
+    m_pendingMigrations.clear();
+    emit migrationProgress( QString(), 1.0 );
+    return;
+  }
+
+  double fraction = 0.0;
+  if ( batch->isMigrationFinished() ) {
+    m_pendingMigrations.removeFirst();
+    m_migrationRowsDone = 0;
+  } else {
+    m_migrationRowsDone += batch->batchSize();
+    if ( batch->remaining() >= 0 ) {
+      fraction = static_cast< double >( m_migrationRowsDone ) /
+          ( m_migrationRowsDone + batch->remaining() );
+    }
+  }
+
+  if ( m_pendingMigrations.isEmpty() ) {
+    emit migrationProgress( QString(), 1.0 );
+  } else {
+    int done = m_pendingMigrationsTotal - m_pendingMigrations.size();
+    emit migrationProgress( migration( m_pendingMigrations.first() )->description,
+                            ( done + fraction ) / m_pendingMigrationsTotal );
+    scheduleMigrationBatch();
+  }
+}
+
+/**
+   @brief Returns the registered migration creating the given schema @p version
+
+   Returns nullptr if there is no such migration.
+ */
+const DatabaseWorker::Migration *DatabaseWorker::migration(int version)
+{
+  for ( const Migration &entry : migrations() ) {
+    if ( entry.version == version ) {
+      return &entry;
+    }
+  }
+  return nullptr;
 }
 
 void DatabaseWorker::runSimpleQuery(const QString &query, const QString &errorMsg)
 {
   QSqlQuery q( query, m_dataBase );
   if ( q.lastError().isValid() ) {
+    ++m_failedStatements;
     if ( !errorMsg.isEmpty() ) {
       qCritical() << errorMsg;
     }
@@ -149,71 +654,318 @@ void DatabaseWorker::runSimpleQuery(const QString &query, const QString &errorMs
   }
 }
 
+/**
+   @brief Configures the database connection according to the profile()
+
+   Like enabling foreign keys, this has to be done for every connection to the database.
+ */
+void DatabaseWorker::applyProfile()
+{
+  qDebug() << "Using database profile" << profileToString( m_profile );
+
+  // Wait for locks held by other connections instead of failing immediately:
+  runSimpleQuery( "PRAGMA busy_timeout=5000;", "Failed to set busy timeout" );
+
+  // The journal mode is persistent and can only be changed by the writing connection:
+  if ( !m_readOnly ) {
+    runSimpleQuery( m_profile == SafeProfile ? "PRAGMA journal_mode=DELETE;" :
+                                               "PRAGMA journal_mode=WAL;",
+                    "Failed to set journal mode" );
+  }
+
+  switch ( m_profile ) {
+  case SafeProfile:
+    runSimpleQuery( "PRAGMA synchronous=FULL;", "Failed to set synchronous mode" );
+    break;
+
+  case BalancedProfile:
+    runSimpleQuery( "PRAGMA synchronous=NORMAL;", "Failed to set synchronous mode" );
+    break;
+
+  case FastProfile:
+    runSimpleQuery( "PRAGMA synchronous=NORMAL;", "Failed to set synchronous mode" );
+    // 64 MiB page cache (negative values are interpreted as KiB):
+    runSimpleQuery( "PRAGMA cache_size=-65536;", "Failed to set cache size" );
+    runSimpleQuery( "PRAGMA mmap_size=268435456;", "Failed to enable memory mapped I/O" );
+    runSimpleQuery( "PRAGMA temp_store=MEMORY;", "Failed to set temp store" );
+    break;
+  }
+}
+
+/**
+   @brief The statement used to start a transaction
+
+   The writer immediately acquires the write lock, so that transactions are not aborted
+   half-way. Readers use deferred transactions, which give them a consistent snapshot without
+   ever blocking the writer.
+ */
+QString DatabaseWorker::beginTransactionStatement() const
+{
+  return m_readOnly ? "BEGIN;" : "BEGIN IMMEDIATE;";
+}
+
+/**
+   @brief Runs a single statement on the database
+
+   This is used for e.g. transaction control. The statement is taken from the statement cache.
+   Returns true on success.
+ */
+bool DatabaseWorker::runStatement(const QString &statement)
+{
+  QSqlError error;
+  QSqlQuery *q = m_statementCache.statement( m_dataBase, statement, &error );
+  if ( !q ) {
+    qWarning() << "Failed to prepare" << statement << ":" << error.text();
+    return false;
+  }
+  bool result = q->exec();
+  if ( !result ) {
+    qWarning() << "Failed to run" << statement << ":" << q->lastError().text();
+  }
+  q->finish();
+  return result;
+}
+
+/**
+   @brief Connects the signals of the @p query to the worker's ones
+
+   Change signals emitted by the query are recorded in the set of pending changes, which is
+   broadcasted by publishChanges() once the transaction the query ran in has been processed
+   completely.
+ */
+void DatabaseWorker::connectQuery(StorageQuery *query)
+{
+  connect( query, &StorageQuery::backendChanged, this, [this] (const QVariant &backend) {
+    recordChange( ChangeSet::BackendObject, backend, false );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::accountChanged, this, [this] (const QVariant &account) {
+    recordChange( ChangeSet::AccountObject, account, false );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::todoListChanged, this, [this] (const QVariant &todoList) {
+    recordChange( ChangeSet::TodoListObject, todoList, false );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::todoChanged, this, [this] (const QVariant &todo) {
+    recordChange( ChangeSet::TodoObject, todo, false );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::taskChanged, this, [this] (const QVariant &task) {
+    recordChange( ChangeSet::TaskObject, task, false );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::accountDeleted, this, [this] (const QVariant &account) {
+    recordChange( ChangeSet::AccountObject, account, true );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::todoListDeleted, this, [this] (const QVariant &todoList) {
+    recordChange( ChangeSet::TodoListObject, todoList, true );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::todoDeleted, this, [this] (const QVariant &todo) {
+    recordChange( ChangeSet::TodoObject, todo, true );
+  }, Qt::DirectConnection );
+  connect( query, &StorageQuery::taskDeleted, this, [this] (const QVariant &task) {
+    recordChange( ChangeSet::TaskObject, task, true );
+  }, Qt::DirectConnection );
+  query->m_worker = this;
+}
+
+/**
+   @brief Stops broadcasting change signals of the @p query
+
+   This is used for queries whose changes have been rolled back.
+ */
+void DatabaseWorker::disconnectChangeSignals(StorageQuery *query)
+{
+  disconnect( query, 0, this, 0 );
+}
+
+/**
+   @brief Adds a change to the set of pending changes
+ */
+void DatabaseWorker::recordChange(ChangeSet::ObjectType type, const QVariant &object,
+                                  bool deleted)
+{
+  QMutexLocker l( &m_changesLock );
+  if ( deleted ) {
+    m_pendingChanges.addDeleted( type, object );
+  } else {
+    m_pendingChanges.addChanged( type, object );
+  }
+}
+
+/**
+   @brief Broadcasts the pending changes
+
+   This emits changesAvailable() with all changes recorded since the last call (if any).
+ */
+void DatabaseWorker::publishChanges()
+{
+  ChangeSet changes;
+  {
+    QMutexLocker l( &m_changesLock );
+    if ( m_pendingChanges.isEmpty() ) {
+      return;
+    }
+    changes = m_pendingChanges;
+    m_pendingChanges.clear();
+  }
+  emit changesAvailable( changes );
+}
+
 /**
    @brief Runs the @p query
+
+   This runs all steps of the query. The caller is responsible for transaction handling and
+   emitting StorageQuery::queryFinished(). Returns false if any step failed; in that case
+   the remaining steps are skipped.
  */
-void DatabaseWorker::runQuery(StorageQuery *query)
+bool DatabaseWorker::runQuery(StorageQuery *query)
 {
-  QMutexLocker l( &m_runLock );
+  bool succeeded = true;
   do {
-    connect( query, &StorageQuery::backendChanged,
-             this, &DatabaseWorker::backendChanged, Qt::QueuedConnection );
-    connect( query, &StorageQuery::accountChanged,
-             this, &DatabaseWorker::accountChanged, Qt::QueuedConnection );
-    connect( query, &StorageQuery::todoListChanged,
-             this, &DatabaseWorker::todoListChanged, Qt::QueuedConnection );
-    connect( query, &StorageQuery::todoChanged,
-             this, &DatabaseWorker::todoChanged, Qt::QueuedConnection );
-    connect( query, &StorageQuery::taskChanged,
-             this, &DatabaseWorker::taskChanged, Qt::QueuedConnection );
-    connect( query, &StorageQuery::accountDeleted,
-             this, &DatabaseWorker::accountDeleted, Qt::QueuedConnection );
-    connect( query, &StorageQuery::todoListDeleted,
-             this, &DatabaseWorker::todoListDeleted, Qt::QueuedConnection );
-    connect( query, &StorageQuery::todoDeleted,
-             this, &DatabaseWorker::todoDeleted, Qt::QueuedConnection );
-    connect( query, &StorageQuery::taskDeleted,
-             this, &DatabaseWorker::taskDeleted, Qt::QueuedConnection );
-    query->m_worker = this;
     query->beginRun();
     QString queryStr;
     QVariantMap values;
     int options = 0;
     bool validQuery = query->query( queryStr, values, options );
     if ( validQuery ) {
-      if ( options & StorageQuery::QueryIsUpdateQuery ) {
-        runSimpleQuery( "PRAGMA foreign_keys=0;" );
-      }
-      QSqlQuery q( m_dataBase );
-      q.prepare( queryStr );
-      foreach ( QString key, values.keys() ) {
-        q.bindValue( ":" + key, values.value( key ) );
-      }
-      if ( q.exec() ) {
-        while ( q.next() ) {
-          QVariantMap recordData;
-          for ( int i = 0; i < q.record().count(); ++i ) {
-            recordData.insert( q.record().fieldName( i ),
-                               q.record().value( i ) );
-          }
-          query->recordAvailable( recordData );
+      QElapsedTimer timer;
+      timer.start();
+      int rows = -1;
+      QSqlError error;
+      QSqlQuery *q = m_statementCache.statement( m_dataBase, queryStr, &error );
+      if ( q ) {
+        for ( auto it = values.constBegin(); it != values.constEnd(); ++it ) {
+          q->bindValue( ":" + it.key(), it.value() );
         }
-        if ( q.lastInsertId().isValid() ) {
-          query->newIdAvailable( q.lastInsertId() );
+        if ( q->exec() ) {
+          RowCursor cursor( q );
+          query->columnsAvailable( cursor );
+          rows = 0;
+          while ( q->next() ) {
+            query->rowAvailable( cursor );
+            ++rows;
+          }
+          if ( q->lastInsertId().isValid() ) {
+            query->newIdAvailable( q->lastInsertId() );
+          }
+        } else {
+          qWarning() << q->lastError().text();
+          qWarning() << q->executedQuery();
+          qWarning() << queryStr;
+          qWarning() << values;
+          succeeded = false;
         }
+        q->finish();
       } else {
-        qWarning() << q.lastError().text();
-        qWarning() << q.executedQuery();
+        qWarning() << error.text();
         qWarning() << queryStr;
         qWarning() << values;
+        succeeded = false;
+      }
+      qint64 elapsed = timer.nsecsElapsed();
+#ifndef OPENTODOLIST_NO_QUERY_STATISTICS
+      if ( rows >= 0 ) {
+        m_queryStatistics.record( query->queryClass(), rows, elapsed );
+      } else {
+        m_queryStatistics.recordFailure( query->queryClass() );
       }
-      if ( options & StorageQuery::QueryIsUpdateQuery ) {
-        runSimpleQuery( "PRAGMA foreign_keys=1;" );
+#endif
+      if ( m_slowQueryLog && rows >= 0 && m_slowQueryLog->isSlow( elapsed ) ) {
+        logSlowQuery( query, queryStr, values, rows, elapsed );
       }
     }
     query->endRun();
-  } while ( query->hasNext() );
-  emit query->queryFinished();
+  } while ( succeeded && query->hasNext() );
+  return succeeded;
+}
+
+/**
+   @brief Records the @p statement run by the @p query in the slow query log
+
+   The query plan is only determined the first time a statement is recorded.
+ */
+void DatabaseWorker::logSlowQuery(StorageQuery *query, const QString &statement,
+                                  const QVariantMap &args, int rows, qint64 nsecs )
+{
+  SlowQueryLog::Record record;
+  record.queryClass = query->queryClass();
+  record.statement = statement;
+  record.arguments = args;
+  record.rows = rows;
+  record.duration = nsecs / 1000000.0;
+  if ( !m_slowQueryLog->hasPlan( statement ) ) {
+    record.plan = explainQueryPlan( statement, args );
+  }
+  m_slowQueryLog->record( record );
+}
+
+/**
+   @brief Returns the query plan SQLite uses for the @p statement
+
+   Each entry of the returned list is the detail of one step of the plan, indented by its
+   depth in the plan.
+ */
+QStringList DatabaseWorker::explainQueryPlan(const QString &statement, const QVariantMap &args)
+{
+  QStringList result;
+  QSqlQuery explain( m_dataBase );
+  explain.setForwardOnly( true );
+  if ( !explain.prepare( "EXPLAIN QUERY PLAN " + statement ) ) {
+    return result;
+  }
+  for ( auto it = args.constBegin(); it != args.constEnd(); ++it ) {
+    explain.bindValue( ":" + it.key(), it.value() );
+  }
+  if ( explain.exec() ) {
+    int idColumn = explain.record().indexOf( "id" );
+    int parentColumn = explain.record().indexOf( "parent" );
+    int detailColumn = explain.record().indexOf( "detail" );
+    QHash< int, int > depths;
+    while ( explain.next() ) {
+      int depth = 0;
+      if ( idColumn >= 0 && parentColumn >= 0 ) {
+        depth = depths.value( explain.value( parentColumn ).toInt(), -1 ) + 1;
+        depths.insert( explain.value( idColumn ).toInt(), depth );
+      }
+      result << QString( depth * 2, ' ' ) + explain.value( detailColumn ).toString();
+    }
+  }
+  explain.finish();
+  return result;
+}
+
+/**
+   @brief Runs the @p queries in a single transaction
+
+   Each query is run inside its own savepoint, so a failing query is rolled back without
+   affecting the others. The StorageQuery::queryFinished() signals are emitted once the
+   transaction has been committed; the changes done by the queries are then broadcasted as a
+   single change set.
+ */
+void DatabaseWorker::runBatch(const QList<StorageQuery *> &queries)
+{
+  QList< StorageQuery* > failed;
+  {
+    QMutexLocker l( &m_runLock );
+    bool transaction = runStatement( beginTransactionStatement() );
+    for ( StorageQuery *query : queries ) {
+      connectQuery( query );
+      runStatement( "SAVEPOINT storageQuery;" );
+      if ( !runQuery( query ) ) {
+        runStatement( "ROLLBACK TO storageQuery;" );
+        failed << query;
+      }
+      runStatement( "RELEASE storageQuery;" );
+    }
+    if ( transaction && !runStatement( "COMMIT;" ) ) {
+      runStatement( "ROLLBACK;" );
+      failed = queries;
+    }
+  }
+  for ( StorageQuery *query : queries ) {
+    if ( failed.contains( query ) ) {
+      disconnectChangeSignals( query );
+    }
+    emit query->queryFinished();
+  }
+  publishChanges();
 }
 
 /**
@@ -369,26 +1121,221 @@ void DatabaseWorker::updateToSchemaVersion0()
                   " FOREIGN KEY ( attributeName ) REFERENCES taskMetaAttributeName ( id ) ON DELETE CASCADE"
                   ");",
                   "Failed to create table taskMetaAttribute" );
+}
 
-  runSimpleQuery( "INSERT INTO schemaVersion  (version) VALUES ( 0 );",
-                  "Failed to save current schema version" );
+/**
+   @brief Updates the database to schema version 1
+
+   Version 1 adds secondary indexes for the predicates used by the queries:
+
+   - The foreign keys to the parent objects, which are used to read the children of an object and
+     when deleting objects cascades to their children. For todos and tasks, the index also covers
+     the weight, so that children can be read in order without a separate sort step.
+   - Partial indexes on modified (dirty > 0) and disposed (disposed > 0) objects. Backends scan
+     for these when syncing; as usually only few objects are affected, these indexes stay small.
+     Both are range conditions, so the query planner still picks these indexes when they are
+     empty and hence have no statistics.
+   - The due date of todos, which is used to find scheduled todos and to page through todos
+     by due date.
+   - The attribute name of meta attributes, which is required when names are deleted.
+
+   The statistics used by the query planner are updated in the background afterwards.
+ */
+void DatabaseWorker::updateToSchemaVersion1()
+{
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS accountBackendIndex ON account ( backend );",
+                  "Failed to create index on account.backend" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoListAccountIndex ON todoList ( account );",
+                  "Failed to create index on todoList.account" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoTodoListIndex ON todo ( todoList, weight );",
+                  "Failed to create index on todo.todoList" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS taskTodoIndex ON task ( todo, weight );",
+                  "Failed to create index on task.todo" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoDueDateIndex ON todo ( dueDate );",
+                  "Failed to create index on todo.dueDate" );
+
+  for ( const QString &table : QStringList() << "account" << "todoList" << "todo" << "task" ) {
+    runSimpleQuery( QString( "CREATE INDEX IF NOT EXISTS %1DirtyIndex ON %1 ( dirty ) "
+                             "WHERE dirty > 0;" ).arg( table ),
+                    QString( "Failed to create index on %1.dirty" ).arg( table ) );
+    runSimpleQuery( QString( "CREATE INDEX IF NOT EXISTS %1DisposedIndex ON %1 ( disposed ) "
+                             "WHERE disposed > 0;" ).arg( table ),
+                    QString( "Failed to create index on %1.disposed" ).arg( table ) );
+    runSimpleQuery( QString( "CREATE INDEX IF NOT EXISTS %1MetaAttributeNameIndex "
+                             "ON %1MetaAttribute ( attributeName );" ).arg( table ),
+                    QString( "Failed to create index on %1MetaAttribute.attributeName" )
+                    .arg( table ) );
+  }
+}
+
+/**
+   @brief Updates the database to schema version 2
+
+   Version 2 adds FTS5 full text search indexes over the title and description of todos
+   (todoSearch) and the title of tasks (taskSearch). Triggers keep them in sync with the todo and
+   task tables.
+
+   Existing todos and tasks are indexed in the background: They are recorded in the
+   searchIndexPending table; deleting a row from there indexes the object it refers to. Until
+   that table is empty, searching falls back to scanning (see hasFullTextSearch()). This is also
+   the case if SQLite has been built without FTS5.
+ */
+void DatabaseWorker::updateToSchemaVersion2()
+{
+  runSimpleQuery( "CREATE TABLE searchIndexPending ("
+                  " type INTEGER NOT NULL,"
+                  " id INTEGER NOT NULL,"
+                  " PRIMARY KEY ( type, id ) );",
+                  "Failed to create table searchIndexPending" );
+
+  QSqlQuery fts5Query( m_dataBase );
+  bool fts5 = fts5Query.exec( "SELECT sqlite_compileoption_used( 'ENABLE_FTS5' );" ) &&
+      fts5Query.next() && fts5Query.value( 0 ).toBool();
+  fts5Query.finish();
+  if ( !fts5 ) {
+    qWarning() << "SQLite has been built without FTS5 support. Searching todos will be slow.";
+    return;
+  }
+
+  runSimpleQuery( "CREATE VIRTUAL TABLE todoSearch USING fts5 ("
+                  " title, description, tokenize = 'unicode61 remove_diacritics 1' );",
+                  "Failed to create table todoSearch" );
+  runSimpleQuery( "CREATE VIRTUAL TABLE taskSearch USING fts5 ("
+                  " title, tokenize = 'unicode61 remove_diacritics 1' );",
+                  "Failed to create table taskSearch" );
+
+  // Note: Updates delete the old entry first, so objects which are still waiting to be indexed
+  //       in the background can be handled the same way as indexed ones.
+  runSimpleQuery( "CREATE TRIGGER todoSearchInsert AFTER INSERT ON todo BEGIN"
+                  " INSERT INTO todoSearch ( rowid, title, description )"
+                  " VALUES ( new.id, new.title, new.description );"
+                  " END;",
+                  "Failed to create trigger todoSearchInsert" );
+  runSimpleQuery( "CREATE TRIGGER todoSearchUpdate AFTER UPDATE OF title, description ON todo BEGIN"
+                  " DELETE FROM todoSearch WHERE rowid = old.id;"
+                  " INSERT INTO todoSearch ( rowid, title, description )"
+                  " VALUES ( new.id, new.title, new.description );"
+                  " END;",
+                  "Failed to create trigger todoSearchUpdate" );
+  runSimpleQuery( "CREATE TRIGGER todoSearchDelete AFTER DELETE ON todo BEGIN"
+                  " DELETE FROM todoSearch WHERE rowid = old.id;"
+                  " END;",
+                  "Failed to create trigger todoSearchDelete" );
+  runSimpleQuery( "CREATE TRIGGER taskSearchInsert AFTER INSERT ON task BEGIN"
+                  " INSERT INTO taskSearch ( rowid, title ) VALUES ( new.id, new.title );"
+                  " END;",
+                  "Failed to create trigger taskSearchInsert" );
+  runSimpleQuery( "CREATE TRIGGER taskSearchUpdate AFTER UPDATE OF title ON task BEGIN"
+                  " DELETE FROM taskSearch WHERE rowid = old.id;"
+                  " INSERT INTO taskSearch ( rowid, title ) VALUES ( new.id, new.title );"
+                  " END;",
+                  "Failed to create trigger taskSearchUpdate" );
+  runSimpleQuery( "CREATE TRIGGER taskSearchDelete AFTER DELETE ON task BEGIN"
+                  " DELETE FROM taskSearch WHERE rowid = old.id;"
+                  " END;",
+                  "Failed to create trigger taskSearchDelete" );
+
+  // Type 0 refers to todos, type 1 to tasks:
+  runSimpleQuery( "CREATE TRIGGER searchIndexPendingDelete BEFORE DELETE ON searchIndexPending BEGIN"
+                  " DELETE FROM todoSearch WHERE old.type = 0 AND rowid = old.id;"
+                  " INSERT INTO todoSearch ( rowid, title, description )"
+                  " SELECT id, title, description FROM todo WHERE old.type = 0 AND id = old.id;"
+                  " DELETE FROM taskSearch WHERE old.type = 1 AND rowid = old.id;"
+                  " INSERT INTO taskSearch ( rowid, title )"
+                  " SELECT id, title FROM task WHERE old.type = 1 AND id = old.id;"
+                  " END;",
+                  "Failed to create trigger searchIndexPendingDelete" );
+  runSimpleQuery( "INSERT INTO searchIndexPending ( type, id ) SELECT 0, id FROM todo;",
+                  "Failed to queue todos for indexing" );
+  runSimpleQuery( "INSERT INTO searchIndexPending ( type, id ) SELECT 1, id FROM task;",
+                  "Failed to queue tasks for indexing" );
 }
 
 /**
-   @brief Executes the next query in the queue
+   @brief Updates the database to schema version 3
 
-   This will run the next query from the queue and delete it after the run.
+   Version 3 adds indexes for paging through todos by the keys the models sort them by (see
+   Queries::Private::ReadObject::setAfter()), both for reading the todos of a single list and for
+   reading todos of all lists. As the ID is the row ID, each index implicitly ends with it, so
+   the database can seek directly to the start of each page. Paging by weight within a list is
+   covered by todoTodoListIndex and paging by due date over all lists by todoDueDateIndex (both
+   from version 1).
+
+   Titles are paged through case insensitively (see TodoModel::createPageQuery()), so the title
+   indexes use the NOCASE collation.
+ */
+void DatabaseWorker::updateToSchemaVersion3()
+{
+  // Reading the todos of one list:
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoTitleIndex "
+                  "ON todo ( todoList, title COLLATE NOCASE );",
+                  "Failed to create index on todo.title" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoPriorityIndex ON todo ( todoList, priority );",
+                  "Failed to create index on todo.priority" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoDueDatePagingIndex ON todo ( todoList, dueDate );",
+                  "Failed to create index on todo.dueDate" );
+  // Reading todos of all lists:
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoTitleOrderIndex ON todo ( title COLLATE NOCASE );",
+                  "Failed to create index on todo.title" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoPriorityOrderIndex ON todo ( priority );",
+                  "Failed to create index on todo.priority" );
+  runSimpleQuery( "CREATE INDEX IF NOT EXISTS todoWeightOrderIndex ON todo ( weight );",
+                  "Failed to create index on todo.weight" );
+}
+
+/**
+   @brief Executes the next batch of queries in the queue
+
+   This will take up to maxBatchSize() queries from the scheduler (in order of their priority),
+   run them in one transaction and delete them afterwards. Queries passed in via run() are
+   not deleted; instead, the waiting thread is woken up.
  */
 void DatabaseWorker::next()
 {
-  QMutexLocker l( &m_queueLock );
-  StorageQuery *query = 0;
-  if ( !m_queue.isEmpty() ) {
-    query = m_queue.dequeue();
+  QList< QueryScheduler::Entry > batch;
+  {
+    QMutexLocker l( &m_queueLock );
+    QueryScheduler::Entry entry;
+    while ( batch.size() < m_maxBatchSize && m_scheduler.take( entry ) ) {
+      batch << entry;
+    }
+    int nextReadyIn = m_scheduler.nextReadyIn();
+    if ( nextReadyIn == 0 ) {
+      QMetaObject::invokeMethod( this, "next", Qt::QueuedConnection );
+    } else if ( nextReadyIn > 0 ) {
+      // Only held back writes are left; come back once the first one is due:
+      armBatchTimer( nextReadyIn );
+    }
   }
-  if ( query ) {
-    runQuery( query );
-    delete query;
+  if ( !batch.isEmpty() ) {
+    QList< StorageQuery* > queries;
+    for ( const QueryScheduler::Entry &entry : batch ) {
+      queries << entry.query;
+    }
+    runBatch( queries );
+    for ( const QueryScheduler::Entry &entry : batch ) {
+      if ( entry.finished ) {
+        entry.finished->release();
+      } else {
+        delete entry.query;
+      }
+    }
+  }
+}
+
+/**
+   @brief Runs all queries which are still waiting
+
+   This is used on shutdown to make sure no scheduled changes are lost.
+ */
+void DatabaseWorker::flush()
+{
+  // Do not start further background work while shutting down:
+  m_stopping = true;
+  m_batchTimer->stop();
+  while ( !m_scheduler.isEmpty() ) {
+    m_scheduler.releaseHeld();
+    next();
   }
 }
 
@@ -20,11 +20,16 @@
 #define TODOLISTSTORAGEWORKER_H
 
 #include "core/opentodolistinterfaces.h"
+#include "database/changeset.h"
+#include "database/querystatistics.h"
+#include "database/queryscheduler.h"
+#include "database/statementcache.h"
 
 #include <QMutex>
-#include <QQueue>
 #include <QSqlDatabase>
 #include <QTemporaryFile>
+#include <QTimer>
+#include <QVector>
 
 namespace OpenTodoList {
 
@@ -32,6 +37,8 @@ namespace DataBase {
 
 class StorageQuery;
 class Database;
+class MigrationBatch;
+class SlowQueryLog;
 
 /**
    @brief Maintains the todo storage database
@@ -51,9 +58,88 @@ class DatabaseWorker : public QObject
 
 public:
 
-    explicit DatabaseWorker( const QString &dbLocation );
+    /**
+       @brief Durability and performance profiles for the database
+
+       The profile determines how the SQLite database is configured on each connection. It
+       trades durability of the most recent writes against write and read throughput.
+     */
+    enum Profile {
+      /**
+         Rollback journal with full synchronous writes. Every commit is durable
+         once it returns.
+       */
+      SafeProfile,
+
+      /**
+         Write-ahead log with synchronous=NORMAL. The database cannot be corrupted, but the
+         most recent commits might be lost on power failure.
+       */
+      BalancedProfile,
+
+      /**
+         Like BalancedProfile, but additionally uses a larger page cache, memory mapped I/O and
+         keeps temporary tables in memory.
+       */
+      FastProfile
+    };
+
+    static const Profile DefaultProfile = BalancedProfile;
+
+    /**
+       @brief A step in the chain of schema migrations
+
+       Each schema version is created by exactly one migration, which is registered in
+       migrations(). On start up, all migrations to versions newer than the one of the database
+       are applied in order, each in its own transaction.
+
+       Migrations which have to process many rows can do so in the background: The
+       backgroundStatement is run repeatedly in batches (binding the batch size to a ":batchSize"
+       placeholder) with MaintenancePriority until the remainingStatement returns 0. If no
+       remainingStatement is given, the backgroundStatement is run exactly once. Pending
+       background work is recorded in the database, so it is resumed on the next start if the
+       application is closed before it is done.
+     */
+    struct Migration {
+      int                          version;             //!< The version created by the step
+      QString                      description;         //!< What the step does
+      void ( DatabaseWorker::*apply )();                //!< Changes the schema
+      QString                      backgroundStatement; //!< Optional batch run in background
+      QString                      remainingStatement;  //!< Counts rows left for the batches
+    };
+
+    static const int MigrationBatchSize = 500;
+
+    static const QVector< Migration > &migrations();
+    static int latestSchemaVersion();
+
+    static Profile profileFromString( const QString &profile, bool *ok = nullptr );
+    static QString profileToString( Profile profile );
+
+    explicit DatabaseWorker( const QString &dbLocation, Profile profile = DefaultProfile,
+                             bool readOnly = false );
     virtual ~DatabaseWorker();
 
+    const StatementCache &statementCache() const;
+
+    Profile profile() const;
+    bool isReadOnly() const;
+
+    int maxBatchSize() const;
+    void setMaxBatchSize( int maxBatchSize );
+
+    int maxBatchLatency() const;
+    void setMaxBatchLatency( int maxBatchLatency );
+
+    const QueryScheduler &scheduler() const;
+
+    int schemaVersion() const;
+    bool hasFullTextSearch() const;
+
+    const QueryStatistics &queryStatistics() const;
+
+    SlowQueryLog *slowQueryLog() const;
+    void setSlowQueryLog( SlowQueryLog *slowQueryLog );
 
     // Interface used by Database class:
 private:
@@ -62,35 +148,83 @@ private:
 
 private slots:
     void init();
+    void flush();
+    void armBatchTimer( int msec );
 
 signals:
 
     void initialized();
 
-    void backendChanged( const QVariant &backend );
-    void accountChanged( const QVariant &account );
-    void todoListChanged( const QVariant &todoList );
-    void todoChanged( const QVariant &todo );
-    void taskChanged( const QVariant &task );
-    void accountDeleted( const QVariant &account );
-    void todoListDeleted( const QVariant &todoList );
-    void todoDeleted( const QVariant &todo );
-    void taskDeleted( const QVariant &task );
+    /**
+       @brief Reports the progress of schema migrations
+
+       The @p description is the one of the migration currently being applied. The
+       @p progress ranges from 0 to 1 (meaning all migrations are done).
+     */
+    void migrationProgress( const QString &description, double progress );
+
+    /**
+       @brief Objects have been changed or deleted
+
+       The signal is emitted once per transaction and carries all changes done by the queries
+       that have been run (and committed) in it.
+     */
+    void changesAvailable( const OpenTodoList::DataBase::ChangeSet &changes );
 
     // Private area:
 private:
 
     QSqlDatabase                    m_dataBase;
     QFile                           m_dataBaseFile;
+    Profile                         m_profile;
+    bool                            m_readOnly;
+    QString                         m_connectionName;
     bool                            m_initialized;
-    QQueue< StorageQuery* >         m_queue;
-    QMutex                          m_queueLock;
+    QueryScheduler                  m_scheduler;
+    mutable QMutex                  m_queueLock;
     QMutex                          m_runLock;
+    StatementCache                  m_statementCache;
+    QueryStatistics                 m_queryStatistics;
+    int                             m_maxBatchSize;
+    int                             m_maxBatchLatency;
+    QTimer                         *m_batchTimer;
+    int                             m_schemaVersion;
+    int                             m_failedStatements;
+    bool                            m_stopping;
+    QList< int >                    m_pendingMigrations;
+    int                             m_pendingMigrationsTotal;
+    int                             m_migrationRowsDone;
+    mutable bool                    m_fullTextSearch;
+    SlowQueryLog                   *m_slowQueryLog;
+    QMutex                          m_changesLock;
+    ChangeSet                       m_pendingChanges;
 
     void runSimpleQuery(const QString &query , const QString &errorMsg = QString() );
-    void runQuery( StorageQuery *query );
+    void runNow( StorageQuery *query );
+    void scheduleNext( bool urgent );
+    bool runStatement( const QString &statement );
+    void applyProfile();
+    QString beginTransactionStatement() const;
+    void updateSchema();
+    bool applyMigration( const Migration &migration );
+    void startBackgroundMigrations();
+    void scheduleMigrationBatch();
+    void migrationBatchFinished( MigrationBatch *batch );
+    static const Migration *migration( int version );
+    bool runQuery( StorageQuery *query );
+    void logSlowQuery( StorageQuery *query, const QString &statement, const QVariantMap &args,
+                       int rows, qint64 nsecs );
+    QStringList explainQueryPlan( const QString &statement, const QVariantMap &args );
+    void runBatch( const QList< StorageQuery* > &queries );
+    void connectQuery( StorageQuery *query );
+    void disconnectChangeSignals( StorageQuery *query );
+    void recordChange( ChangeSet::ObjectType type, const QVariant &object, bool deleted );
+    void publishChanges();
 
     void updateToSchemaVersion0();
+    void updateToSchemaVersion1();
+    void updateToSchemaVersion2();
+    void updateToSchemaVersion3();
 
 private slots:
 
@@ -0,0 +1,176 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/migrationbatch.h"
+
+#include "database/rowcursor.h"
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+
+   Creates a query which runs the @p statement of the migration to the schema @p version once.
+   If the statement contains a ":batchSize" placeholder, @p batchSize is bound to it.
+
+   The @p remainingStatement shall return the number of rows which still need to be processed
+   (in its first column). If it is empty, the migration is considered finished after running the
+   statement once.
+ */
+MigrationBatch::MigrationBatch( int version,
+                                const QString &statement,
+                                const QString &remainingStatement,
+                                int batchSize ) :
+  StorageQuery(),
+  m_version( version ),
+  m_statement( statement ),
+  m_remainingStatement( remainingStatement ),
+  m_batchSize( batchSize ),
+  m_state( RunBatchState ),
+  m_remaining( -1 ),
+  m_pending( -1 )
+{
+  setPriority( MaintenancePriority );
+}
+
+/**
+   @brief Destructor
+ */
+MigrationBatch::~MigrationBatch()
+{
+}
+
+/**
+   @brief The schema version the migration belongs to
+ */
+int MigrationBatch::version() const
+{
+  return m_version;
+}
+
+/**
+   @brief The number of rows processed in one batch
+ */
+int MigrationBatch::batchSize() const
+{
+  return m_batchSize;
+}
+
+/**
+   @brief The number of rows left to be processed after this batch
+
+   Returns -1 if this is not known.
+ */
+int MigrationBatch::remaining() const
+{
+  return m_remaining;
+}
+
+/**
+   @brief Returns true if all steps of the query have been run successfully
+ */
+bool MigrationBatch::isSucceeded() const
+{
+  return m_pending >= 0;
+}
+
+/**
+   @brief Returns true if this has been the last batch of the migration
+ */
+bool MigrationBatch::isMigrationFinished() const
+{
+  return m_pending == 0;
+}
+
+bool MigrationBatch::query(QString &query, QVariantMap &args, int &options)
+{
+  Q_UNUSED( options );
+  switch ( m_state ) {
+  case RunBatchState:
+  {
+    query = m_statement;
+    if ( m_statement.contains( ":batchSize" ) ) {
+      args.insert( "batchSize", m_batchSize );
+    }
+    m_state = m_remainingStatement.isEmpty() ? FinishMigrationState : CountRemainingState;
+    return true;
+  }
+
+  case CountRemainingState:
+  {
+    query = m_remainingStatement;
+    m_state = FinishMigrationState;
+    return true;
+  }
+
+  case FinishMigrationState:
+  {
+    m_state = ConfirmState;
+    if ( m_remaining > 0 ) {
+      // More batches to come; nothing to be done here
+      return false;
+    }
+    query = "DELETE FROM schemaBackgroundMigration WHERE version = :version;";
+    args.insert( "version", m_version );
+    return true;
+  }
+
+  case ConfirmState:
+  {
+    query = "SELECT COUNT(*) FROM schemaBackgroundMigration WHERE version = :version;";
+    args.insert( "version", m_version );
+    m_state = FinishedState;
+    return true;
+  }
+
+  case FinishedState: return false;
+
+  }
+  return false;
+}
+
+void MigrationBatch::rowAvailable(const RowCursor &cursor)
+{
+  switch ( m_state ) {
+  case FinishMigrationState:
+    // Result of the CountRemainingState query:
+    if ( !m_remainingStatement.isEmpty() ) {
+      m_remaining = cursor.toInt( 0 );
+    }
+    break;
+
+  case FinishedState:
+    // Result of the ConfirmState query:
+    m_pending = cursor.toInt( 0 );
+    break;
+
+  default:
+    break;
+  }
+}
+
+bool MigrationBatch::hasNext() const
+{
+  return m_state != FinishedState;
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,84 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_MIGRATIONBATCH_H
+#define OPENTODOLIST_DATABASE_MIGRATIONBATCH_H
+
+#include "database/storagequery.h"
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Runs one batch of the background part of a schema migration
+
+   Schema migrations which have to touch many rows (e.g. to fill a new table) can do so in the
+   background after the application has started (see DatabaseWorker::Migration). For each
+   pending migration, the worker schedules a sequence of MigrationBatch queries with
+   MaintenancePriority. Each of them runs the migration's background statement once and then
+   checks how much work is left. Once nothing is left, the migration is removed from the list of
+   pending ones in the database.
+ */
+class MigrationBatch : public StorageQuery
+{
+    Q_OBJECT
+public:
+
+    explicit MigrationBatch( int version,
+                             const QString &statement,
+                             const QString &remainingStatement,
+                             int batchSize );
+    virtual ~MigrationBatch();
+
+    int version() const;
+    int batchSize() const;
+    int remaining() const;
+    bool isSucceeded() const;
+    bool isMigrationFinished() const;
+
+    // StorageQuery interface
+    bool query(QString &query, QVariantMap &args, int &options) override;
+    void rowAvailable(const RowCursor &cursor) override;
+    bool hasNext() const override;
+
+private:
+
+    enum State {
+      RunBatchState,
+      CountRemainingState,
+      FinishMigrationState,
+      ConfirmState,
+      FinishedState
+    };
+
+    int     m_version;
+    QString m_statement;
+    QString m_remainingStatement;
+    int     m_batchSize;
+    State   m_state;
+    int     m_remaining;
+    int     m_pending;
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_MIGRATIONBATCH_H
@@ -0,0 +1,244 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/objectcache.h"
+
+#include "database/databaseconnection.h"
+
+#include <QPointer>
+#include <QQmlEngine>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+
+   Changes done to the cached objects are written back to the @p database. The cache keeps
+   at most @p capacity recently used objects alive.
+ */
+ObjectCache::ObjectCache(Database *database, int capacity) :
+  m_database( database ),
+  m_capacity( capacity ),
+  m_objects( ChangeSet::NumObjectTypes ),
+  m_recent(),
+  m_recentIndex(),
+  m_purgeThreshold( DefaultCapacity ),
+  m_hits( 0 ),
+  m_misses( 0 )
+{
+}
+
+/**
+   @brief Destructor
+
+   Objects still referenced elsewhere stay alive; they are no longer written back once the
+   database is gone.
+ */
+ObjectCache::~ObjectCache()
+{
+}
+
+/**
+   @brief The number of recently used objects the cache keeps alive
+ */
+int ObjectCache::capacity() const
+{
+  return m_capacity;
+}
+
+/**
+   @brief Sets the capacity of the cache
+
+   @sa capacity()
+ */
+void ObjectCache::setCapacity(int capacity)
+{
+  m_capacity = qMax( capacity, 0 );
+  while ( m_recent.size() > m_capacity ) {
+    m_recentIndex.remove( m_recent.first().data() );
+    m_recent.removeFirst();
+  }
+}
+
+/**
+   @brief Returns the number of live objects in the cache
+ */
+int ObjectCache::size() const
+{
+  int result = 0;
+  for ( const QHash< QString, QWeakPointer<QObject> > &objects : m_objects ) {
+    for ( const QWeakPointer<QObject> &object : objects ) {
+      if ( !object.isNull() ) {
+        ++result;
+      }
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Returns statistics about the cache
+
+   The map contains the number of "live" objects, the number of objects "retained" because they
+   have been used recently, the "capacity" and the number of "hits" and "misses" of object().
+ */
+QVariantMap ObjectCache::statistics() const
+{
+  QVariantMap result;
+  result.insert( "live", size() );
+  result.insert( "retained", m_recent.size() );
+  result.insert( "capacity", m_capacity );
+  result.insert( "hits", m_hits );
+  result.insert( "misses", m_misses );
+  return result;
+}
+
+/**
+   @brief Updates the cached objects with the @p changes done in the database
+
+   Changed objects are updated in place, deleted ones are removed from the cache. This has to
+   be done before the @p changes are passed on to other clients, so these will see the
+   updated objects.
+ */
+void ObjectCache::applyChanges(const ChangeSet &changes)
+{
+  applyChanges<Backend>( changes.changed( ChangeSet::BackendObject ) );
+  applyChanges<Account>( changes.changed( ChangeSet::AccountObject ) );
+  applyChanges<TodoList>( changes.changed( ChangeSet::TodoListObject ) );
+  applyChanges<Todo>( changes.changed( ChangeSet::TodoObject ) );
+  applyChanges<Task>( changes.changed( ChangeSet::TaskObject ) );
+  for ( int type = 0; type < ChangeSet::NumObjectTypes; ++type ) {
+    ChangeSet::ObjectType objectType = static_cast< ChangeSet::ObjectType >( type );
+    for ( const QVariant &data : changes.deleted( objectType ) ) {
+      QWeakPointer<QObject> object = m_objects[ type ].take( ChangeSet::keyOf( objectType, data ) );
+      QSharedPointer<QObject> strongRef = object.toStrongRef();
+      if ( strongRef ) {
+        forget( strongRef.data() );
+      }
+    }
+  }
+}
+
+/**
+   @brief Marks the @p object as the most recently used one
+ */
+void ObjectCache::touch(const QSharedPointer<QObject> &object)
+{
+  if ( m_capacity <= 0 ) {
+    return;
+  }
+  auto it = m_recentIndex.find( object.data() );
+  if ( it != m_recentIndex.end() ) {
+    m_recent.erase( it.value() );
+  }
+  m_recentIndex.insert( object.data(), m_recent.insert( m_recent.end(), object ) );
+  while ( m_recent.size() > m_capacity ) {
+    m_recentIndex.remove( m_recent.first().data() );
+    m_recent.removeFirst();
+  }
+}
+
+/**
+   @brief Drops the reference the cache holds on the @p object (if any)
+ */
+void ObjectCache::forget(QObject *object)
+{
+  auto it = m_recentIndex.find( object );
+  if ( it != m_recentIndex.end() ) {
+    m_recent.erase( it.value() );
+    m_recentIndex.erase( it );
+  }
+}
+
+/**
+   @brief Removes the entries of objects which are no longer alive from @p objects
+ */
+void ObjectCache::purge(QHash<QString, QWeakPointer<QObject> > &objects)
+{
+  for ( auto it = objects.begin(); it != objects.end(); ) {
+    if ( it.value().isNull() ) {
+      it = objects.erase( it );
+    } else {
+      ++it;
+    }
+  }
+  m_purgeThreshold = qMax( DefaultCapacity, objects.size() * 2 );
+}
+
+/**
+   @brief Prepares a newly created @p object for being shared
+
+   Cached objects have no parent; their lifetime is controlled by the references held on them.
+   Hence, QML must never take ownership of them.
+ */
+void ObjectCache::prepare(QObject *object)
+{
+  QQmlEngine::setObjectOwnership( object, QQmlEngine::CppOwnership );
+}
+
+void ObjectCache::connectWriteBack(Backend *backend)
+{
+  // Backends are not changed from within the application
+  Q_UNUSED( backend );
+}
+
+void ObjectCache::connectWriteBack(Account *account)
+{
+  QPointer<Database> database( m_database );
+  QObject::connect( account, &Account::changed, [database,account] {
+    DatabaseConnection conn;
+    conn.setDatabase( database.data() );
+    conn.insertAccount( account );
+  });
+}
+
+void ObjectCache::connectWriteBack(TodoList *todoList)
+{
+  QPointer<Database> database( m_database );
+  QObject::connect( todoList, &TodoList::changed, [database,todoList] {
+    DatabaseConnection conn;
+    conn.setDatabase( database.data() );
+    conn.insertTodoList( todoList );
+  });
+}
+
+void ObjectCache::connectWriteBack(Todo *todo)
+{
+  QPointer<Database> database( m_database );
+  QObject::connect( todo, &Todo::changed, [database,todo] {
+    DatabaseConnection conn;
+    conn.setDatabase( database.data() );
+    conn.insertTodo( todo );
+  });
+}
+
+void ObjectCache::connectWriteBack(Task *task)
+{
+  QPointer<Database> database( m_database );
+  QObject::connect( task, &Task::changed, [database,task] {
+    DatabaseConnection conn;
+    conn.setDatabase( database.data() );
+    conn.insertTask( task );
+  });
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,194 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_OBJECTCACHE_H
+#define OPENTODOLIST_DATABASE_OBJECTCACHE_H
+
+#include "database/changeset.h"
+
+#include "datamodel/account.h"
+#include "datamodel/backend.h"
+#include "datamodel/task.h"
+#include "datamodel/todo.h"
+#include "datamodel/todolist.h"
+
+#include <QHash>
+#include <QLinkedList>
+#include <QSharedPointer>
+#include <QVariant>
+#include <QVector>
+#include <QWeakPointer>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+class Database;
+
+using namespace DataModel;
+
+/**
+   @brief Maps object classes to the object types used in change sets
+ */
+template<typename T> struct ObjectCacheType;
+template<> struct ObjectCacheType<Backend> {
+  static const ChangeSet::ObjectType Type = ChangeSet::BackendObject;
+};
+template<> struct ObjectCacheType<Account> {
+  static const ChangeSet::ObjectType Type = ChangeSet::AccountObject;
+};
+template<> struct ObjectCacheType<TodoList> {
+  static const ChangeSet::ObjectType Type = ChangeSet::TodoListObject;
+};
+template<> struct ObjectCacheType<Todo> {
+  static const ChangeSet::ObjectType Type = ChangeSet::TodoObject;
+};
+template<> struct ObjectCacheType<Task> {
+  static const ChangeSet::ObjectType Type = ChangeSet::TaskObject;
+};
+
+/**
+   @brief A process wide identity map of the objects read from the database
+
+   The cache holds at most one (canonical) instance per object, identified by the object's UUID
+   (or name, in case of backends). Models request their objects from the cache using object()
+   instead of creating private copies, so showing the same object in several views costs only
+   one instance. The instances are shared: Each user holds a strong reference, the cache itself
+   only tracks them weakly. Additionally, the most recently requested objects are kept alive
+   by the cache (up to capacity()), so re-opening a view does not need to re-create them.
+
+   Instances are kept up to date by applying the change sets broadcasted by the database (see
+   Database::changesAvailable()) and by the data read from the database. Changes done to an
+   instance (e.g. by the user) are written back to the database.
+
+   @note The cache is not thread safe; it must only be used from the thread the Database lives
+         in.
+ */
+class ObjectCache
+{
+public:
+
+  static const int DefaultCapacity = 512;
+
+  explicit ObjectCache( Database *database, int capacity = DefaultCapacity );
+  virtual ~ObjectCache();
+
+  int capacity() const;
+  void setCapacity( int capacity );
+
+  int size() const;
+  QVariantMap statistics() const;
+
+  template<typename T>
+  QSharedPointer<T> object( const QVariant &data );
+
+  template<typename T>
+  QSharedPointer<T> find( const QString &key ) const;
+
+  void applyChanges( const ChangeSet &changes );
+
+private:
+
+  typedef QLinkedList< QSharedPointer<QObject> > RecentList;
+
+  Database                                           *m_database;
+  int                                                 m_capacity;
+  QVector< QHash< QString, QWeakPointer<QObject> > >  m_objects;
+  RecentList                                          m_recent;
+  QHash< QObject*, RecentList::iterator >             m_recentIndex;
+  int                                                 m_purgeThreshold;
+  qint64                                              m_hits;
+  qint64                                              m_misses;
+
+  template<typename T>
+  void applyChanges( const QVariantList &changed );
+
+  void touch( const QSharedPointer<QObject> &object );
+  void forget( QObject *object );
+  void purge( QHash< QString, QWeakPointer<QObject> > &objects );
+  void prepare( QObject *object );
+  void connectWriteBack( Backend *backend );
+  void connectWriteBack( Account *account );
+  void connectWriteBack( TodoList *todoList );
+  void connectWriteBack( Todo *todo );
+  void connectWriteBack( Task *task );
+
+};
+
+/**
+   @brief Returns the canonical instance of the object described by @p data
+
+   If the cache already holds an instance of the object, it is updated with the @p data and
+   returned. Otherwise, a new instance is created from the @p data. The @p data is expected in
+   the format returned by the object's toVariant() method.
+ */
+template<typename T>
+QSharedPointer<T> ObjectCache::object(const QVariant &data)
+{
+  const ChangeSet::ObjectType type = ObjectCacheType<T>::Type;
+  QString key = ChangeSet::keyOf( type, data );
+  QHash< QString, QWeakPointer<QObject> > &objects = m_objects[ type ];
+  QSharedPointer<T> result = qSharedPointerDynamicCast<T>( objects.value( key ).toStrongRef() );
+  if ( result ) {
+    ++m_hits;
+    result->fromVariant( data );
+  } else {
+    ++m_misses;
+    T *object = new T();
+    object->fromVariant( data );
+    prepare( object );
+    connectWriteBack( object );
+    result = QSharedPointer<T>( object, &QObject::deleteLater );
+    objects.insert( key, result.template staticCast<QObject>().toWeakRef() );
+    if ( objects.size() > m_purgeThreshold ) {
+      purge( objects );
+    }
+  }
+  touch( result.template staticCast<QObject>() );
+  return result;
+}
+
+/**
+   @brief Returns the instance of the object with the given @p key
+
+   Returns a null pointer if there is no live instance of the object.
+ */
+template<typename T>
+QSharedPointer<T> ObjectCache::find(const QString &key) const
+{
+  return qSharedPointerDynamicCast<T>(
+        m_objects.at( ObjectCacheType<T>::Type ).value( key ).toStrongRef() );
+}
+
+template<typename T>
+void ObjectCache::applyChanges(const QVariantList &changed)
+{
+  const ChangeSet::ObjectType type = ObjectCacheType<T>::Type;
+  for ( const QVariant &data : changed ) {
+    QSharedPointer<T> object = find<T>( ChangeSet::keyOf( type, data ) );
+    if ( object ) {
+      object->fromVariant( data );
+    }
+  }
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_OBJECTCACHE_H
@@ -18,6 +18,8 @@
 
 #include "insertbackend.h"
 
+#include "database/rowcursor.h"
+
 namespace OpenTodoList {
 namespace DataBase {
 namespace Queries {
@@ -35,10 +37,11 @@ namespace Queries {
 InsertBackend::InsertBackend( Backend *backend ) :
   OpenTodoList::DataBase::StorageQuery(),
   m_backend( backend ),
-  m_state( InsertBackendState ),
-  m_waitForId( false )
+  m_state( UpdateBackendState )
 {
   Q_ASSERT( backend != nullptr );
+  connect( this, &InsertBackend::queryFinished,
+           [this] { emit this->backendChanged( m_backend->toVariant() ); } );
 }
 
 /**
@@ -51,19 +54,37 @@ InsertBackend::~InsertBackend()
 
 bool InsertBackend::query(QString &query, QVariantMap &args, int &options)
 {
-  m_waitForId = false;
+  Q_UNUSED( options );
   switch ( m_state ) {
+  case UpdateBackendState:
+  {
+    // Note: We must not use INSERT OR REPLACE here, as replacing the row would cascade
+    // into the accounts (and everything below) referring to the backend.
+    query = "UPDATE backend SET title = :title, description = :description "
+            "WHERE name = :name;";
+    args.insert( "name", m_backend->name() );
+    args.insert( "title", m_backend->title() );
+    args.insert( "description", m_backend->description() );
+    m_state = InsertBackendState;
+    return true;
+  }
+
   case InsertBackendState:
   {
-    options = StorageQuery::QueryIsUpdateQuery;
-    query = "INSERT OR REPLACE INTO backend ( id, name, title, description ) "
-            "VALUES ( (SELECT id FROM backend WHERE name = :searchName ), :name, :title, :description );";
-    args.insert( "searchName", m_backend->name() );
+    query = "INSERT OR IGNORE INTO backend ( name, title, description ) "
+            "VALUES ( :name, :title, :description );";
     args.insert( "name", m_backend->name() );
     args.insert( "title", m_backend->title() );
     args.insert( "description", m_backend->description() );
+    m_state = ReadBackendIdState;
+    return true;
+  }
+
+  case ReadBackendIdState:
+  {
+    query = "SELECT id FROM backend WHERE name = :name;";
+    args.insert( "name", m_backend->name() );
     m_state = RemoveCapabilitiesState;
-    m_waitForId = true;
     return true;
   }
 
@@ -105,18 +126,15 @@ bool InsertBackend::query(QString &query, QVariantMap &args, int &options)
 
 }
 
-void InsertBackend::newIdAvailable(const QVariant &id)
+void InsertBackend::rowAvailable(const RowCursor &cursor)
 {
-  if ( m_waitForId && id.isValid() ) {
-    m_backend->setId( id.toInt() );
+  // Only the ReadBackendIdState query returns rows:
+  int idColumn = cursor.indexOf( "id" );
+  if ( idColumn >= 0 ) {
+    m_backend->setId( cursor.toInt( idColumn ) );
   }
 }
 
-void InsertBackend::endRun()
-{
-  emit backendChanged( m_backend->toVariant() );
-}
-
 bool InsertBackend::hasNext() const
 {
   return m_state != FinishedState;
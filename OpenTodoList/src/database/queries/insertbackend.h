@@ -44,8 +44,7 @@ public:
 
     // StorageQuery interface
     bool query(QString &query, QVariantMap &args, int &options) override;
-    void newIdAvailable(const QVariant &id) override;
-    void endRun() override;
+    void rowAvailable(const RowCursor &cursor) override;
     bool hasNext() const override;
 
 signals:
@@ -54,14 +53,15 @@ public slots:
 
 private:
     enum State {
+      UpdateBackendState,
       InsertBackendState,
+      ReadBackendIdState,
       RemoveCapabilitiesState,
       InsertCapabilitiesState,
       FinishedState
     };
     Backend *m_backend;
     State    m_state;
-    bool     m_waitForId;
 
 };
 
@@ -0,0 +1,40 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015 Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "inserttodolists.h"
+
+namespace OpenTodoList {
+namespace DataBase {
+namespace Queries {
+
+InsertTodoLists::InsertTodoLists( const QList<TodoList*> &todoLists ) :
+    InsertObjects<TodoList>(
+      todoLists,
+      { "uuid", "name" } )
+{
+  connect( this, &InsertTodoLists::queryFinished, [this] {
+    for ( TodoList *todoList : this->objects() ) {
+      emit this->todoListChanged( todoList->toVariant() );
+    }
+  });
+}
+
+} // namespace Queries
+} // namespace DataBase
+} // namespace OpenTodoList
@@ -48,6 +48,8 @@ public:
 
   // StorageQuery interface
   bool query(QString &query, QVariantMap &args, int &options) override;
+  QString coalescingKey() const override;
+  QString queryClass() const override;
 
 private:
 
@@ -80,6 +82,21 @@ bool DeleteObject<T>::query(QString &query, QVariantMap &args, int &options )
   return true;
 }
 
+template<typename T>
+QString DeleteObject<T>::coalescingKey() const
+{
+  if ( m_object->uuid().isNull() ) {
+    return QString();
+  }
+  return objectKey( ObjectInfo<T>::classNameLowerFirst(), m_object->uuid() );
+}
+
+template<typename T>
+QString DeleteObject<T>::queryClass() const
+{
+  return "DeleteObject<" + ObjectInfo<T>::className() + ">";
+}
+
 }
 }
 }
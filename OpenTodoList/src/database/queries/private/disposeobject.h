@@ -45,6 +45,8 @@ public:
 
   // StorageQuery interface
   bool query(QString &query, QVariantMap &args, int &options) override;
+  QString coalescingKey() const override;
+  QString queryClass() const override;
 
 private:
 
@@ -72,6 +74,21 @@ bool DisposeObject<T>::query(QString &query, QVariantMap &args, int &options )
   return true;
 }
 
+template<typename T>
+QString DisposeObject<T>::coalescingKey() const
+{
+  if ( m_object->uuid().isNull() ) {
+    return QString();
+  }
+  return objectKey( ObjectInfo<T>::classNameLowerFirst(), m_object->uuid() );
+}
+
+template<typename T>
+QString DisposeObject<T>::queryClass() const
+{
+  return "DisposeObject<" + ObjectInfo<T>::className() + ">";
+}
+
 } // namespace Private
 } // namespace Queries
 } // namespace DataBase
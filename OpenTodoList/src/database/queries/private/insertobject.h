@@ -19,6 +19,7 @@
 #ifndef OPENTODOLIST_DATABASE_QUERIES_PRIVATE_INSERTOBJECT_H
 #define OPENTODOLIST_DATABASE_QUERIES_PRIVATE_INSERTOBJECT_H
 
+#include "database/rowcursor.h"
 #include "database/storagequery.h"
 
 #include "datamodel/objectinfo.h"
@@ -68,8 +69,12 @@ public:
 
   // StorageQuery interface
   bool query(QString &query, QVariantMap &args, int &options) override;
-  void newIdAvailable(const QVariant &id) override;
+  void rowAvailable(const RowCursor &cursor) override;
   bool hasNext() const override;
+  QString coalescingKey() const override;
+  QString queryClass() const override;
+  bool isCoalescable() const override;
+  bool coalesce(StorageQuery *newer) override;
 
   bool weightAtEnd() const;
   void setWeightAtEnd(bool weightAtEnd);
@@ -77,7 +82,9 @@ public:
 private:
 
   enum State {
+    UpdateObjectState,
     InsertObjectState,
+    ReadObjectIdState,
     InsertObjectMetaNameState,
     InsertObjectMetaValueState,
     RemoveExtraMetaValuesState,
@@ -86,7 +93,6 @@ private:
 
   State       m_state;
   T*          m_object;
-  bool        m_waitingForId;
   QString     m_baseTable;
   QString     m_attributeNameTable;
   QString     m_attributeValueTable;
@@ -95,13 +101,19 @@ private:
   QString     m_parentAttribute;
   QString     m_parentIdAttribute;
   bool        m_weightAtEnd;
+  int         m_dirtyIncrement;
 
+  void queryUpdateObject(QTextStream &stream, QVariantMap &args );
   void queryInsertObject(QTextStream &stream, QVariantMap &args );
+  void queryReadObjectId(QTextStream &stream, QVariantMap &args );
   void queryInsertMetaName(QTextStream &stream, QVariantMap &args );
   void queryInsertMetaValue(QTextStream &stream, QVariantMap &args );
   void queryRemoveExtraMeta(QTextStream &stream, QVariantMap &args );
 
   void insertObjectInfo( QTextStream &stream, QVariantMap &args );
+  void insertParentRef( QTextStream &stream, QVariantMap &args );
+  void insertAttributeValue( QTextStream &stream, QVariantMap &args, const QString &attribute );
+  void finishObjectStages();
 
 };
 
@@ -131,9 +143,8 @@ InsertObject<T>::InsertObject(T* object,
                               const QStringList &attributes,
                               bool update ) :
   StorageQuery(),
-  m_state( InsertObjectState ),
+  m_state( UpdateObjectState ),
   m_object( object ),
-  m_waitingForId( false ),
   m_baseTable( ObjectInfo<T>::classNameLowerFirst() ),
   m_attributeNameTable( ObjectInfo<T>::classNameLowerFirst() + "MetaAttributeName" ),
   m_attributeValueTable( ObjectInfo<T>::classNameLowerFirst() + "MetaAttribute" ),
@@ -141,7 +152,8 @@ InsertObject<T>::InsertObject(T* object,
   m_update( update ),
   m_parentAttribute( ObjectInfo< typename T::ContainerType >::classNameLowerFirst() ),
   m_parentIdAttribute( ObjectInfo< typename T::ContainerType >::classUuidProperty() ),
-  m_weightAtEnd( false )
+  m_weightAtEnd( false ),
+  m_dirtyIncrement( 1 )
 {
   Q_ASSERT( m_object != nullptr );
   Q_ASSERT( !m_baseTable.isEmpty() );
@@ -150,6 +162,17 @@ InsertObject<T>::InsertObject(T* object,
   Q_ASSERT( !m_parentAttribute.isEmpty() );
   Q_ASSERT( !m_parentIdAttribute.isEmpty() );
   Q_ASSERT( !m_attributes.isEmpty() );
+
+  // Make the flags of the object match the ones written, so the change reported for it tells
+  // whether a backend needs to sync it (see BackendWrapper::onChangesAvailable()):
+  connect( this, &StorageQuery::queryFinished, [this] {
+    if ( m_update ) {
+      m_object->setDirty( qMax( m_object->dirty(), 0 ) + m_dirtyIncrement );
+    } else {
+      m_object->setDirty( 0 );
+      m_object->setDisposed( false );
+    }
+  } );
 }
 
 template<typename T>
@@ -162,19 +185,30 @@ bool InsertObject<T>::query(QString &query, QVariantMap &args, int &options )
 {
   Q_ASSERT( m_state <= RemoveExtraMetaValuesState );
 
-  m_waitingForId = false;
+  Q_UNUSED( options );
 
   QTextStream stream( &query );
 
   switch ( m_state ) {
 
+  case UpdateObjectState:
+  {
+    queryUpdateObject( stream, args );
+    return true;
+  }
+
   case InsertObjectState:
   {
-    options = QueryIsUpdateQuery;
     queryInsertObject( stream, args );
     return true;
   }
 
+  case ReadObjectIdState:
+  {
+    queryReadObjectId( stream, args );
+    return true;
+  }
+
   case InsertObjectMetaNameState:
   {
     queryInsertMetaName( stream, args );
@@ -200,10 +234,12 @@ bool InsertObject<T>::query(QString &query, QVariantMap &args, int &options )
 }
 
 template<typename T>
-void InsertObject<T>::newIdAvailable(const QVariant &id)
+void InsertObject<T>::rowAvailable(const RowCursor &cursor)
 {
-  if ( m_waitingForId && id.isValid() ) {
-    m_object->setId( id.toInt() );
+  // Only the id lookup of newly inserted objects returns records:
+  int idColumn = cursor.indexOf( "id" );
+  if ( !m_object->hasId() && idColumn >= 0 ) {
+    m_object->setId( cursor.toInt( idColumn ) );
   }
 }
 
@@ -213,6 +249,64 @@ bool InsertObject<T>::hasNext() const
   return m_state != FinishedState;
 }
 
+template<typename T>
+QString InsertObject<T>::coalescingKey() const
+{
+  if ( m_object->uuid().isNull() ) {
+    return QString();
+  }
+  return objectKey( m_baseTable, m_object->uuid() );
+}
+
+template<typename T>
+QString InsertObject<T>::queryClass() const
+{
+  return "InsertObject<" + ObjectInfo<T>::className() + ">";
+}
+
+/**
+  @brief Can later updates of the object be merged into this query?
+
+  This is the case for updates (i.e. not insertions coming from a backend) of objects
+  which are already stored in the database (i.e. their ID is known). New objects are never held
+  back, as other queries (e.g. ones inserting children) might depend on them.
+ */
+template<typename T>
+bool InsertObject<T>::isCoalescable() const
+{
+  return m_update && m_object->hasId() && m_state == UpdateObjectState;
+}
+
+/**
+  @brief Merges a @p newer update of the same object into this query
+
+  The query takes over the state of the object from the newer query. The dirty counter will be
+  increased by the sum of both queries' increments, so the object is marked as modified
+  the same way as if both queries would have been run. Updates which move the object to
+  another parent are not merged, as the new parent might not yet be in the database when
+  this query runs.
+ */
+template<typename T>
+bool InsertObject<T>::coalesce(StorageQuery *newer)
+{
+  InsertObject<T> *other = dynamic_cast< InsertObject<T>* >( newer );
+  if ( other == nullptr || !m_update || !other->m_update ||
+       m_state != UpdateObjectState || other->m_state != UpdateObjectState ||
+       m_attributes != other->m_attributes ||
+       m_object->uuid() != other->m_object->uuid() ) {
+    return false;
+  }
+  QByteArray parentProperty = m_parentAttribute.toUtf8();
+  if ( m_object->property( parentProperty.constData() ) !=
+       other->m_object->property( parentProperty.constData() ) ) {
+    return false;
+  }
+  m_object->fromVariant( other->m_object->toVariant() );
+  m_dirtyIncrement += other->m_dirtyIncrement;
+  m_weightAtEnd = m_weightAtEnd || other->m_weightAtEnd;
+  return true;
+}
+
 /**
   @brief Put inserted objects at end of list by its weight
 
@@ -241,67 +335,76 @@ void InsertObject<T>::setWeightAtEnd(bool weightAtEnd)
 }
 
 
+/*
+  Note: Objects are written using an UPDATE followed by an INSERT OR IGNORE instead of a
+  single INSERT OR REPLACE. Replacing a row deletes it first, which would cascade into all
+  children referring to the object (e.g. all todos of a todo list). The cascade cannot be
+  suppressed by disabling foreign keys, as that is not possible inside a transaction.
+ */
+template<typename T>
+void InsertObject<T>::queryUpdateObject(QTextStream &stream, QVariantMap &args)
+{
+  stream << "UPDATE " << m_baseTable << " SET ";
+  if ( m_update ) {
+    stream << "dirty = COALESCE( dirty, 0 ) + :dirtyIncrement, disposed = COALESCE( disposed, 0 ), ";
+    args.insert( "dirtyIncrement", m_dirtyIncrement );
+  } else {
+    stream << "dirty = 0, disposed = 0, ";
+  }
+  stream << m_parentAttribute << " = ";
+  insertParentRef( stream, args );
+  for ( const QString &attribute : m_attributes ) {
+    stream << ", " << attribute << " = ";
+    insertAttributeValue( stream, args, attribute );
+  }
+  if ( m_object->hasId() ) {
+    stream << " WHERE id = :objectId;";
+    args.insert( "objectId", m_object->id() );
+  } else {
+    stream << " WHERE uuid = :objectUuid;";
+    args.insert( "objectUuid", m_object->uuid() );
+  }
+  m_state = InsertObjectState;
+}
+
 template<typename T>
 void InsertObject<T>::queryInsertObject(QTextStream &stream, QVariantMap &args)
 {
-  insertObjectInfo( stream, args );
-  if ( !m_object->hasId() ) {
-    m_waitingForId = true;
+  stream << "INSERT OR IGNORE INTO " << m_baseTable << " ( ";
+  if ( m_object->hasId() ) {
+    stream << "id, ";
+  }
+  stream << "dirty, disposed, " << m_parentAttribute << ", "
+         << m_attributes.join( ", " ) << " ) VALUES ( ";
+  if ( m_object->hasId() ) {
+    stream << ":objectId, ";
+    args.insert( "objectId", m_object->id() );
   }
-  stream << ", protoInfo ( dirty, disposed ) AS ( ";
   if ( m_update ) {
-    stream << "VALUES ( "
-           << " COALESCE( ( SELECT dirty FROM " << m_baseTable << " WHERE ";
-    if ( m_object->hasId() ) {
-      stream << " id = :protoInfoSearchId1 ";
-      args.insert( "protoInfoSearchId1", m_object->id() );
-    } else {
-      stream << " uuid = :protoInfoSearchUuid1 ";
-      args.insert( "protoInfoSearchUuid1", m_object->uuid() );
-    }
-    stream << "), 0 ) + 1, COALESCE( ( SELECT disposed FROM " << m_baseTable << " WHERE ";
-    if ( m_object->hasId() ) {
-      stream << " id = :protoInfoSearchId2 ";
-      args.insert( "protoInfoSearchId2", m_object->id() );
-    } else {
-      stream << " uuid = :protoInfoSearchUuid2 ";
-      args.insert( "protoInfoSearchUuid2", m_object->uuid() );
-    }
-    stream << " ), 0 ) ) ";
+    stream << ":dirtyIncrement, 0, ";
+    args.insert( "dirtyIncrement", m_dirtyIncrement );
   } else {
-    stream << " VALUES ( 0, 0 ) ";
+    stream << "0, 0, ";
   }
-  stream << " ) ";
-  stream << "INSERT OR REPLACE INTO " << m_baseTable << " "
-         << " ( id, dirty, disposed, " << m_parentAttribute << ", "
-         << m_attributes.join( ", " ) << " ) "
-         << "VALUES ( "
-         << "(SELECT id FROM objectInfo), "
-         << "(SELECT dirty FROM protoInfo), "
-         << "(SELECT disposed FROM protoInfo), "
-         << "(SELECT id FROM " << m_parentAttribute << " WHERE "
-         << " " << m_parentIdAttribute  << " = :parentRef ) ";
-  args.insert( "parentRef", m_object->property( m_parentAttribute.toUtf8().constData() ) );
+  insertParentRef( stream, args );
   for ( const QString &attribute : m_attributes ) {
-    if ( attribute == "weight" && m_weightAtEnd ) {
-      stream << ", COALESCE( ( SELECT MAX(weight) FROM " << m_baseTable
-             << " WHERE " << m_parentAttribute << " = "
-             << "(SELECT id FROM " << m_parentAttribute << " WHERE "
-             << " " << m_parentIdAttribute  << " = :parentRefWeight ) "
-             << " ), 0 ) + 10 ";
-      args.insert( "parentRefWeight", args.value( "parentRef" ) );
-    } else {
-      stream << ", :" << attribute;
-    }
+    stream << ", ";
+    insertAttributeValue( stream, args, attribute );
   }
   stream << " );";
-  for ( const QString &attribute : m_attributes ) {
-    if ( !m_weightAtEnd || ( attribute != "weight" ) ) {
-      args.insert( attribute, m_object->property( attribute.toUtf8().constData() ) );
-    }
+  if ( m_object->hasId() ) {
+    finishObjectStages();
+  } else {
+    m_state = ReadObjectIdState;
   }
-  m_state = m_object->metaAttributes().isEmpty() ?
-        RemoveExtraMetaValuesState : InsertObjectMetaNameState;
+}
+
+template<typename T>
+void InsertObject<T>::queryReadObjectId(QTextStream &stream, QVariantMap &args)
+{
+  stream << "SELECT id FROM " << m_baseTable << " WHERE uuid = :objectUuid;";
+  args.insert( "objectUuid", m_object->uuid() );
+  finishObjectStages();
 }
 
 template<typename T>
@@ -376,6 +479,39 @@ void InsertObject<T>::queryRemoveExtraMeta(QTextStream &stream, QVariantMap &arg
   m_state = FinishedState;
 }
 
+template<typename T>
+void InsertObject<T>::insertParentRef(QTextStream &stream, QVariantMap &args)
+{
+  stream << "(SELECT id FROM " << m_parentAttribute << " WHERE "
+         << m_parentIdAttribute  << " = :parentRef )";
+  args.insert( "parentRef", m_object->property( m_parentAttribute.toUtf8().constData() ) );
+}
+
+template<typename T>
+void InsertObject<T>::insertAttributeValue(QTextStream &stream, QVariantMap &args,
+                                           const QString &attribute)
+{
+  if ( attribute == "weight" && m_weightAtEnd ) {
+    stream << "COALESCE( ( SELECT MAX(weight) FROM " << m_baseTable
+           << " WHERE " << m_parentAttribute << " = "
+           << "(SELECT id FROM " << m_parentAttribute << " WHERE "
+           << " " << m_parentIdAttribute  << " = :parentRefWeight ) "
+           << " ), 0 ) + 10";
+    args.insert( "parentRefWeight",
+                 m_object->property( m_parentAttribute.toUtf8().constData() ) );
+  } else {
+    stream << ":" << attribute;
+    args.insert( attribute, m_object->property( attribute.toUtf8().constData() ) );
+  }
+}
+
+template<typename T>
+void InsertObject<T>::finishObjectStages()
+{
+  m_state = m_object->metaAttributes().isEmpty() ?
+        RemoveExtraMetaValuesState : InsertObjectMetaNameState;
+}
+
 template<typename T>
 void InsertObject<T>::insertObjectInfo(QTextStream &stream, QVariantMap &args)
 {
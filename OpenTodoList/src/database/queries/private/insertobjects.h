@@ -0,0 +1,493 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015 Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_QUERIES_PRIVATE_INSERTOBJECTS_H
+#define OPENTODOLIST_DATABASE_QUERIES_PRIVATE_INSERTOBJECTS_H
+
+#include "database/rowcursor.h"
+#include "database/storagequery.h"
+
+#include "datamodel/objectinfo.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QTextStream>
+#include <QUuid>
+#include <QVariantMap>
+
+namespace OpenTodoList {
+namespace DataBase {
+namespace Queries {
+namespace Private {
+
+using namespace OpenTodoList::DataModel;
+
+/**
+  @brief Inserts many objects coming from a backend into the database at once
+
+  This works like InsertObject (in insertion mode, i.e. the dirty and disposed flags of the
+  objects are reset), but writes whole batches of objects with a few multi-row statements
+  instead of running several statements per object:
+
+  - The names of all meta attributes used by the objects are inserted and their IDs are read
+    once for the whole batch.
+  - The objects are then written in chunks. Per chunk, existing objects are updated and new ones
+    inserted with one statement each, the IDs of the objects are read back and their meta
+    attributes are replaced.
+
+  Chunks are sized such that no statement binds more than MaxVariables values.
+ */
+template<typename T>
+class InsertObjects : public StorageQuery
+{
+public:
+
+  /**
+    @brief The maximum number of values bound to a single statement
+
+    This is the lowest limit of host parameters SQLite might have been built with.
+   */
+  static const int MaxVariables = 999;
+
+  explicit InsertObjects( const QList<T*> &objects, const QStringList &attributes );
+  ~InsertObjects();
+
+  QList<T*> objects() const;
+
+  // StorageQuery interface
+  bool query(QString &query, QVariantMap &args, int &options) override;
+  void rowAvailable(const RowCursor &cursor) override;
+  bool hasNext() const override;
+  QString queryClass() const override;
+
+private:
+
+  enum State {
+    InsertMetaNamesState,
+    ReadMetaNamesState,
+    UpdateObjectsState,
+    InsertObjectsState,
+    ReadObjectIdsState,
+    RemoveMetaValuesState,
+    InsertMetaValuesState,
+    FinishedState
+  };
+
+  struct Chunk {
+    int begin;
+    int end;
+  };
+
+  State              m_state;
+  QList<T*>          m_objects;
+  QString            m_baseTable;
+  QString            m_attributeNameTable;
+  QString            m_attributeValueTable;
+  QStringList        m_attributes;
+  QString            m_parentAttribute;
+  QString            m_parentIdAttribute;
+  QStringList        m_metaAttributeNames;
+  QHash<QString,int> m_metaAttributeIds;
+  QHash<QUuid,T*>    m_objectsByUuid;
+  QList<Chunk>       m_nameChunks;
+  QList<Chunk>       m_objectChunks;
+  int                m_chunk;
+
+  void queryInsertMetaNames( QTextStream &stream, QVariantMap &args );
+  void queryReadMetaNames( QTextStream &stream, QVariantMap &args );
+  void queryUpdateObjects( QTextStream &stream, QVariantMap &args );
+  void queryInsertObjects( QTextStream &stream, QVariantMap &args );
+  void queryReadObjectIds( QTextStream &stream, QVariantMap &args );
+  bool queryRemoveMetaValues( QTextStream &stream, QVariantMap &args );
+  bool queryInsertMetaValues( QTextStream &stream, QVariantMap &args );
+
+  void insertObjectRow( QTextStream &stream, QVariantMap &args, int index );
+  void nextObjectChunk();
+
+};
+
+/**
+  @brief Constructor
+
+  Creates a query which inserts or updates all @p objects. The core @p attributes of the
+  objects are written into the base table, their meta attributes into the meta attribute
+  tables (see InsertObject for the details).
+ */
+template<typename T>
+InsertObjects<T>::InsertObjects(const QList<T*> &objects, const QStringList &attributes) :
+  StorageQuery(),
+  m_state( InsertMetaNamesState ),
+  m_objects( objects ),
+  m_baseTable( ObjectInfo<T>::classNameLowerFirst() ),
+  m_attributeNameTable( ObjectInfo<T>::classNameLowerFirst() + "MetaAttributeName" ),
+  m_attributeValueTable( ObjectInfo<T>::classNameLowerFirst() + "MetaAttribute" ),
+  m_attributes( attributes ),
+  m_parentAttribute( ObjectInfo< typename T::ContainerType >::classNameLowerFirst() ),
+  m_parentIdAttribute( ObjectInfo< typename T::ContainerType >::classUuidProperty() ),
+  m_metaAttributeNames(),
+  m_metaAttributeIds(),
+  m_objectsByUuid(),
+  m_nameChunks(),
+  m_objectChunks(),
+  m_chunk( 0 )
+{
+  Q_ASSERT( m_attributes.contains( "uuid" ) );
+
+  QSet<QString> names;
+  for ( T *object : m_objects ) {
+    Q_ASSERT( object != nullptr );
+    for ( const QString &name : object->metaAttributes().keys() ) {
+      names.insert( name );
+    }
+  }
+  m_metaAttributeNames = names.toList();
+  for ( int i = 0; i < m_metaAttributeNames.size(); i += MaxVariables ) {
+    Chunk chunk = { i, qMin( i + MaxVariables, m_metaAttributeNames.size() ) };
+    m_nameChunks.append( chunk );
+  }
+
+  // Each object binds its parent and attributes once, each meta attribute binds three values:
+  int objectVariables = m_attributes.size() + 1;
+  Chunk chunk = { 0, 0 };
+  int metaVariables = 0;
+  for ( int i = 0; i < m_objects.size(); ++i ) {
+    int objectMetaVariables = m_objects.at( i )->metaAttributes().size() * 3;
+    if ( chunk.end > chunk.begin &&
+         ( ( chunk.end - chunk.begin + 1 ) * objectVariables > MaxVariables ||
+           metaVariables + objectMetaVariables > MaxVariables ) ) {
+      m_objectChunks.append( chunk );
+      chunk.begin = i;
+      metaVariables = 0;
+    }
+    chunk.end = i + 1;
+    metaVariables += objectMetaVariables;
+  }
+  if ( chunk.end > chunk.begin ) {
+    m_objectChunks.append( chunk );
+  }
+
+  if ( m_nameChunks.isEmpty() ) {
+    m_state = m_objectChunks.isEmpty() ? FinishedState : UpdateObjectsState;
+  }
+
+  // As in InsertObject, the flags of the objects are made to match the ones written:
+  connect( this, &StorageQuery::queryFinished, [this] {
+    for ( T *object : m_objects ) {
+      object->setDirty( 0 );
+      object->setDisposed( false );
+    }
+  } );
+}
+
+template<typename T>
+InsertObjects<T>::~InsertObjects()
+{
+}
+
+/**
+  @brief The objects written by the query
+
+  Once the query has been run, objects which have been written successfully have their ID set.
+ */
+template<typename T>
+QList<T*> InsertObjects<T>::objects() const
+{
+  return m_objects;
+}
+
+template<typename T>
+bool InsertObjects<T>::query(QString &query, QVariantMap &args, int &options)
+{
+  Q_UNUSED( options );
+
+  QTextStream stream( &query );
+
+  switch ( m_state ) {
+
+  case InsertMetaNamesState:
+  {
+    queryInsertMetaNames( stream, args );
+    return true;
+  }
+
+  case ReadMetaNamesState:
+  {
+    queryReadMetaNames( stream, args );
+    return true;
+  }
+
+  case UpdateObjectsState:
+  {
+    queryUpdateObjects( stream, args );
+    return true;
+  }
+
+  case InsertObjectsState:
+  {
+    queryInsertObjects( stream, args );
+    return true;
+  }
+
+  case ReadObjectIdsState:
+  {
+    queryReadObjectIds( stream, args );
+    return true;
+  }
+
+  case RemoveMetaValuesState: return queryRemoveMetaValues( stream, args );
+
+  case InsertMetaValuesState: return queryInsertMetaValues( stream, args );
+
+  case FinishedState: return false;
+
+  }
+  return false;
+}
+
+template<typename T>
+void InsertObjects<T>::rowAvailable(const RowCursor &cursor)
+{
+  // Records are returned by the lookup of meta attribute names and object IDs:
+  int idColumn = cursor.indexOf( "id" );
+  int nameColumn = cursor.indexOf( "name" );
+  int uuidColumn = cursor.indexOf( "uuid" );
+  if ( idColumn < 0 ) {
+    return;
+  }
+  if ( nameColumn >= 0 ) {
+    m_metaAttributeIds.insert( cursor.toString( nameColumn ), cursor.toInt( idColumn ) );
+  } else if ( uuidColumn >= 0 ) {
+    T *object = m_objectsByUuid.value( QUuid( cursor.toString( uuidColumn ) ), nullptr );
+    if ( object != nullptr && !object->hasId() ) {
+      object->setId( cursor.toInt( idColumn ) );
+    }
+  }
+}
+
+template<typename T>
+bool InsertObjects<T>::hasNext() const
+{
+  return m_state != FinishedState;
+}
+
+template<typename T>
+QString InsertObjects<T>::queryClass() const
+{
+  return "InsertObjects<" + ObjectInfo<T>::className() + ">";
+}
+
+template<typename T>
+void InsertObjects<T>::queryInsertMetaNames(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_nameChunks.at( m_chunk );
+  stream << "INSERT OR IGNORE INTO " << m_attributeNameTable << " ( name ) VALUES ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    if ( i > chunk.begin ) {
+      stream << ", ";
+    }
+    QString placeholder = QString( "name%1" ).arg( i - chunk.begin );
+    stream << "( :" << placeholder << " )";
+    args.insert( placeholder, m_metaAttributeNames.at( i ) );
+  }
+  stream << ";";
+  m_state = ReadMetaNamesState;
+}
+
+template<typename T>
+void InsertObjects<T>::queryReadMetaNames(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_nameChunks.at( m_chunk );
+  stream << "SELECT id, name FROM " << m_attributeNameTable << " WHERE name IN ( ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    if ( i > chunk.begin ) {
+      stream << ", ";
+    }
+    QString placeholder = QString( "name%1" ).arg( i - chunk.begin );
+    stream << ":" << placeholder;
+    args.insert( placeholder, m_metaAttributeNames.at( i ) );
+  }
+  stream << " );";
+  if ( ++m_chunk < m_nameChunks.size() ) {
+    m_state = InsertMetaNamesState;
+  } else {
+    m_chunk = 0;
+    m_state = m_objectChunks.isEmpty() ? FinishedState : UpdateObjectsState;
+  }
+}
+
+/*
+  Note: As in InsertObject, existing objects are updated and new ones are inserted with
+  INSERT OR IGNORE afterwards, as replacing rows would cascade into their children. The values
+  of the chunk are bound once in a common table expression, from which the UPDATE picks the
+  new values of each row.
+ */
+template<typename T>
+void InsertObjects<T>::queryUpdateObjects(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_objectChunks.at( m_chunk );
+  stream << "WITH batch ( " << m_parentAttribute << ", " << m_attributes.join( ", " )
+         << " ) AS ( VALUES ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    if ( i > chunk.begin ) {
+      stream << ", ";
+    }
+    insertObjectRow( stream, args, i - chunk.begin );
+  }
+  stream << " ) UPDATE " << m_baseTable << " SET dirty = 0, disposed = 0";
+  QStringList columns = m_attributes;
+  columns.removeAll( "uuid" );
+  columns.prepend( m_parentAttribute );
+  for ( const QString &column : columns ) {
+    stream << ", " << column << " = ( SELECT batch." << column << " FROM batch "
+           << "WHERE batch.uuid = " << m_baseTable << ".uuid )";
+  }
+  stream << " WHERE uuid IN ( SELECT uuid FROM batch );";
+  m_state = InsertObjectsState;
+}
+
+template<typename T>
+void InsertObjects<T>::queryInsertObjects(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_objectChunks.at( m_chunk );
+  stream << "INSERT OR IGNORE INTO " << m_baseTable << " ( " << m_parentAttribute << ", "
+         << m_attributes.join( ", " ) << ", dirty, disposed ) SELECT *, 0, 0 FROM ( VALUES ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    if ( i > chunk.begin ) {
+      stream << ", ";
+    }
+    insertObjectRow( stream, args, i - chunk.begin );
+  }
+  stream << " );";
+  m_state = ReadObjectIdsState;
+}
+
+template<typename T>
+void InsertObjects<T>::queryReadObjectIds(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_objectChunks.at( m_chunk );
+  m_objectsByUuid.clear();
+  stream << "SELECT id, uuid FROM " << m_baseTable << " WHERE uuid IN ( ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    T *object = m_objects.at( i );
+    m_objectsByUuid.insert( object->uuid(), object );
+    if ( i > chunk.begin ) {
+      stream << ", ";
+    }
+    QString placeholder = QString( "uuid%1" ).arg( i - chunk.begin );
+    stream << ":" << placeholder;
+    args.insert( placeholder, object->uuid() );
+  }
+  stream << " );";
+  m_state = RemoveMetaValuesState;
+}
+
+template<typename T>
+bool InsertObjects<T>::queryRemoveMetaValues(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_objectChunks.at( m_chunk );
+  m_state = InsertMetaValuesState;
+  int objects = 0;
+  stream << "DELETE FROM " << m_attributeValueTable << " WHERE " << m_baseTable << " IN ( ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    T *object = m_objects.at( i );
+    if ( !object->hasId() ) {
+      continue;
+    }
+    if ( objects > 0 ) {
+      stream << ", ";
+    }
+    QString placeholder = QString( "object%1" ).arg( objects++ );
+    stream << ":" << placeholder;
+    args.insert( placeholder, object->id() );
+  }
+  stream << " );";
+  return objects > 0;
+}
+
+template<typename T>
+bool InsertObjects<T>::queryInsertMetaValues(QTextStream &stream, QVariantMap &args)
+{
+  const Chunk &chunk = m_objectChunks.at( m_chunk );
+  nextObjectChunk();
+  int values = 0;
+  stream << "INSERT OR REPLACE INTO " << m_attributeValueTable
+         << " ( " << m_baseTable << ", attributeName, value ) VALUES ";
+  for ( int i = chunk.begin; i < chunk.end; ++i ) {
+    T *object = m_objects.at( i );
+    if ( !object->hasId() ) {
+      continue;
+    }
+    QVariantMap metaAttributes = object->metaAttributes();
+    for ( auto it = metaAttributes.constBegin(); it != metaAttributes.constEnd(); ++it ) {
+      if ( !m_metaAttributeIds.contains( it.key() ) ) {
+        continue;
+      }
+      if ( values > 0 ) {
+        stream << ", ";
+      }
+      QString objectRef = QString( "object%1" ).arg( values );
+      QString name = QString( "name%1" ).arg( values );
+      QString value = QString( "value%1" ).arg( values );
+      stream << "( :" << objectRef << ", :" << name << ", :" << value << " )";
+      args.insert( objectRef, object->id() );
+      args.insert( name, m_metaAttributeIds.value( it.key() ) );
+      args.insert( value, it.value() );
+      ++values;
+    }
+  }
+  stream << ";";
+  return values > 0;
+}
+
+/**
+  @brief Writes the values of the object at @p index within the current chunk as a row
+ */
+template<typename T>
+void InsertObjects<T>::insertObjectRow(QTextStream &stream, QVariantMap &args, int index)
+{
+  T *object = m_objects.at( m_objectChunks.at( m_chunk ).begin + index );
+  QString parentRef = QString( "parentRef%1" ).arg( index );
+  stream << "( ( SELECT id FROM " << m_parentAttribute << " WHERE "
+         << m_parentIdAttribute << " = :" << parentRef << " )";
+  args.insert( parentRef, object->property( m_parentAttribute.toUtf8().constData() ) );
+  for ( const QString &attribute : m_attributes ) {
+    QString placeholder = QString( "%1%2" ).arg( attribute ).arg( index );
+    stream << ", :" << placeholder;
+    args.insert( placeholder, object->property( attribute.toUtf8().constData() ) );
+  }
+  stream << " )";
+}
+
+template<typename T>
+void InsertObjects<T>::nextObjectChunk()
+{
+  if ( ++m_chunk < m_objectChunks.size() ) {
+    m_state = UpdateObjectsState;
+  } else {
+    m_state = FinishedState;
+  }
+}
+
+
+} // namespace Private
+} // namespace Queries
+} // namespace DataBase
+} // namespace OpenTodoList
+
+#endif // OPENTODOLIST_DATABASE_QUERIES_PRIVATE_INSERTOBJECTS_H
@@ -21,9 +21,14 @@
 
 #include "datamodel/objectinfo.h"
 
+#include "database/rowcursor.h"
 #include "database/storagequery.h"
 
+#include <QHash>
+#include <QMetaProperty>
+#include <QRegExp>
 #include <QTextStream>
+#include <QVector>
 
 namespace OpenTodoList {
 namespace DataBase {
@@ -55,8 +60,12 @@ public:
 
   // StorageQuery interface
   bool query(QString &query, QVariantMap &args, int &options) override;
-  void recordAvailable(const QVariantMap &record) override;
+  void columnsAvailable(const RowCursor &cursor) override;
+  void rowAvailable(const RowCursor &cursor) override;
   void endRun() override;
+  bool hasNext() const override;
+  bool isReadOnly() const override;
+  QString queryClass() const override;
 
   QList<T*> objects() const;
 
@@ -72,6 +81,14 @@ public:
   QVariant uuid() const;
   void setUuid(const QVariant &uuid);
 
+  /**
+    @brief The maximum number of UUIDs which can be passed to setUuids()
+   */
+  static const int MaxUuids = 512;
+
+  QList<QUuid> uuids() const;
+  void setUuids(const QList<QUuid> &uuids);
+
   bool onlyModified() const;
   void setOnlyModified(bool onlyModified);
 
@@ -91,6 +108,18 @@ public:
   int offset() const;
   void setOffset(int offset);
 
+  QString sortKey() const;
+  Qt::SortOrder sortOrder() const;
+  Qt::CaseSensitivity sortCaseSensitivity() const;
+  void setSortKey(const QString &sortKey, Qt::SortOrder order = Qt::AscendingOrder,
+                  Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+  bool hasAfter() const;
+  QVariant afterSortKey() const;
+  int afterId() const;
+  void setAfter(const QVariant &sortKey, int id);
+  void setAfterId(int id);
+
 protected:
 
   /**
@@ -102,20 +131,70 @@ protected:
    */
   virtual ConditionList generatedConditions() const { return ConditionList(); }
 
+  /**
+     @brief Returns a "generated" ordering of the results
+
+     Sub classes can implement this method to return an expression by which the objects read are
+     ordered ascendingly (stored in the condition member, together with its arguments). This is
+     useful in combination with limit(), e.g. to read the best matching objects first. The
+     expression takes precedence over the sortKey(); objects with the same value are ordered by
+     the sort key and their ID. The expression must only refer to the object's own table. By
+     default, no particular order is applied.
+   */
+  virtual Condition generatedOrdering() const { return Condition(); }
+
 private:
 
+  /**
+     @brief The steps of the query
+   */
+  enum State {
+    ReadObjectsState,
+    ReadMetaAttributesState,
+    FinishedState
+  };
+
+  /**
+     @brief Positions of the columns in the result of the query
+   */
+  struct Columns {
+    int id;
+    int dirty;
+    int disposed;
+    int parent;
+    QVector<int> attributes;
+  };
+
+  /**
+     @brief Positions of the columns when reading meta attributes
+   */
+  enum MetaAttributeColumns {
+    MetaAttributeObjectColumn,
+    MetaAttributeNameColumn,
+    MetaAttributeValueColumn
+  };
+
+  static const int MaxMetaAttributeBatch = 256;
+
   QString                   m_baseTable;
   QString                   m_attributeNameTable;
   QString                   m_attributeValueTable;
   QString                   m_parentAttribute;
   QString                   m_parentIdAttribute;
   QStringList               m_attributes;
+  QVector<int>              m_attributeProperties;
+  int                       m_parentProperty;
 
-  T                        *m_currentObject;
+  State                     m_state;
+  Columns                   m_columns;
   QList<T*>                 m_objects;
+  QHash<int, T*>            m_objectsById;
+  QHash<int, QVariantMap>   m_metaAttributes;
+  QList<int>                m_pendingIds;
 
   QVariant                  m_id;
   QVariant                  m_uuid;
+  QList<QUuid>              m_uuids;
   QVariant                  m_parentId;
   QVariant                  m_parentName;
   bool                      m_onlyModified;
@@ -124,7 +203,22 @@ private:
   ConditionList             m_conditions;
   int                       m_limit;
   int                       m_offset;
-
+  QString                   m_sortKey;
+  Qt::SortOrder             m_sortOrder;
+  Qt::CaseSensitivity       m_sortCaseSensitivity;
+  bool                      m_hasAfter;
+  QVariant                  m_afterSortKey;
+  int                       m_afterId;
+
+  bool queryObjects( QString &query, QVariantMap &args );
+  QString sortKeyExpression() const;
+  QString afterCondition( QVariantMap &args ) const;
+  QString afterRankCondition( const Condition &ordering, QVariantMap &args ) const;
+  static QString orderingExpression( const Condition &ordering, const QString &suffix,
+                                     QVariantMap &args );
+  bool queryMetaAttributes( QString &query, QVariantMap &args );
+  static void writeProperty( T *object, int propertyIndex, const QString &name,
+                             const QVariant &value );
 
 };
 
@@ -137,12 +231,19 @@ ReadObject<T>::ReadObject( const QStringList &attributes ) :
   m_parentAttribute( ObjectInfo< typename T::ContainerType >::classNameLowerFirst() ),
   m_parentIdAttribute( ObjectInfo< typename T::ContainerType >::classUuidProperty() ),
   m_attributes( attributes ),
+  m_attributeProperties(),
+  m_parentProperty( -1 ),
 
-  m_currentObject( nullptr ),
+  m_state( ReadObjectsState ),
+  m_columns(),
   m_objects(),
+  m_objectsById(),
+  m_metaAttributes(),
+  m_pendingIds(),
 
   m_id(),
   m_uuid(),
+  m_uuids(),
   m_parentId(),
   m_parentName(),
   m_onlyModified( false ),
@@ -150,15 +251,47 @@ ReadObject<T>::ReadObject( const QStringList &attributes ) :
   m_includeDeleted( false ),
   m_conditions(),
   m_limit( 0 ),
-  m_offset( 0 )
+  m_offset( 0 ),
+  m_sortKey(),
+  m_sortOrder( Qt::AscendingOrder ),
+  m_sortCaseSensitivity( Qt::CaseSensitive ),
+  m_hasAfter( false ),
+  m_afterSortKey(),
+  m_afterId( 0 )
 {
+  // Property lookups by name are costly; resolve them once per query instead of once per row:
+  const QMetaObject &metaObject = T::staticMetaObject;
+  for ( const QString &attribute : m_attributes ) {
+    m_attributeProperties << metaObject.indexOfProperty( attribute.toUtf8().constData() );
+  }
+  m_parentProperty = metaObject.indexOfProperty( m_parentAttribute.toUtf8().constData() );
 }
 
+/**
+   @brief Returns the next statement to run
+
+   Objects are read in two steps: First, the objects themselves are read (exactly one row per
+   object, so limit() and offset() count objects). Then, their meta attributes are read in
+   batches of up to MaxMetaAttributeBatch objects.
+ */
 template<typename T>
 bool ReadObject<T>::query(QString &query, QVariantMap &args, int &options )
 {
   Q_UNUSED( options );
+  switch ( m_state ) {
+  case ReadObjectsState: return queryObjects( query, args );
+  case ReadMetaAttributesState: return queryMetaAttributes( query, args );
+  case FinishedState: return false;
+  }
+  return false;
+}
 
+/**
+   @brief Builds the statement reading the objects
+ */
+template<typename T>
+bool ReadObject<T>::queryObjects(QString &query, QVariantMap &args)
+{
   QTextStream stream( &query );
   stream << "SELECT " << m_baseTable << ".id AS id, "
          << m_baseTable << ".dirty AS dirty, "
@@ -166,9 +299,7 @@ bool ReadObject<T>::query(QString &query, QVariantMap &args, int &options )
   for ( const QString &attribute : m_attributes ) {
     stream << " " << m_baseTable << "." << attribute << " AS " << attribute << ",";
   }
-  stream << " " << m_parentAttribute << "." << m_parentIdAttribute << " AS " << m_parentAttribute << ","
-         << " " << m_attributeValueTable << ".value AS metaAttributeValue,"
-         << " " << m_attributeNameTable << ".name AS metaAttributeName"
+  stream << " " << m_parentAttribute << "." << m_parentIdAttribute << " AS " << m_parentAttribute
          << " FROM " << m_baseTable << " ";
   QStringList containerTypes = ObjectInfo<T>::containerTypesLowerFirst();
   if ( !containerTypes.isEmpty() ) {
@@ -183,18 +314,13 @@ bool ReadObject<T>::query(QString &query, QVariantMap &args, int &options )
   }
 
 
-  stream << " LEFT OUTER JOIN " << m_attributeValueTable
-         << " ON " << m_baseTable << ".id = " << m_attributeValueTable << "." << m_baseTable
-         << " LEFT OUTER JOIN " << m_attributeNameTable
-         << " ON " << m_attributeNameTable << ".id = " << m_attributeValueTable << ".attributeName";
-
   QStringList conditions;
   if ( !m_parentId.isNull() ) {
     conditions << QString( " (%1.id = :searchParentId) ").arg( m_parentAttribute );
     args.insert( "searchParentId", m_parentId );
   }
   if ( !m_parentName.isNull() ) {
-    conditions << QString( " (%1.%2 = :seachParentName) " ).arg( m_parentAttribute ).arg( m_parentIdAttribute );
+    conditions << QString( " (%1.%2 = :searchParentName) " ).arg( m_parentAttribute ).arg( m_parentIdAttribute );
     args.insert( "searchParentName", m_parentName );
   }
   if ( !m_id.isNull() ) {
@@ -205,16 +331,38 @@ bool ReadObject<T>::query(QString &query, QVariantMap &args, int &options )
     conditions << QString( " (%1.uuid = :searchObjectUuid ) " ).arg( m_baseTable );
     args.insert( "searchObjectUuid", m_uuid );
   }
+  if ( !m_uuids.isEmpty() ) {
+    // Round up to the next power of two, so that only a few distinct statements are prepared:
+    int placeholders = 1;
+    while ( placeholders < m_uuids.size() ) {
+      placeholders *= 2;
+    }
+    QStringList names;
+    for ( int i = 0; i < placeholders; ++i ) {
+      QString name = QString( "searchObjectUuids%1" ).arg( i );
+      names << ":" + name;
+      args.insert( name, m_uuids.at( qMin( i, m_uuids.size() - 1 ) ) );
+    }
+    conditions << QString( " (%1.uuid IN ( %2 ) ) " ).arg( m_baseTable ).arg( names.join( ", " ) );
+  }
   if ( m_onlyModified ) {
     conditions << QString( " (%1.dirty > 0) " ).arg( m_baseTable );
   }
   if ( m_onlyDeleted ) {
-    conditions << QString( " (%1.disposed) " ).arg( m_baseTable );
+    conditions << QString( " (%1.disposed > 0) " ).arg( m_baseTable );
   } else {
     if ( !m_includeDeleted ) {
       conditions << QString( " (NOT %1.disposed) " ).arg( m_baseTable );
     }
   }
+  Condition ordering = generatedOrdering();
+  if ( m_hasAfter ) {
+    if ( ordering.condition.isEmpty() ) {
+      conditions << afterCondition( args );
+    } else {
+      conditions << afterRankCondition( ordering, args );
+    }
+  }
   ConditionList additionalConditions;
   additionalConditions.append( m_conditions );
   additionalConditions.append( generatedConditions() );
@@ -228,46 +376,244 @@ bool ReadObject<T>::query(QString &query, QVariantMap &args, int &options )
     stream << " WHERE " << conditions.join( " AND " );
   }
 
-  stream << " LIMIT " << ( m_limit > 0 ? m_limit : -1 ) << " OFFSET " << m_offset << ";";
+  if ( !ordering.condition.isEmpty() || !m_sortKey.isEmpty() || m_hasAfter ) {
+    // Keyset paging: The ID breaks ties, so that the order is total and the next page starts
+    // exactly after the last object of the previous one:
+    QString direction = m_sortOrder == Qt::AscendingOrder ? " ASC" : " DESC";
+    stream << " ORDER BY ";
+    if ( !ordering.condition.isEmpty() ) {
+      stream << orderingExpression( ordering, QString(), args ) << " ASC, ";
+    }
+    if ( !m_sortKey.isEmpty() ) {
+      stream << sortKeyExpression() << direction << ", ";
+    }
+    stream << m_baseTable << ".id" << direction;
+  }
+
+  // Limit and offset are bound as arguments, so that paging through results keeps hitting the
+  // same prepared statement:
+  stream << " LIMIT :readObjectLimit OFFSET :readObjectOffset;";
+  args.insert( "readObjectLimit", m_limit > 0 ? m_limit : -1 );
+  args.insert( "readObjectOffset", m_offset );
   return true;
 }
 
+/**
+   @brief Returns the expression objects are ordered by, including the collation to use
+ */
 template<typename T>
-void ReadObject<T>::recordAvailable(const QVariantMap &record)
+QString ReadObject<T>::sortKeyExpression() const
 {
-  if ( m_currentObject && m_currentObject->id() != record.value( "id" ).toInt() ) {
-    m_objects << m_currentObject;
-    m_currentObject = nullptr;
+  QString result = m_baseTable + "." + m_sortKey;
+  if ( m_sortCaseSensitivity == Qt::CaseInsensitive ) {
+    result += " COLLATE NOCASE";
   }
-  if ( !m_currentObject ) {
-    m_currentObject = new T( this );
-    m_currentObject->setId( record.value( "id" ).toInt() );
-    m_currentObject->setDirty( record.value( "dirty", 0 ).toInt() );
-    m_currentObject->setDisposed( record.value( "disposed", false ).toBool() );
+  return result;
+}
+
+/**
+   @brief Returns the condition selecting the objects following the after() position
+
+   SQLite sorts NULL before any other value, so in ascending order objects without a sort key
+   come first and in descending order they come last.
+ */
+template<typename T>
+QString ReadObject<T>::afterCondition(QVariantMap &args) const
+{
+  bool ascending = m_sortOrder == Qt::AscendingOrder;
+  QString id = m_baseTable + ".id";
+  QString idComparison = id + ( ascending ? " > " : " < " ) + ":readObjectAfterId";
+  args.insert( "readObjectAfterId", m_afterId );
+  if ( m_sortKey.isEmpty() ) {
+    return "(" + idComparison + ")";
+  }
+
+  QString key = sortKeyExpression();
+  if ( m_afterSortKey.isNull() ) {
+    if ( ascending ) {
+      return QString( "((%1 IS NULL AND %2) OR %1 IS NOT NULL)" ).arg( key ).arg( idComparison );
+    }
+    return QString( "(%1 IS NULL AND %2)" ).arg( key ).arg( idComparison );
+  }
+
+  args.insert( "readObjectAfterKey", m_afterSortKey );
+  args.insert( "readObjectAfterKeyEqual", m_afterSortKey );
+  QString result = QString( "(%1 %2 :readObjectAfterKey OR "
+                            "(%1 = :readObjectAfterKeyEqual AND %3)" )
+      .arg( key ).arg( ascending ? ">" : "<" ).arg( idComparison );
+  if ( !ascending ) {
+    result += QString( " OR %1 IS NULL" ).arg( key );
+  }
+  return result + ")";
+}
+
+/**
+   @brief Returns the condition selecting the objects following the after() position when
+          objects are ordered by the generatedOrdering()
+
+   The value of the @p ordering for the object at the after() position is looked up in the
+   same statement. Objects with a larger value follow it, objects with the same value are
+   compared by sort key and ID (see afterCondition()). If the object has been removed
+   meanwhile, nothing follows it.
+ */
+template<typename T>
+QString ReadObject<T>::afterRankCondition(const Condition &ordering, QVariantMap &args) const
+{
+  // The expression refers to the object's table, so evaluating it in a sub query on that
+  // table yields the value for the object at the after() position:
+  QString afterRank = "( SELECT %1 FROM " + m_baseTable + " WHERE " + m_baseTable +
+                      ".id = :readObjectAfterRankId%2 )";
+  args.insert( "readObjectAfterRankId", m_afterId );
+  args.insert( "readObjectAfterRankIdEqual", m_afterId );
+  QString greater = orderingExpression( ordering, "Greater", args );
+  QString afterGreater = afterRank.arg( orderingExpression( ordering, "AfterGreater", args ),
+                                        QString() );
+  QString equal = orderingExpression( ordering, "Equal", args );
+  QString afterEqual = afterRank.arg( orderingExpression( ordering, "AfterEqual", args ),
+                                      "Equal" );
+  return "(" + greater + " > " + afterGreater + " OR (" + equal + " = " + afterEqual +
+      " AND " + afterCondition( args ) + "))";
+}
+
+/**
+   @brief Returns the expression of the @p ordering, with its arguments inserted into @p args
+
+   As the expression might be used several times in one statement, the @p suffix is appended
+   to the names of its arguments, so that each placeholder is bound exactly once.
+ */
+template<typename T>
+QString ReadObject<T>::orderingExpression(const Condition &ordering, const QString &suffix,
+                                          QVariantMap &args)
+{
+  QString expression = ordering.condition;
+  for ( auto it = ordering.arguments.constBegin(); it != ordering.arguments.constEnd(); ++it ) {
+    expression.replace( QRegExp( ":" + it.key() + "\\b" ), ":" + it.key() + suffix );
+    args.insert( it.key() + suffix, it.value() );
+  }
+  return expression;
+}
+
+/**
+   @brief Builds the statement reading the meta attributes of the next batch of objects
+
+   The object IDs are bound as arguments. The number of placeholders is rounded up to the next
+   power of two (repeating the last ID), so that only a few distinct statements are prepared.
+ */
+template<typename T>
+bool ReadObject<T>::queryMetaAttributes(QString &query, QVariantMap &args)
+{
+  int count = qMin( m_pendingIds.size(), static_cast<int>( MaxMetaAttributeBatch ) );
+  if ( count == 0 ) {
+    return false;
+  }
+  int placeholders = 1;
+  while ( placeholders < count ) {
+    placeholders *= 2;
+  }
+
+  QTextStream stream( &query );
+  stream << "SELECT " << m_attributeValueTable << "." << m_baseTable << " AS objectId, "
+         << m_attributeNameTable << ".name AS name, "
+         << m_attributeValueTable << ".value AS value"
+         << " FROM " << m_attributeValueTable
+         << " INNER JOIN " << m_attributeNameTable
+         << " ON " << m_attributeNameTable << ".id = " << m_attributeValueTable << ".attributeName"
+         << " WHERE " << m_attributeValueTable << "." << m_baseTable << " IN (";
+  for ( int i = 0; i < placeholders; ++i ) {
+    QString name = QString( "metaObjectId%1" ).arg( i );
+    stream << ( i > 0 ? ", :" : ":" ) << name;
+    args.insert( name, m_pendingIds.at( qMin( i, count - 1 ) ) );
+  }
+  stream << ");";
+  m_pendingIds = m_pendingIds.mid( count );
+  return true;
+}
+
+template<typename T>
+void ReadObject<T>::columnsAvailable(const RowCursor &cursor)
+{
+  if ( m_state == ReadObjectsState ) {
+    m_columns.id = cursor.indexOf( "id" );
+    m_columns.dirty = cursor.indexOf( "dirty" );
+    m_columns.disposed = cursor.indexOf( "disposed" );
+    m_columns.parent = cursor.indexOf( m_parentAttribute );
+    m_columns.attributes.clear();
     for ( const QString &attribute : m_attributes ) {
-      m_currentObject->setProperty( attribute.toUtf8().constData(),
-                                    record.value( attribute ) );
+      m_columns.attributes << cursor.indexOf( attribute );
     }
-    m_currentObject->setProperty( m_parentAttribute.toUtf8().constData(),
-                                  record.value( m_parentAttribute ) );
   }
-  if ( record.contains( "metaAttributeName" ) && !record.value( "metaAttributeName" ).isNull() ) {
-    QVariantMap metaAttributes = m_currentObject->metaAttributes();
-    metaAttributes.insert( record.value( "metaAttributeName" ).toString(),
-                           record.value( "metaAttributeValue" ) );
-    m_currentObject->setMetaAttributes( metaAttributes );
+}
+
+template<typename T>
+void ReadObject<T>::rowAvailable(const RowCursor &cursor)
+{
+  if ( m_state == ReadObjectsState ) {
+    int id = cursor.toInt( m_columns.id );
+    T *object = new T( this );
+    object->setId( id );
+    object->setDirty( cursor.toInt( m_columns.dirty ) );
+    object->setDisposed( cursor.toBool( m_columns.disposed ) );
+    for ( int i = 0; i < m_attributes.size(); ++i ) {
+      writeProperty( object, m_attributeProperties.at( i ), m_attributes.at( i ),
+                     cursor.value( m_columns.attributes.at( i ) ) );
+    }
+    writeProperty( object, m_parentProperty, m_parentAttribute, cursor.value( m_columns.parent ) );
+    m_objects << object;
+    m_objectsById.insert( id, object );
+  } else {
+    m_metaAttributes[ cursor.toInt( MetaAttributeObjectColumn ) ].insert(
+          cursor.toString( MetaAttributeNameColumn ),
+          cursor.value( MetaAttributeValueColumn ) );
   }
 }
 
 template<typename T>
 void ReadObject<T>::endRun()
 {
-  if ( m_currentObject != nullptr ) {
-    m_objects << m_currentObject;
-    m_currentObject = nullptr;
+  switch ( m_state ) {
+  case ReadObjectsState:
+    for ( T *object : m_objects ) {
+      m_pendingIds << object->id();
+    }
+    m_state = m_pendingIds.isEmpty() ? FinishedState : ReadMetaAttributesState;
+    break;
+
+  case ReadMetaAttributesState:
+    if ( m_pendingIds.isEmpty() ) {
+      for ( auto it = m_metaAttributes.constBegin(); it != m_metaAttributes.constEnd(); ++it ) {
+        T *object = m_objectsById.value( it.key() );
+        if ( object ) {
+          object->setMetaAttributes( it.value() );
+        }
+      }
+      m_metaAttributes.clear();
+      m_state = FinishedState;
+    }
+    break;
+
+  case FinishedState:
+    break;
   }
 }
 
+template<typename T>
+bool ReadObject<T>::hasNext() const
+{
+  return m_state != FinishedState;
+}
+
+template<typename T>
+bool ReadObject<T>::isReadOnly() const
+{
+  return true;
+}
+
+template<typename T>
+QString ReadObject<T>::queryClass() const
+{
+  return "ReadObject<" + ObjectInfo<T>::className() + ">";
+}
+
 template<typename T>
 QList<T *> ReadObject<T>::objects() const
 {
@@ -371,6 +717,32 @@ void ReadObject<T>::setUuid(const QVariant &uuid)
   m_uuid = uuid;
 }
 
+/**
+  @brief The UUIDs of the objects to read
+
+  @sa setUuids()
+ */
+template<typename T>
+QList<QUuid> ReadObject<T>::uuids() const
+{
+  return m_uuids;
+}
+
+/**
+  @brief Restricts the query to the objects with the given @p uuids
+
+  This allows to look up many objects with a single statement. At most MaxUuids UUIDs
+  can be passed. If the list is empty, the objects are not filtered by their UUID.
+
+  @sa uuids()
+ */
+template<typename T>
+void ReadObject<T>::setUuids(const QList<QUuid> &uuids)
+{
+  Q_ASSERT( uuids.size() <= MaxUuids );
+  m_uuids = uuids;
+}
+
 /**
   @brief Include only modified objects
 
@@ -530,6 +902,9 @@ int ReadObject<T>::offset() const
 /**
   @brief Sets the offset to return objects from
 
+  @note The database still has to step over all skipped objects, so reading a page gets slower
+        the deeper it is. Prefer paging with setAfter().
+
   @sa offset()
  */
 template<typename T>
@@ -538,6 +913,143 @@ void ReadObject<T>::setOffset(int offset)
   m_offset = offset;
 }
 
+/**
+  @brief The attribute by which objects are ordered
+
+  If this is set, objects are ordered by this attribute (and by their ID if equal). If there
+  is a generatedOrdering(), it takes precedence over the sort key. If neither is set, objects
+  are ordered by their ID when paging with setAfter() and not ordered at all otherwise.
+
+  @sa setSortKey()
+ */
+template<typename T>
+QString ReadObject<T>::sortKey() const
+{
+  return m_sortKey;
+}
+
+/**
+  @brief The direction in which objects are ordered
+
+  @sa setSortKey()
+ */
+template<typename T>
+Qt::SortOrder ReadObject<T>::sortOrder() const
+{
+  return m_sortOrder;
+}
+
+/**
+  @brief Whether the sort key is compared case sensitively
+
+  @sa setSortKey()
+ */
+template<typename T>
+Qt::CaseSensitivity ReadObject<T>::sortCaseSensitivity() const
+{
+  return m_sortCaseSensitivity;
+}
+
+/**
+  @brief Sets the attribute (i.e. column of the object's table) to order objects by
+
+  If @p caseSensitivity is Qt::CaseInsensitive, text is compared using SQLite's NOCASE
+  collation (which folds ASCII letters only). This applies to setAfter() as well. Paging is
+  only fast if there is an index on the attribute using the same collation.
+
+  @sa sortKey()
+ */
+template<typename T>
+void ReadObject<T>::setSortKey(const QString &sortKey, Qt::SortOrder order,
+                               Qt::CaseSensitivity caseSensitivity)
+{
+  m_sortKey = sortKey;
+  m_sortOrder = order;
+  m_sortCaseSensitivity = caseSensitivity;
+}
+
+/**
+  @brief Whether only objects after a given position are read
+
+  @sa setAfter()
+ */
+template<typename T>
+bool ReadObject<T>::hasAfter() const
+{
+  return m_hasAfter;
+}
+
+/**
+  @brief The sort key of the object after which to start reading
+
+  @sa setAfter()
+ */
+template<typename T>
+QVariant ReadObject<T>::afterSortKey() const
+{
+  return m_afterSortKey;
+}
+
+/**
+  @brief The ID of the object after which to start reading
+
+  @sa setAfter()
+ */
+template<typename T>
+int ReadObject<T>::afterId() const
+{
+  return m_afterId;
+}
+
+/**
+  @brief Reads only objects coming after the given position
+
+  The position is given by the @p sortKey value and the @p id of the last object of the
+  previous page. Together with setLimit(), this allows to page through large result sets: In
+  contrast to setOffset(), the database can seek directly to the start of the page (given a
+  suitable index), so each page costs the same no matter how deep it is. Objects inserted or
+  removed in between are neither skipped nor returned twice.
+
+  @sa setAfterId()
+ */
+template<typename T>
+void ReadObject<T>::setAfter(const QVariant &sortKey, int id)
+{
+  m_hasAfter = true;
+  m_afterSortKey = sortKey;
+  m_afterId = id;
+}
+
+/**
+  @brief Reads only objects after the one with the given @p id
+
+  This is a shortcut for paging in the order of IDs (i.e. without a sortKey()).
+
+  @sa setAfter()
+ */
+template<typename T>
+void ReadObject<T>::setAfterId(int id)
+{
+  setAfter( QVariant(), id );
+}
+
+/**
+  @brief Writes the @p value to the property of the @p object
+
+  The @p propertyIndex has been resolved from the static meta object of T. If the class has no
+  such property, the value is set as dynamic property with the given @p name.
+ */
+template<typename T>
+void ReadObject<T>::writeProperty(T *object, int propertyIndex, const QString &name,
+                                  const QVariant &value)
+{
+  if ( propertyIndex >= 0 ) {
+    T::staticMetaObject.property( propertyIndex ).write( object, value );
+  } else {
+    object->setProperty( name.toUtf8().constData(), value );
+  }
+}
+
 } // namespace Private
 } // namespace Queries
 } // namespace DataBase
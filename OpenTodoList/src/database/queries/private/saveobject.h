@@ -49,6 +49,8 @@ public:
 
   // StorageQuery interface
   bool query(QString &query, QVariantMap &args, int &options ) override;
+  QString coalescingKey() const override;
+  QString queryClass() const override;
   bool hasNext() const override;
 
 
@@ -227,6 +229,21 @@ void SaveObject<T>::queryRemoveExtraMetaValues(QTextStream &stream, QVariantMap
   m_status = FinishedState;
 }
 
+template<typename T>
+QString SaveObject<T>::coalescingKey() const
+{
+  if ( m_object->uuid().isNull() ) {
+    return QString();
+  }
+  return objectKey( ObjectInfo<T>::classNameLowerFirst(), m_object->uuid() );
+}
+
+template<typename T>
+QString SaveObject<T>::queryClass() const
+{
+  return "SaveObject<" + ObjectInfo<T>::className() + ">";
+}
+
 } // namespace Private
 } // namespace Queries
 } // namespace DataBase
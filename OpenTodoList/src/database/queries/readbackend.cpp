@@ -18,6 +18,8 @@
 
 #include "readbackend.h"
 
+#include "database/rowcursor.h"
+
 namespace OpenTodoList {
 namespace DataBase {
 namespace Queries {
@@ -62,24 +64,29 @@ bool ReadBackend::query(QString &query, QVariantMap &args, int &options )
   return true;
 }
 
-void ReadBackend::recordAvailable(const QVariantMap &record)
+void ReadBackend::rowAvailable(const RowCursor &cursor)
 {
-  if ( m_currentBackend && m_currentBackend->id() != record.value( "id" ).toInt() ) {
+  // Column positions as selected in query():
+  enum { IdColumn, NameColumn, TitleColumn, DescriptionColumn, CapabilityColumn };
+
+  int id = cursor.toInt( IdColumn, -1 );
+  if ( m_currentBackend && m_currentBackend->id() != id ) {
     m_backends << m_currentBackend;
     emit readBackend( m_currentBackend->toVariant() );
     m_currentBackend = nullptr;
   }
   if ( !m_currentBackend ) {
     m_currentBackend = new DataModel::Backend( this );
-    m_currentBackend->setId( record.value( "id", -1 ).toInt() );
-    m_currentBackend->setName( record.value( "name", QString() ).toString() );
-    m_currentBackend->setTitle( record.value( "title", QString() ).toString() );
-    m_currentBackend->setDescription( record.value( "description", QString() ).toString() );
+    m_currentBackend->setId( id );
+    m_currentBackend->setName( cursor.toString( NameColumn ) );
+    m_currentBackend->setTitle( cursor.toString( TitleColumn ) );
+    m_currentBackend->setDescription( cursor.toString( DescriptionColumn ) );
   }
-  if ( record.contains( "capability" ) ) {
+  // Backends without capabilities yield a single row with a NULL capability:
+  if ( !cursor.isNull( CapabilityColumn ) ) {
     QSet<DataModel::Backend::Capabilities> caps = m_currentBackend->capabilities();
     caps.insert( static_cast< DataModel::Backend::Capabilities>(
-                   record.value( "capability" ).toInt() ) );
+                   cursor.toInt( CapabilityColumn ) ) );
     m_currentBackend->setCapabilities( caps );
   }
 }
@@ -93,6 +100,11 @@ void ReadBackend::endRun()
   }
 }
 
+bool ReadBackend::isReadOnly() const
+{
+  return true;
+}
+
 } // namespace Queries
 } // namespace DataBase
 } // namespace OpenTodoList
@@ -44,8 +44,9 @@ public:
 
     // StorageQuery interface
     bool query(QString &query, QVariantMap &args, int &options ) override;
-    void recordAvailable(const QVariantMap &record) override;
+    void rowAvailable(const RowCursor &cursor) override;
     void endRun() override;
+    bool isReadOnly() const override;
 
 signals:
 
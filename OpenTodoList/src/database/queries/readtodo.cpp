@@ -18,6 +18,9 @@
 
 #include "readtodo.h"
 
+#include "database/databaseworker.h"
+
+#include <QRegExp>
 #include <QTextStream>
 
 namespace OpenTodoList {
@@ -99,15 +102,85 @@ ReadTodo::ConditionList ReadTodo::generatedConditions() const
     c.condition = "(NOT done)";
     result.append( c );
   }
-  if ( !m_filter.isEmpty() ) {
+  // Each term must be contained in the todo's text or the title of one of its tasks (not
+  // necessarily all in the same one):
+  bool fullTextSearch = useFullTextSearch();
+  int i = 0;
+  for ( QString term : filterTerms( m_filter ) ) {
     Condition c;
-    c.condition = "( title LIKE '%:readTodoFilterInTitle%' OR "
-                    "description LIKE '%:readTodoFilterInDescription%' )";
-    c.arguments.insert( "readTodoFilterInTitle", m_filter );
-    c.arguments.insert( "readTodoFilterInDescription", m_filter );
+    if ( fullTextSearch ) {
+      c.condition = QString( "todo.id IN ( "
+                             "SELECT rowid FROM todoSearch WHERE todoSearch MATCH :readTodoSearch%1 "
+                             "UNION SELECT task.todo FROM taskSearch "
+                             "INNER JOIN task ON task.id = taskSearch.rowid "
+                             "WHERE taskSearch MATCH :readTodoSearchInTasks%1 )" ).arg( i );
+      c.arguments.insert( QString( "readTodoSearch%1" ).arg( i ), matchExpression( term ) );
+      c.arguments.insert( QString( "readTodoSearchInTasks%1" ).arg( i ), matchExpression( term ) );
+    } else {
+      term.replace( "\\", "\\\\" ).replace( "%", "\\%" ).replace( "_", "\\_" );
+      QString pattern = "%" + term + "%";
+      c.condition = QString( "todo.title LIKE :readTodoFilterInTitle%1 ESCAPE '\\' OR "
+                             "todo.description LIKE :readTodoFilterInDescription%1 ESCAPE '\\' OR "
+                             "EXISTS ( SELECT 1 FROM task WHERE task.todo = todo.id AND "
+                             "task.title LIKE :readTodoFilterInTasks%1 ESCAPE '\\' )" ).arg( i );
+      c.arguments.insert( QString( "readTodoFilterInTitle%1" ).arg( i ), pattern );
+      c.arguments.insert( QString( "readTodoFilterInDescription%1" ).arg( i ), pattern );
+      c.arguments.insert( QString( "readTodoFilterInTasks%1" ).arg( i ), pattern );
+    }
+    result.append( c );
+    ++i;
+  }
+  return result;
+}
+
+/**
+   @brief Orders search results by relevance
+
+   If a filter is set and the full text search index can be used, the todos are ordered by
+   their BM25 rank (todos whose own text does not contain all terms come last). Otherwise, no
+   particular order is applied.
+ */
+ReadTodo::Condition ReadTodo::generatedOrdering() const
+{
+  Condition result;
+  if ( !filterTerms( m_filter ).isEmpty() && useFullTextSearch() ) {
+    result.condition = "IFNULL( ( SELECT bm25( todoSearch ) FROM todoSearch "
+                       "WHERE todoSearch MATCH :readTodoRank AND todoSearch.rowid = todo.id ), 0 )";
+    result.arguments.insert( "readTodoRank", matchExpression( m_filter ) );
   }
   return result;
 }
+
+/**
+   @brief Splits the @p filter into the terms to search for
+ */
+QStringList ReadTodo::filterTerms(const QString &filter)
+{
+  return filter.split( QRegExp( "\\s+" ), QString::SkipEmptyParts );
+}
+
+/**
+   @brief Returns the FTS5 query for the @p filter
+
+   Each term of the filter is matched as a prefix, e.g. "buy mil" finds todos containing
+   both "buy" and "milk". Terms are quoted, so FTS5 operators in the filter are taken literally.
+ */
+QString ReadTodo::matchExpression(const QString &filter)
+{
+  QStringList terms;
+  for ( QString term : filterTerms( filter ) ) {
+    terms << "\"" + term.replace( "\"", "\"\"" ) + "\"*";
+  }
+  return terms.join( " " );
+}
+
+/**
+   @brief Can the full text search index be used to filter todos?
+ */
+bool ReadTodo::useFullTextSearch() const
+{
+  return worker() != nullptr && worker()->hasFullTextSearch();
+}
 bool ReadTodo::showOnlyScheduled() const
 {
     return m_showOnlyScheduled;
@@ -54,6 +54,9 @@ public:
     bool showOnlyScheduled() const;
     void setShowOnlyScheduled(bool showOnlyScheduled);
 
+    static QStringList filterTerms( const QString &filter );
+    static QString matchExpression( const QString &filter );
+
 signals:
 
     void readTodo( const QVariant &todo );
@@ -63,6 +66,7 @@ public slots:
 protected:
     // ReadObject interface
     ConditionList generatedConditions() const;
+    Condition generatedOrdering() const;
 
 private:
 
@@ -73,6 +77,7 @@ private:
     QString m_filter;
     bool m_showOnlyScheduled;
 
+    bool useFullTextSearch() const;
 
 };
 
@@ -0,0 +1,455 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/queryscheduler.h"
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+ */
+QueryScheduler::QueryScheduler() :
+  m_lock(),
+  m_clock(),
+  m_queues( StorageQuery::NumPriorities ),
+  m_statistics( StorageQuery::NumPriorities ),
+  m_held(),
+  m_latestByKey(),
+  m_size( 0 ),
+  m_agingInterval( DefaultAgingInterval ),
+  m_holdBack( DefaultHoldBack ),
+  m_maxHoldBack( DefaultMaxHoldBack )
+{
+  m_clock.start();
+  for ( ClassStatistics &stats : m_statistics ) {
+    stats.depth = 0;
+    stats.enqueued = 0;
+    stats.dequeued = 0;
+    stats.coalesced = 0;
+    stats.totalWait = 0;
+    stats.maxWait = 0;
+    stats.waits = LatencyHistogram();
+  }
+}
+
+/**
+   @brief Destructor
+ */
+QueryScheduler::~QueryScheduler()
+{
+}
+
+/**
+   @brief Adds the @p query to the queue of its priority class
+
+   If @p finished is given, the worker will release it once the query has been run.
+
+   If an earlier write to the same object is still waiting and that query takes over the
+   @p query (see StorageQuery::coalesce()), the query is not enqueued and false is returned. If
+   @p mergedInto is given, it is set to the query the @p query has been merged into. The caller
+   is responsible for deleting the query in that case. Queries with a semaphore are never merged.
+ */
+bool QueryScheduler::enqueue( StorageQuery *query, QSemaphore *finished,
+                              StorageQuery **mergedInto )
+{
+  Q_ASSERT( query != nullptr );
+  QMutexLocker l( &m_lock );
+  qint64 now = m_clock.elapsed();
+  int priority = priorityOf( query );
+  QString key = query->coalescingKey();
+  if ( !key.isEmpty() ) {
+    auto latest = m_latestByKey.find( key );
+    if ( latest != m_latestByKey.end() ) {
+      if ( latest->mergeable && finished == nullptr && latest->query->coalesce( query ) ) {
+        for ( Entry &held : m_held ) {
+          if ( held.query == latest->query ) {
+            held.readyAt = qMin( now + m_holdBack, held.enqueuedAt + m_maxHoldBack );
+            break;
+          }
+        }
+        m_statistics[ priority ].coalesced += 1;
+        if ( mergedInto ) {
+          *mergedInto = latest->query;
+        }
+        return false;
+      }
+      // Writes to the same object must not overtake each other, so they share one queue:
+      release( latest->query, now );
+      int waiting = queueOf( latest->query );
+      if ( waiting > priority ) {
+        moveKey( key, waiting, priority, now );
+      } else if ( waiting >= 0 ) {
+        priority = waiting;
+      }
+    }
+    KeyInfo info;
+    info.query = query;
+    info.mergeable = ( finished == nullptr );
+    m_latestByKey.insert( key, info );
+  }
+
+  Entry entry;
+  entry.query = query;
+  entry.finished = finished;
+  entry.key = key;
+  entry.priority = priority;
+  entry.enqueuedAt = now;
+  if ( finished == nullptr && !key.isEmpty() && m_holdBack > 0 && query->isCoalescable() ) {
+    entry.readyAt = now + m_holdBack;
+    m_held.append( entry );
+  } else {
+    entry.readyAt = now;
+    m_queues[ priority ].enqueue( entry );
+  }
+  m_statistics[ priority ].depth += 1;
+  m_statistics[ priority ].enqueued += 1;
+  m_size += 1;
+  return true;
+}
+
+/**
+   @brief Takes the query to be run next
+
+   This removes the entry with the best effective priority from the scheduler and stores it
+   in @p entry. Queries which are held back are not considered. Returns false if no query is
+   ready to be run.
+ */
+bool QueryScheduler::take( Entry &entry )
+{
+  QMutexLocker l( &m_lock );
+  qint64 now = m_clock.elapsed();
+  promoteHeld( now );
+  int best = -1;
+  qint64 bestPriority = 0;
+  for ( int i = 0; i < m_queues.size(); ++i ) {
+    if ( m_queues.at( i ).isEmpty() ) {
+      continue;
+    }
+    qint64 waited = now - m_queues.at( i ).head().enqueuedAt;
+    qint64 effectivePriority = i - waited / qMax( 1, m_agingInterval );
+    if ( best < 0 || effectivePriority < bestPriority ) {
+      best = i;
+      bestPriority = effectivePriority;
+    }
+  }
+  if ( best < 0 ) {
+    return false;
+  }
+  entry = m_queues[ best ].dequeue();
+  if ( !entry.key.isEmpty() ) {
+    auto latest = m_latestByKey.find( entry.key );
+    if ( latest != m_latestByKey.end() && latest->query == entry.query ) {
+      m_latestByKey.erase( latest );
+    }
+  }
+  qint64 waited = now - entry.enqueuedAt;
+  ClassStatistics &stats = m_statistics[ best ];
+  stats.depth -= 1;
+  stats.dequeued += 1;
+  stats.totalWait += waited;
+  stats.maxWait = qMax( stats.maxWait, waited );
+  stats.waits.record( waited );
+  m_size -= 1;
+  return true;
+}
+
+/**
+   @brief Takes all waiting queries in the order they would have been taken
+ */
+QList< QueryScheduler::Entry > QueryScheduler::takeAll()
+{
+  QList< Entry > result;
+  Entry entry;
+  while ( take( entry ) ) {
+    result << entry;
+  }
+  return result;
+}
+
+/**
+   @brief Makes all held back queries ready to be run
+
+   This is used e.g. on shutdown to make sure all pending writes are done.
+ */
+void QueryScheduler::releaseHeld()
+{
+  QMutexLocker l( &m_lock );
+  promoteHeld( m_clock.elapsed(), true );
+}
+
+/**
+   @brief Time (in ms) until the next query is ready to be run
+
+   Returns 0 if a query can be taken right now and -1 if no query is waiting at all.
+ */
+int QueryScheduler::nextReadyIn() const
+{
+  QMutexLocker l( &m_lock );
+  for ( const QQueue< Entry > &queue : m_queues ) {
+    if ( !queue.isEmpty() ) {
+      return 0;
+    }
+  }
+  if ( m_held.isEmpty() ) {
+    return -1;
+  }
+  qint64 now = m_clock.elapsed();
+  qint64 readyAt = m_held.first().readyAt;
+  for ( const Entry &entry : m_held ) {
+    readyAt = qMin( readyAt, entry.readyAt );
+  }
+  return static_cast< int >( qMax( Q_INT64_C( 0 ), readyAt - now ) );
+}
+
+/**
+   @brief Returns true if no query is waiting
+ */
+bool QueryScheduler::isEmpty() const
+{
+  return size() == 0;
+}
+
+/**
+   @brief The number of waiting queries (over all priority classes)
+ */
+int QueryScheduler::size() const
+{
+  QMutexLocker l( &m_lock );
+  return m_size;
+}
+
+/**
+   @brief The time (in ms) after which a waiting query is promoted by one priority class
+
+   @sa setAgingInterval()
+ */
+int QueryScheduler::agingInterval() const
+{
+  QMutexLocker l( &m_lock );
+  return m_agingInterval;
+}
+
+/**
+   @brief Sets the time (in ms) after which a waiting query is promoted by one priority class
+ */
+void QueryScheduler::setAgingInterval( int agingInterval )
+{
+  QMutexLocker l( &m_lock );
+  m_agingInterval = qMax( 1, agingInterval );
+}
+
+/**
+   @brief The time (in ms) coalescable writes are held back
+
+   @sa setHoldBack()
+ */
+int QueryScheduler::holdBack() const
+{
+  QMutexLocker l( &m_lock );
+  return m_holdBack;
+}
+
+/**
+   @brief Sets the time (in ms) coalescable writes are held back
+
+   Setting this to 0 disables holding back writes (they will still be merged if the worker
+   does not get to them before a newer write arrives).
+ */
+void QueryScheduler::setHoldBack( int holdBack )
+{
+  QMutexLocker l( &m_lock );
+  m_holdBack = qMax( 0, holdBack );
+}
+
+/**
+   @brief The maximum time (in ms) a write is held back, even if newer writes are merged into it
+
+   @sa setMaxHoldBack()
+ */
+int QueryScheduler::maxHoldBack() const
+{
+  QMutexLocker l( &m_lock );
+  return m_maxHoldBack;
+}
+
+/**
+   @brief Sets the maximum time (in ms) a write is held back
+ */
+void QueryScheduler::setMaxHoldBack( int maxHoldBack )
+{
+  QMutexLocker l( &m_lock );
+  m_maxHoldBack = qMax( 0, maxHoldBack );
+}
+
+/**
+   @brief Returns the statistics of the @p priority class
+ */
+QueryScheduler::ClassStatistics QueryScheduler::statistics( StorageQuery::Priority priority ) const
+{
+  QMutexLocker l( &m_lock );
+  return m_statistics.value( priority );
+}
+
+/**
+   @brief Returns the statistics of all priority classes
+
+   The returned map contains one entry per priority class (keyed by priorityName()), each
+   holding the depth, enqueued, dequeued, coalesced, averageWait and maxWait values of the
+   class as well as the waitP50, waitP95 and waitP99 percentiles of the waiting times (all
+   times in ms).
+ */
+QVariantMap QueryScheduler::statistics() const
+{
+  QMutexLocker l( &m_lock );
+  QVariantMap result;
+  for ( int i = 0; i < m_statistics.size(); ++i ) {
+    const ClassStatistics &stats = m_statistics.at( i );
+    QVariantMap map;
+    map.insert( "depth", stats.depth );
+    map.insert( "enqueued", stats.enqueued );
+    map.insert( "dequeued", stats.dequeued );
+    map.insert( "coalesced", stats.coalesced );
+    map.insert( "averageWait", stats.dequeued > 0 ?
+                  static_cast< double >( stats.totalWait ) / stats.dequeued : 0.0 );
+    map.insert( "maxWait", stats.maxWait );
+    map.insert( "waitP50", stats.waits.percentile( 50 ) );
+    map.insert( "waitP95", stats.waits.percentile( 95 ) );
+    map.insert( "waitP99", stats.waits.percentile( 99 ) );
+    result.insert( priorityName( static_cast< StorageQuery::Priority >( i ) ), map );
+  }
+  return result;
+}
+
+/**
+   @brief Returns a human readable name of the @p priority class
+ */
+QString QueryScheduler::priorityName( StorageQuery::Priority priority )
+{
+  switch ( priority ) {
+  case StorageQuery::InteractivePriority: return "interactive";
+  case StorageQuery::UserWritePriority: return "userWrite";
+  case StorageQuery::BackgroundSyncPriority: return "backgroundSync";
+  case StorageQuery::MaintenancePriority: return "maintenance";
+  }
+  return QString();
+}
+
+/**
+   @brief Returns the index of the queue for the @p query
+ */
+int QueryScheduler::priorityOf( StorageQuery *query )
+{
+  return qBound( 0, static_cast< int >( query->priority() ), StorageQuery::NumPriorities - 1 );
+}
+
+/**
+   @brief Returns the index of the queue the @p query is waiting in
+
+   Returns -1 if the query is not in any queue (e.g. because it is held back).
+
+   @note Must be called with the lock being held.
+ */
+int QueryScheduler::queueOf( StorageQuery *query ) const
+{
+  for ( int i = 0; i < m_queues.size(); ++i ) {
+    for ( const Entry &entry : m_queues.at( i ) ) {
+      if ( entry.query == query ) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+/**
+   @brief Makes the held back @p query ready to be run immediately
+
+   @note Must be called with the lock being held.
+ */
+void QueryScheduler::release( StorageQuery *query, qint64 now )
+{
+  for ( int i = 0; i < m_held.size(); ++i ) {
+    if ( m_held.at( i ).query == query ) {
+      Entry entry = m_held.takeAt( i );
+      schedule( entry, now );
+      return;
+    }
+  }
+}
+
+/**
+   @brief Moves all entries with the given @p key from one queue to another
+
+   The entries keep their relative order and are appended to the queue @p to.
+
+   @note Must be called with the lock being held.
+ */
+void QueryScheduler::moveKey( const QString &key, int from, int to, qint64 now )
+{
+  QQueue< Entry > &source = m_queues[ from ];
+  for ( int i = 0; i < source.size(); ) {
+    if ( source.at( i ).key == key ) {
+      Entry entry = source.takeAt( i );
+      m_statistics[ from ].depth -= 1;
+      m_statistics[ to ].depth += 1;
+      entry.priority = to;
+      schedule( entry, now );
+    } else {
+      ++i;
+    }
+  }
+}
+
+/**
+   @brief Appends the @p entry to the queue of its priority class
+
+   The entry's enqueuedAt time is reset to @p now, as it starts waiting at the tail of the
+   queue (which is what aging relies on).
+
+   @note Must be called with the lock being held.
+ */
+void QueryScheduler::schedule( Entry &entry, qint64 now )
+{
+  entry.enqueuedAt = now;
+  m_queues[ entry.priority ].enqueue( entry );
+}
+
+/**
+   @brief Moves all held back queries which are ready at @p now into their queues
+
+   If @p all is true, all held back queries are moved, regardless of whether they are ready.
+
+   @note Must be called with the lock being held.
+ */
+void QueryScheduler::promoteHeld( qint64 now, bool all )
+{
+  for ( int i = 0; i < m_held.size(); ) {
+    if ( all || m_held.at( i ).readyAt <= now ) {
+      Entry entry = m_held.takeAt( i );
+      schedule( entry, qMin( now, entry.readyAt ) );
+    } else {
+      ++i;
+    }
+  }
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,153 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_QUERYSCHEDULER_H
+#define OPENTODOLIST_DATABASE_QUERYSCHEDULER_H
+
+#include "database/querystatistics.h"
+#include "database/storagequery.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QSemaphore>
+#include <QVariantMap>
+#include <QVector>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Orders queries waiting to be run by a DatabaseWorker
+
+   The QueryScheduler keeps one FIFO queue per StorageQuery::Priority class. When the worker asks
+   for the next query, the scheduler picks the query with the best effective priority. The
+   effective priority of a query is its priority class, promoted by one class for every
+   agingInterval() milliseconds the query has been waiting. Hence, interactive reads overtake
+   bulk background work, but background work still makes progress while the user is working.
+
+   Writes to the same object (as identified by StorageQuery::coalescingKey()) are kept in order.
+   If a query is enqueued while an earlier write to the same object is still waiting, the
+   scheduler asks the earlier query to take over the newer one (see StorageQuery::coalesce()).
+   If that is not possible, the new query is put into the same queue as the waiting writes to
+   the object. If the new query is more urgent, the waiting writes are moved to its queue
+   first, so a user edit does not overtake an earlier background write to the same object.
+   Queries which support this (StorageQuery::isCoalescable()) are held back for holdBack()
+   milliseconds, so that e.g. a burst of edits to a todo's title results in a single write. Each
+   merged write extends the hold back, up to maxHoldBack() milliseconds in total.
+
+   The scheduler also keeps statistics per priority class (current queue depth, number of
+   queries, merged queries and time spent waiting), which can be inspected via statistics().
+   Waiting times are kept in a LatencyHistogram, so their percentiles can be reported.
+
+   @note The class is thread safe.
+ */
+class QueryScheduler
+{
+public:
+
+  /**
+     @brief A query waiting in the scheduler
+   */
+  struct Entry {
+    StorageQuery *query;      //!< The query to be run
+    QSemaphore   *finished;   //!< If set, released once the query has been run
+    QString       key;        //!< The coalescing key of the query
+    int           priority;   //!< The priority class (i.e. queue) the query is scheduled in
+    qint64        enqueuedAt; //!< Time (in ms since creation of the scheduler) it entered its queue
+    qint64        readyAt;    //!< Time (in ms since creation of the scheduler) it may be run
+  };
+
+  /**
+     @brief Statistics for one priority class
+   */
+  struct ClassStatistics {
+    int     depth;      //!< Number of queries currently waiting
+    quint64 enqueued;   //!< Total number of queries enqueued
+    quint64 dequeued;   //!< Total number of queries taken for execution
+    quint64 coalesced;  //!< Total number of queries merged into waiting ones
+    qint64  totalWait;  //!< Total time (ms) taken queries have been waiting
+    qint64  maxWait;    //!< Longest time (ms) a taken query has been waiting
+    LatencyHistogram waits; //!< Times (ms) taken queries have been waiting
+  };
+
+  static const int DefaultAgingInterval = 500;
+  static const int DefaultHoldBack = 300;
+  static const int DefaultMaxHoldBack = 3000;
+
+  explicit QueryScheduler();
+  virtual ~QueryScheduler();
+
+  bool enqueue( StorageQuery *query, QSemaphore *finished = nullptr,
+                StorageQuery **mergedInto = nullptr );
+  bool take( Entry &entry );
+  QList< Entry > takeAll();
+  void releaseHeld();
+  int nextReadyIn() const;
+
+  bool isEmpty() const;
+  int size() const;
+
+  int agingInterval() const;
+  void setAgingInterval( int agingInterval );
+
+  int holdBack() const;
+  void setHoldBack( int holdBack );
+
+  int maxHoldBack() const;
+  void setMaxHoldBack( int maxHoldBack );
+
+  ClassStatistics statistics( StorageQuery::Priority priority ) const;
+  QVariantMap statistics() const;
+
+  static QString priorityName( StorageQuery::Priority priority );
+
+private:
+
+  struct KeyInfo {
+    StorageQuery *query;
+    bool          mergeable;
+  };
+
+  mutable QMutex                m_lock;
+  QElapsedTimer                 m_clock;
+  QVector< QQueue< Entry > >    m_queues;
+  QVector< ClassStatistics >    m_statistics;
+  QList< Entry >                m_held;
+  QHash< QString, KeyInfo >     m_latestByKey;
+  int                           m_size;
+  int                           m_agingInterval;
+  int                           m_holdBack;
+  int                           m_maxHoldBack;
+
+  static int priorityOf( StorageQuery *query );
+  int queueOf( StorageQuery *query ) const;
+  void release( StorageQuery *query, qint64 now );
+  void moveKey( const QString &key, int from, int to, qint64 now );
+  void schedule( Entry &entry, qint64 now );
+  void promoteHeld( qint64 now, bool all = false );
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_QUERYSCHEDULER_H
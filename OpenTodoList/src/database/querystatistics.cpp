@@ -0,0 +1,249 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "database/querystatistics.h"
+
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+ */
+LatencyHistogram::LatencyHistogram() :
+  m_buckets( NumBuckets, 0 ),
+  m_count( 0 ),
+  m_max( 0 )
+{
+}
+
+/**
+   @brief Counts the @p value
+
+   Negative values are counted as 0. Values beyond 2^MaxValueBits are counted in the last
+   bucket.
+ */
+void LatencyHistogram::record( qint64 value )
+{
+  value = qMax( Q_INT64_C( 0 ), value );
+  m_buckets[ bucketOf( static_cast< quint64 >( value ) ) ] += 1;
+  m_count += 1;
+  m_max = qMax( m_max, value );
+}
+
+/**
+   @brief Adds the values counted in the @p other histogram to this one
+ */
+void LatencyHistogram::merge( const LatencyHistogram &other )
+{
+  for ( int i = 0; i < NumBuckets; ++i ) {
+    m_buckets[ i ] += other.m_buckets.at( i );
+  }
+  m_count += other.m_count;
+  m_max = qMax( m_max, other.m_max );
+}
+
+/**
+   @brief The number of values counted
+ */
+quint64 LatencyHistogram::count() const
+{
+  return m_count;
+}
+
+/**
+   @brief The largest value counted
+ */
+qint64 LatencyHistogram::max() const
+{
+  return m_max;
+}
+
+/**
+   @brief Returns the value below or at which @p percentile percent of the values are
+
+   The result is the highest value which falls into the same bucket as the exact percentile.
+   Returns 0 if no values have been counted.
+ */
+qint64 LatencyHistogram::percentile( double percentile ) const
+{
+  if ( m_count == 0 ) {
+    return 0;
+  }
+  quint64 target = static_cast< quint64 >(
+        std::ceil( qBound( 0.0, percentile, 100.0 ) / 100.0 * m_count ) );
+  target = qMax( Q_UINT64_C( 1 ), target );
+  quint64 seen = 0;
+  for ( int i = 0; i < NumBuckets; ++i ) {
+    seen += m_buckets.at( i );
+    if ( seen >= target ) {
+      return qMin( highestValueIn( i ), m_max );
+    }
+  }
+  return m_max;
+}
+
+/**
+   @brief Returns the bucket the @p value is counted in
+ */
+int LatencyHistogram::bucketOf( quint64 value )
+{
+  if ( value < static_cast< quint64 >( SubBuckets ) ) {
+    return static_cast< int >( value );
+  }
+  int msb = SubBucketBits;
+  while ( msb < 63 && ( value >> ( msb + 1 ) ) != 0 ) {
+    ++msb;
+  }
+  if ( msb >= MaxValueBits ) {
+    return NumBuckets - 1;
+  }
+  int shift = msb - SubBucketBits;
+  return SubBuckets * shift + static_cast< int >( value >> shift );
+}
+
+/**
+   @brief Returns the highest value counted in the @p bucket
+ */
+qint64 LatencyHistogram::highestValueIn( int bucket )
+{
+  if ( bucket < 2 * SubBuckets ) {
+    return bucket;
+  }
+  int shift = bucket / SubBuckets - 1;
+  qint64 mantissa = bucket % SubBuckets + SubBuckets;
+  return ( ( mantissa + 1 ) << shift ) - 1;
+}
+
+/**
+   @brief Constructor
+ */
+QueryStatistics::QueryStatistics() :
+  m_lock(),
+  m_entries()
+{
+}
+
+/**
+   @brief Destructor
+ */
+QueryStatistics::~QueryStatistics()
+{
+}
+
+/**
+   @brief Counts a successful statement of the @p queryClass
+
+   The statement returned @p rows rows and took @p nsecs nanoseconds.
+ */
+void QueryStatistics::record( const QString &queryClass, int rows, qint64 nsecs )
+{
+  QMutexLocker l( &m_lock );
+  auto it = m_entries.find( queryClass );
+  if ( it == m_entries.end() ) {
+    Entry entry = { 0, 0, 0, LatencyHistogram() };
+    it = m_entries.insert( queryClass, entry );
+  }
+  it->executions += 1;
+  it->rows += static_cast< quint64 >( qMax( 0, rows ) );
+  it->latency.record( nsecs / 1000 );
+}
+
+/**
+   @brief Counts a failed statement of the @p queryClass
+ */
+void QueryStatistics::recordFailure( const QString &queryClass )
+{
+  QMutexLocker l( &m_lock );
+  auto it = m_entries.find( queryClass );
+  if ( it == m_entries.end() ) {
+    Entry entry = { 0, 0, 0, LatencyHistogram() };
+    it = m_entries.insert( queryClass, entry );
+  }
+  it->failures += 1;
+}
+
+/**
+   @brief Returns a copy of the statistics of all query classes
+ */
+QueryStatistics::Entries QueryStatistics::entries() const
+{
+  QMutexLocker l( &m_lock );
+  return m_entries;
+}
+
+/**
+   @brief Resets all statistics
+ */
+void QueryStatistics::clear()
+{
+  QMutexLocker l( &m_lock );
+  m_entries.clear();
+}
+
+/**
+   @brief Adds the statistics in @p source to the ones in @p target
+
+   This is used to combine the statistics of several workers.
+ */
+void QueryStatistics::merge( Entries &target, const Entries &source )
+{
+  for ( auto it = source.constBegin(); it != source.constEnd(); ++it ) {
+    auto existing = target.find( it.key() );
+    if ( existing == target.end() ) {
+      target.insert( it.key(), it.value() );
+    } else {
+      existing->executions += it->executions;
+      existing->failures += it->failures;
+      existing->rows += it->rows;
+      existing->latency.merge( it->latency );
+    }
+  }
+}
+
+/**
+   @brief Converts the @p entries to a variant map
+
+   The returned map holds one entry per query class with the executions, failures and rows
+   counters as well as the p50, p95, p99 and max durations (in milliseconds).
+ */
+QVariantMap QueryStatistics::toVariant( const Entries &entries )
+{
+  QVariantMap result;
+  for ( auto it = entries.constBegin(); it != entries.constEnd(); ++it ) {
+    QVariantMap map;
+    map.insert( "executions", it->executions );
+    map.insert( "failures", it->failures );
+    map.insert( "rows", it->rows );
+    map.insert( "p50", it->latency.percentile( 50 ) / 1000.0 );
+    map.insert( "p95", it->latency.percentile( 95 ) / 1000.0 );
+    map.insert( "p99", it->latency.percentile( 99 ) / 1000.0 );
+    map.insert( "max", it->latency.max() / 1000.0 );
+    result.insert( it.key(), map );
+  }
+  return result;
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,122 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENTODOLIST_DATABASE_QUERYSTATISTICS_H
+#define OPENTODOLIST_DATABASE_QUERYSTATISTICS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief A histogram of durations with bounded relative error
+
+   Values are counted in buckets of logarithmically growing width (similar to HDR histograms):
+   Each power of two is split into SubBuckets equally wide buckets, so percentiles are accurate
+   to about 1/SubBuckets of the value, whatever the magnitude. Recording a value is a
+   constant time operation and the memory used does not depend on the number of values.
+
+   The unit of the values is up to the user (e.g. microseconds or milliseconds).
+ */
+class LatencyHistogram
+{
+public:
+
+  static const int SubBucketBits = 4;
+  static const int SubBuckets = 1 << SubBucketBits;
+  static const int MaxValueBits = 40;
+  static const int NumBuckets = SubBuckets * ( MaxValueBits - SubBucketBits + 1 );
+
+  LatencyHistogram();
+
+  void record( qint64 value );
+  void merge( const LatencyHistogram &other );
+
+  quint64 count() const;
+  qint64 max() const;
+  qint64 percentile( double percentile ) const;
+
+private:
+
+  QVector< quint64 >  m_buckets;
+  quint64             m_count;
+  qint64              m_max;
+
+  static int bucketOf( quint64 value );
+  static qint64 highestValueIn( int bucket );
+
+};
+
+/**
+   @brief Counts statements run by a DatabaseWorker per query class
+
+   For each query class (see StorageQuery::queryClass()), the number of statements run and
+   failed, the number of rows returned and a LatencyHistogram of the durations (in microseconds)
+   are kept. Recording is cheap (the lock is only contended while the statistics are read),
+   so statistics are always collected unless the application has been built with
+   OPENTODOLIST_NO_QUERY_STATISTICS.
+
+   @note The class is thread safe.
+ */
+class QueryStatistics
+{
+public:
+
+  /**
+     @brief Statistics of one query class
+   */
+  struct Entry {
+    quint64           executions;   //!< Number of statements run successfully
+    quint64           failures;     //!< Number of statements which failed
+    quint64           rows;         //!< Number of rows returned in total
+    LatencyHistogram  latency;      //!< Durations (us) of successful statements
+  };
+
+  typedef QHash< QString, Entry > Entries;
+
+  QueryStatistics();
+  virtual ~QueryStatistics();
+
+  void record( const QString &queryClass, int rows, qint64 nsecs );
+  void recordFailure( const QString &queryClass );
+
+  Entries entries() const;
+  void clear();
+
+  static void merge( Entries &target, const Entries &source );
+  static QVariantMap toVariant( const Entries &entries );
+
+private:
+
+  mutable QMutex  m_lock;
+  Entries         m_entries;
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_QUERYSTATISTICS_H
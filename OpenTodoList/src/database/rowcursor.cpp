@@ -0,0 +1,142 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/rowcursor.h"
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+
+   Creates a cursor on the @p query, which must have been executed already. The
+   column layout is read once on construction.
+ */
+RowCursor::RowCursor( QSqlQuery *query ) :
+  m_query( query ),
+  m_record( query->record() )
+{
+  Q_ASSERT( m_query != nullptr );
+}
+
+/**
+   @brief The number of columns in the result
+ */
+int RowCursor::columnCount() const
+{
+  return m_record.count();
+}
+
+/**
+   @brief Returns the position of the column with the given @p name
+
+   Returns -1 if there is no such column. Use this once per statement (not per row).
+ */
+int RowCursor::indexOf( const QString &name ) const
+{
+  return m_record.indexOf( name );
+}
+
+/**
+   @brief Returns the name of the @p column
+ */
+QString RowCursor::columnName( int column ) const
+{
+  return m_record.fieldName( column );
+}
+
+/**
+   @brief Returns true if the value of the @p column in the current row is NULL
+
+   Invalid columns (e.g. as returned by indexOf() for unknown names) are reported as NULL.
+ */
+bool RowCursor::isNull( int column ) const
+{
+  return column < 0 || m_query->isNull( column );
+}
+
+/**
+   @brief Returns the value of the @p column in the current row
+ */
+QVariant RowCursor::value( int column ) const
+{
+  if ( column < 0 ) {
+    return QVariant();
+  }
+  return m_query->value( column );
+}
+
+/**
+   @brief Returns the value of the @p column as integer or @p defaultValue if it is NULL
+ */
+int RowCursor::toInt( int column, int defaultValue ) const
+{
+  return isNull( column ) ? defaultValue : m_query->value( column ).toInt();
+}
+
+/**
+   @brief Returns the value of the @p column as double or @p defaultValue if it is NULL
+ */
+double RowCursor::toDouble( int column, double defaultValue ) const
+{
+  return isNull( column ) ? defaultValue : m_query->value( column ).toDouble();
+}
+
+/**
+   @brief Returns the value of the @p column as boolean or @p defaultValue if it is NULL
+ */
+bool RowCursor::toBool( int column, bool defaultValue ) const
+{
+  return isNull( column ) ? defaultValue : m_query->value( column ).toBool();
+}
+
+/**
+   @brief Returns the value of the @p column as string
+ */
+QString RowCursor::toString( int column ) const
+{
+  return isNull( column ) ? QString() : m_query->value( column ).toString();
+}
+
+/**
+   @brief Returns the value of the @p column as date/time
+ */
+QDateTime RowCursor::toDateTime( int column ) const
+{
+  return isNull( column ) ? QDateTime() : m_query->value( column ).toDateTime();
+}
+
+/**
+   @brief Returns the current row as a map from column names to values
+
+   This is used to support queries which only implement StorageQuery::recordAvailable(). It is
+   considerably slower than positional access.
+ */
+QVariantMap RowCursor::toMap() const
+{
+  QVariantMap result;
+  for ( int i = 0; i < m_record.count(); ++i ) {
+    result.insert( m_record.fieldName( i ), m_query->value( i ) );
+  }
+  return result;
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,79 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_ROWCURSOR_H
+#define OPENTODOLIST_DATABASE_ROWCURSOR_H
+
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Gives access to the current row of a running query
+
+   The RowCursor wraps the live QSqlQuery a DatabaseWorker is stepping through. Instead of
+   copying every row into a QVariantMap keyed by field name, queries resolve the positions of the
+   columns they are interested in once (using indexOf() in StorageQuery::columnsAvailable())
+   and then read values positionally for each row (in StorageQuery::rowAvailable()).
+
+   Reading numbers, booleans and strings through the cursor does not allocate memory (strings
+   are shared with the row the driver holds). This does not make reading rows free of
+   allocations, though: When stepping to the next row, the SQLite driver of QtSql already
+   converts every column into a QVariant, which allocates for each non-NULL text or blob value.
+
+   @note A cursor is only valid during the StorageQuery callbacks it is passed to.
+ */
+class RowCursor
+{
+public:
+
+  explicit RowCursor( QSqlQuery *query );
+
+  int columnCount() const;
+  int indexOf( const QString &name ) const;
+  QString columnName( int column ) const;
+
+  bool isNull( int column ) const;
+  QVariant value( int column ) const;
+  int toInt( int column, int defaultValue = 0 ) const;
+  double toDouble( int column, double defaultValue = 0.0 ) const;
+  bool toBool( int column, bool defaultValue = false ) const;
+  QString toString( int column ) const;
+  QDateTime toDateTime( int column ) const;
+
+  QVariantMap toMap() const;
+
+private:
+
+  QSqlQuery  *m_query;
+  QSqlRecord  m_record;
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_ROWCURSOR_H
@@ -0,0 +1,268 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "database/slowquerylog.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+
+   Creates a log writing to @p fileName, recording statements which take at least
+   @p threshold milliseconds.
+ */
+SlowQueryLog::SlowQueryLog( const QString &fileName, int threshold ) :
+  m_lock(),
+  m_fileName( fileName ),
+  m_threshold( static_cast< qint64 >( qMax( 0, threshold ) ) * 1000000 ),
+  m_maxFileSize( DefaultMaxFileSize ),
+  m_maxFiles( DefaultMaxFiles ),
+  m_plans(),
+  m_classes()
+{
+}
+
+/**
+   @brief Destructor
+ */
+SlowQueryLog::~SlowQueryLog()
+{
+}
+
+/**
+   @brief The file the log is written to
+ */
+QString SlowQueryLog::fileName() const
+{
+  return m_fileName;
+}
+
+/**
+   @brief The duration (in ms) from which on statements are recorded
+ */
+int SlowQueryLog::threshold() const
+{
+  return static_cast< int >( m_threshold / 1000000 );
+}
+
+/**
+   @brief Returns true if a statement which took @p nsecs nanoseconds shall be recorded
+ */
+bool SlowQueryLog::isSlow( qint64 nsecs ) const
+{
+  return nsecs >= m_threshold;
+}
+
+/**
+   @brief The size (in bytes) from which on the log file is rotated
+ */
+int SlowQueryLog::maxFileSize() const
+{
+  QMutexLocker l( &m_lock );
+  return m_maxFileSize;
+}
+
+/**
+   @brief Sets the size (in bytes) from which on the log file is rotated
+ */
+void SlowQueryLog::setMaxFileSize( int maxFileSize )
+{
+  QMutexLocker l( &m_lock );
+  m_maxFileSize = qMax( 1, maxFileSize );
+}
+
+/**
+   @brief The number of log files kept (including the current one)
+ */
+int SlowQueryLog::maxFiles() const
+{
+  QMutexLocker l( &m_lock );
+  return m_maxFiles;
+}
+
+/**
+   @brief Sets the number of log files kept (including the current one)
+ */
+void SlowQueryLog::setMaxFiles( int maxFiles )
+{
+  QMutexLocker l( &m_lock );
+  m_maxFiles = qMax( 1, maxFiles );
+}
+
+/**
+   @brief Returns true if the query plan of the @p statement is already known
+
+   Query plans are collected only once per (normalized) statement. If this returns true, the
+   caller can leave the plan of the Record empty.
+ */
+bool SlowQueryLog::hasPlan( const QString &statement ) const
+{
+  QMutexLocker l( &m_lock );
+  return m_plans.contains( normalize( statement ) );
+}
+
+/**
+   @brief Appends the @p record to the log
+ */
+void SlowQueryLog::record( const Record &record )
+{
+  QString statement = normalize( record.statement );
+
+  QMutexLocker l( &m_lock );
+  if ( !m_classes.contains( record.queryClass ) ) {
+    ClassStatistics empty = { 0, 0.0, 0.0 };
+    m_classes.insert( record.queryClass, empty );
+  }
+  ClassStatistics &stats = m_classes[ record.queryClass ];
+  stats.count += 1;
+  stats.totalDuration += record.duration;
+  stats.maxDuration = qMax( stats.maxDuration, record.duration );
+
+  QStringList plan = record.plan;
+  if ( plan.isEmpty() ) {
+    plan = m_plans.value( statement );
+  } else {
+    m_plans.insert( statement, plan );
+  }
+
+  QJsonObject entry;
+  entry.insert( "time", QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) );
+  entry.insert( "class", record.queryClass );
+  entry.insert( "statement", statement );
+  entry.insert( "arguments", QJsonObject::fromVariantMap( argumentShapes( record.arguments ) ) );
+  entry.insert( "rows", record.rows );
+  entry.insert( "duration", record.duration );
+  entry.insert( "plan", QJsonArray::fromStringList( plan ) );
+
+  rotate();
+  QFile file( m_fileName );
+  if ( file.open( QIODevice::WriteOnly | QIODevice::Append ) ) {
+    file.write( QJsonDocument( entry ).toJson( QJsonDocument::Compact ) );
+    file.write( "\n" );
+    file.close();
+  } else {
+    qWarning() << "Failed to open slow query log" << m_fileName << ":" << file.errorString();
+  }
+}
+
+/**
+   @brief Returns the number of slow statements recorded per query class
+
+   The returned map contains one entry per query class, holding the count, averageDuration and
+   maxDuration (in ms) of the statements recorded since the log has been created.
+ */
+QVariantMap SlowQueryLog::statistics() const
+{
+  QMutexLocker l( &m_lock );
+  QVariantMap result;
+  for ( auto it = m_classes.constBegin(); it != m_classes.constEnd(); ++it ) {
+    QVariantMap map;
+    map.insert( "count", it->count );
+    map.insert( "averageDuration", it->totalDuration / it->count );
+    map.insert( "maxDuration", it->maxDuration );
+    result.insert( it.key(), map );
+  }
+  return result;
+}
+
+/**
+   @brief Returns the @p statement with all literal values removed
+
+   Besides collapsing white space, string and numeric literals are replaced by "?" and
+   lists of numbered placeholders (like the ":metaObjectId0, :metaObjectId1, ..." generated
+   when reading objects in batches) are collapsed into a single ":metaObjectId*". Statements
+   which only differ in these details hence end up in the same group.
+ */
+QString SlowQueryLog::normalize( const QString &statement )
+{
+  static const QRegularExpression Strings( "'(?:[^']|'')*'" );
+  static const QRegularExpression Numbers( "(?<![\\w:.])\\d+(?:\\.\\d+)?\\b" );
+  static const QRegularExpression PlaceholderLists( "(:[A-Za-z_]+)\\d+(?:\\s*,\\s*\\1\\d+)*" );
+
+  QString result = statement.simplified();
+  result.replace( Strings, "?" );
+  result.replace( Numbers, "?" );
+  result.replace( PlaceholderLists, "\\1*" );
+  return result;
+}
+
+/**
+   @brief Describes the @p arguments without revealing their values
+
+   For each argument, the name of its type is returned. Strings and binary values also
+   include their length, e.g. "QString(12)". NULL values are described as "NULL".
+ */
+QVariantMap SlowQueryLog::argumentShapes( const QVariantMap &arguments )
+{
+  QVariantMap result;
+  for ( auto it = arguments.constBegin(); it != arguments.constEnd(); ++it ) {
+    const QVariant &value = it.value();
+    QString shape;
+    if ( value.isNull() ) {
+      shape = "NULL";
+    } else if ( value.type() == QVariant::String ) {
+      shape = QString( "QString(%1)" ).arg( value.toString().length() );
+    } else if ( value.type() == QVariant::ByteArray ) {
+      shape = QString( "QByteArray(%1)" ).arg( value.toByteArray().size() );
+    } else {
+      shape = value.typeName();
+    }
+    result.insert( it.key(), shape );
+  }
+  return result;
+}
+
+/**
+   @brief Rotates the log files if the current one grew too large
+
+   @note Must be called with the lock being held.
+ */
+void SlowQueryLog::rotate()
+{
+  QFileInfo fi( m_fileName );
+  if ( !fi.exists() || fi.size() < m_maxFileSize ) {
+    return;
+  }
+  QFile::remove( QString( "%1.%2" ).arg( m_fileName ).arg( m_maxFiles - 1 ) );
+  for ( int i = m_maxFiles - 2; i >= 1; --i ) {
+    QFile::rename( QString( "%1.%2" ).arg( m_fileName ).arg( i ),
+                   QString( "%1.%2" ).arg( m_fileName ).arg( i + 1 ) );
+  }
+  if ( m_maxFiles > 1 ) {
+    QFile::rename( m_fileName, m_fileName + ".1" );
+  } else {
+    QFile::remove( m_fileName );
+  }
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,118 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENTODOLIST_DATABASE_SLOWQUERYLOG_H
+#define OPENTODOLIST_DATABASE_SLOWQUERYLOG_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Records statements which took longer than a threshold
+
+   The DatabaseWorker times each statement it runs. Statements exceeding the threshold() are
+   passed to record(), which appends them as one JSON object per line to the log file. Each
+   entry holds the class of the query which generated the statement (see
+   StorageQuery::queryClass()), the normalized SQL, the shapes (but not the values) of the
+   bound arguments, the number of rows returned, the duration and the output of
+   EXPLAIN QUERY PLAN. This allows to find e.g. full table scans on user machines without
+   leaking any of their data.
+
+   Once the log file grows beyond maxFileSize(), it is rotated: The current file is renamed to
+   "<fileName>.1", older ones are shifted up to "<fileName>.<maxFiles - 1>" and the oldest one
+   is dropped.
+
+   @note The log is thread safe, so it can be shared by all workers of a Database.
+ */
+class SlowQueryLog
+{
+public:
+
+  static const int DefaultThreshold = 100;
+  static const int DefaultMaxFileSize = 512 * 1024;
+  static const int DefaultMaxFiles = 3;
+
+  /**
+     @brief A single slow statement
+   */
+  struct Record {
+    QString       queryClass;   //!< The class of the query which ran the statement
+    QString       statement;    //!< The SQL text of the statement
+    QVariantMap   arguments;    //!< The arguments bound to the statement
+    int           rows;         //!< The number of rows returned
+    double        duration;     //!< The time it took to run the statement (in ms)
+    QStringList   plan;         //!< The lines of the query plan
+  };
+
+  explicit SlowQueryLog( const QString &fileName, int threshold = DefaultThreshold );
+  virtual ~SlowQueryLog();
+
+  QString fileName() const;
+  int threshold() const;
+  bool isSlow( qint64 nsecs ) const;
+
+  int maxFileSize() const;
+  void setMaxFileSize( int maxFileSize );
+
+  int maxFiles() const;
+  void setMaxFiles( int maxFiles );
+
+  bool hasPlan( const QString &statement ) const;
+  void record( const Record &record );
+
+  QVariantMap statistics() const;
+
+  static QString normalize( const QString &statement );
+  static QVariantMap argumentShapes( const QVariantMap &arguments );
+
+private:
+
+  /**
+     @brief Counters kept per query class
+   */
+  struct ClassStatistics {
+    int     count;
+    double  totalDuration;
+    double  maxDuration;
+  };
+
+  mutable QMutex                      m_lock;
+  QString                             m_fileName;
+  qint64                              m_threshold;
+  int                                 m_maxFileSize;
+  int                                 m_maxFiles;
+  QHash< QString, QStringList >       m_plans;
+  QHash< QString, ClassStatistics >   m_classes;
+
+  void rotate();
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_SLOWQUERYLOG_H
@@ -0,0 +1,183 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "database/statementcache.h"
+
+#include <QDebug>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief Constructor
+
+   Creates a cache which holds at most @p capacity prepared statements.
+ */
+StatementCache::StatementCache( int capacity ) :
+  m_capacity( qMax( 1, capacity ) ),
+  m_entries(),
+  m_recentlyUsed(),
+  m_hits( 0 ),
+  m_misses( 0 ),
+  m_evictions( 0 )
+{
+}
+
+/**
+   @brief Destructor
+ */
+StatementCache::~StatementCache()
+{
+  clear();
+}
+
+/**
+   @brief Returns a prepared statement for the @p sql text
+
+   If a statement for the exact @p sql text is already in the cache, it is returned and
+   marked as most recently used. Values bound by a previous user are reset, so a value which
+   is not bound again is NULL (as with a freshly prepared statement). Otherwise, a new statement is prepared on the @p database
+   and put into the cache, potentially evicting the least recently used one.
+
+   The returned statement is owned by the cache. It stays valid until the next call to
+   statement() or clear(). Callers shall call QSqlQuery::finish() once they are done with it, so
+   that it does not keep the database locked.
+
+   If the statement cannot be prepared, nullptr is returned and the error is stored in
+   @p error (if given).
+ */
+QSqlQuery *StatementCache::statement( const QSqlDatabase &database, const QString &sql,
+                                      QSqlError *error )
+{
+  auto it = m_entries.find( sql );
+  if ( it != m_entries.end() ) {
+    ++m_hits;
+    if ( it->position != m_recentlyUsed.begin() ) {
+      m_recentlyUsed.erase( it->position );
+      m_recentlyUsed.prepend( sql );
+      it->position = m_recentlyUsed.begin();
+    }
+    int placeholders = it->query->boundValues().size();
+    for ( int i = 0; i < placeholders; ++i ) {
+      it->query->bindValue( i, QVariant() );
+    }
+    return it->query;
+  }
+
+  ++m_misses;
+  QSqlQuery *query = new QSqlQuery( database );
+  query->setForwardOnly( true );
+  if ( !query->prepare( sql ) ) {
+    if ( error ) {
+      *error = query->lastError();
+    }
+    delete query;
+    return nullptr;
+  }
+
+  evict( m_capacity - 1 );
+  m_recentlyUsed.prepend( sql );
+  Entry entry;
+  entry.query = query;
+  entry.position = m_recentlyUsed.begin();
+  m_entries.insert( sql, entry );
+  return query;
+}
+
+/**
+   @brief Removes all statements from the cache
+
+   This must be called before the database connection the statements belong to is closed.
+ */
+void StatementCache::clear()
+{
+  for ( const Entry &entry : m_entries ) {
+    delete entry.query;
+  }
+  m_entries.clear();
+  m_recentlyUsed.clear();
+}
+
+/**
+   @brief The maximum number of statements kept in the cache
+ */
+int StatementCache::capacity() const
+{
+  return m_capacity;
+}
+
+/**
+   @brief Sets the maximum number of statements kept in the cache
+
+   If the cache currently holds more than @p capacity statements, the least recently used ones are
+   dropped.
+ */
+void StatementCache::setCapacity( int capacity )
+{
+  m_capacity = qMax( 1, capacity );
+  evict( m_capacity );
+}
+
+/**
+   @brief The number of statements currently in the cache
+ */
+int StatementCache::size() const
+{
+  return m_entries.size();
+}
+
+/**
+   @brief The number of lookups which could be served from the cache
+ */
+quint64 StatementCache::hits() const
+{
+  return m_hits;
+}
+
+/**
+   @brief The number of lookups which required preparing a new statement
+ */
+quint64 StatementCache::misses() const
+{
+  return m_misses;
+}
+
+/**
+   @brief The number of statements dropped because the cache was full
+ */
+quint64 StatementCache::evictions() const
+{
+  return m_evictions;
+}
+
+/**
+   @brief Drops least recently used statements until at most @p maxSize are left
+ */
+void StatementCache::evict( int maxSize )
+{
+  while ( m_entries.size() > qMax( 0, maxSize ) && !m_recentlyUsed.isEmpty() ) {
+    QString key = m_recentlyUsed.takeLast();
+    delete m_entries.take( key ).query;
+    ++m_evictions;
+  }
+}
+
+} /* DataBase */
+
+} /* OpenTodoList */
@@ -0,0 +1,90 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENTODOLIST_DATABASE_STATEMENTCACHE_H
+#define OPENTODOLIST_DATABASE_STATEMENTCACHE_H
+
+#include <QHash>
+#include <QLinkedList>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+
+namespace OpenTodoList {
+
+namespace DataBase {
+
+/**
+   @brief A bounded cache of prepared SQL statements
+
+   The StatementCache keeps prepared QSqlQuery objects for a single database connection. Statements
+   are keyed by their exact SQL text, so queries which regenerate the same statement
+   on every run (like the ones built by the ReadObject and InsertObject templates) only
+   have to be parsed and planned once by SQLite.
+
+   The cache holds at most capacity() statements. When it is full, the least recently used
+   statement is dropped.
+
+   @note The cache is not thread safe. It is supposed to be used by the DatabaseWorker only, which
+         serializes access to it.
+ */
+class StatementCache
+{
+public:
+
+  static const int DefaultCapacity = 64;
+
+  explicit StatementCache( int capacity = DefaultCapacity );
+  virtual ~StatementCache();
+
+  QSqlQuery *statement( const QSqlDatabase &database, const QString &sql,
+                        QSqlError *error = nullptr );
+  void clear();
+
+  int capacity() const;
+  void setCapacity( int capacity );
+
+  int size() const;
+  quint64 hits() const;
+  quint64 misses() const;
+  quint64 evictions() const;
+
+private:
+
+  struct Entry {
+    QSqlQuery                          *query;
+    QLinkedList< QString >::iterator    position;
+  };
+
+  int                                   m_capacity;
+  QHash< QString, Entry >               m_entries;
+  QLinkedList< QString >                m_recentlyUsed;
+  quint64                               m_hits;
+  quint64                               m_misses;
+  quint64                               m_evictions;
+
+  void evict( int maxSize );
+
+};
+
+} /* DataBase */
+
+} /* OpenTodoList */
+
+#endif // OPENTODOLIST_DATABASE_STATEMENTCACHE_H
@@ -20,6 +20,7 @@
 
 #include "database/database.h"
 #include "database/databaseworker.h"
+#include "database/rowcursor.h"
 
 #include <QJsonDocument>
 
@@ -31,7 +32,9 @@ namespace DataBase {
    @brief Constructor
  */
 StorageQuery::StorageQuery(QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  m_worker( nullptr ),
+  m_priority( -1 )
 {
 }
 
@@ -77,11 +80,37 @@ bool StorageQuery::query(QString &query, QVariantMap &args, int &queryOptions)
   return false;
 }
 
+/**
+   @brief The result columns of the current statement are known
+
+   This is called once per statement, before the first row is passed to rowAvailable(). Sub-classes
+   shall look up the positions of the columns they are interested in here (via
+   RowCursor::indexOf()), so that they can read rows positionally later on.
+ */
+void StorageQuery::columnsAvailable(const RowCursor &cursor)
+{
+  Q_UNUSED( cursor );
+}
+
+/**
+   @brief A new row is available
+
+   This is called for each row that is read from the database when running the query. The
+   values of the row can be read from the @p cursor.
+
+   The default implementation converts the row into a map and passes it to
+   recordAvailable(). Queries which read many rows should re-implement this method instead.
+ */
+void StorageQuery::rowAvailable(const RowCursor &cursor)
+{
+  recordAvailable( cursor.toMap() );
+}
+
 /**
    @brief A new record is available
 
    This is called for each record that is read from the database when
-   running the query.
+   running the query, unless rowAvailable() has been re-implemented.
 
    The values read are passed in via the @p record map.
  */
@@ -121,8 +150,9 @@ void StorageQuery::endRun()
 
    1. beginRun()
    2. query()
-   3. recordAvailable() (for every record that might be returned)
-   4. endRun()
+   3. columnsAvailable()
+   4. rowAvailable() (for every record that might be returned)
+   5. endRun()
 
    Sometimes it might be required to continue with another query after a
    first successful one. For this, you can re-implement this method and return true
@@ -131,9 +161,10 @@ void StorageQuery::endRun()
 
    1. beginRun()
    2. query()
-   3. recordAvailable() (for every record that might be returned)
-   4. endRun()
-   5. if hasNext() goto 1
+   3. columnsAvailable()
+   4. rowAvailable() (for every record that might be returned)
+   5. endRun()
+   6. if hasNext() goto 1
 
  */
 bool StorageQuery::hasNext() const
@@ -143,6 +174,104 @@ bool StorageQuery::hasNext() const
 
 
 
+/**
+   @brief Does the query only read from the database?
+
+   Queries returning true here can be run on one of the Database's read-only connections,
+   concurrently to other queries. The default implementation returns false. Sub-classes which
+   never modify the database shall re-implement this method and return true.
+ */
+bool StorageQuery::isReadOnly() const
+{
+  return false;
+}
+
+/**
+   @brief The priority with which the query is scheduled
+
+   If no priority has been set explicitly, read-only queries are run with InteractivePriority
+   and all other queries with UserWritePriority.
+
+   @sa setPriority()
+ */
+StorageQuery::Priority StorageQuery::priority() const
+{
+  if ( m_priority < 0 ) {
+    return isReadOnly() ? InteractivePriority : UserWritePriority;
+  }
+  return static_cast< Priority >( m_priority );
+}
+
+/**
+   @brief Sets the @p priority with which the query is scheduled
+
+   @sa priority()
+ */
+void StorageQuery::setPriority(StorageQuery::Priority priority)
+{
+  m_priority = priority;
+}
+
+/**
+   @brief The name of the kind of query
+
+   This is used to group queries e.g. in the slow query log. The default implementation returns
+   the class name without namespaces. The generic queries return the name of the template
+   including the type of objects they handle (e.g. "ReadObject<Todo>").
+ */
+QString StorageQuery::queryClass() const
+{
+  QString name = metaObject()->className();
+  return name.mid( name.lastIndexOf( ':' ) + 1 );
+}
+
+/**
+   @brief Identifies the object the query writes to
+
+   Queries which modify a single object shall return a key identifying that object (see
+   objectKey()). The scheduler uses the key to merge redundant writes (see coalesce()) and
+   to keep writes to the same object in order. The default implementation returns an
+   empty string, meaning the query is not bound to a single object.
+ */
+QString StorageQuery::coalescingKey() const
+{
+  return QString();
+}
+
+/**
+   @brief Can later queries be merged into this one?
+
+   If this returns true, the scheduler might hold the query back for a short time, giving
+   later writes to the same object the chance to be merged into it via coalesce(). The default
+   implementation returns false.
+ */
+bool StorageQuery::isCoalescable() const
+{
+  return false;
+}
+
+/**
+   @brief Merges the @p newer query into this one
+
+   This is called by the scheduler when the @p newer query has the same coalescingKey() as this
+   one, which is still waiting to be run. If the implementation can take over the effect of
+   the newer query, it shall do so and return true; the newer query is then dropped without
+   being run. The default implementation returns false.
+ */
+bool StorageQuery::coalesce(StorageQuery *newer)
+{
+  Q_UNUSED( newer );
+  return false;
+}
+
+/**
+   @brief Returns a coalescingKey() for the object of the given @p type and @p uuid
+ */
+QString StorageQuery::objectKey(const QString &type, const QUuid &uuid)
+{
+  return type + ":" + uuid.toString();
+}
+
 /**
    @brief The worker that is processing the query.
  */
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QUuid>
 #include <QVariantMap>
 
 namespace OpenTodoList {
@@ -30,6 +31,7 @@ namespace OpenTodoList {
 namespace DataBase {
 
 class DatabaseWorker;
+class RowCursor;
 
 /**
    @brief Base class for all database queries
@@ -51,24 +53,46 @@ public:
        allowing to specify flags that might influence how a query is executed.
      */
     enum QueryOptions {
-      QueryNoOptions      = 0, //!< No special handling for the query is required
+      QueryNoOptions      = 0 //!< No special handling for the query is required
+    };
+
+    /**
+       @brief The priority class of a query
 
-      /**
-        If this flag is set, the query is supposed to be an "update" query (e.g. INSERT OR REPLACE).
-        For the execution of the query, delete triggers will be disabled.
-        */
-      QueryIsUpdateQuery  = 0x01
+       Queries waiting to be run by a DatabaseWorker are picked by their priority. Lower
+       values are run first. Queries which have been waiting for long are promoted to
+       higher priorities over time, so that background work still makes progress.
+     */
+    enum Priority {
+      InteractivePriority     = 0, //!< Reads the user is waiting for (e.g. model refreshes)
+      UserWritePriority       = 1, //!< Changes done by the user
+      BackgroundSyncPriority  = 2, //!< Queries run on behalf of backends
+      MaintenancePriority     = 3  //!< House keeping work (e.g. schema migrations)
     };
 
+    static const int NumPriorities = MaintenancePriority + 1;
+
     explicit StorageQuery(QObject *parent = 0);
     virtual ~StorageQuery();
 
     virtual void beginRun();
     virtual bool query( QString &query, QVariantMap &args, int &queryOptions );
+    virtual void columnsAvailable( const RowCursor &cursor );
+    virtual void rowAvailable( const RowCursor &cursor );
     virtual void recordAvailable( const QVariantMap &record );
     virtual void newIdAvailable( const QVariant &id );
     virtual void endRun();
     virtual bool hasNext() const;
+    virtual bool isReadOnly() const;
+
+    Priority priority() const;
+    void setPriority( Priority priority );
+
+    virtual QString queryClass() const;
+
+    virtual QString coalescingKey() const;
+    virtual bool isCoalescable() const;
+    virtual bool coalesce( StorageQuery *newer );
 
     static ITodoList* todoListFromRecord( const QVariantMap &record );
     static ITodo* todoFromRecord( const QVariantMap &record );
@@ -79,7 +103,9 @@ signals:
        @brief This signal is emitted when the query is fully done
 
        This signal is emitted as soon as the query has been processed and will be deleted next
-       by the scheduler.
+       by the scheduler. Queries are run inside a transaction; the signal is emitted only after
+       that transaction has been committed. If running the query failed, its changes have been
+       rolled back and any change signals emitted in response are not broadcasted.
      */
     void queryFinished();
 
@@ -139,9 +165,12 @@ protected:
 
     DatabaseWorker *worker() const;
 
+    static QString objectKey( const QString &type, const QUuid &uuid );
+
 private:
 
     DatabaseWorker *m_worker;
+    int             m_priority;
 
 };
 
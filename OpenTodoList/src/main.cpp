@@ -23,11 +23,13 @@
 
 #include <iostream>
 
+#include "core/tracer.h"
 #include "systemintegration/application.h"
 
 using namespace OpenTodoList;
 
 int startService( int &argc, char *argv[] ) {
+  Core::Tracer::Scope scope( "startService" );
   SystemIntegration::Application *app = qobject_cast< SystemIntegration::Application* >( qApp );
   if ( !app ) {
     app = new SystemIntegration::Application( argc, argv );
@@ -73,6 +75,9 @@ void hideWindow() {
 
 int main(int argc, char *argv[])
 {
+  // Start the clock of the tracer as early as possible:
+  Core::Tracer::instance();
+
   QCoreApplication::setApplicationName( "OpenTodoList" );
   QCoreApplication::setApplicationVersion( VERSION );
   QCoreApplication::setOrganizationDomain( "www.rpdev.net" );
@@ -125,6 +130,54 @@ int main(int argc, char *argv[])
                                                  "platform specific user writable directory "
                                                  "will be selected automatically." ),
                                                "dir" );
+  QCommandLineOption databaseProfileOption( "databaseProfile",
+                                            QCoreApplication::translate(
+                                              "main",
+                                              "Selects how the local database trades durability "
+                                              "for speed. Valid profiles are \"safe\" (full "
+                                              "synchronous writes), \"balanced\" (write-ahead "
+                                              "log, the default) and \"fast\" (write-ahead log, "
+                                              "larger caches and memory mapped I/O). This is "
+                                              "the same as setting the "
+                                              "OPENTODOLIST_DATABASE_PROFILE environment "
+                                              "variable or the databaseProfile setting." ),
+                                            "profile" );
+  QCommandLineOption slowQueryThresholdOption( "slowQueryThreshold",
+                                               QCoreApplication::translate(
+                                                 "main",
+                                                 "Records database statements taking at least "
+                                                 "the given number of milliseconds (together "
+                                                 "with their query plan) in the slowqueries.log "
+                                                 "file in the local storage directory. Use 0 to "
+                                                 "disable the log. This is the same as setting "
+                                                 "the OPENTODOLIST_SLOW_QUERY_THRESHOLD "
+                                                 "environment variable or the "
+                                                 "slowQueryThreshold setting." ),
+                                               "ms" );
+  QCommandLineOption statsOption( "stats",
+                                  QCoreApplication::translate(
+                                    "main",
+                                    "Prints statistics about the database of the running "
+                                    "application instance (encoded as JSON) and exits." ) );
+  QCommandLineOption traceOption( "trace",
+                                  QCoreApplication::translate(
+                                    "main",
+                                    "Records the phases the application goes through "
+                                    "(e.g. during start up) and writes them to the given "
+                                    "file when the application exits. The file uses the "
+                                    "Chrome trace format and can be loaded into "
+                                    "chrome://tracing. This is the same as setting the "
+                                    "OPENTODOLIST_TRACE_FILE environment variable." ),
+                                  "file" );
+  QCommandLineOption fastStartOption( "fastStart",
+                                      QCoreApplication::translate(
+                                        "main",
+                                        "Shows the user interface with the data cached in the "
+                                        "local database right away and starts the backends "
+                                        "(which might scan their data on start up) only once "
+                                        "the user interface has been shown. This is the same "
+                                        "as setting the OPENTODOLIST_FAST_START environment "
+                                        "variable to 1 or the fastStart setting to true." ) );
   QCommandLineParser parser;
   parser.addOption( helpOption );
   parser.addOption( versionOption );
@@ -133,6 +186,11 @@ int main(int argc, char *argv[])
   parser.addOption( reloadQmlOnChangeOption );
   parser.addOption( getLocalStorageDirOption );
   parser.addOption( setLocalStorageDirOption );
+  parser.addOption( databaseProfileOption );
+  parser.addOption( slowQueryThresholdOption );
+  parser.addOption( statsOption );
+  parser.addOption( traceOption );
+  parser.addOption( fastStartOption );
 
   parser.process(*app);
 
@@ -147,11 +205,38 @@ int main(int argc, char *argv[])
   } else if ( parser.isSet( getLocalStorageDirOption ) ) {
     std::cout << DataBase::Database::localStorageDir().toStdString() << std::endl;
     return 0;
+  } else if ( parser.isSet( statsOption ) ) {
+    SystemIntegration::ApplicationInstance instance( QCoreApplication::applicationName() );
+    if ( instance.state() != SystemIntegration::ApplicationInstance::InstanceIsSecondary ) {
+      std::cerr << "OpenTodoList is not running" << std::endl;
+      delete app;
+      return 1;
+    }
+    std::cout << instance.request(
+                   SystemIntegration::CommandHandler::databaseStats() ).toStdString()
+              << std::endl;
+    delete app;
+    return 0;
   } else {
     if ( parser.isSet( setLocalStorageDirOption ) ) {
       qputenv( "OPENTODOLIST_LOCAL_STORAGE_LOCATION",
                parser.value( setLocalStorageDirOption ).toLocal8Bit() );
     }
+    if ( parser.isSet( databaseProfileOption ) ) {
+      qputenv( "OPENTODOLIST_DATABASE_PROFILE",
+               parser.value( databaseProfileOption ).toLocal8Bit() );
+    }
+    if ( parser.isSet( slowQueryThresholdOption ) ) {
+      qputenv( "OPENTODOLIST_SLOW_QUERY_THRESHOLD",
+               parser.value( slowQueryThresholdOption ).toLocal8Bit() );
+    }
+    if ( parser.isSet( traceOption ) ) {
+      Core::Tracer::instance()->setOutputFile(
+            QFileInfo( parser.value( traceOption ) ).absoluteFilePath() );
+    }
+    if ( parser.isSet( fastStartOption ) ) {
+      qputenv( "OPENTODOLIST_FAST_START", "1" );
+    }
     if ( parser.isSet( mainQmlFileOption ) ) {
       QFileInfo fi( parser.value( mainQmlFileOption ) );
       if ( fi.isFile() && fi.isReadable() ) {
@@ -165,6 +250,9 @@ int main(int argc, char *argv[])
       }
       int exitCode = startApp();
       stopService();
+      if ( Core::Tracer::instance()->isEnabled() ) {
+        Core::Tracer::instance()->write();
+      }
       return exitCode;
     }
   }
@@ -19,7 +19,6 @@
 #include "accountmodel.h"
 
 #include "datamodel/objectinfo.h"
-#include "database/databaseconnection.h"
 
 namespace OpenTodoList {
 namespace Models {
@@ -28,34 +27,16 @@ AccountModel::AccountModel(QObject *parent) :
     ObjectModel(ObjectInfo<Account>::classUuidProperty(), parent)
 {
   setTextProperty( "name" );
-  connect( this, &AccountModel::objectAdded, [this] (QObject *object) {
-    Account *account = dynamic_cast< Account* >( object );
-    if ( account ) {
-      this->connect( account, &Account::changed, [account,this] {
-        if ( this->database() ) {
-          DatabaseConnection conn;
-          conn.setDatabase( this->database() );
-          conn.insertAccount( account );
-        }
-      });
-    }
-  });
 }
 
 void AccountModel::connectToDatabase()
 {
-  connect( database(), &Database::accountChanged,
-           this, &AccountModel::addAccount );
-  connect( database(), &Database::accountDeleted,
-           this, &AccountModel::removeAccount );
+  connect( database(), &Database::changesAvailable, this, &AccountModel::applyChanges );
 }
 
 void AccountModel::disconnectFromDatabase()
 {
-  disconnect( database(), &Database::accountChanged,
-              this, &AccountModel::addAccount );
-  disconnect( database(), &Database::accountDeleted,
-              this, &AccountModel::removeAccount );
+  disconnect( database(), &Database::changesAvailable, this, &AccountModel::applyChanges );
 }
 
 StorageQuery *AccountModel::createQuery() const
@@ -76,6 +57,15 @@ void AccountModel::removeAccount(const QVariant &account)
   this->removeObject<Account>(account);
 }
 
+/**
+   @brief Applies the @p changes done in the database to the model
+ */
+void AccountModel::applyChanges(const ChangeSet &changes)
+{
+  ObjectModel::applyChanges<Account>( changes.changed( ChangeSet::AccountObject ),
+                                      changes.deleted( ChangeSet::AccountObject ) );
+}
+
 
 } // namespace Models
 } // namespace OpenTodoList
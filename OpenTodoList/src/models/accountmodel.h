@@ -59,6 +59,7 @@ private slots:
 
     void addAccount( const QVariant &account );
     void removeAccount( const QVariant &account );
+    void applyChanges( const ChangeSet &changes );
 
 };
 
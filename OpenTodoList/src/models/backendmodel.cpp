@@ -34,12 +34,12 @@ BackendModel::BackendModel(QObject *parent) :
 
 void BackendModel::connectToDatabase()
 {
-  connect( database(), &Database::backendChanged, this, &BackendModel::addBackend );
+  connect( database(), &Database::changesAvailable, this, &BackendModel::applyChanges );
 }
 
 void BackendModel::disconnectFromDatabase()
 {
-  disconnect( database(), &Database::backendChanged, this, &BackendModel::addBackend );
+  disconnect( database(), &Database::changesAvailable, this, &BackendModel::applyChanges );
 }
 
 StorageQuery *BackendModel::createQuery() const
@@ -55,6 +55,15 @@ void BackendModel::addBackend(const QVariant &backend)
   addObject<Backend>( backend );
 }
 
+/**
+   @brief Applies the @p changes done in the database to the model
+ */
+void BackendModel::applyChanges(const ChangeSet &changes)
+{
+  ObjectModel::applyChanges<Backend>( changes.changed( ChangeSet::BackendObject ),
+                                      changes.deleted( ChangeSet::BackendObject ) );
+}
+
 
 } // namespace Models
 } // namespace OpenTodoList
@@ -56,6 +56,7 @@ private:
 private slots:
 
     void addBackend( const QVariant &backend );
+    void applyChanges( const ChangeSet &changes );
 
 };
 
@@ -28,6 +28,9 @@ ObjectModel::ObjectModel(const char *uuidPropertyName, QObject *parent) :
   QAbstractListModel( parent ),
   m_database( nullptr ),
   m_objects(),
+  m_objectsByUuid(),
+  m_uuidsByObject(),
+  m_references(),
   m_uuidPropertyName(uuidPropertyName),
   m_readObjects(),
   m_updateTimer(),
@@ -157,8 +160,9 @@ void ObjectModel::refresh()
  */
 void ObjectModel::clear()
 {
-  for ( QObject *object : m_objects ) {
-    object->deleteLater();
+  const QObjectList objects = m_objects;
+  for ( QObject *object : objects ) {
+    releaseObject( object );
   }
 }
 
@@ -297,42 +301,71 @@ void ObjectModel::setTextProperty(const char *textProperty)
    If the index is either smaller than 0 or greater than the size of lists of
    already contained objects, the object will be appended to the list.
 
-   @note The model takes ownership of the object.
+   @note The model holds a reference on the object until it is removed again.
  */
-void ObjectModel::addObject(QObject *object, int index)
+void ObjectModel::addObject(const QSharedPointer<QObject> &object, int index)
 {
-  Q_ASSERT( object != nullptr );
-  object->setParent( this );
+  Q_ASSERT( object );
   if ( index >= 0 && index < m_objects.size() ) {
     beginInsertRows( QModelIndex(), index, index );
-    m_objects.insert( index, object );
+    m_objects.insert( index, object.data() );
     endInsertRows();
   } else {
     index = m_objects.size();
     for ( int i = 0; i < m_objects.size(); ++i ) {
-      if ( compareObjects( object, m_objects.at( i ) ) < 0 ) {
+      if ( compareObjects( object.data(), m_objects.at( i ) ) < 0 ) {
            index = i;
            break;
       }
     }
     beginInsertRows( QModelIndex(), index, index );
-    m_objects.insert( index, object );
+    m_objects.insert( index, object.data() );
     endInsertRows();
   }
-  connect( object, &QObject::destroyed, this, &ObjectModel::objectDestroyed );
-  m_readObjects.insert( object->property( m_uuidPropertyName ).toString() );
+  QString uuid = object->property( m_uuidPropertyName ).toString();
+  m_references.insert( object.data(), object );
+  m_objectsByUuid.insert( uuid, object.data() );
+  m_uuidsByObject.insert( object.data(), uuid );
+  m_readObjects.insert( uuid );
   emit objectsChanged();
-  emit objectAdded( object );
+  emit objectAdded( object.data() );
+}
+
+/**
+   @brief Checks whether the contained @p object shall stay in the model after it changed
+
+   The object is removed if it has been @p disposed or no longer passes the objectFilter().
+ */
+void ObjectModel::checkObject(QObject *object, bool disposed)
+{
+  if ( disposed || !objectFilter( object ) ) {
+    releaseObject( object );
+  } else {
+    objectUpdated( object );
+    m_readObjects.insert( m_uuidsByObject.value( object ) );
+  }
 }
 
-void ObjectModel::removeObject(QObject *object)
+/**
+   @brief Removes the @p object from the model and drops the reference held on it
+ */
+void ObjectModel::releaseObject(QObject *object)
 {
   Q_ASSERT( object != nullptr );
-  for ( QObject *o : m_objects ) {
-    if ( o->property( m_uuidPropertyName ) == object->property( m_uuidPropertyName ) ) {
-      o->deleteLater();
-    }
+  int idx = m_objects.indexOf( object );
+  if ( idx < 0 ) {
+    return;
+  }
+  beginRemoveRows( QModelIndex(), idx, idx );
+  m_objects.removeAt( idx );
+  endRemoveRows();
+  QString uuid = m_uuidsByObject.take( object );
+  if ( m_objectsByUuid.value( uuid ) == object ) {
+    m_objectsByUuid.remove( uuid );
   }
+  disconnect( object, 0, this, 0 );
+  m_references.remove( object );
+  emit objectsChanged();
 }
 
 int ObjectModel::objectsCountFn(QQmlListProperty<QObject> *prop)
@@ -363,17 +396,6 @@ QQmlListProperty<QObject> ObjectModel::objects()
                                     &ObjectModel::objectsAtFn );
 }
 
-void ObjectModel::objectDestroyed(QObject *obj)
-{
-  int idx = m_objects.indexOf( obj );
-  if ( idx >= 0 ) {
-    beginRemoveRows( QModelIndex(), idx, idx );
-    m_objects.removeAt( idx );
-    endRemoveRows();
-    emit objectsChanged();
-  }
-}
-
 void ObjectModel::objectUpdated(QObject *obj) {
   int idx = m_objects.indexOf( obj );
   if ( idx >= 0 ) {
@@ -388,9 +410,10 @@ void ObjectModel::queryStarted()
 
 void ObjectModel::queryFinished()
 {
-  for ( QObject *object : m_objects ) {
-    if ( !m_readObjects.contains( object->property( m_uuidPropertyName ).toString() ) ) {
-      object->deleteLater();
+  const QObjectList objects = m_objects;
+  for ( QObject *object : objects ) {
+    if ( !m_readObjects.contains( m_uuidsByObject.value( object ) ) ) {
+      releaseObject( object );
     }
   }
 }
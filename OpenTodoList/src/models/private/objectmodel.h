@@ -27,6 +27,7 @@
 #include <QObjectList>
 #include <QQmlListProperty>
 #include <QSet>
+#include <QSharedPointer>
 #include <QTimer>
 #include <QVariant>
 
@@ -103,45 +104,59 @@ protected:
 
   template<typename T>
   void addObject( const QVariant &data, int index = -1 ) {
-    T *tmp = new T( this );
-    tmp->fromVariant( data );
-
-    if ( tmp->disposed() || !objectFilter( tmp ) ) {
-      this->removeObject( tmp );
-      delete tmp;
-      return;
+    QSharedPointer<T> object = acquireObject<T>( data );
+    if ( m_references.contains( object.data() ) ) {
+      checkObject( object.data(), object->disposed() );
+      sort();
+    } else {
+      insertObject<T>( object, index );
     }
+  }
 
-    for ( QObject *o : m_objects ) {
-      if ( o->property( m_uuidPropertyName ) == tmp->property( m_uuidPropertyName ) ) {
-        dynamic_cast< T* >( o )->fromVariant( data );
-        objectUpdated( o );
-        m_readObjects.insert( o->property( m_uuidPropertyName ).toString() );
-        delete tmp;
-        sort();
-        return;
-      }
+  template<typename T>
+  void removeObject( const QVariant &data ) {
+    QObject *o = m_objectsByUuid.value( data.toMap().value( m_uuidPropertyName ).toString() );
+    if ( o ) {
+      releaseObject( o );
     }
-    this->addObject( tmp, index );
-    connect( tmp, &T::changed, [this] { objectUpdated( sender() ); } );
   }
 
+  /**
+     @brief Applies a set of changes to the model
+
+     Objects in the model are shared via the database's ObjectCache, which already has
+     updated them when the change set arrives. Hence, the @p changed objects contained in the
+     model only are checked against the objectFilter(); others are added to the model if they
+     pass it. The @p deleted objects are removed. The model is sorted once afterwards.
+   */
   template<typename T>
-  void removeObject( const QVariant &data ) {
-    T *tmp = new T( this );
-    tmp->fromVariant( data );
-    for ( QObject *o : m_objects ) {
-      if ( o->property( m_uuidPropertyName ) == tmp->property( m_uuidPropertyName ) ) {
-        o->deleteLater();
+  void applyChanges( const QVariantList &changed, const QVariantList &deleted ) {
+    bool sortNeeded = false;
+    for ( const QVariant &data : changed ) {
+      T *object = dynamic_cast< T* >( m_objectsByUuid.value(
+                                        data.toMap().value( m_uuidPropertyName ).toString() ) );
+      if ( object ) {
+        checkObject( object, object->disposed() );
+        sortNeeded = true;
+      } else {
+        insertObject<T>( acquireObject<T>( data ) );
       }
     }
-    delete tmp;
+    for ( const QVariant &data : deleted ) {
+      removeObject<T>( data );
+    }
+    if ( sortNeeded ) {
+      sort();
+    }
   }
 
 private:
 
   Database        *m_database;
   QObjectList      m_objects;
+  QHash<QString, QObject*> m_objectsByUuid;
+  QHash<QObject*, QString> m_uuidsByObject;
+  QHash<QObject*, QSharedPointer<QObject> > m_references;
   const char      *m_uuidPropertyName;
   QSet<QString>    m_readObjects;
   QTimer           m_updateTimer;
@@ -149,15 +164,44 @@ private:
   const char      *m_textProperty;
   mutable QJSValue m_groupingFunction;
 
-  void addObject( QObject *object, int index = -1 );
-  void removeObject( QObject *object );
+  void addObject( const QSharedPointer<QObject> &object, int index = -1 );
+
+  void checkObject( QObject *object, bool disposed );
+  void releaseObject( QObject *object );
+
+  /*
+   * Returns the shared instance of the object described by @p data. Without database, a
+   * private instance is created.
+   */
+  template<typename T>
+  QSharedPointer<T> acquireObject( const QVariant &data ) {
+    if ( m_database ) {
+      return m_database->objectCache()->object<T>( data );
+    }
+    QSharedPointer<T> result( new T(), &QObject::deleteLater );
+    result->fromVariant( data );
+    return result;
+  }
+
+  /*
+   * Adds the @p object to the model at the given @p index, unless it is disposed or
+   * filtered out.
+   */
+  template<typename T>
+  void insertObject( const QSharedPointer<T> &object, int index = -1 ) {
+    if ( object->disposed() || !objectFilter( object.data() ) ) {
+      return;
+    }
+    T *o = object.data();
+    this->addObject( object, index );
+    connect( o, &T::changed, this, [this,o] { objectUpdated( o ); } );
+  }
 
   static int objectsCountFn( QQmlListProperty<QObject> *prop );
   static QObject* objectsAtFn( QQmlListProperty<QObject> *prop, int index );
 
 private slots:
 
-  void objectDestroyed( QObject *obj );
   void objectUpdated( QObject *obj );
 
   void queryStarted();
@@ -21,7 +21,6 @@
 #include "datamodel/objectinfo.h"
 
 #include "database/queries/readtask.h"
-#include "database/databaseconnection.h"
 
 namespace OpenTodoList {
 namespace Models {
@@ -33,19 +32,6 @@ TaskModel::TaskModel(QObject *parent) :
   setTextProperty( "title" );
   connect( this, &TaskModel::databaseChanged, this, &TaskModel::refresh );
   connect( this, &TaskModel::todoChanged, this, &TaskModel::refresh );
-
-  connect( this, &TaskModel::objectAdded, [this] (QObject *object) {
-    Task *task = dynamic_cast< Task* >( object );
-    if ( task ) {
-      this->connect( task, &Task::changed, [task,this] {
-        if ( this->database() ) {
-          DatabaseConnection conn;
-          conn.setDatabase( this->database() );
-          conn.insertTask( task );
-        }
-      });
-    }
-  });
 }
 
 Todo *TaskModel::todo() const
@@ -101,14 +87,12 @@ void TaskModel::moveTask(Task *task, TaskModel::MoveTaskMode mode, Task *target)
 
 void TaskModel::connectToDatabase()
 {
-  connect( database(), &Database::taskChanged, this, &TaskModel::addTask );
-  connect( database(), &Database::taskDeleted, this, &TaskModel::removeTask );
+  connect( database(), &Database::changesAvailable, this, &TaskModel::applyChanges );
 }
 
 void TaskModel::disconnectFromDatabase()
 {
-  connect( database(), &Database::taskChanged, this, &TaskModel::addTask );
-  connect( database(), &Database::taskDeleted, this, &TaskModel::removeTask );
+  disconnect( database(), &Database::changesAvailable, this, &TaskModel::applyChanges );
 }
 
 StorageQuery *TaskModel::createQuery() const
@@ -149,6 +133,15 @@ void TaskModel::removeTask(const QVariant &task)
   removeObject<Task>( task );
 }
 
+/**
+   @brief Applies the @p changes done in the database to the model
+ */
+void TaskModel::applyChanges(const ChangeSet &changes)
+{
+  ObjectModel::applyChanges<Task>( changes.changed( ChangeSet::TaskObject ),
+                                   changes.deleted( ChangeSet::TaskObject ) );
+}
+
 
 
 } // namespace Models
@@ -70,6 +70,7 @@ protected:
 private slots:
   void addTask( const QVariant &task );
   void removeTask( const QVariant &task );
+  void applyChanges( const ChangeSet &changes );
 };
 
 } // namespace Models
@@ -21,7 +21,6 @@
 #include "datamodel/objectinfo.h"
 
 #include "database/queries/readtodolist.h"
-#include "database/databaseconnection.h"
 
 #include <QDebug>
 #include <QTimer>
@@ -34,18 +33,6 @@ TodoListModel::TodoListModel(QObject *parent) :
     ObjectModel( ObjectInfo<TodoList>::classUuidProperty(), parent )
 {
   setTextProperty("name");
-  connect( this, &TodoListModel::objectAdded, [this] (QObject *object) {
-    TodoList *todoList = dynamic_cast< TodoList* >( object );
-    if ( todoList ) {
-      this->connect( todoList, &TodoList::changed, [todoList,this] {
-        if ( this->database() ) {
-          DatabaseConnection conn;
-          conn.setDatabase( this->database() );
-          conn.insertTodoList( todoList );
-        }
-      });
-    }
-  });
 }
 
 TodoListModel::~TodoListModel()
@@ -54,14 +41,12 @@ TodoListModel::~TodoListModel()
 
 void TodoListModel::connectToDatabase()
 {
-  connect( database(), &Database::todoListChanged, this, &TodoListModel::addTodoList );
-  connect( database(), &Database::todoListDeleted, this, &TodoListModel::removeTodoList );
+  connect( database(), &Database::changesAvailable, this, &TodoListModel::applyChanges );
 }
 
 void TodoListModel::disconnectFromDatabase()
 {
-  disconnect( database(), &Database::todoListChanged, this, &TodoListModel::addTodoList );
-  disconnect( database(), &Database::todoListDeleted, this, &TodoListModel::removeTodoList );
+  disconnect( database(), &Database::changesAvailable, this, &TodoListModel::applyChanges );
 }
 
 StorageQuery *TodoListModel::createQuery() const
@@ -92,6 +77,15 @@ void TodoListModel::removeTodoList(const QVariant &todoList)
   removeObject<TodoList>( todoList );
 }
 
+/**
+   @brief Applies the @p changes done in the database to the model
+ */
+void TodoListModel::applyChanges(const ChangeSet &changes)
+{
+  ObjectModel::applyChanges<TodoList>( changes.changed( ChangeSet::TodoListObject ),
+                                       changes.deleted( ChangeSet::TodoListObject ) );
+}
+
 } /* Models */
 
 } /* OpenTodoList */
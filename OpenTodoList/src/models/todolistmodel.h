@@ -67,6 +67,7 @@ private slots:
 
     void addTodoList( const QVariant &todoList );
     void removeTodoList( const QVariant &todoList );
+    void applyChanges( const ChangeSet &changes );
 };
 
 } /* Models */
@@ -22,7 +22,6 @@
 
 #include "datamodel/todo.h"
 
-#include "database/databaseconnection.h"
 #include "database/queries/readtodo.h"
 
 #include <QTimer>
@@ -42,7 +41,13 @@ TodoModel::TodoModel(QObject *parent) :
     m_backendSortMode( TodoModel::SortTodoByName ),
     m_limitOffset( -1 ),
     m_limitCount( -1 ),
-    m_showOnlyScheduled( false )
+    m_showOnlyScheduled( false ),
+    m_filterMatches(),
+    m_pageSortKey(),
+    m_pageLastId( 0 ),
+    m_pageRows( 0 ),
+    m_hasMorePages( false ),
+    m_fetchingPage( false )
 {
     setTextProperty("title");
     connect( this, &TodoModel::todoListChanged, this, &TodoModel::refresh );
@@ -51,19 +56,6 @@ TodoModel::TodoModel(QObject *parent) :
     connect( this, &TodoModel::showDoneChanged, this, &TodoModel::refresh );
     connect( this, &TodoModel::maxDueDateChanged, this, &TodoModel::refresh );
     connect( this, &TodoModel::minDueDateChanged, this, &TodoModel::refresh );
-
-    connect( this, &TodoModel::objectAdded, [this] (QObject *object) {
-      Todo *todo = dynamic_cast< Todo* >( object );
-      if ( todo ) {
-        this->connect( todo, &Todo::changed, [todo,this] {
-          if ( this->database() ) {
-            DatabaseConnection conn;
-            conn.setDatabase( this->database() );
-            conn.insertTodo( todo );
-          }
-        });
-      }
-    });
 }
 
 TodoModel::~TodoModel()
@@ -72,17 +64,71 @@ TodoModel::~TodoModel()
 
 void TodoModel::connectToDatabase()
 {
-  connect( database(), &Database::todoChanged, this, &TodoModel::addTodo );
-  connect( database(), &Database::todoDeleted, this, &TodoModel::removeTodo );
+  connect( database(), &Database::changesAvailable, this, &TodoModel::applyChanges );
 }
 
 void TodoModel::disconnectFromDatabase()
 {
-  disconnect( database(), &Database::todoChanged, this, &TodoModel::addTodo );
-  disconnect( database(), &Database::todoDeleted, this, &TodoModel::removeTodo );
+  disconnect( database(), &Database::changesAvailable, this, &TodoModel::applyChanges );
 }
 
+/**
+   @brief Creates the query reading the (first page of) todos
+
+   If limitCount() is set, the todos are read in pages ordered by the backendSortMode(). The
+   first page starts at limitOffset(); further pages are read by fetchMore().
+ */
 StorageQuery *TodoModel::createQuery() const
+{
+  Queries::ReadTodo *query = createPageQuery();
+  query->setOffset( m_limitOffset );
+  m_filterMatches.clear();
+  return query;
+}
+
+/**
+   @brief Whether there are more todos to be read
+
+   This is the case if paging is enabled (see limitCount()) and the last page read was a
+   full one.
+ */
+bool TodoModel::canFetchMore(const QModelIndex &parent) const
+{
+  return !parent.isValid() && m_limitCount > 0 && m_hasMorePages && !m_fetchingPage;
+}
+
+/**
+   @brief Reads the next page of todos
+
+   The page starts right after the last todo of the previous page (instead of skipping the
+   todos read so far), so reading a page costs the same no matter how deep it is.
+ */
+void TodoModel::fetchMore(const QModelIndex &parent)
+{
+  if ( canFetchMore( parent ) && database() ) {
+    Queries::ReadTodo *query = createPageQuery();
+    query->setAfter( m_pageSortKey, m_pageLastId );
+    database()->scheduleQuery( query );
+  }
+}
+
+bool TodoModel::objectFilter(QObject *object) const
+{
+  Todo *todo = dynamic_cast< Todo* >( object );
+  if ( todo ) {
+    return ( !m_minDueDate.isValid() ||  ( todo->dueDate().isValid() && m_minDueDate <= todo->dueDate() ) ) &&
+           ( !m_maxDueDate.isValid() || ( todo->dueDate().isValid() && todo->dueDate() <= m_maxDueDate ) ) &&
+           ( m_showDone || !todo->done() ) &&
+           ( m_filter.isEmpty() || m_filterMatches.contains( todo->uuid() ) ||
+             matchesFilter( todo ) );
+  }
+  return false;
+}
+
+/**
+   @brief Creates a query reading one page of todos matching the model's criteria
+ */
+Queries::ReadTodo *TodoModel::createPageQuery() const
 {
   Queries::ReadTodo *query = new Queries::ReadTodo();
   if ( !m_todoList.isNull() ) {
@@ -93,27 +139,60 @@ StorageQuery *TodoModel::createQuery() const
     }
   }
   query->setLimit( m_limitCount );
-  query->setOffset( m_limitOffset );
+  if ( m_limitCount > 0 ) {
+    // Titles are compared like compareObjects() does (as close as SQLite gets to it), so that
+    // pages are read in the order the todos are shown:
+    query->setSortKey( backendSortKey(),
+                       m_backendSortMode == SortTodoByPriority ? Qt::DescendingOrder
+                                                               : Qt::AscendingOrder,
+                       m_backendSortMode == SortTodoByName ? Qt::CaseInsensitive
+                                                           : Qt::CaseSensitive );
+  }
   query->setMinDueDate( m_minDueDate );
   query->setMaxDueDate( m_maxDueDate );
   query->setShowDone( m_showDone );
   query->setFilter( m_filter );
   query->setShowOnlyScheduled( m_showOnlyScheduled );
-  connect( query, &Queries::ReadTodo::readTodo, this, &TodoModel::addTodo, Qt::QueuedConnection );
+  m_pageRows = 0;
+  m_hasMorePages = false;
+  m_fetchingPage = true;
+  connect( query, &Queries::ReadTodo::readTodo, this, &TodoModel::addPageTodo, Qt::QueuedConnection );
+  connect( query, &Queries::ReadTodo::queryFinished, this, &TodoModel::pageFinished,
+           Qt::QueuedConnection );
   return query;
 }
 
-bool TodoModel::objectFilter(QObject *object) const
+/**
+   @brief The attribute todos are ordered by when reading them in pages
+ */
+QString TodoModel::backendSortKey() const
 {
-  Todo *todo = dynamic_cast< Todo* >( object );
-  if ( todo ) {
-    return ( !m_minDueDate.isValid() ||  ( todo->dueDate().isValid() && m_minDueDate <= todo->dueDate() ) ) &&
-           ( !m_maxDueDate.isValid() || ( todo->dueDate().isValid() && todo->dueDate() <= m_maxDueDate ) ) &&
-           ( m_showDone || !todo->done() ) &&
-           ( m_filter.isEmpty() || todo->title().contains( m_filter, Qt::CaseInsensitive )
-                                   || todo->description().contains( m_filter, Qt::CaseInsensitive ) );
+  switch ( m_backendSortMode ) {
+  case SortTodoByName: return "title";
+  case SortTodoByPriority: return "priority";
+  case SortTodoByDueDate: return "dueDate";
+  case SortTodoByWeight: return "weight";
   }
-  return false;
+  return QString();
+}
+
+/**
+   @brief Checks whether the @p todo matches the filter
+
+   The filtering is done by the database (see Queries::ReadTodo::setFilter()); todos read by
+   the model's query are accepted as they are. This is used for todos which are changed
+   later on: Each term of the filter must be contained in either the todo's title or
+   description.
+ */
+bool TodoModel::matchesFilter(Todo *todo) const
+{
+  for ( const QString &term : Queries::ReadTodo::filterTerms( m_filter ) ) {
+    if ( !todo->title().contains( term, Qt::CaseInsensitive ) &&
+         !todo->description().contains( term, Qt::CaseInsensitive ) ) {
+      return false;
+    }
+  }
+  return true;
 }
 
 int TodoModel::compareObjects(QObject *left, QObject *right) const
@@ -226,11 +305,46 @@ void TodoModel::addTodo(const QVariant &todo)
   addObject<Todo>(todo);
 }
 
+void TodoModel::addFilterMatch(const QVariant &todo)
+{
+  m_filterMatches.insert( todo.toMap().value( "uuid" ).toUuid() );
+  addObject<Todo>(todo);
+}
+
+/**
+   @brief Adds a @p todo read as part of a page
+
+   The todo is remembered as the end of the page, so that the next page can continue after it.
+ */
+void TodoModel::addPageTodo(const QVariant &todo)
+{
+  QVariantMap map = todo.toMap();
+  m_pageSortKey = map.value( backendSortKey() );
+  m_pageLastId = map.value( "id" ).toInt();
+  m_pageRows += 1;
+  addFilterMatch( todo );
+}
+
+void TodoModel::pageFinished()
+{
+  m_hasMorePages = m_limitCount > 0 && m_pageRows >= m_limitCount;
+  m_fetchingPage = false;
+}
+
 void TodoModel::removeTodo(const QVariant &todo)
 {
   removeObject<Todo>(todo);
 }
 
+/**
+   @brief Applies the @p changes done in the database to the model
+ */
+void TodoModel::applyChanges(const ChangeSet &changes)
+{
+  ObjectModel::applyChanges<Todo>( changes.changed( ChangeSet::TodoObject ),
+                                   changes.deleted( ChangeSet::TodoObject ) );
+}
+
 int TodoModel::limitCount() const
 {
     return m_limitCount;
@@ -26,11 +26,13 @@
 #include "datamodel/todolist.h"
 #include "database/database.h"
 #include "database/storagequery.h"
+#include "database/queries/readtodo.h"
 
 #include <QAbstractListModel>
 #include <QPointer>
 #include <QSet>
 #include <QTimer>
+#include <QUuid>
 #include <QVector>
 
 namespace OpenTodoList {
@@ -113,6 +115,10 @@ public:
   bool showOnlyScheduled() const;
   void setShowOnlyScheduled(bool showOnlyScheduled);
 
+  // QAbstractItemModel interface
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
+
 signals:
 
   void queryTypeChanged();
@@ -151,11 +157,25 @@ private:
   int                           m_limitOffset;
   int                           m_limitCount;
   bool                          m_showOnlyScheduled;
+  mutable QSet<QUuid>           m_filterMatches;
+  mutable QVariant              m_pageSortKey;
+  mutable int                   m_pageLastId;
+  mutable int                   m_pageRows;
+  mutable bool                  m_hasMorePages;
+  mutable bool                  m_fetchingPage;
+
+  bool matchesFilter( Todo *todo ) const;
+  Queries::ReadTodo *createPageQuery() const;
+  QString backendSortKey() const;
 
 private slots:
 
   void addTodo( const QVariant &todo );
+  void addFilterMatch( const QVariant &todo );
+  void addPageTodo( const QVariant &todo );
+  void pageFinished();
   void removeTodo( const QVariant &todo );
+  void applyChanges( const ChangeSet &changes );
 
 
 };
@@ -19,6 +19,7 @@
 #include "application.h"
 
 #include "core/coreplugin.h"
+#include "core/tracer.h"
 #include "datamodel/datamodelplugin.h"
 #include "database/databaseplugin.h"
 #include "models/modelsplugin.h"
@@ -26,9 +27,11 @@
 
 #include <QDir>
 #include <QDirIterator>
+#include <QJsonDocument>
 #include <QProcess>
 #include <QQmlEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 
 namespace OpenTodoList {
 namespace SystemIntegration {
@@ -43,6 +46,7 @@ Application::Application(int &argc, char *argv[]) :
   m_pluginsRegistered( false ),
   m_mainQmlFile( "qrc:/qml/OpenTodoList/main.qml" ),
   m_reloadQmlOnChange( false ),
+  m_firstFrameShown( false ),
   m_fileSystemWatcher( new QFileSystemWatcher(this) )
 {
   connect( m_fileSystemWatcher, &QFileSystemWatcher::fileChanged, [this](const QString &file) {
@@ -77,6 +81,8 @@ Application::~Application()
 
 void Application::prepare()
 {
+  Core::Tracer::Scope scope( "Application::prepare" );
+
   // keep app open in background
 #if !defined(Q_OS_ANDROID)
   setQuitOnLastWindowClosed( false );
@@ -86,7 +92,10 @@ void Application::prepare()
   connect( m_handler, &CommandHandler::requestCreateWindow, [this] { showWindow(); } );
 
   // ensure app is running at most once
-  m_instance = new ApplicationInstance( QCoreApplication::applicationName() );
+  {
+    Core::Tracer::Scope scope( "ApplicationInstance" );
+    m_instance = new ApplicationInstance( QCoreApplication::applicationName() );
+  }
   if ( m_instance->state() == ApplicationInstance::InstanceIsSecondary ) {
     qDebug() << "Running secondary instance. Contacting server and quitting...";
     m_instance->sendMessage( SystemIntegration::CommandHandler::show() );
@@ -94,6 +103,10 @@ void Application::prepare()
     // process incoming requests in command handler:
     connect( m_instance, &ApplicationInstance::receivedMessage,
              m_handler, &CommandHandler::handleMessage );
+    connect( m_handler, &CommandHandler::requestDatabaseStats, [this] {
+      QVariantMap stats = m_database ? m_database->stats() : QVariantMap();
+      m_instance->reply( QJsonDocument::fromVariant( stats ).toJson( QJsonDocument::Compact ) );
+    });
 
     // further setup:
     setupPaths();
@@ -278,6 +291,7 @@ void Application::showWindowImplementation()
 {
   unwatchQmlFiles();
   if ( !m_viewer ) {
+    Core::Tracer::Scope scope( "Application::showWindow" );
     m_viewer = new QQmlApplicationEngine(this);
     m_handler->setApplicationWindow( m_viewer );
     setupPaths(m_viewer);
@@ -292,6 +306,7 @@ void Application::showWindowImplementation()
     }
     m_viewer->load(QUrl(m_mainQmlFile));
     m_handler->showWindow();
+    watchFirstFrame();
     emit viewerChanged();
   }
   if ( m_reloadQmlOnChange ) {
@@ -299,6 +314,43 @@ void Application::showWindowImplementation()
   }
 }
 
+/**
+   @brief Notifies when the first frame of the main window has been shown
+
+   This records the "firstFrame" event in the trace and releases the backends of the database
+   if they have been deferred (see DataBase::Database::releaseBackends()).
+ */
+void Application::watchFirstFrame()
+{
+  if ( m_firstFrameShown ) {
+    return;
+  }
+  QQuickWindow *window = nullptr;
+  for ( QObject *object : m_viewer->rootObjects() ) {
+    window = qobject_cast< QQuickWindow* >( object );
+    if ( window ) {
+      break;
+    }
+  }
+  if ( window ) {
+    connect( window, &QQuickWindow::frameSwapped,
+             this, &Application::firstFrameShown, Qt::QueuedConnection );
+  } else {
+    firstFrameShown();
+  }
+}
+
+void Application::firstFrameShown()
+{
+  if ( !m_firstFrameShown ) {
+    m_firstFrameShown = true;
+    Core::Tracer::instance()->addInstantEvent( "firstFrame" );
+    if ( m_database ) {
+      m_database->releaseBackends();
+    }
+  }
+}
+
 void Application::hideWindowImplementation()
 {
   if ( m_viewer ) {
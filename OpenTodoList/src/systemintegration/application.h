@@ -96,6 +96,7 @@ private:
 
   QString                      m_mainQmlFile;
   bool                         m_reloadQmlOnChange;
+  bool                         m_firstFrameShown;
 
   QFileSystemWatcher          *m_fileSystemWatcher;
 
@@ -104,12 +105,14 @@ private:
   void showNotifierIcon();
   void watchQmlFiles();
   void unwatchQmlFiles();
+  void watchFirstFrame();
 
 private slots:
 
   void showWindowImplementation();
   void hideWindowImplementation();
   void reloadQml();
+  void firstFrameShown();
 
 };
 
@@ -36,6 +36,7 @@ ApplicationInstance::ApplicationInstance(const QString &applicationName, QObject
     m_applicationName( applicationName ),
     m_server( new QLocalServer(this) ),
     m_socket( new QLocalSocket() ),
+    m_currentClient( nullptr ),
     m_state( UnconnectedState )
 {
     // Try to connect to the server to see if it is running
@@ -89,15 +90,73 @@ ApplicationInstance::State ApplicationInstance::state() const
 void ApplicationInstance::sendMessage(const QString &message)
 {
     if ( m_socket->state() == QLocalSocket::ConnectedState ) {
-        QString line = message;
-        line = line.replace( "\\", "\\\\" );
-        line = line.replace( "\n", "\\n" );
-        m_socket->write( (line + "\n").toUtf8() );
+        m_socket->write( encodeLine( message ) );
         m_socket->flush();
         m_socket->waitForBytesWritten();
     }
 }
 
+/**
+   @brief Sends a message to the primary application instance and waits for its reply
+
+   This sends the @p message like sendMessage() and waits up to @p timeout milliseconds for
+   the primary instance to answer it (see reply()). Returns the reply or an empty string if
+   no reply has been received.
+
+   @note This method has no effect if this is the primary instance!
+ */
+QString ApplicationInstance::request(const QString &message, int timeout)
+{
+    sendMessage( message );
+    while ( m_socket->state() == QLocalSocket::ConnectedState && !m_socket->canReadLine() ) {
+        if ( !m_socket->waitForReadyRead( timeout ) ) {
+            return QString();
+        }
+    }
+    if ( !m_socket->canReadLine() ) {
+        return QString();
+    }
+    QString line = QString::fromUtf8( m_socket->readLine() );
+    line.chop( 1 );
+    return decodeLine( line );
+}
+
+/**
+   @brief Answers the message currently being handled
+
+   This can be called by handlers of receivedMessage() (using a direct connection) to send
+   the @p message back to the instance which sent the message being handled (see request()).
+   Outside of the handling of a message, this has no effect.
+ */
+void ApplicationInstance::reply(const QString &message)
+{
+    if ( m_currentClient ) {
+        m_currentClient->write( encodeLine( message ) );
+        m_currentClient->flush();
+    }
+}
+
+/**
+   @brief Escapes the @p message so that it can be sent as a single line
+ */
+QByteArray ApplicationInstance::encodeLine(const QString &message)
+{
+    QString line = message;
+    line = line.replace( "\\", "\\\\" );
+    line = line.replace( "\n", "\\n" );
+    return ( line + "\n" ).toUtf8();
+}
+
+/**
+   @brief Restores the message sent as the (already chopped) @p line
+ */
+QString ApplicationInstance::decodeLine(QString line)
+{
+    line.replace( "\\n", "\n" );
+    line.replace( "\\\\", "\\" );
+    return line;
+}
+
 // Called when a new client connects
 void ApplicationInstance::onClientConnected()
 {
@@ -123,10 +182,11 @@ void ApplicationInstance::onClientDataReceived()
         while ( socket->canReadLine() ) {
             QString line = socket->readLine( MaxLineSize + 1 );
             line.chop(1);
-            line.replace( "\\n", "\n" );
-            line.replace( "\\\\", "\\" );
+            line = decodeLine( line );
             qDebug() << "Received message from client:" << line;
+            m_currentClient = socket;
             emit receivedMessage( line );
+            m_currentClient = nullptr;
         }
     }
 }
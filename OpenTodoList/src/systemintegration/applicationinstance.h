@@ -59,6 +59,8 @@ public:
 
     State state() const;
 
+    QString request( const QString &message, int timeout = 5000 );
+
 signals:
 
     void receivedMessage( const QString &message );
@@ -66,14 +68,19 @@ signals:
 public slots:
 
     void sendMessage( const QString &message = QString() );
+    void reply( const QString &message );
 
 private:
 
     QString       m_applicationName;
     QLocalServer *m_server;
     QLocalSocket *m_socket;
+    QLocalSocket *m_currentClient;
     State         m_state;
 
+    static QByteArray encodeLine( const QString &message );
+    static QString decodeLine( QString line );
+
 private slots:
 
     void onClientConnected();
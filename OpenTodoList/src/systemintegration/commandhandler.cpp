@@ -36,6 +36,7 @@ const QString CommandHandler::ShowWindowCommand = "window.show";
 const QString CommandHandler::HideWindowCommand = "window.hide";
 const QString CommandHandler::ToggleWindowCommand = "window.toggle";
 const QString CommandHandler::TerminateApplicationCommand = "application.terminate";
+const QString CommandHandler::DatabaseStatsCommand = "database.stats";
 
 /**
    @brief Constructor
@@ -78,6 +79,16 @@ QString CommandHandler::terminate()
   return TerminateApplicationCommand;
 }
 
+/**
+   @brief Generates the command for querying the statistics of the database
+
+   The primary instance answers the command with the Database::stats() encoded as JSON.
+ */
+QString CommandHandler::databaseStats()
+{
+  return DatabaseStatsCommand;
+}
+
 /**
    @brief Handles incoming messages
 
@@ -100,6 +111,8 @@ void CommandHandler::handleMessage(const QString &message)
       toggleWindow();
     } else if ( commandName == TerminateApplicationCommand ) {
       terminate();
+    } else if ( commandName == DatabaseStatsCommand ) {
+      emit requestDatabaseStats();
     } else {
       emit customCommandReceived( message );
     }
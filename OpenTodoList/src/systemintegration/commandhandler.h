@@ -41,6 +41,7 @@ public:
     static QString hide();
     static QString toggle();
     static QString terminate();
+    static QString databaseStats();
 
     QQmlApplicationEngine *applicationWindow() const;
     void setApplicationWindow(QQmlApplicationEngine *applicationWindow);
@@ -52,6 +53,7 @@ signals:
     void requestShow();
     void requestHide();
     void requestToggleWindow();
+    void requestDatabaseStats();
 
 public slots:
 
@@ -68,6 +70,7 @@ private:
     static const QString HideWindowCommand;
     static const QString ToggleWindowCommand;
     static const QString TerminateApplicationCommand;
+    static const QString DatabaseStatsCommand;
 
     QQmlApplicationEngine *m_applicationWindow;
 };
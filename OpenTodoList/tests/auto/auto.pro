@@ -0,0 +1,11 @@
+TEMPLATE = subdirs
+SUBDIRS = \
+  changeset \
+  localxmlbackend \
+  localxmldocument \
+  localxmlmanifest \
+  localxmlwritebatch \
+  objectcache \
+  queryscheduler \
+  readtodo \
+  statementcache
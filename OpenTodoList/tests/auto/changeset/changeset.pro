@@ -0,0 +1,5 @@
+TARGET = tst_changeset
+
+include(../../database.pri)
+
+SOURCES += tst_changeset.cpp
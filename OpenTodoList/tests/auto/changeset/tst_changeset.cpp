@@ -0,0 +1,194 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/changeset.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+class ChangeSetTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void keepsLatestStatePerObject();
+  void deletedAfterChangedIsOnlyDeleted();
+  void changedAfterDeletedIsChanged();
+  void keepsOrderOfFirstChange();
+  void separatesObjectTypes();
+  void mergePrefersNewerChanges();
+  void clear();
+  void databasePublishesChangeSets();
+
+private:
+
+  static QVariant todo( const QUuid &uuid, const QString &title );
+  static QStringList titles( const QVariantList &todos );
+  static ChangeSet merged( const QSignalSpy &spy );
+
+};
+
+void ChangeSetTest::keepsLatestStatePerObject()
+{
+  QUuid uuid = QUuid::createUuid();
+  ChangeSet changes;
+  changes.addChanged( ChangeSet::TodoObject, todo( uuid, "First" ) );
+  changes.addChanged( ChangeSet::TodoObject, todo( uuid, "Second" ) );
+  QCOMPARE( changes.size(), 1 );
+  QCOMPARE( titles( changes.changed( ChangeSet::TodoObject ) ), QStringList() << "Second" );
+  QVERIFY( changes.deleted( ChangeSet::TodoObject ).isEmpty() );
+}
+
+void ChangeSetTest::deletedAfterChangedIsOnlyDeleted()
+{
+  QUuid uuid = QUuid::createUuid();
+  ChangeSet changes;
+  changes.addChanged( ChangeSet::TodoObject, todo( uuid, "Todo" ) );
+  changes.addDeleted( ChangeSet::TodoObject, todo( uuid, "Todo" ) );
+  QCOMPARE( changes.size(), 1 );
+  QVERIFY( changes.changed( ChangeSet::TodoObject ).isEmpty() );
+  QCOMPARE( titles( changes.deleted( ChangeSet::TodoObject ) ), QStringList() << "Todo" );
+}
+
+void ChangeSetTest::changedAfterDeletedIsChanged()
+{
+  // E.g. an object which is removed and inserted again by a backend within one transaction:
+  QUuid uuid = QUuid::createUuid();
+  ChangeSet changes;
+  changes.addDeleted( ChangeSet::TodoObject, todo( uuid, "Todo" ) );
+  changes.addChanged( ChangeSet::TodoObject, todo( uuid, "Todo" ) );
+  QCOMPARE( changes.size(), 1 );
+  QCOMPARE( titles( changes.changed( ChangeSet::TodoObject ) ), QStringList() << "Todo" );
+  QVERIFY( changes.deleted( ChangeSet::TodoObject ).isEmpty() );
+}
+
+void ChangeSetTest::keepsOrderOfFirstChange()
+{
+  QUuid a = QUuid::createUuid();
+  QUuid b = QUuid::createUuid();
+  ChangeSet changes;
+  changes.addChanged( ChangeSet::TodoObject, todo( a, "A" ) );
+  changes.addChanged( ChangeSet::TodoObject, todo( b, "B" ) );
+  changes.addChanged( ChangeSet::TodoObject, todo( a, "A2" ) );
+  QCOMPARE( titles( changes.changed( ChangeSet::TodoObject ) ), QStringList() << "A2" << "B" );
+}
+
+void ChangeSetTest::separatesObjectTypes()
+{
+  QUuid uuid = QUuid::createUuid();
+  Task task;
+  task.setUuid( uuid );
+  task.setTitle( "Task" );
+  ChangeSet changes;
+  changes.addChanged( ChangeSet::TodoObject, todo( uuid, "Todo" ) );
+  changes.addDeleted( ChangeSet::TaskObject, task.toVariant() );
+  QCOMPARE( changes.size(), 2 );
+  QCOMPARE( changes.size( ChangeSet::TodoObject ), 1 );
+  QCOMPARE( changes.size( ChangeSet::TaskObject ), 1 );
+  QCOMPARE( changes.changed( ChangeSet::TodoObject ).size(), 1 );
+  QCOMPARE( changes.deleted( ChangeSet::TaskObject ).size(), 1 );
+
+  // Backends are identified by their name:
+  Backend backend;
+  backend.setName( "SomeBackend" );
+  QCOMPARE( ChangeSet::keyOf( ChangeSet::BackendObject, backend.toVariant() ),
+            QString( "SomeBackend" ) );
+}
+
+void ChangeSetTest::mergePrefersNewerChanges()
+{
+  QUuid a = QUuid::createUuid();
+  QUuid b = QUuid::createUuid();
+  ChangeSet older;
+  older.addChanged( ChangeSet::TodoObject, todo( a, "A" ) );
+  older.addChanged( ChangeSet::TodoObject, todo( b, "B" ) );
+  ChangeSet newer;
+  newer.addChanged( ChangeSet::TodoObject, todo( a, "A2" ) );
+  newer.addDeleted( ChangeSet::TodoObject, todo( b, "B" ) );
+
+  older.merge( newer );
+  QCOMPARE( older.size(), 2 );
+  QCOMPARE( titles( older.changed( ChangeSet::TodoObject ) ), QStringList() << "A2" );
+  QCOMPARE( titles( older.deleted( ChangeSet::TodoObject ) ), QStringList() << "B" );
+
+  // The merged set is not affected:
+  QCOMPARE( newer.size(), 2 );
+}
+
+void ChangeSetTest::clear()
+{
+  ChangeSet changes;
+  QVERIFY( changes.isEmpty() );
+  changes.addChanged( ChangeSet::TodoObject, todo( QUuid::createUuid(), "Todo" ) );
+  ChangeSet copy = changes;
+  changes.clear();
+  QVERIFY( changes.isEmpty() );
+  QCOMPARE( changes.size( ChangeSet::TodoObject ), 0 );
+  QCOMPARE( copy.size(), 1 );
+}
+
+void ChangeSetTest::databasePublishesChangeSets()
+{
+  TestDatabase db;
+  QSignalSpy spy( db.database(), &Database::changesAvailable );
+  QUuid todoList = db.addTodoList( "List" );
+  QUuid todoUuid = db.addTodo( todoList, "Todo" );
+
+  // The changes are published once the transactions are done, maybe split into several sets:
+  QTRY_COMPARE( merged( spy ).size( ChangeSet::TodoObject ), 1 );
+  ChangeSet changes = merged( spy );
+  QVariantList todos = changes.changed( ChangeSet::TodoObject );
+  QCOMPARE( todos.size(), 1 );
+  QCOMPARE( ChangeSet::keyOf( ChangeSet::TodoObject, todos.first() ), todoUuid.toString() );
+}
+
+QVariant ChangeSetTest::todo( const QUuid &uuid, const QString &title )
+{
+  Todo todo;
+  todo.setUuid( uuid );
+  todo.setTitle( title );
+  return todo.toVariant();
+}
+
+QStringList ChangeSetTest::titles( const QVariantList &todos )
+{
+  QStringList result;
+  for ( const QVariant &todo : todos ) {
+    result << todo.toMap().value( "title" ).toString();
+  }
+  return result;
+}
+
+ChangeSet ChangeSetTest::merged( const QSignalSpy &spy )
+{
+  ChangeSet result;
+  for ( const QList<QVariant> &arguments : spy ) {
+    result.merge( arguments.at( 0 ).value<ChangeSet>() );
+  }
+  return result;
+}
+
+QTEST_GUILESS_MAIN(ChangeSetTest)
+
+#include "tst_changeset.moc"
@@ -0,0 +1,23 @@
+TARGET = tst_localxmlbackend
+
+include(../../database.pri)
+
+# The backend is linked in as static plugin, so the Database picks it up like in the app:
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+QT += concurrent
+DEFINES += QT_STATICPLUGIN
+INCLUDEPATH += $$BACKEND_DIR $$PWD/../../../inc/core
+
+SOURCES += \
+    tst_localxmlbackend.cpp \
+    $$BACKEND_DIR/localxmlbackend.cpp \
+    $$BACKEND_DIR/localxmldocument.cpp \
+    $$BACKEND_DIR/localxmlmanifest.cpp \
+    $$BACKEND_DIR/localxmlwritebatch.cpp
+
+HEADERS += \
+    $$BACKEND_DIR/localxmlbackend.h \
+    $$BACKEND_DIR/localxmldocument.h \
+    $$BACKEND_DIR/localxmlmanifest.h \
+    $$BACKEND_DIR/localxmlwritebatch.h
@@ -0,0 +1,172 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testfiles.h"
+
+#include "database/database.h"
+#include "database/queries/readtodo.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <QUuid>
+
+Q_IMPORT_PLUGIN(LocalXmlBackend)
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::DataModel;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Checks that changes done to the files of the LocalXmlBackend show up in the database
+
+   The backend runs inside a real Database, so the changes are picked up by its file system
+   watcher in the backends thread.
+ */
+class LocalXmlBackendTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void importsChangedFiles();
+  void importsNewFiles();
+  void removesObjectsOfDeletedFiles();
+  void importsFilesChangedWhileStopped();
+  void importsEditsAfterReplace();
+
+private:
+
+  QTemporaryDir *m_dir;
+  Database      *m_database;
+
+  QString todoFileName( const QString &name ) const;
+  void writeTodo( const QString &name, const QString &title, bool replace = false );
+  QStringList titles();
+
+};
+
+void LocalXmlBackendTest::init()
+{
+  m_dir = new QTemporaryDir();
+  qputenv( "OPENTODOLIST_LOCAL_STORAGE_LOCATION", m_dir->path().toUtf8() );
+
+  // Create the files before the backend starts, so they are read by the initial import:
+  QVERIFY( TestFiles::writeFile( m_dir->path() + "/LocalXmlDirectory/list/config.xml",
+                                 TestFiles::todoListXml( QUuid::createUuid(), "List" ) ) );
+  writeTodo( "first", "First" );
+
+  m_database = new Database();
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First", 10000 );
+}
+
+void LocalXmlBackendTest::cleanup()
+{
+  delete m_database;
+  m_database = nullptr;
+  delete m_dir;
+  m_dir = nullptr;
+}
+
+void LocalXmlBackendTest::importsChangedFiles()
+{
+  writeTodo( "first", "First (changed)" );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First (changed)", 10000 );
+}
+
+void LocalXmlBackendTest::importsNewFiles()
+{
+  writeTodo( "second", "Second" );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First" << "Second", 10000 );
+}
+
+void LocalXmlBackendTest::removesObjectsOfDeletedFiles()
+{
+  writeTodo( "second", "Second" );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First" << "Second", 10000 );
+  QVERIFY( QFile::remove( todoFileName( "first" ) ) );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "Second", 10000 );
+}
+
+void LocalXmlBackendTest::importsFilesChangedWhileStopped()
+{
+  // The manifest written on shutdown must not hide changes done while the app is not running:
+  delete m_database;
+  m_database = nullptr;
+  writeTodo( "first", "First (changed while stopped)" );
+  writeTodo( "second", "Second" );
+  m_database = new Database();
+  QTRY_COMPARE_WITH_TIMEOUT(
+        titles(), QStringList() << "First (changed while stopped)" << "Second", 10000 );
+}
+
+void LocalXmlBackendTest::importsEditsAfterReplace()
+{
+  // Replacing a file by renaming another one over it must not stop watching the file:
+  writeTodo( "first", "First (replaced)", true );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First (replaced)", 10000 );
+  writeTodo( "first", "First (edited)" );
+  QTRY_COMPARE_WITH_TIMEOUT( titles(), QStringList() << "First (edited)", 10000 );
+}
+
+QString LocalXmlBackendTest::todoFileName( const QString &name ) const
+{
+  return m_dir->path() + "/LocalXmlDirectory/list/todos/" + name + ".xml";
+}
+
+/**
+   @brief Writes the todo file called @p name with the given @p title
+
+   The todo's ID is derived from the @p name, so rewriting a file changes the same todo. If
+   @p replace is true, the content is written to a new file which is then renamed over the
+   existing one; otherwise, the file is overwritten in place.
+ */
+void LocalXmlBackendTest::writeTodo( const QString &name, const QString &title, bool replace )
+{
+  QUuid uuid = QUuid::createUuidV5( QUuid(), name );
+  QByteArray content = TestFiles::todoXml( uuid, title );
+  if ( replace ) {
+    QSaveFile file( todoFileName( name ) );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( content );
+    QVERIFY( file.commit() );
+  } else {
+    QVERIFY( TestFiles::writeFile( todoFileName( name ), content ) );
+  }
+}
+
+QStringList LocalXmlBackendTest::titles()
+{
+  Queries::ReadTodo query;
+  m_database->runQuery( &query );
+  QStringList result;
+  for ( Todo *todo : query.todos() ) {
+    result << todo->title();
+  }
+  result.sort();
+  return result;
+}
+
+QTEST_GUILESS_MAIN(LocalXmlBackendTest)
+
+#include "tst_localxmlbackend.moc"
@@ -0,0 +1,16 @@
+TARGET = tst_localxmldocument
+
+include(../../tests.pri)
+
+# QtXml is only used to produce and read files the way the backend did before
+QT += xml
+
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+INCLUDEPATH += $$BACKEND_DIR
+
+HEADERS += $$BACKEND_DIR/localxmldocument.h
+
+SOURCES += \
+  $$BACKEND_DIR/localxmldocument.cpp \
+  tst_localxmldocument.cpp
@@ -0,0 +1,242 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "localxmldocument.h"
+
+#include <QDomDocument>
+#include <QtTest>
+#include <QUuid>
+
+/**
+   @brief Compares LocalXmlDocument with the QDomDocument based code it replaced
+
+   Files written by older versions must be read the same way, and files written now must
+   still be readable by QDomDocument (i.e. older versions of the app).
+ */
+class LocalXmlDocumentTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void readsDomOutput();
+  void writesDomCompatibleOutput();
+  void numbersMatchDomOutput_data();
+  void numbersMatchDomOutput();
+  void keepsUnknownContent();
+  void editsKeepAttributeOrder();
+  void invalidContent();
+
+private:
+
+  static const char* Title;
+  static const char* Description;
+
+  static QDomDocument oldTodoDocument( const QString &uuid, double weight );
+  static QString canonical( const QDomElement &element );
+  static QString canonical( const QByteArray &xml );
+
+};
+
+const char* LocalXmlDocumentTest::Title = "Buy <milk> & \"bread\"";
+const char* LocalXmlDocumentTest::Description = "  First line\n\tSecond line with <tags> & entities  \n";
+
+void LocalXmlDocumentTest::readsDomOutput()
+{
+  QString uuid = QUuid::createUuid().toString();
+  QByteArray xml = oldTodoDocument( uuid, 12.5 ).toByteArray( 2 );
+
+  LocalXmlDocument doc;
+  QVERIFY( doc.setContent( xml ) );
+  QCOMPARE( doc.rootName(), QString( "todo" ) );
+  QCOMPARE( doc.attribute( "id" ), uuid );
+  QCOMPARE( doc.attribute( "title" ), QString( Title ) );
+  QCOMPARE( doc.attribute( "done" ), QString( "false" ) );
+  QCOMPARE( doc.attribute( "priority" ), QString( "3" ) );
+  QCOMPARE( doc.attribute( "weight" ), QString( "12.5" ) );
+  QVERIFY( !doc.hasAttribute( "dueDate" ) );
+  QVERIFY( doc.hasElement( "description" ) );
+  QCOMPARE( doc.elementText( "description" ), QString( Description ) );
+
+  // Writing the document back does not change its content:
+  QCOMPARE( canonical( doc.toByteArray() ), canonical( xml ) );
+}
+
+void LocalXmlDocumentTest::writesDomCompatibleOutput()
+{
+  QString uuid = QUuid::createUuid().toString();
+  LocalXmlDocument doc;
+  doc.setRootName( "todo" );
+  doc.setAttribute( "id", uuid );
+  doc.setAttribute( "title", QString( Title ) );
+  doc.setAttribute( "done", QString( "false" ) );
+  doc.setAttribute( "priority", 3 );
+  doc.setAttribute( "weight", 12.5 );
+  doc.setElementText( "description", Description );
+
+  QByteArray xml = doc.toByteArray();
+  QDomDocument dom;
+  QVERIFY( dom.setContent( xml ) );
+  QCOMPARE( dom.documentElement().attribute( "title" ), QString( Title ) );
+  QCOMPARE( dom.documentElement().firstChildElement( "description" ).text(),
+            QString( Description ) );
+  QCOMPARE( canonical( xml ), canonical( oldTodoDocument( uuid, 12.5 ).toByteArray( 2 ) ) );
+}
+
+void LocalXmlDocumentTest::numbersMatchDomOutput_data()
+{
+  QTest::addColumn<double>( "weight" );
+  QTest::newRow( "integer" ) << 42.0;
+  QTest::newRow( "two digits" ) << 12.34;
+  QTest::newRow( "between" ) << ( 12.34 + 12.345 ) / 2.0;
+  QTest::newRow( "third" ) << 1.0 / 3.0;
+  QTest::newRow( "negative" ) << -1234.5678901;
+}
+
+void LocalXmlDocumentTest::numbersMatchDomOutput()
+{
+  QFETCH( double, weight );
+  QDomDocument dom = oldTodoDocument( QUuid().toString(), weight );
+  LocalXmlDocument doc;
+  doc.setRootName( "todo" );
+  doc.setAttribute( "weight", weight );
+  QCOMPARE( doc.attribute( "weight" ), dom.documentElement().attribute( "weight" ) );
+}
+
+void LocalXmlDocumentTest::keepsUnknownContent()
+{
+  QByteArray xml =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<todo id=\"{00000000-0000-0000-0000-000000000001}\" x:custom=\"value\" title=\"Todo\">\n"
+      "  <description>Text</description>\n"
+      "  <attachments kind=\"files\">\n"
+      "    <!-- written by some other tool -->\n"
+      "    <file name=\"a.txt\">Content <b>bold</b></file>\n"
+      "    <file name=\"b.txt\"/>\n"
+      "  </attachments>\n"
+      "  <empty/>\n"
+      "</todo>\n";
+
+  LocalXmlDocument doc;
+  QVERIFY( doc.setContent( xml ) );
+  QCOMPARE( doc.attribute( "x:custom" ), QString( "value" ) );
+  QCOMPARE( canonical( doc.toByteArray() ), canonical( xml ) );
+
+  doc.setAttribute( "title", QString( "Changed" ) );
+  doc.setElementText( "description", "Changed text" );
+  QDomDocument dom;
+  QVERIFY( dom.setContent( doc.toByteArray() ) );
+  QDomElement root = dom.documentElement();
+  QCOMPARE( root.attribute( "title" ), QString( "Changed" ) );
+  QCOMPARE( root.attribute( "x:custom" ), QString( "value" ) );
+  QCOMPARE( root.firstChildElement( "description" ).text(), QString( "Changed text" ) );
+  QDomElement attachments = root.firstChildElement( "attachments" );
+  QCOMPARE( attachments.attribute( "kind" ), QString( "files" ) );
+  QCOMPARE( attachments.elementsByTagName( "file" ).size(), 2 );
+  QCOMPARE( attachments.firstChildElement( "file" ).text(), QString( "Content bold" ) );
+  QVERIFY( root.firstChildElement( "empty" ).isElement() );
+}
+
+void LocalXmlDocumentTest::editsKeepAttributeOrder()
+{
+  LocalXmlDocument doc;
+  QVERIFY( doc.setContent( "<task b=\"1\" id=\"x\" a=\"2\"/>" ) );
+  doc.setAttribute( "id", QString( "y" ) );
+  doc.setAttribute( "c", 3 );
+  doc.removeAttribute( "b" );
+  QVERIFY( doc.toByteArray().contains( "<task id=\"y\" a=\"2\" c=\"3\"/>" ) );
+}
+
+void LocalXmlDocumentTest::invalidContent()
+{
+  LocalXmlDocument doc;
+  QVERIFY( doc.isNull() );
+  QVERIFY( doc.toByteArray().isEmpty() );
+
+  QString errorMsg;
+  int errorLine = 0;
+  QVERIFY( !doc.setContent( "<todo>\n<description>\n</todo>", &errorMsg, &errorLine ) );
+  QVERIFY( doc.isNull() );
+  QVERIFY( !doc.hasElement( "description" ) );
+  QVERIFY( !errorMsg.isEmpty() );
+  QVERIFY( errorLine > 0 );
+
+  // Same as QDomDocument, which also refused these:
+  QDomDocument dom;
+  QVERIFY( !dom.setContent( QByteArray( "<todo>\n<description>\n</todo>" ) ) );
+}
+
+/**
+   @brief Creates a todo document the way LocalXmlBackend::todoToDom() did
+ */
+QDomDocument LocalXmlDocumentTest::oldTodoDocument( const QString &uuid, double weight )
+{
+  QDomDocument doc;
+  QDomElement root = doc.createElement( "todo" );
+  doc.appendChild( root );
+  root.setAttribute( "id", uuid );
+  root.setAttribute( "title", Title );
+  root.setAttribute( "done", "false" );
+  root.setAttribute( "priority", 3 );
+  root.setAttribute( "weight", weight );
+  QDomElement descriptionElement = doc.createElement( "description" );
+  root.appendChild( descriptionElement );
+  descriptionElement.appendChild( doc.createTextNode( Description ) );
+  return doc;
+}
+
+/**
+   @brief Returns a representation of the @p element which ignores formatting
+
+   Attributes are sorted, whitespace-only text between elements is dropped.
+ */
+QString LocalXmlDocumentTest::canonical( const QDomElement &element )
+{
+  QStringList attributes;
+  QDomNamedNodeMap map = element.attributes();
+  for ( int i = 0; i < map.count(); ++i ) {
+    QDomAttr attribute = map.item( i ).toAttr();
+    attributes << attribute.name() + "=" + attribute.value();
+  }
+  attributes.sort();
+  QString result = "<" + element.tagName() + " " + attributes.join( " " ) + ">";
+  for ( QDomNode node = element.firstChild(); !node.isNull(); node = node.nextSibling() ) {
+    if ( node.isElement() ) {
+      result += canonical( node.toElement() );
+    } else if ( node.isText() ) {
+      result += "[" + node.toText().data() + "]";
+    } else if ( node.isComment() ) {
+      result += "<!--" + node.toComment().data() + "-->";
+    }
+  }
+  return result + "</" + element.tagName() + ">";
+}
+
+QString LocalXmlDocumentTest::canonical( const QByteArray &xml )
+{
+  QDomDocument doc;
+  if ( !doc.setContent( xml ) ) {
+    return QString();
+  }
+  return canonical( doc.documentElement() );
+}
+
+QTEST_GUILESS_MAIN(LocalXmlDocumentTest)
+
+#include "tst_localxmldocument.moc"
@@ -0,0 +1,13 @@
+TARGET = tst_localxmlmanifest
+
+include(../../tests.pri)
+
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+INCLUDEPATH += $$BACKEND_DIR
+
+HEADERS += $$BACKEND_DIR/localxmlmanifest.h
+
+SOURCES += \
+  $$BACKEND_DIR/localxmlmanifest.cpp \
+  tst_localxmlmanifest.cpp
@@ -0,0 +1,214 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "localxmlmanifest.h"
+
+#include "testfiles.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+using namespace OpenTodoList::Tests;
+
+class LocalXmlManifestTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void detectsUnchangedFiles();
+  void detectsChangedFiles();
+  void detectsReplacedFiles();
+  void saveAndLoad();
+  void ignoresIncompatibleManifests();
+  void fileNames();
+  void removeDirectoryAndRetain();
+  void dirtyState();
+
+private:
+
+  QTemporaryDir    *m_dir;
+  LocalXmlManifest *m_manifest;
+
+  QString path( const QString &fileName ) const;
+
+};
+
+void LocalXmlManifestTest::init()
+{
+  m_dir = new QTemporaryDir();
+  m_manifest = new LocalXmlManifest( m_dir->path() );
+}
+
+void LocalXmlManifestTest::cleanup()
+{
+  delete m_manifest;
+  m_manifest = nullptr;
+  delete m_dir;
+  m_dir = nullptr;
+}
+
+void LocalXmlManifestTest::detectsUnchangedFiles()
+{
+  QUuid uuid = QUuid::createUuid();
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml" ), "<todoList/>" ) );
+  m_manifest->record( "list/config.xml", uuid, "hash" );
+
+  LocalXmlManifest::Entry stored;
+  QVERIFY( m_manifest->isUnchanged( "list/config.xml", m_manifest->stat( "list/config.xml" ),
+                                    &stored ) );
+  QCOMPARE( stored.uuid, uuid );
+  QCOMPARE( stored.hash, QByteArray( "hash" ) );
+
+  // Files not recorded yet are always considered to be changed:
+  QVERIFY( TestFiles::writeFile( path( "other/config.xml" ), "<todoList/>" ) );
+  QVERIFY( !m_manifest->isUnchanged( "other/config.xml",
+                                     m_manifest->stat( "other/config.xml" ) ) );
+}
+
+void LocalXmlManifestTest::detectsChangedFiles()
+{
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml" ), "<todoList/>" ) );
+  m_manifest->record( "list/config.xml", QUuid::createUuid(), "hash" );
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml" ), "<todoList name=\"Changed\"/>" ) );
+  QVERIFY( !m_manifest->isUnchanged( "list/config.xml", m_manifest->stat( "list/config.xml" ) ) );
+
+  // Removed files are never unchanged:
+  m_manifest->record( "list/config.xml", QUuid::createUuid(), "hash" );
+  QVERIFY( QFile::remove( m_dir->path() + "/list/config.xml" ) );
+  LocalXmlManifest::Entry current = m_manifest->stat( "list/config.xml" );
+  QVERIFY( !current.exists() );
+  QVERIFY( !m_manifest->isUnchanged( "list/config.xml", current ) );
+}
+
+void LocalXmlManifestTest::detectsReplacedFiles()
+{
+  // A file replaced by another one with the same size (e.g. by a synchronization tool
+  // writing a temporary file and renaming it) must be read again:
+#ifndef Q_OS_UNIX
+  QSKIP( "Inodes are only recorded on Unix systems" );
+#endif
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml" ), "<todoList name=\"A\"/>" ) );
+  m_manifest->record( "list/config.xml", QUuid::createUuid(), "hash" );
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml.tmp" ), "<todoList name=\"B\"/>" ) );
+  QVERIFY( QFile::remove( m_dir->path() + "/list/config.xml" ) );
+  QVERIFY( QFile::rename( m_dir->path() + "/list/config.xml.tmp",
+                          m_dir->path() + "/list/config.xml" ) );
+  QVERIFY( !m_manifest->isUnchanged( "list/config.xml", m_manifest->stat( "list/config.xml" ) ) );
+}
+
+void LocalXmlManifestTest::saveAndLoad()
+{
+  QUuid uuid = QUuid::createUuid();
+  QVERIFY( TestFiles::writeFile( path( "list/config.xml" ), "<todoList/>" ) );
+  m_manifest->record( "list/config.xml", uuid, "hash" );
+  LocalXmlManifest::Entry recorded = m_manifest->entry( "list/config.xml" );
+  QVERIFY( m_manifest->save() );
+  QVERIFY( QFile::exists( m_dir->path() + "/" + LocalXmlManifest::FileName ) );
+
+  LocalXmlManifest loaded( m_dir->path() );
+  QVERIFY( loaded.load() );
+  QVERIFY( !loaded.isDirty() );
+  LocalXmlManifest::Entry entry = loaded.entry( "list/config.xml" );
+  QCOMPARE( entry.size, recorded.size );
+  QCOMPARE( entry.modified, recorded.modified );
+  QCOMPARE( entry.inode, recorded.inode );
+  QCOMPARE( entry.uuid, uuid );
+  QCOMPARE( entry.hash, QByteArray( "hash" ) );
+  QVERIFY( loaded.isUnchanged( "list/config.xml", loaded.stat( "list/config.xml" ) ) );
+}
+
+void LocalXmlManifestTest::ignoresIncompatibleManifests()
+{
+  LocalXmlManifest manifest( m_dir->path() );
+  QVERIFY( !manifest.load() );
+
+  QVERIFY( TestFiles::writeFile( path( LocalXmlManifest::FileName ), "This is not a manifest" ) );
+  manifest.insert( "list/config.xml", LocalXmlManifest::Entry() );
+  QVERIFY( !manifest.load() );
+  QVERIFY( manifest.fileNames( QString(), true ).isEmpty() );
+  QVERIFY( !manifest.isDirty() );
+}
+
+void LocalXmlManifestTest::fileNames()
+{
+  LocalXmlManifest::Entry entry;
+  m_manifest->insert( "a/config.xml", entry );
+  m_manifest->insert( "a/todos/1.xml", entry );
+  m_manifest->insert( "a/todos/1/2.xml", entry );
+  m_manifest->insert( "ab/config.xml", entry );
+
+  QStringList fileNames = m_manifest->fileNames( "a", false );
+  QCOMPARE( fileNames, QStringList() << "a/config.xml" );
+
+  fileNames = m_manifest->fileNames( "a/", true );
+  fileNames.sort();
+  QCOMPARE( fileNames, QStringList() << "a/config.xml" << "a/todos/1.xml" << "a/todos/1/2.xml" );
+
+  fileNames = m_manifest->fileNames( QString(), true );
+  QCOMPARE( fileNames.size(), 4 );
+  QVERIFY( m_manifest->fileNames( QString(), false ).isEmpty() );
+}
+
+void LocalXmlManifestTest::removeDirectoryAndRetain()
+{
+  LocalXmlManifest::Entry entry;
+  m_manifest->insert( "a/config.xml", entry );
+  m_manifest->insert( "a/todos/1.xml", entry );
+  m_manifest->insert( "ab/config.xml", entry );
+  m_manifest->insert( "b/config.xml", entry );
+
+  m_manifest->removeDirectory( "a" );
+  QStringList fileNames = m_manifest->fileNames( QString(), true );
+  fileNames.sort();
+  QCOMPARE( fileNames, QStringList() << "ab/config.xml" << "b/config.xml" );
+
+  m_manifest->retain( QSet<QString>() << "b/config.xml" << "c/config.xml" );
+  QCOMPARE( m_manifest->fileNames( QString(), true ), QStringList() << "b/config.xml" );
+}
+
+void LocalXmlManifestTest::dirtyState()
+{
+  QVERIFY( !m_manifest->isDirty() );
+  m_manifest->remove( "missing.xml" );
+  m_manifest->retain( QSet<QString>() );
+  m_manifest->clear();
+  QVERIFY( !m_manifest->isDirty() );
+
+  m_manifest->insert( "a/config.xml", LocalXmlManifest::Entry() );
+  QVERIFY( m_manifest->isDirty() );
+  QVERIFY( m_manifest->save() );
+  QVERIFY( !m_manifest->isDirty() );
+
+  m_manifest->clear();
+  QVERIFY( m_manifest->isDirty() );
+}
+
+QString LocalXmlManifestTest::path( const QString &fileName ) const
+{
+  return m_dir->path() + "/" + fileName;
+}
+
+QTEST_GUILESS_MAIN(LocalXmlManifestTest)
+
+#include "tst_localxmlmanifest.moc"
@@ -0,0 +1,13 @@
+TARGET = tst_localxmlwritebatch
+
+include(../../tests.pri)
+
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+INCLUDEPATH += $$BACKEND_DIR
+
+HEADERS += $$BACKEND_DIR/localxmlwritebatch.h
+
+SOURCES += \
+  $$BACKEND_DIR/localxmlwritebatch.cpp \
+  tst_localxmlwritebatch.cpp
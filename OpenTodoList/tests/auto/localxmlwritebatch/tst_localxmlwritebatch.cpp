@@ -0,0 +1,213 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "localxmlwritebatch.h"
+
+#include "testfiles.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+using namespace OpenTodoList::Tests;
+
+class LocalXmlWriteBatchTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void writeKeepsOldContent();
+  void commitReplacesFiles();
+  void writingTwiceKeepsLatestData();
+  void discardKeepsOldContent();
+  void destructorDiscards();
+  void failedReplaceKeepsOthers();
+  void removeStaleFiles();
+
+private:
+
+  QTemporaryDir *m_dir;
+
+  QString path( const QString &fileName ) const;
+  QByteArray content( const QString &fileName ) const;
+  QStringList tempFiles() const;
+
+};
+
+void LocalXmlWriteBatchTest::init()
+{
+  m_dir = new QTemporaryDir();
+  QVERIFY( QDir( m_dir->path() ).mkpath( "a/todos" ) );
+  QVERIFY( QDir( m_dir->path() ).mkpath( "b" ) );
+}
+
+void LocalXmlWriteBatchTest::cleanup()
+{
+  delete m_dir;
+  m_dir = nullptr;
+}
+
+void LocalXmlWriteBatchTest::writeKeepsOldContent()
+{
+  QVERIFY( TestFiles::writeFile( path( "a/config.xml" ), "old" ) );
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QVERIFY( batch.isEmpty() );
+  QVERIFY( batch.write( "a/config.xml", "new" ) );
+  QVERIFY( !batch.isEmpty() );
+  QVERIFY( batch.contains( "a/config.xml" ) );
+  QVERIFY( !batch.contains( "b/config.xml" ) );
+
+  // Until the batch is committed, only the temporary file has the new content:
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "old" ) );
+  QCOMPARE( content( "a/config.xml" + LocalXmlWriteBatch::TempSuffix ), QByteArray( "new" ) );
+}
+
+void LocalXmlWriteBatchTest::commitReplacesFiles()
+{
+  QVERIFY( TestFiles::writeFile( path( "a/config.xml" ), "old" ) );
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QVERIFY( batch.write( "a/config.xml", "list" ) );
+  QVERIFY( batch.write( "a/todos/1.xml", "todo" ) );
+  QVERIFY( batch.write( "b/config.xml", "other list" ) );
+
+  QStringList committed = batch.commit();
+  QCOMPARE( committed, QStringList() << "a/config.xml" << "a/todos/1.xml" << "b/config.xml" );
+  QVERIFY( batch.isEmpty() );
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "list" ) );
+  QCOMPARE( content( "a/todos/1.xml" ), QByteArray( "todo" ) );
+  QCOMPARE( content( "b/config.xml" ), QByteArray( "other list" ) );
+  QVERIFY( tempFiles().isEmpty() );
+
+  // Nothing left to do:
+  QVERIFY( batch.commit().isEmpty() );
+}
+
+void LocalXmlWriteBatchTest::writingTwiceKeepsLatestData()
+{
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QVERIFY( batch.write( "a/config.xml", "first version, which is longer" ) );
+  QVERIFY( batch.write( "a/config.xml", "second" ) );
+  QCOMPARE( batch.commit(), QStringList() << "a/config.xml" );
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "second" ) );
+}
+
+void LocalXmlWriteBatchTest::discardKeepsOldContent()
+{
+  QVERIFY( TestFiles::writeFile( path( "a/config.xml" ), "old" ) );
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QVERIFY( batch.write( "a/config.xml", "new" ) );
+  QVERIFY( batch.write( "b/config.xml", "new" ) );
+  batch.discard();
+  QVERIFY( batch.isEmpty() );
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "old" ) );
+  QVERIFY( !QFile::exists( path( "b/config.xml" ) ) );
+  QVERIFY( tempFiles().isEmpty() );
+  QVERIFY( batch.commit().isEmpty() );
+
+  // Changing the directory drops pending files as well:
+  QVERIFY( batch.write( "a/config.xml", "new" ) );
+  batch.setDirectory( m_dir->path() + "/b" );
+  QVERIFY( batch.isEmpty() );
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "old" ) );
+  QVERIFY( tempFiles().isEmpty() );
+}
+
+void LocalXmlWriteBatchTest::destructorDiscards()
+{
+  QVERIFY( TestFiles::writeFile( path( "a/config.xml" ), "old" ) );
+  {
+    LocalXmlWriteBatch batch( m_dir->path() );
+    QVERIFY( batch.write( "a/config.xml", "new" ) );
+  }
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "old" ) );
+  QVERIFY( tempFiles().isEmpty() );
+}
+
+void LocalXmlWriteBatchTest::failedReplaceKeepsOthers()
+{
+#ifndef Q_OS_UNIX
+  QSKIP( "Replacing a directory fails differently outside of Unix" );
+#endif
+  // A non-empty directory cannot be replaced by a file:
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QVERIFY( batch.write( "a/config.xml", "list" ) );
+  QVERIFY( batch.write( "a/todos", "not a directory" ) );
+  QVERIFY( batch.write( "b/config.xml", "other list" ) );
+  QVERIFY( TestFiles::writeFile( path( "a/todos/1.xml" ), "todo" ) );
+
+  QCOMPARE( batch.commit(), QStringList() << "a/config.xml" << "b/config.xml" );
+  QVERIFY( QFileInfo( path( "a/todos" ) ).isDir() );
+  QCOMPARE( content( "a/todos/1.xml" ), QByteArray( "todo" ) );
+  QVERIFY( tempFiles().isEmpty() );
+}
+
+void LocalXmlWriteBatchTest::removeStaleFiles()
+{
+  QVERIFY( TestFiles::writeFile( path( "a/config.xml" ), "list" ) );
+  for ( const QString &fileName : { "a/config.xml", "a/todos/1.xml", ".hidden.xml" } ) {
+    QString tempFile = path( fileName + LocalXmlWriteBatch::TempSuffix );
+    QVERIFY( TestFiles::writeFile( tempFile, "left over" ) );
+  }
+
+  LocalXmlWriteBatch batch( m_dir->path() );
+  QCOMPARE( batch.removeStaleFiles(), 3 );
+  QVERIFY( tempFiles().isEmpty() );
+  QCOMPARE( content( "a/config.xml" ), QByteArray( "list" ) );
+
+  // Without a directory, nothing must be touched (in particular not the working directory):
+  QCOMPARE( LocalXmlWriteBatch().removeStaleFiles(), 0 );
+}
+
+QString LocalXmlWriteBatchTest::path( const QString &fileName ) const
+{
+  return m_dir->path() + "/" + fileName;
+}
+
+QByteArray LocalXmlWriteBatchTest::content( const QString &fileName ) const
+{
+  QFile file( path( fileName ) );
+  if ( file.open( QIODevice::ReadOnly ) ) {
+    return file.readAll();
+  }
+  return QByteArray();
+}
+
+/**
+   @brief Returns the temporary files of the batch found in the directory
+ */
+QStringList LocalXmlWriteBatchTest::tempFiles() const
+{
+  QStringList result;
+  QDirIterator it( m_dir->path(), { "*" + LocalXmlWriteBatch::TempSuffix },
+                   QDir::Files | QDir::Hidden, QDirIterator::Subdirectories );
+  while ( it.hasNext() ) {
+    result << it.next();
+  }
+  return result;
+}
+
+QTEST_GUILESS_MAIN(LocalXmlWriteBatchTest)
+
+#include "tst_localxmlwritebatch.moc"
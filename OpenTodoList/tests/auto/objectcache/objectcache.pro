@@ -0,0 +1,5 @@
+TARGET = tst_objectcache
+
+include(../../database.pri)
+
+SOURCES += tst_objectcache.cpp
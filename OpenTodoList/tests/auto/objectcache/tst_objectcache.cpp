@@ -0,0 +1,197 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/objectcache.h"
+#include "database/queries/inserttodo.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+class ObjectCacheTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void sharesOneInstancePerObject();
+  void separatesObjectTypes();
+  void keepsRecentObjectsAlive();
+  void releasesUnusedObjects();
+  void appliesChanges();
+  void followsDatabaseChanges();
+  void statistics();
+
+private:
+
+  TestDatabase *m_db;
+
+  static QVariant todo( const QUuid &uuid, const QString &title );
+
+};
+
+void ObjectCacheTest::init()
+{
+  m_db = new TestDatabase();
+}
+
+void ObjectCacheTest::cleanup()
+{
+  delete m_db;
+  m_db = nullptr;
+}
+
+void ObjectCacheTest::sharesOneInstancePerObject()
+{
+  ObjectCache cache( m_db->database() );
+  QUuid uuid = QUuid::createUuid();
+  QSharedPointer<Todo> first = cache.object<Todo>( todo( uuid, "First" ) );
+  QSharedPointer<Todo> second = cache.object<Todo>( todo( uuid, "Second" ) );
+  QCOMPARE( first.data(), second.data() );
+  // The instance is updated with the data read last:
+  QCOMPARE( first->title(), QString( "Second" ) );
+  QCOMPARE( cache.find<Todo>( uuid.toString() ).data(), first.data() );
+
+  QSharedPointer<Todo> other = cache.object<Todo>( todo( QUuid::createUuid(), "Other" ) );
+  QVERIFY( other.data() != first.data() );
+  QCOMPARE( cache.size(), 2 );
+}
+
+void ObjectCacheTest::separatesObjectTypes()
+{
+  ObjectCache cache( m_db->database() );
+  QUuid uuid = QUuid::createUuid();
+  Task task;
+  task.setUuid( uuid );
+  task.setTitle( "Task" );
+  QSharedPointer<Todo> todoObject = cache.object<Todo>( todo( uuid, "Todo" ) );
+  QSharedPointer<Task> taskObject = cache.object<Task>( task.toVariant() );
+  QCOMPARE( todoObject->title(), QString( "Todo" ) );
+  QCOMPARE( taskObject->title(), QString( "Task" ) );
+  QVERIFY( cache.find<Task>( uuid.toString() ) );
+  QCOMPARE( cache.size(), 2 );
+}
+
+void ObjectCacheTest::keepsRecentObjectsAlive()
+{
+  ObjectCache cache( m_db->database(), 2 );
+  QUuid a = QUuid::createUuid();
+  QUuid b = QUuid::createUuid();
+  QUuid c = QUuid::createUuid();
+  cache.object<Todo>( todo( a, "A" ) );
+  cache.object<Todo>( todo( b, "B" ) );
+  cache.object<Todo>( todo( a, "A" ) );
+  cache.object<Todo>( todo( c, "C" ) );
+
+  // No one else holds a reference, so only the two used most recently are left:
+  QVERIFY( cache.find<Todo>( a.toString() ) );
+  QVERIFY( !cache.find<Todo>( b.toString() ) );
+  QVERIFY( cache.find<Todo>( c.toString() ) );
+
+  cache.setCapacity( 1 );
+  QVERIFY( !cache.find<Todo>( a.toString() ) );
+  QVERIFY( cache.find<Todo>( c.toString() ) );
+}
+
+void ObjectCacheTest::releasesUnusedObjects()
+{
+  ObjectCache cache( m_db->database(), 0 );
+  QUuid uuid = QUuid::createUuid();
+  QSharedPointer<Todo> object = cache.object<Todo>( todo( uuid, "Todo" ) );
+  QVERIFY( cache.find<Todo>( uuid.toString() ) );
+  object.clear();
+  QVERIFY( !cache.find<Todo>( uuid.toString() ) );
+  QCOMPARE( cache.size(), 0 );
+}
+
+void ObjectCacheTest::appliesChanges()
+{
+  ObjectCache cache( m_db->database() );
+  QUuid changedUuid = QUuid::createUuid();
+  QUuid deletedUuid = QUuid::createUuid();
+  QSharedPointer<Todo> changed = cache.object<Todo>( todo( changedUuid, "Todo" ) );
+  QSharedPointer<Todo> deleted = cache.object<Todo>( todo( deletedUuid, "Deleted" ) );
+
+  ChangeSet changes;
+  changes.addChanged( ChangeSet::TodoObject, todo( changedUuid, "Changed" ) );
+  changes.addChanged( ChangeSet::TodoObject, todo( QUuid::createUuid(), "Not cached" ) );
+  changes.addDeleted( ChangeSet::TodoObject, todo( deletedUuid, "Deleted" ) );
+  cache.applyChanges( changes );
+
+  QCOMPARE( changed->title(), QString( "Changed" ) );
+  QCOMPARE( cache.size(), 1 );
+  // Deleted objects are no longer handed out, but stay valid for their current users:
+  QVERIFY( !cache.find<Todo>( deletedUuid.toString() ) );
+  QCOMPARE( deleted->title(), QString( "Deleted" ) );
+  QSharedPointer<Todo> recreated = cache.object<Todo>( todo( deletedUuid, "Deleted" ) );
+  QVERIFY( recreated.data() != deleted.data() );
+}
+
+void ObjectCacheTest::followsDatabaseChanges()
+{
+  QUuid todoList = m_db->addTodoList( "List" );
+  QUuid uuid = m_db->addTodo( todoList, "Todo" );
+  Todo data;
+  data.setUuid( uuid );
+  data.setTodoList( todoList );
+  data.setTitle( "Todo" );
+  ObjectCache *cache = m_db->database()->objectCache();
+  QSharedPointer<Todo> object = cache->object<Todo>( data.toVariant() );
+
+  // Changes done by someone else (e.g. a backend) show up in the shared instance:
+  Todo update;
+  update.fromVariant( data.toVariant() );
+  update.setTitle( "Updated" );
+  Queries::InsertTodo query( &update, true );
+  m_db->database()->runQuery( &query );
+  QTRY_COMPARE( object->title(), QString( "Updated" ) );
+}
+
+void ObjectCacheTest::statistics()
+{
+  ObjectCache cache( m_db->database(), 1 );
+  QUuid uuid = QUuid::createUuid();
+  cache.object<Todo>( todo( uuid, "Todo" ) );
+  cache.object<Todo>( todo( uuid, "Todo" ) );
+  cache.object<Todo>( todo( QUuid::createUuid(), "Other" ) );
+  QVariantMap statistics = cache.statistics();
+  QCOMPARE( statistics.value( "hits" ).toInt(), 1 );
+  QCOMPARE( statistics.value( "misses" ).toInt(), 2 );
+  QCOMPARE( statistics.value( "retained" ).toInt(), 1 );
+  QCOMPARE( statistics.value( "capacity" ).toInt(), 1 );
+  QCOMPARE( statistics.value( "live" ).toInt(), 1 );
+}
+
+QVariant ObjectCacheTest::todo( const QUuid &uuid, const QString &title )
+{
+  Todo todo;
+  todo.setUuid( uuid );
+  todo.setTitle( title );
+  return todo.toVariant();
+}
+
+QTEST_GUILESS_MAIN(ObjectCacheTest)
+
+#include "tst_objectcache.moc"
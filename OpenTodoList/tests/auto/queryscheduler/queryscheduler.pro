@@ -0,0 +1,5 @@
+TARGET = tst_queryscheduler
+
+include(../../database.pri)
+
+SOURCES += tst_queryscheduler.cpp
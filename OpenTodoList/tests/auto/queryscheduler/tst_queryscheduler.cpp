@@ -0,0 +1,304 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "database/queryscheduler.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+
+/**
+   @brief A query which only carries the properties the scheduler looks at
+ */
+class TestQuery : public StorageQuery
+{
+public:
+
+  TestQuery( const QString &name, Priority priority, const QString &key = QString(),
+             bool coalescable = false ) :
+    StorageQuery(),
+    m_name( name ),
+    m_key( key ),
+    m_coalescable( coalescable ),
+    m_merged()
+  {
+    setPriority( priority );
+  }
+
+  QString name() const { return m_name; }
+  QStringList merged() const { return m_merged; }
+
+  QString coalescingKey() const override { return m_key; }
+  bool isCoalescable() const override { return m_coalescable; }
+  bool coalesce( StorageQuery *newer ) override {
+    TestQuery *query = static_cast< TestQuery* >( newer );
+    if ( m_coalescable && query->m_coalescable ) {
+      m_merged << query->name();
+      return true;
+    }
+    return false;
+  }
+
+private:
+
+  QString     m_name;
+  QString     m_key;
+  bool        m_coalescable;
+  QStringList m_merged;
+
+};
+
+class QuerySchedulerTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void cleanup();
+
+  void priorityOrder();
+  void fifoWithinClass();
+  void aging();
+  void coalescing();
+  void holdBack();
+  void sameKeyAcrossPriorities();
+  void sameKeyAcrossPrioritiesWhenHeld();
+  void sameKeyStaysInSlowerQueue();
+  void releaseResetsWaitingTime();
+  void statistics();
+
+private:
+
+  QList< TestQuery* > m_queries;
+
+  TestQuery *query( const QString &name, StorageQuery::Priority priority,
+                    const QString &key = QString(), bool coalescable = false );
+  static QStringList names( const QList< QueryScheduler::Entry > &entries );
+
+};
+
+void QuerySchedulerTest::cleanup()
+{
+  qDeleteAll( m_queries );
+  m_queries.clear();
+}
+
+void QuerySchedulerTest::priorityOrder()
+{
+  QueryScheduler scheduler;
+  scheduler.enqueue( query( "maintenance", StorageQuery::MaintenancePriority ) );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority ) );
+  scheduler.enqueue( query( "write", StorageQuery::UserWritePriority ) );
+  scheduler.enqueue( query( "read", StorageQuery::InteractivePriority ) );
+  QCOMPARE( scheduler.size(), 4 );
+  QCOMPARE( names( scheduler.takeAll() ),
+            QStringList() << "read" << "write" << "sync" << "maintenance" );
+  QVERIFY( scheduler.isEmpty() );
+  QCOMPARE( scheduler.nextReadyIn(), -1 );
+}
+
+void QuerySchedulerTest::fifoWithinClass()
+{
+  QueryScheduler scheduler;
+  for ( int i = 0; i < 5; ++i ) {
+    scheduler.enqueue( query( QString::number( i ), StorageQuery::UserWritePriority ) );
+  }
+  QCOMPARE( names( scheduler.takeAll() ),
+            QStringList() << "0" << "1" << "2" << "3" << "4" );
+}
+
+void QuerySchedulerTest::aging()
+{
+  QueryScheduler scheduler;
+  scheduler.setAgingInterval( 10 );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority ) );
+  QThread::msleep( 50 );
+  scheduler.enqueue( query( "read", StorageQuery::InteractivePriority ) );
+  QCOMPARE( names( scheduler.takeAll() ), QStringList() << "sync" << "read" );
+
+  // Without waiting long enough, the priority class decides:
+  scheduler.setAgingInterval( 60000 );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority ) );
+  scheduler.enqueue( query( "read", StorageQuery::InteractivePriority ) );
+  QCOMPARE( names( scheduler.takeAll() ), QStringList() << "read" << "sync" );
+}
+
+void QuerySchedulerTest::coalescing()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 0 );
+  TestQuery *first = query( "first", StorageQuery::UserWritePriority, "todo:1", true );
+  QVERIFY( scheduler.enqueue( first ) );
+  QVERIFY( !scheduler.enqueue( query( "second", StorageQuery::UserWritePriority, "todo:1", true ) ) );
+  StorageQuery *mergedInto = nullptr;
+  QVERIFY( !scheduler.enqueue( query( "third", StorageQuery::UserWritePriority, "todo:1", true ),
+                               nullptr, &mergedInto ) );
+  QCOMPARE( mergedInto, static_cast< StorageQuery* >( first ) );
+  QVERIFY( scheduler.enqueue( query( "other", StorageQuery::UserWritePriority, "todo:2", true ) ) );
+  QCOMPARE( scheduler.size(), 2 );
+  QCOMPARE( first->merged(), QStringList() << "second" << "third" );
+
+  // Queries someone waits for must not be merged away:
+  QSemaphore finished;
+  QVERIFY( scheduler.enqueue( query( "blocking", StorageQuery::UserWritePriority, "todo:1", true ),
+                              &finished ) );
+  QVERIFY( scheduler.enqueue( query( "after", StorageQuery::UserWritePriority, "todo:1", true ) ) );
+  QCOMPARE( names( scheduler.takeAll() ),
+            QStringList() << "first" << "other" << "blocking" << "after" );
+
+  // Once a write has been taken, later writes are not merged into it anymore:
+  QVERIFY( scheduler.enqueue( query( "late", StorageQuery::UserWritePriority, "todo:1", true ) ) );
+  QCOMPARE( scheduler.size(), 1 );
+}
+
+void QuerySchedulerTest::holdBack()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 100 );
+  scheduler.setMaxHoldBack( 150 );
+  scheduler.enqueue( query( "write", StorageQuery::UserWritePriority, "todo:1", true ) );
+  QueryScheduler::Entry entry;
+  QVERIFY( !scheduler.take( entry ) );
+  QVERIFY( scheduler.nextReadyIn() > 0 );
+  QVERIFY( scheduler.nextReadyIn() <= 100 );
+
+  QThread::msleep( 70 );
+  // Merging extends the hold back, but not beyond maxHoldBack():
+  QVERIFY( !scheduler.enqueue( query( "merged", StorageQuery::UserWritePriority, "todo:1", true ) ) );
+  QVERIFY( scheduler.nextReadyIn() > 30 );
+  QVERIFY( scheduler.nextReadyIn() <= 80 );
+
+  scheduler.releaseHeld();
+  QCOMPARE( scheduler.nextReadyIn(), 0 );
+  QCOMPARE( names( scheduler.takeAll() ), QStringList() << "write" );
+}
+
+void QuerySchedulerTest::sameKeyAcrossPriorities()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 0 );
+  scheduler.setAgingInterval( 60000 );
+  scheduler.enqueue( query( "unrelated-sync", StorageQuery::BackgroundSyncPriority ) );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority, "todo:1" ) );
+  scheduler.enqueue( query( "user", StorageQuery::UserWritePriority, "todo:1" ) );
+
+  // The user's write must not overtake the earlier sync of the same todo. Instead, the sync is
+  // promoted, so the user's write is not delayed by unrelated background work either:
+  QCOMPARE( names( scheduler.takeAll() ),
+            QStringList() << "sync" << "user" << "unrelated-sync" );
+}
+
+void QuerySchedulerTest::sameKeyAcrossPrioritiesWhenHeld()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 60000 );
+  scheduler.setMaxHoldBack( 60000 );
+  scheduler.setAgingInterval( 60000 );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority, "todo:1", true ) );
+  QSemaphore finished;
+  scheduler.enqueue( query( "user", StorageQuery::UserWritePriority, "todo:1" ), &finished );
+
+  // The held back sync is released and has to run first:
+  QCOMPARE( scheduler.nextReadyIn(), 0 );
+  QList< QueryScheduler::Entry > entries = scheduler.takeAll();
+  QCOMPARE( names( entries ), QStringList() << "sync" << "user" );
+  QCOMPARE( entries.at( 0 ).priority, static_cast< int >( StorageQuery::UserWritePriority ) );
+  QCOMPARE( entries.at( 1 ).finished, &finished );
+}
+
+void QuerySchedulerTest::sameKeyStaysInSlowerQueue()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 0 );
+  scheduler.setAgingInterval( 60000 );
+  scheduler.enqueue( query( "user", StorageQuery::UserWritePriority, "todo:1" ) );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority, "todo:1" ) );
+  scheduler.enqueue( query( "unrelated-sync", StorageQuery::BackgroundSyncPriority ) );
+  scheduler.enqueue( query( "unrelated-user", StorageQuery::UserWritePriority ) );
+
+  // A later, less urgent write to the same object joins the queue of the earlier one:
+  QCOMPARE( names( scheduler.takeAll() ),
+            QStringList() << "user" << "sync" << "unrelated-user" << "unrelated-sync" );
+}
+
+void QuerySchedulerTest::releaseResetsWaitingTime()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 60000 );
+  scheduler.setMaxHoldBack( 60000 );
+  scheduler.enqueue( query( "held", StorageQuery::UserWritePriority, "todo:1", true ) );
+  QThread::msleep( 50 );
+  QSemaphore finished;
+  scheduler.enqueue( query( "blocking", StorageQuery::UserWritePriority, "todo:1" ), &finished );
+
+  // The held query only starts waiting in its queue when it is released, so the time it was
+  // held back does neither count for aging nor show up in the waiting time statistics:
+  QList< QueryScheduler::Entry > entries = scheduler.takeAll();
+  QCOMPARE( names( entries ), QStringList() << "held" << "blocking" );
+  qint64 heldSince = entries.at( 0 ).readyAt - 60000;
+  QVERIFY( entries.at( 0 ).enqueuedAt - heldSince >= 50 );
+  QVERIFY( scheduler.statistics( StorageQuery::UserWritePriority ).maxWait < 50 );
+}
+
+void QuerySchedulerTest::statistics()
+{
+  QueryScheduler scheduler;
+  scheduler.setHoldBack( 0 );
+  scheduler.enqueue( query( "sync", StorageQuery::BackgroundSyncPriority, "todo:1" ) );
+  scheduler.enqueue( query( "user", StorageQuery::UserWritePriority, "todo:1" ) );
+  scheduler.enqueue( query( "read", StorageQuery::InteractivePriority ) );
+
+  // Moving writes to another queue moves them in the statistics, too:
+  QCOMPARE( scheduler.statistics( StorageQuery::BackgroundSyncPriority ).depth, 0 );
+  QCOMPARE( scheduler.statistics( StorageQuery::BackgroundSyncPriority ).enqueued, 1 );
+  QCOMPARE( scheduler.statistics( StorageQuery::UserWritePriority ).depth, 2 );
+  QCOMPARE( scheduler.statistics( StorageQuery::InteractivePriority ).depth, 1 );
+
+  scheduler.takeAll();
+  QCOMPARE( scheduler.statistics( StorageQuery::UserWritePriority ).depth, 0 );
+  QCOMPARE( scheduler.statistics( StorageQuery::UserWritePriority ).dequeued, 2 );
+  QCOMPARE( scheduler.statistics( StorageQuery::InteractivePriority ).dequeued, 1 );
+
+  QVariantMap map = scheduler.statistics();
+  QCOMPARE( map.size(), StorageQuery::NumPriorities );
+  QCOMPARE( map.value( "userWrite" ).toMap().value( "dequeued" ).toInt(), 2 );
+}
+
+TestQuery *QuerySchedulerTest::query( const QString &name, StorageQuery::Priority priority,
+                                      const QString &key, bool coalescable )
+{
+  TestQuery *result = new TestQuery( name, priority, key, coalescable );
+  m_queries << result;
+  return result;
+}
+
+QStringList QuerySchedulerTest::names( const QList< QueryScheduler::Entry > &entries )
+{
+  QStringList result;
+  for ( const QueryScheduler::Entry &entry : entries ) {
+    result << static_cast< TestQuery* >( entry.query )->name();
+  }
+  return result;
+}
+
+QTEST_GUILESS_MAIN( QuerySchedulerTest )
+
+#include "tst_queryscheduler.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_readtodo
+
+include(../../database.pri)
+
+SOURCES += tst_readtodo.cpp
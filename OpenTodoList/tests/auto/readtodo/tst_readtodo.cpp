@@ -0,0 +1,220 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/queries/readtodo.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+class ReadTodoTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void termsMayMatchDifferentTasks();
+  void termsMustAllMatch();
+  void rankedSearch();
+  void rankedSearchPaged();
+  void pagingByTitleIgnoresCase();
+
+private:
+
+  TestDatabase *m_db;
+  QUuid         m_todoList;
+
+  QStringList search( const QString &filter, int limit = 0 );
+  QStringList readByTitle( const QUuid &todoList, int limit );
+
+};
+
+void ReadTodoTest::init()
+{
+  m_db = new TestDatabase();
+  m_todoList = m_db->addTodoList( "List" );
+}
+
+void ReadTodoTest::cleanup()
+{
+  delete m_db;
+  m_db = nullptr;
+}
+
+void ReadTodoTest::termsMayMatchDifferentTasks()
+{
+  // Each term must be found in the todo or any of its tasks, no matter whether the full text
+  // search index is used or not:
+  QUuid inTodoAndTask = m_db->addTodo( m_todoList, "Buy" );
+  m_db->addTask( inTodoAndTask, "Milk" );
+  QUuid inTwoTasks = m_db->addTodo( m_todoList, "Groceries" );
+  m_db->addTask( inTwoTasks, "Buy bread" );
+  m_db->addTask( inTwoTasks, "Some milk" );
+  m_db->addTodo( m_todoList, "Buy milk" );
+  m_db->addTodo( m_todoList, "Unrelated", "Buy milk in the description" );
+
+  QStringList found = search( "buy milk" );
+  found.sort();
+  QCOMPARE( found, QStringList() << "Buy" << "Buy milk" << "Groceries" << "Unrelated" );
+}
+
+void ReadTodoTest::termsMustAllMatch()
+{
+  QUuid todo = m_db->addTodo( m_todoList, "Buy" );
+  m_db->addTask( todo, "Bread" );
+  m_db->addTodo( m_todoList, "Milk" );
+
+  QCOMPARE( search( "buy milk" ), QStringList() );
+  QCOMPARE( search( "bread" ), QStringList() << "Buy" );
+  QCOMPARE( search( "BUY" ), QStringList() << "Buy" );
+}
+
+void ReadTodoTest::rankedSearch()
+{
+  if ( !TestDatabase::hasFullTextSearch() ) {
+    QSKIP( "SQLite has been built without FTS5, search results are not ranked" );
+  }
+  // By title, the order would be the reverse of the one by rank:
+  QUuid tasksOnly = m_db->addTodo( m_todoList, "A todo", "Nothing to see here" );
+  m_db->addTask( tasksOnly, "Buy milk" );
+  m_db->addTodo( m_todoList, "B buy something",
+                 "Lots of other text in the description, which makes the term less relevant "
+                 "for this todo, even though it is mentioned once: milk" );
+  m_db->addTodo( m_todoList, "C buy milk" );
+  m_db->addTodo( m_todoList, "D bread" );
+
+  QStringList expected = QStringList() << "C buy milk" << "B buy something" << "A todo";
+  QCOMPARE( search( "buy milk" ), expected );
+}
+
+void ReadTodoTest::rankedSearchPaged()
+{
+  if ( !TestDatabase::hasFullTextSearch() ) {
+    QSKIP( "SQLite has been built without FTS5, search results are not ranked" );
+  }
+  QUuid tasksOnly = m_db->addTodo( m_todoList, "A todo" );
+  m_db->addTask( tasksOnly, "Buy milk" );
+  m_db->addTodo( m_todoList, "B buy something",
+                 "Lots of other text in the description, which makes the term less relevant "
+                 "for this todo, even though it is mentioned once: milk" );
+  m_db->addTodo( m_todoList, "C buy milk" );
+  // Equally ranked todos are ordered by the sort key:
+  m_db->addTodo( m_todoList, "E buy milk" );
+  m_db->addTodo( m_todoList, "D buy milk" );
+
+  QStringList expected = QStringList() << "C buy milk" << "D buy milk" << "E buy milk"
+                                       << "B buy something" << "A todo";
+  QCOMPARE( search( "buy milk" ), expected );
+  // Reading one todo per page must yield the same order:
+  QCOMPARE( search( "buy milk", 1 ), expected );
+  QCOMPARE( search( "buy milk", 2 ), expected );
+}
+
+void ReadTodoTest::pagingByTitleIgnoresCase()
+{
+  QUuid otherList = m_db->addTodoList( "Other List" );
+  m_db->addTodo( m_todoList, "b" );
+  m_db->addTodo( otherList, "D" );
+  m_db->addTodo( m_todoList, "C" );
+  m_db->addTodo( otherList, "a" );
+
+  // Paging must use the order the TodoModel shows the todos in, with and without restricting
+  // the todos to one list:
+  for ( int limit = 0; limit <= 2; ++limit ) {
+    QCOMPARE( readByTitle( m_todoList, limit ), QStringList() << "b" << "C" );
+    QCOMPARE( readByTitle( QUuid(), limit ), QStringList() << "a" << "b" << "C" << "D" );
+  }
+}
+
+/**
+   @brief Reads the titles of the todos in the @p todoList in pages of @p limit todos
+
+   Todos are ordered by title case insensitively. If the @p todoList is null, the todos of
+   all lists are read.
+ */
+QStringList ReadTodoTest::readByTitle( const QUuid &todoList, int limit )
+{
+  QStringList result;
+  QVariant afterTitle;
+  int afterId = -1;
+  forever {
+    Queries::ReadTodo query;
+    if ( !todoList.isNull() ) {
+      query.setParentName( todoList );
+    }
+    query.setSortKey( "title", Qt::AscendingOrder, Qt::CaseInsensitive );
+    query.setLimit( limit );
+    if ( afterId >= 0 ) {
+      query.setAfter( afterTitle, afterId );
+    }
+    m_db->database()->runQuery( &query );
+    for ( Todo *todo : query.todos() ) {
+      result << todo->title();
+      afterTitle = todo->title();
+      afterId = todo->id();
+    }
+    if ( limit <= 0 || query.todos().size() < limit ) {
+      break;
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Reads the titles of the todos matching the @p filter ordered by title
+
+   If a @p limit is given, the todos are read in pages of that size, each one starting after
+   the last todo of the previous page (like the TodoModel does).
+ */
+QStringList ReadTodoTest::search( const QString &filter, int limit )
+{
+  QStringList result;
+  QVariant afterTitle;
+  int afterId = -1;
+  forever {
+    Queries::ReadTodo query;
+    query.setParentName( m_todoList );
+    query.setFilter( filter );
+    query.setSortKey( "title" );
+    query.setLimit( limit );
+    if ( afterId >= 0 ) {
+      query.setAfter( afterTitle, afterId );
+    }
+    m_db->database()->runQuery( &query );
+    for ( Todo *todo : query.todos() ) {
+      result << todo->title();
+      afterTitle = todo->title();
+      afterId = todo->id();
+    }
+    if ( limit <= 0 || query.todos().size() < limit ) {
+      break;
+    }
+  }
+  return result;
+}
+
+QTEST_GUILESS_MAIN( ReadTodoTest )
+
+#include "tst_readtodo.moc"
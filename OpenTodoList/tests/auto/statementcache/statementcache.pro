@@ -0,0 +1,11 @@
+TARGET = tst_statementcache
+
+include(../../tests.pri)
+
+QT += sql
+
+HEADERS += ../../../src/database/statementcache.h
+
+SOURCES += \
+  ../../../src/database/statementcache.cpp \
+  tst_statementcache.cpp
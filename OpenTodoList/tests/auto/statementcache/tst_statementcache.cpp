@@ -0,0 +1,173 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "database/statementcache.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+
+class StatementCacheTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void initTestCase();
+  void cleanupTestCase();
+
+  void reusesStatements();
+  void keyedByExactText();
+  void evictsLeastRecentlyUsed();
+  void shrinkingEvicts();
+  void failedStatementsAreNotCached();
+  void resetsBoundValues();
+  void clear();
+
+private:
+
+  QSqlDatabase m_database;
+
+};
+
+void StatementCacheTest::initTestCase()
+{
+  m_database = QSqlDatabase::addDatabase( "QSQLITE", "statementCacheTest" );
+  m_database.setDatabaseName( ":memory:" );
+  QVERIFY( m_database.open() );
+}
+
+void StatementCacheTest::cleanupTestCase()
+{
+  m_database.close();
+  m_database = QSqlDatabase();
+  QSqlDatabase::removeDatabase( "statementCacheTest" );
+}
+
+void StatementCacheTest::reusesStatements()
+{
+  StatementCache cache;
+  QSqlQuery *first = cache.statement( m_database, "SELECT 1;" );
+  QVERIFY( first != nullptr );
+  QCOMPARE( cache.statement( m_database, "SELECT 1;" ), first );
+  QCOMPARE( cache.size(), 1 );
+  QCOMPARE( cache.hits(), Q_UINT64_C( 1 ) );
+  QCOMPARE( cache.misses(), Q_UINT64_C( 1 ) );
+}
+
+void StatementCacheTest::keyedByExactText()
+{
+  // Statements differing in white space only might still differ in meaning (e.g. in string
+  // literals), so they must not share an entry:
+  StatementCache cache;
+  QSqlQuery *single = cache.statement( m_database, "SELECT 'a b';" );
+  QSqlQuery *wide = cache.statement( m_database, "SELECT 'a  b';" );
+  QVERIFY( single != nullptr );
+  QVERIFY( wide != nullptr );
+  QVERIFY( single != wide );
+  QCOMPARE( cache.size(), 2 );
+  QCOMPARE( cache.misses(), Q_UINT64_C( 2 ) );
+
+  QVERIFY( wide->exec() );
+  QVERIFY( wide->next() );
+  QCOMPARE( wide->value( 0 ).toString(), QString( "a  b" ) );
+  wide->finish();
+}
+
+void StatementCacheTest::evictsLeastRecentlyUsed()
+{
+  StatementCache cache( 2 );
+  QSqlQuery *a = cache.statement( m_database, "SELECT 'a';" );
+  cache.statement( m_database, "SELECT 'b';" );
+  // Using "a" again makes "b" the least recently used statement:
+  QCOMPARE( cache.statement( m_database, "SELECT 'a';" ), a );
+  cache.statement( m_database, "SELECT 'c';" );
+  QCOMPARE( cache.size(), 2 );
+  QCOMPARE( cache.evictions(), Q_UINT64_C( 1 ) );
+
+  quint64 misses = cache.misses();
+  QCOMPARE( cache.statement( m_database, "SELECT 'a';" ), a );
+  QCOMPARE( cache.misses(), misses );
+  cache.statement( m_database, "SELECT 'b';" );
+  QCOMPARE( cache.misses(), misses + 1 );
+  QCOMPARE( cache.evictions(), Q_UINT64_C( 2 ) );
+}
+
+void StatementCacheTest::shrinkingEvicts()
+{
+  StatementCache cache( 4 );
+  for ( int i = 0; i < 4; ++i ) {
+    cache.statement( m_database, QString( "SELECT %1;" ).arg( i ) );
+  }
+  QCOMPARE( cache.size(), 4 );
+  cache.setCapacity( 1 );
+  QCOMPARE( cache.capacity(), 1 );
+  QCOMPARE( cache.size(), 1 );
+  QCOMPARE( cache.evictions(), Q_UINT64_C( 3 ) );
+
+  // The most recently used statement is the one kept:
+  quint64 hits = cache.hits();
+  cache.statement( m_database, "SELECT 3;" );
+  QCOMPARE( cache.hits(), hits + 1 );
+}
+
+void StatementCacheTest::failedStatementsAreNotCached()
+{
+  StatementCache cache;
+  QSqlError error;
+  QVERIFY( cache.statement( m_database, "SELECT FROM WHERE;", &error ) == nullptr );
+  QVERIFY( error.isValid() );
+  QCOMPARE( cache.size(), 0 );
+}
+
+void StatementCacheTest::resetsBoundValues()
+{
+  StatementCache cache;
+  QSqlQuery *query = cache.statement( m_database, "SELECT :first, :second;" );
+  QVERIFY( query != nullptr );
+  query->bindValue( ":first", 1 );
+  query->bindValue( ":second", 2 );
+  QVERIFY( query->exec() );
+  query->finish();
+
+  // The next user only binds one of the values; the other one must not leak over:
+  query = cache.statement( m_database, "SELECT :first, :second;" );
+  query->bindValue( ":first", 3 );
+  QVERIFY( query->exec() );
+  QVERIFY( query->next() );
+  QCOMPARE( query->value( 0 ).toInt(), 3 );
+  QVERIFY( query->value( 1 ).isNull() );
+  query->finish();
+}
+
+void StatementCacheTest::clear()
+{
+  StatementCache cache;
+  cache.statement( m_database, "SELECT 1;" );
+  cache.statement( m_database, "SELECT 2;" );
+  cache.clear();
+  QCOMPARE( cache.size(), 0 );
+  quint64 misses = cache.misses();
+  cache.statement( m_database, "SELECT 1;" );
+  QCOMPARE( cache.misses(), misses + 1 );
+}
+
+QTEST_GUILESS_MAIN( StatementCacheTest )
+
+#include "tst_statementcache.moc"
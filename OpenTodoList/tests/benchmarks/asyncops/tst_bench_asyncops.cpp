@@ -0,0 +1,164 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/backendwrapper.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList;
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief A backend doing nothing; the benchmark calls the database interface directly
+ */
+class NullBackend : public IBackend
+{
+public:
+  void setDatabase( IDatabase *database ) override { Q_UNUSED( database ); }
+  void setLocalStorageDirectory( const QString &directory ) override { Q_UNUSED( directory ); }
+  QString name() const override { return TestDatabase::backendName(); }
+  QString title() const override { return name(); }
+  QString description() const override { return QString(); }
+  QSet<Capabilities> capabilities() const override { return QSet<Capabilities>(); }
+  bool start() override { return true; }
+  bool stop() override { return true; }
+  void sync() override {}
+};
+
+/**
+   @brief Compares blocking and asynchronous database calls made by backends
+
+   The calls are made through a BackendWrapper like a backend does, on a database holding
+   NumTodos todos. In the "blocking" rows, each call waits for its query; in the "async" rows,
+   all calls are issued at once and waited for at the end, like LocalXmlBackend does per level
+   of the object hierarchy.
+ */
+class AsyncOpsBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void import_data();
+  void import();
+  void sync_data();
+  void sync();
+
+private:
+
+  static const int NumTodos = 5000;
+
+  TestDatabase   *m_db;
+  NullBackend     m_backend;
+  BackendWrapper *m_wrapper;
+  QUuid           m_todoList;
+  QList<QUuid>    m_todos;
+
+  void addModes();
+
+};
+
+void AsyncOpsBenchmark::init()
+{
+  m_db = new TestDatabase();
+  m_todoList = m_db->addTodoList( "List" );
+  m_todos = m_db->addTodos( m_todoList, NumTodos );
+  m_wrapper = new BackendWrapper( m_db->database(), &m_backend );
+}
+
+void AsyncOpsBenchmark::cleanup()
+{
+  delete m_wrapper;
+  m_wrapper = nullptr;
+  delete m_db;
+  m_db = nullptr;
+}
+
+void AsyncOpsBenchmark::import_data()
+{
+  addModes();
+}
+
+/**
+   @brief Inserts NumTodos new todos one by one, like importing files does
+ */
+void AsyncOpsBenchmark::import()
+{
+  QFETCH( bool, async );
+  IDatabase *database = m_wrapper;
+  QBENCHMARK {
+    for ( int i = 0; i < NumTodos; ++i ) {
+      ITodo *todo = database->createTodo();
+      todo->setUuid( QUuid::createUuid() );
+      todo->setTodoList( m_todoList );
+      todo->setTitle( QString( "Imported todo %1" ).arg( i ) );
+      if ( async ) {
+        database->insertTodoAsync( todo );
+      } else {
+        database->insertTodo( todo );
+        delete todo;
+      }
+    }
+    database->waitForPendingOperations();
+  }
+}
+
+void AsyncOpsBenchmark::sync_data()
+{
+  addModes();
+}
+
+/**
+   @brief Reads all todos and marks them as saved, like a sync pass does
+ */
+void AsyncOpsBenchmark::sync()
+{
+  QFETCH( bool, async );
+  IDatabase *database = m_wrapper;
+  QBENCHMARK {
+    QList<ITodo*> todos = database->getTodos( m_todos ).values();
+    QCOMPARE( todos.size(), NumTodos );
+    for ( ITodo *todo : todos ) {
+      if ( async ) {
+        database->onTodoSavedAsync( todo );
+      } else {
+        database->onTodoSaved( todo );
+        delete todo;
+      }
+    }
+    database->waitForPendingOperations();
+  }
+}
+
+void AsyncOpsBenchmark::addModes()
+{
+  QTest::addColumn<bool>( "async" );
+  QTest::newRow( "blocking" ) << false;
+  QTest::newRow( "async" ) << true;
+}
+
+QTEST_GUILESS_MAIN(AsyncOpsBenchmark)
+
+#include "tst_bench_asyncops.moc"
@@ -0,0 +1,6 @@
+# Common settings for all benchmarks.
+#
+# Benchmarks are registered with CONFIG += benchmark, so they are not run by "make check" but
+# by "make benchmark" (or by starting the test binary directly).
+
+CONFIG += benchmark
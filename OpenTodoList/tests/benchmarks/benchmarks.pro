@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+SUBDIRS = \
+  asyncops \
+  bulkinsert \
+  changelatency \
+  durability \
+  indexes \
+  manifest \
+  parallelimport \
+  rowcursor \
+  writebatch \
+  xmldocument
@@ -0,0 +1,137 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/queries/inserttasks.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Compares inserting objects one by one with inserting them in bulk
+
+   Each iteration imports NumTodos new todos with TasksPerTodo tasks each (50,000 objects in
+   total) into a list, the way a backend imports a directory on its first start: All todos
+   first, then all tasks. Every object carries a meta attribute with its file name.
+ */
+class BulkInsertBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void init();
+  void cleanup();
+
+  void import_data();
+  void import();
+
+private:
+
+  static const int NumTodos = 10000;
+  static const int TasksPerTodo = 4;
+
+  /**
+     @brief The number of objects passed to a single bulk insertion
+
+     This is what LocalXmlBackend uses.
+   */
+  static const int BatchSize = 256;
+
+  TestDatabase *m_db;
+  QUuid         m_todoList;
+
+  template<typename T, typename InsertOne, typename InsertMany>
+  void insert( const QList<T*> &objects, bool bulk );
+
+};
+
+void BulkInsertBenchmark::init()
+{
+  m_db = new TestDatabase();
+  m_todoList = m_db->addTodoList( "List" );
+}
+
+void BulkInsertBenchmark::cleanup()
+{
+  delete m_db;
+  m_db = nullptr;
+}
+
+void BulkInsertBenchmark::import_data()
+{
+  QTest::addColumn<bool>( "bulk" );
+  QTest::newRow( "single" ) << false;
+  QTest::newRow( "bulk" ) << true;
+}
+
+void BulkInsertBenchmark::import()
+{
+  QFETCH( bool, bulk );
+  QBENCHMARK {
+    QList<Todo*> todos;
+    QList<Task*> tasks;
+    for ( int i = 0; i < NumTodos; ++i ) {
+      Todo *todo = new Todo();
+      todo->setUuid( QUuid::createUuid() );
+      todo->setTodoList( m_todoList );
+      todo->setTitle( QString( "Todo %1" ).arg( i ) );
+      todo->setWeight( i );
+      todo->insertMetaAttribute( "fileName", QString( "list/todos/%1.xml" ).arg( i ) );
+      todos << todo;
+      for ( int j = 0; j < TasksPerTodo; ++j ) {
+        Task *task = new Task();
+        task->setUuid( QUuid::createUuid() );
+        task->setTodo( todo->uuid() );
+        task->setTitle( QString( "Task %1" ).arg( j ) );
+        task->setWeight( j );
+        task->insertMetaAttribute( "fileName",
+                                   QString( "list/todos/%1/%2.xml" ).arg( i ).arg( j ) );
+        tasks << task;
+      }
+    }
+    insert<Todo, Queries::InsertTodo, Queries::InsertTodos>( todos, bulk );
+    insert<Task, Queries::InsertTask, Queries::InsertTasks>( tasks, bulk );
+    qDeleteAll( todos );
+    qDeleteAll( tasks );
+  }
+}
+
+template<typename T, typename InsertOne, typename InsertMany>
+void BulkInsertBenchmark::insert( const QList<T*> &objects, bool bulk )
+{
+  if ( bulk ) {
+    for ( int i = 0; i < objects.size(); i += BatchSize ) {
+      InsertMany query( objects.mid( i, BatchSize ) );
+      m_db->database()->runQuery( &query );
+    }
+  } else {
+    for ( T *object : objects ) {
+      InsertOne query( object, false );
+      m_db->database()->runQuery( &query );
+    }
+  }
+}
+
+QTEST_GUILESS_MAIN(BulkInsertBenchmark)
+
+#include "tst_bench_bulkinsert.moc"
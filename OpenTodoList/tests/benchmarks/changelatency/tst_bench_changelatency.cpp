@@ -0,0 +1,118 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+#include "testfiles.h"
+
+#include "database/backendwrapper.h"
+#include "database/queries/readtodo.h"
+
+#include "localxmlbackend.h"
+
+#include <QElapsedTimer>
+#include <QtTest>
+
+using namespace OpenTodoList;
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Measures how long it takes until a change to a file shows up in the database
+
+   The backend's directory holds a single list with the number of todos given by the row.
+   Each iteration rewrites the file of one todo with a new title and waits until the database
+   returns that title. This includes the delay the backend waits for further changes before
+   importing them (LocalXmlBackend::ImportDelay), so only the time above that delay is spent
+   on picking up the change.
+ */
+class ChangeLatencyBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void externalChange_data();
+  void externalChange();
+
+private:
+
+  static const int Timeout = 10000;
+
+  static QString title( Database *database, const QUuid &uuid );
+
+};
+
+void ChangeLatencyBenchmark::externalChange_data()
+{
+  QTest::addColumn<int>( "numTodos" );
+  QTest::newRow( "10 todos" ) << 10;
+  QTest::newRow( "10000 todos" ) << 10000;
+}
+
+void ChangeLatencyBenchmark::externalChange()
+{
+  QFETCH( int, numTodos );
+  QTemporaryDir dir;
+  QVERIFY( dir.isValid() );
+  QString list = dir.path() + "/list";
+  QVERIFY( TestFiles::writeFile( list + "/config.xml",
+                                 TestFiles::todoListXml( QUuid::createUuid(), "List" ) ) );
+  QUuid uuid;
+  for ( int i = 0; i < numTodos; ++i ) {
+    uuid = QUuid::createUuid();
+    QVERIFY( TestFiles::writeFile( list + QString( "/todos/todo%1.xml" ).arg( i ),
+                                   TestFiles::todoXml( uuid, QString( "Todo %1" ).arg( i ) ) ) );
+  }
+  QString fileName = list + QString( "/todos/todo%1.xml" ).arg( numTodos - 1 );
+
+  TestDatabase db;
+  LocalXmlBackend backend;
+  BackendWrapper wrapper( db.database(), &backend );
+  wrapper.setLocalStorageDirectory( dir.path() );
+  QVERIFY( wrapper.start() );
+  QCOMPARE( title( db.database(), uuid ), QString( "Todo %1" ).arg( numTodos - 1 ) );
+
+  int change = 0;
+  QBENCHMARK {
+    QString changed = QString( "Changed %1" ).arg( ++change );
+    QVERIFY( TestFiles::writeFile( fileName, TestFiles::todoXml( uuid, changed ) ) );
+    QElapsedTimer timer;
+    timer.start();
+    while ( title( db.database(), uuid ) != changed ) {
+      QVERIFY2( !timer.hasExpired( Timeout ), "The change has not been imported" );
+      QTest::qWait( 1 );
+    }
+  }
+  QVERIFY( wrapper.stop() );
+}
+
+/**
+   @brief Returns the title of the todo with the @p uuid as stored in the @p database
+ */
+QString ChangeLatencyBenchmark::title( Database *database, const QUuid &uuid )
+{
+  Queries::ReadTodo query;
+  query.setUuid( uuid );
+  database->runQuery( &query );
+  return query.todos().isEmpty() ? QString() : query.todos().first()->title();
+}
+
+QTEST_GUILESS_MAIN(ChangeLatencyBenchmark)
+
+#include "tst_bench_changelatency.moc"
@@ -0,0 +1,158 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/databaseworker.h"
+#include "database/queries/readtodo.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Measures the write and read throughput of the database profiles
+
+   Each benchmark runs on a freshly generated database of NumTodos todos, using the profile
+   given by the data row.
+ */
+class DurabilityBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void cleanup();
+
+  void singleWrites_data();
+  void singleWrites();
+  void bulkWrite_data();
+  void bulkWrite();
+  void readAll_data();
+  void readAll();
+
+private:
+
+  static const int NumTodos = 100000;
+  static const int NumWrites = 100;
+
+  void addProfiles();
+  TestDatabase *createDatabase( QUuid *todoList, QList<QUuid> *todos );
+
+};
+
+void DurabilityBenchmark::cleanup()
+{
+  qunsetenv( "OPENTODOLIST_DATABASE_PROFILE" );
+}
+
+void DurabilityBenchmark::singleWrites_data()
+{
+  addProfiles();
+}
+
+/**
+   @brief Updates NumWrites todos, each one in its own transaction (like edits done in the UI)
+ */
+void DurabilityBenchmark::singleWrites()
+{
+  QUuid todoList;
+  QList<QUuid> uuids;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoList, &uuids ) );
+  int run = 0;
+  QBENCHMARK {
+    ++run;
+    for ( int i = 0; i < NumWrites; ++i ) {
+      Todo todo;
+      todo.setUuid( uuids.at( i ) );
+      todo.setTodoList( todoList );
+      todo.setTitle( QString( "Todo %1 (run %2)" ).arg( i ).arg( run ) );
+      Queries::InsertTodo query( &todo, true );
+      db->database()->runQuery( &query );
+    }
+  }
+}
+
+void DurabilityBenchmark::bulkWrite_data()
+{
+  addProfiles();
+}
+
+/**
+   @brief Adds NumTodos todos in one go (like the initial import of a backend)
+ */
+void DurabilityBenchmark::bulkWrite()
+{
+  QUuid todoList;
+  QList<QUuid> uuids;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoList, &uuids ) );
+  QBENCHMARK {
+    db->addTodos( todoList, NumTodos );
+  }
+}
+
+void DurabilityBenchmark::readAll_data()
+{
+  addProfiles();
+}
+
+/**
+   @brief Reads all NumTodos todos of the list
+ */
+void DurabilityBenchmark::readAll()
+{
+  QUuid todoList;
+  QList<QUuid> uuids;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoList, &uuids ) );
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setParentName( todoList );
+    db->database()->runQuery( &query );
+    QCOMPARE( query.todos().size(), NumTodos );
+  }
+}
+
+void DurabilityBenchmark::addProfiles()
+{
+  QTest::addColumn<QString>( "profile" );
+  for ( DatabaseWorker::Profile profile : { DatabaseWorker::SafeProfile,
+                                            DatabaseWorker::BalancedProfile,
+                                            DatabaseWorker::FastProfile } ) {
+    QString name = DatabaseWorker::profileToString( profile );
+    QTest::newRow( qPrintable( name ) ) << name;
+  }
+}
+
+/**
+   @brief Creates a database using the current row's profile and fills it with NumTodos todos
+ */
+TestDatabase *DurabilityBenchmark::createDatabase( QUuid *todoList, QList<QUuid> *todos )
+{
+  QFETCH( QString, profile );
+  qputenv( "OPENTODOLIST_DATABASE_PROFILE", profile.toUtf8() );
+  TestDatabase *result = new TestDatabase();
+  *todoList = result->addTodoList( "List" );
+  *todos = result->addTodos( *todoList, NumTodos );
+  return result;
+}
+
+QTEST_GUILESS_MAIN(DurabilityBenchmark)
+
+#include "tst_bench_durability.moc"
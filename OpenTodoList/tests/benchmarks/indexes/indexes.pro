@@ -0,0 +1,6 @@
+TARGET = tst_bench_indexes
+
+include(../../database.pri)
+include(../benchmarks.pri)
+
+SOURCES += tst_bench_indexes.cpp
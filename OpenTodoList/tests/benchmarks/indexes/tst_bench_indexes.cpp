@@ -0,0 +1,251 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/queries/readtodo.h"
+#include "database/storagequery.h"
+
+#include <QtTest>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Drops all secondary indexes, leaving only the ones of primary keys and unique columns
+
+   This turns the schema back into what version 0 provided.
+ */
+class DropIndexes : public StorageQuery
+{
+public:
+
+  DropIndexes() :
+    StorageQuery(),
+    m_listed( false ),
+    m_names()
+  {
+  }
+
+  bool query( QString &query, QVariantMap &args, int &options ) override {
+    Q_UNUSED( args );
+    Q_UNUSED( options );
+    if ( !m_listed ) {
+      m_listed = true;
+      query = "SELECT name FROM sqlite_master WHERE type = 'index' AND sql IS NOT NULL;";
+    } else {
+      query = "DROP INDEX " + m_names.takeFirst() + ";";
+    }
+    return true;
+  }
+
+  void recordAvailable( const QVariantMap &record ) override {
+    m_names << record.value( "name" ).toString();
+  }
+
+  bool hasNext() const override {
+    return !m_names.isEmpty();
+  }
+
+private:
+
+  bool        m_listed;
+  QStringList m_names;
+
+};
+
+/**
+   @brief Updates the statistics of the query planner
+
+   The application does this in the background after adding indexes (see
+   DatabaseWorker::updateSchema()). Empty indexes get no statistics, which is when the planner
+   is most likely to pick a worse index.
+ */
+class Analyze : public StorageQuery
+{
+public:
+
+  bool query( QString &query, QVariantMap &args, int &options ) override {
+    Q_UNUSED( args );
+    Q_UNUSED( options );
+    query = "ANALYZE;";
+    return true;
+  }
+
+};
+
+/**
+   @brief Compares the scans done by models and backends with and without secondary indexes
+
+   Each benchmark runs on a freshly generated database with NumTodoLists lists of
+   NumTodosPerList todos each, of which NumDirtyTodos have been changed locally.
+ */
+class IndexesBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void refreshModel_data();
+  void refreshModel();
+  void scheduledTodos_data();
+  void scheduledTodos();
+  void syncScanDirty_data();
+  void syncScanDirty();
+  void syncScanDisposed_data();
+  void syncScanDisposed();
+
+private:
+
+  static const int NumTodoLists = 100;
+  static const int NumTodosPerList = 1000;
+  static const int NumDirtyTodos = 100;
+
+  void addSchemas();
+  TestDatabase *createDatabase( QList<QUuid> *todoLists );
+
+};
+
+void IndexesBenchmark::refreshModel_data()
+{
+  addSchemas();
+}
+
+/**
+   @brief Reads the todos of one list ordered by weight, like the todo list page does
+ */
+void IndexesBenchmark::refreshModel()
+{
+  QList<QUuid> todoLists;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoLists ) );
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setParentName( todoLists.at( NumTodoLists / 2 ) );
+    query.setSortKey( "weight" );
+    query.setShowDone( false );
+    db->database()->runQuery( &query );
+    QVERIFY( !query.todos().isEmpty() );
+  }
+}
+
+void IndexesBenchmark::scheduledTodos_data()
+{
+  addSchemas();
+}
+
+/**
+   @brief Reads the todos due within an hour across all lists, like the schedule view does
+ */
+void IndexesBenchmark::scheduledTodos()
+{
+  QList<QUuid> todoLists;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoLists ) );
+  QDateTime from( QDate( 2015, 1, 1 ) );
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setMinDueDate( from );
+    query.setMaxDueDate( from.addSecs( 3600 ) );
+    db->database()->runQuery( &query );
+    QVERIFY( !query.todos().isEmpty() );
+  }
+}
+
+void IndexesBenchmark::syncScanDirty_data()
+{
+  addSchemas();
+}
+
+/**
+   @brief Looks up the locally changed todos, like a backend does on every sync
+ */
+void IndexesBenchmark::syncScanDirty()
+{
+  QList<QUuid> todoLists;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoLists ) );
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setOnlyModified( true );
+    db->database()->runQuery( &query );
+    QCOMPARE( query.todos().size(), NumDirtyTodos );
+  }
+}
+
+void IndexesBenchmark::syncScanDisposed_data()
+{
+  addSchemas();
+}
+
+/**
+   @brief Looks up the todos deleted locally, like a backend does on every sync
+ */
+void IndexesBenchmark::syncScanDisposed()
+{
+  QList<QUuid> todoLists;
+  QScopedPointer<TestDatabase> db( createDatabase( &todoLists ) );
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setOnlyDeleted( true );
+    db->database()->runQuery( &query );
+    QVERIFY( query.todos().isEmpty() );
+  }
+}
+
+void IndexesBenchmark::addSchemas()
+{
+  QTest::addColumn<bool>( "indexed" );
+  QTest::newRow( "indexed" ) << true;
+  QTest::newRow( "unindexed" ) << false;
+}
+
+/**
+   @brief Creates and fills a database; drops the secondary indexes if the row asks for it
+
+   Afterwards, the planner statistics are updated as the application would do.
+ */
+TestDatabase *IndexesBenchmark::createDatabase( QList<QUuid> *todoLists )
+{
+  QFETCH( bool, indexed );
+  TestDatabase *result = new TestDatabase();
+  QList<QUuid> todos;
+  for ( int i = 0; i < NumTodoLists; ++i ) {
+    QUuid todoList = result->addTodoList( QString( "List %1" ).arg( i ) );
+    *todoLists << todoList;
+    todos << result->addTodos( todoList, NumTodosPerList );
+  }
+  for ( int i = 0; i < NumDirtyTodos; ++i ) {
+    Todo todo;
+    int index = i * todos.size() / NumDirtyTodos;
+    todo.setUuid( todos.at( index ) );
+    todo.setTodoList( todoLists->at( index / NumTodosPerList ) );
+    todo.setTitle( QString( "Changed todo %1" ).arg( i ) );
+    Queries::InsertTodo query( &todo, true );
+    result->database()->runQuery( &query );
+  }
+  if ( !indexed ) {
+    DropIndexes query;
+    result->database()->runQuery( &query );
+  }
+  Analyze analyze;
+  result->database()->runQuery( &analyze );
+  return result;
+}
+
+QTEST_GUILESS_MAIN(IndexesBenchmark)
+
+#include "tst_bench_indexes.moc"
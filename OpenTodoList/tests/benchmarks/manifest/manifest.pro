@@ -0,0 +1,23 @@
+TARGET = tst_bench_manifest
+
+include(../../database.pri)
+include(../benchmarks.pri)
+
+# The backend is built into the benchmark and driven directly through a BackendWrapper:
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+QT += concurrent
+INCLUDEPATH += $$BACKEND_DIR $$PWD/../../../inc/core
+
+SOURCES += \
+    tst_bench_manifest.cpp \
+    $$BACKEND_DIR/localxmlbackend.cpp \
+    $$BACKEND_DIR/localxmldocument.cpp \
+    $$BACKEND_DIR/localxmlmanifest.cpp \
+    $$BACKEND_DIR/localxmlwritebatch.cpp
+
+HEADERS += \
+    $$BACKEND_DIR/localxmlbackend.h \
+    $$BACKEND_DIR/localxmldocument.h \
+    $$BACKEND_DIR/localxmlmanifest.h \
+    $$BACKEND_DIR/localxmlwritebatch.h
@@ -0,0 +1,120 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+#include "testfiles.h"
+
+#include "database/backendwrapper.h"
+#include "database/queries/readtodo.h"
+
+#include "localxmlbackend.h"
+#include "localxmlmanifest.h"
+
+#include <QFile>
+#include <QtTest>
+
+using namespace OpenTodoList;
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Measures how long the LocalXmlBackend takes to start up
+
+   The backend's directory holds NumTodoLists lists with NumTodosPerList todo files each. In the
+   "cold" rows, the manifest is removed before each start, so every file is read and parsed
+   again. In the "warm" rows, the manifest written by the previous run is used and no file
+   needs to be read. The backend is stopped again within the measured block, which only
+   removes the file system watches.
+ */
+class ManifestBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void initTestCase();
+
+  void startup_data();
+  void startup();
+
+private:
+
+  static const int NumTodoLists = 100;
+  static const int NumTodosPerList = 200;
+
+  QTemporaryDir m_dir;
+
+};
+
+/**
+   @brief Creates the files read by the backend
+ */
+void ManifestBenchmark::initTestCase()
+{
+  QVERIFY( m_dir.isValid() );
+  for ( int i = 0; i < NumTodoLists; ++i ) {
+    QString list = m_dir.path() + QString( "/list%1" ).arg( i );
+    QVERIFY( TestFiles::writeFile(
+               list + "/config.xml",
+               TestFiles::todoListXml( QUuid::createUuid(), QString( "List %1" ).arg( i ) ) ) );
+    for ( int j = 0; j < NumTodosPerList; ++j ) {
+      QVERIFY( TestFiles::writeFile(
+                 list + QString( "/todos/todo%1.xml" ).arg( j ),
+                 TestFiles::todoXml( QUuid::createUuid(), QString( "Todo %1" ).arg( j ),
+                                     QString( "Description of todo %1" ).arg( j ) ) ) );
+    }
+  }
+}
+
+void ManifestBenchmark::startup_data()
+{
+  QTest::addColumn<bool>( "warm" );
+  QTest::newRow( "cold" ) << false;
+  QTest::newRow( "warm" ) << true;
+}
+
+void ManifestBenchmark::startup()
+{
+  QFETCH( bool, warm );
+  TestDatabase db;
+  LocalXmlBackend backend;
+  BackendWrapper wrapper( db.database(), &backend );
+  wrapper.setLocalStorageDirectory( m_dir.path() );
+
+  // The first start imports everything into the fresh database and writes the manifest:
+  QVERIFY( wrapper.start() );
+  QVERIFY( wrapper.stop() );
+  Queries::ReadTodo query;
+  db.database()->runQuery( &query );
+  QCOMPARE( query.todos().size(), NumTodoLists * NumTodosPerList );
+
+  QString manifest = m_dir.path() + "/" + LocalXmlManifest::FileName;
+  QVERIFY( QFile::exists( manifest ) );
+  QBENCHMARK {
+    if ( !warm ) {
+      QFile::remove( manifest );
+    }
+    QVERIFY( wrapper.start() );
+    QVERIFY( wrapper.stop() );
+  }
+}
+
+QTEST_GUILESS_MAIN(ManifestBenchmark)
+
+#include "tst_bench_manifest.moc"
@@ -0,0 +1,143 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+#include "testfiles.h"
+
+#include "database/backendwrapper.h"
+#include "database/queries/readtask.h"
+#include "database/queries/readtodo.h"
+
+#include "localxmlbackend.h"
+#include "localxmlmanifest.h"
+
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtTest>
+
+using namespace OpenTodoList;
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+/**
+   @brief Measures how the start up import of the LocalXmlBackend scales with the thread count
+
+   The backend's directory holds NumTodoLists lists with NumTodosPerList todos, each of which
+   has NumTasksPerTodo tasks. Before each start, the manifest is removed, so all files are read
+   and parsed again. The files are parsed in the global thread pool, whose size is limited to
+   the number of threads of the row.
+ */
+class ParallelImportBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void initTestCase();
+  void cleanup();
+
+  void coldStart_data();
+  void coldStart();
+
+private:
+
+  static const int NumTodoLists = 50;
+  static const int NumTodosPerList = 100;
+  static const int NumTasksPerTodo = 2;
+
+  QTemporaryDir m_dir;
+  int           m_maxThreadCount;
+
+};
+
+/**
+   @brief Creates the files read by the backend
+ */
+void ParallelImportBenchmark::initTestCase()
+{
+  m_maxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+  QVERIFY( m_dir.isValid() );
+  for ( int i = 0; i < NumTodoLists; ++i ) {
+    QString list = m_dir.path() + QString( "/list%1" ).arg( i );
+    QVERIFY( TestFiles::writeFile(
+               list + "/config.xml",
+               TestFiles::todoListXml( QUuid::createUuid(), QString( "List %1" ).arg( i ) ) ) );
+    for ( int j = 0; j < NumTodosPerList; ++j ) {
+      QString todo = list + QString( "/todos/todo%1" ).arg( j );
+      QVERIFY( TestFiles::writeFile(
+                 todo + ".xml",
+                 TestFiles::todoXml( QUuid::createUuid(), QString( "Todo %1" ).arg( j ),
+                                     QString( "Description of todo %1" ).arg( j ) ) ) );
+      for ( int k = 0; k < NumTasksPerTodo; ++k ) {
+        QVERIFY( TestFiles::writeFile(
+                   todo + QString( "/task%1.xml" ).arg( k ),
+                   TestFiles::taskXml( QUuid::createUuid(), QString( "Task %1" ).arg( k ), k ) ) );
+      }
+    }
+  }
+}
+
+void ParallelImportBenchmark::cleanup()
+{
+  QThreadPool::globalInstance()->setMaxThreadCount( m_maxThreadCount );
+}
+
+void ParallelImportBenchmark::coldStart_data()
+{
+  QTest::addColumn<int>( "threads" );
+  QList<int> counts = { 1, 2, 4 };
+  if ( !counts.contains( QThread::idealThreadCount() ) ) {
+    counts << QThread::idealThreadCount();
+  }
+  for ( int count : counts ) {
+    QTest::newRow( qPrintable( QString( "%1 threads" ).arg( count ) ) ) << count;
+  }
+}
+
+void ParallelImportBenchmark::coldStart()
+{
+  QFETCH( int, threads );
+  TestDatabase db;
+  LocalXmlBackend backend;
+  BackendWrapper wrapper( db.database(), &backend );
+  wrapper.setLocalStorageDirectory( m_dir.path() );
+
+  // The first start fills the fresh database, so all further starts update existing objects:
+  QVERIFY( wrapper.start() );
+  QVERIFY( wrapper.stop() );
+  Queries::ReadTodo readTodos;
+  db.database()->runQuery( &readTodos );
+  QCOMPARE( readTodos.todos().size(), NumTodoLists * NumTodosPerList );
+  Queries::ReadTask readTasks;
+  db.database()->runQuery( &readTasks );
+  QCOMPARE( readTasks.tasks().size(), NumTodoLists * NumTodosPerList * NumTasksPerTodo );
+
+  QThreadPool::globalInstance()->setMaxThreadCount( threads );
+  QString manifest = m_dir.path() + "/" + LocalXmlManifest::FileName;
+  QBENCHMARK {
+    QFile::remove( manifest );
+    QVERIFY( wrapper.start() );
+    QVERIFY( wrapper.stop() );
+  }
+}
+
+QTEST_GUILESS_MAIN(ParallelImportBenchmark)
+
+#include "tst_bench_parallelimport.moc"
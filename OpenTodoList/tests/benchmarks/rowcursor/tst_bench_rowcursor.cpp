@@ -0,0 +1,231 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "testdatabase.h"
+
+#include "database/queries/readtodo.h"
+#include "database/rowcursor.h"
+#include "database/storagequery.h"
+
+#include <QtTest>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace OpenTodoList::DataBase;
+using namespace OpenTodoList::Tests;
+
+namespace {
+
+std::atomic<bool>    countingAllocations( false );
+std::atomic<quint64> allocationCount( 0 );
+
+}
+
+/*
+   Counts the allocations done while countingAllocations is set, in any thread (the queries are
+   run by the database worker's thread). The array forms use these as well.
+ */
+void *operator new( std::size_t size )
+{
+  if ( countingAllocations ) {
+    ++allocationCount;
+  }
+  void *result = std::malloc( size > 0 ? size : 1 );
+  if ( result == nullptr ) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void operator delete( void *pointer ) noexcept
+{
+  std::free( pointer );
+}
+
+/**
+   @brief Scans all todos, reading each row either through the cursor or as a map
+ */
+class ScanTodos : public StorageQuery
+{
+public:
+
+  explicit ScanTodos( bool useCursor ) :
+    StorageQuery(),
+    m_useCursor( useCursor ),
+    m_rows( 0 ),
+    m_checksum( 0 )
+  {
+  }
+
+  int rows() const { return m_rows; }
+  qint64 checksum() const { return m_checksum; }
+
+  bool query( QString &query, QVariantMap &args, int &options ) override {
+    Q_UNUSED( args );
+    Q_UNUSED( options );
+    query = "SELECT id, uuid, title, description, priority, weight, done, dueDate FROM todo;";
+    return true;
+  }
+
+  void columnsAvailable( const RowCursor &cursor ) override {
+    m_id = cursor.indexOf( "id" );
+    m_title = cursor.indexOf( "title" );
+    m_description = cursor.indexOf( "description" );
+    m_priority = cursor.indexOf( "priority" );
+    m_weight = cursor.indexOf( "weight" );
+    m_done = cursor.indexOf( "done" );
+  }
+
+  void rowAvailable( const RowCursor &cursor ) override {
+    if ( !m_useCursor ) {
+      // What all queries did before: Build a map per row and look up the values by name
+      StorageQuery::rowAvailable( cursor );
+      return;
+    }
+    ++m_rows;
+    m_checksum += cursor.toInt( m_id ) + cursor.toString( m_title ).length() +
+        cursor.toString( m_description ).length() + cursor.toInt( m_priority ) +
+        static_cast< qint64 >( cursor.toDouble( m_weight ) ) + cursor.toBool( m_done );
+  }
+
+  void recordAvailable( const QVariantMap &record ) override {
+    ++m_rows;
+    m_checksum += record.value( "id" ).toInt() + record.value( "title" ).toString().length() +
+        record.value( "description" ).toString().length() + record.value( "priority" ).toInt() +
+        static_cast< qint64 >( record.value( "weight" ).toDouble() ) +
+        record.value( "done" ).toBool();
+  }
+
+private:
+
+  bool   m_useCursor;
+  int    m_rows;
+  qint64 m_checksum;
+  int    m_id;
+  int    m_title;
+  int    m_description;
+  int    m_priority;
+  int    m_weight;
+  int    m_done;
+
+};
+
+/**
+   @brief Measures reading many rows from the database
+ */
+class RowCursorBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void initTestCase();
+  void cleanupTestCase();
+
+  void scan_data();
+  void scan();
+  void allocations();
+  void readTodos();
+
+private:
+
+  static const int NumTodos = 100000;
+
+  TestDatabase *m_db;
+  QUuid         m_todoList;
+
+};
+
+void RowCursorBenchmark::initTestCase()
+{
+  m_db = new TestDatabase();
+  m_todoList = m_db->addTodoList( "List" );
+  m_db->addTodos( m_todoList, NumTodos );
+}
+
+void RowCursorBenchmark::cleanupTestCase()
+{
+  delete m_db;
+  m_db = nullptr;
+}
+
+void RowCursorBenchmark::scan_data()
+{
+  QTest::addColumn<bool>( "useCursor" );
+  QTest::newRow( "cursor" ) << true;
+  QTest::newRow( "map" ) << false;
+}
+
+/**
+   @brief Reads the same columns of all todos with positional or name based access
+
+   This isolates the per row cost of handing the rows over to a query.
+ */
+void RowCursorBenchmark::scan()
+{
+  QFETCH( bool, useCursor );
+  QBENCHMARK {
+    ScanTodos query( useCursor );
+    m_db->database()->runQuery( &query );
+    QCOMPARE( query.rows(), NumTodos );
+  }
+}
+
+/**
+   @brief Counts the allocations per row done when scanning the todos
+
+   Reading the values through the cursor does not allocate, so the cursor's count is what the
+   SQLite driver itself allocates per row (one QString per non-NULL text column). The
+   difference to the map's count is the cost of building a map per row.
+ */
+void RowCursorBenchmark::allocations()
+{
+  auto allocationsPerRow = [this] ( bool useCursor ) {
+    ScanTodos query( useCursor );
+    allocationCount = 0;
+    countingAllocations = true;
+    m_db->database()->runQuery( &query );
+    countingAllocations = false;
+    return query.rows() == NumTodos ? double( allocationCount ) / NumTodos : -1.0;
+  };
+  double cursor = allocationsPerRow( true );
+  double map = allocationsPerRow( false );
+  qDebug() << "Allocations per row: cursor" << cursor << "map" << map;
+  QVERIFY( cursor >= 0 && map >= 0 );
+  QVERIFY( cursor < map );
+}
+
+/**
+   @brief Reads all todos into objects, like a model showing the whole list
+ */
+void RowCursorBenchmark::readTodos()
+{
+  QBENCHMARK {
+    Queries::ReadTodo query;
+    query.setParentName( m_todoList );
+    m_db->database()->runQuery( &query );
+    QCOMPARE( query.todos().size(), NumTodos );
+  }
+}
+
+QTEST_GUILESS_MAIN(RowCursorBenchmark)
+
+#include "tst_bench_rowcursor.moc"
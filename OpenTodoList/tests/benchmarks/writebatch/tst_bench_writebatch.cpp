@@ -0,0 +1,136 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "localxmlwritebatch.h"
+
+#include "testfiles.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <QUuid>
+
+/**
+   @brief Measures how fast a sync pass can save files
+
+   Each iteration saves NumFiles files spread over NumDirectories directories, like a sync
+   pass saving changed todos does. The rows are:
+
+   - plain: the files are overwritten in place without flushing them, like the backend did
+     before (not crash safe)
+   - per file: each file is written through a LocalXmlWriteBatch which is committed right away,
+     so the file's directory is flushed once per file
+   - batch: all files are written through one LocalXmlWriteBatch which is committed at the end,
+     so each directory is flushed once per iteration
+ */
+class WriteBatchBenchmark : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  enum Mode {
+    Plain,
+    PerFile,
+    Batch
+  };
+
+private slots:
+
+  void initTestCase();
+
+  void save_data();
+  void save();
+
+private:
+
+  static const int NumFiles = 500;
+  static const int NumDirectories = 10;
+
+  QTemporaryDir m_dir;
+
+  static QString fileName( int index );
+  static QByteArray content( int index );
+
+};
+
+Q_DECLARE_METATYPE( WriteBatchBenchmark::Mode )
+
+void WriteBatchBenchmark::initTestCase()
+{
+  QVERIFY( m_dir.isValid() );
+  for ( int i = 0; i < NumDirectories; ++i ) {
+    QVERIFY( QDir( m_dir.path() ).mkpath( QString( "list%1/todos" ).arg( i ) ) );
+  }
+}
+
+void WriteBatchBenchmark::save_data()
+{
+  QTest::addColumn<Mode>( "mode" );
+  QTest::newRow( "plain" ) << Plain;
+  QTest::newRow( "per file" ) << PerFile;
+  QTest::newRow( "batch" ) << Batch;
+}
+
+void WriteBatchBenchmark::save()
+{
+  QFETCH( Mode, mode );
+  LocalXmlWriteBatch batch( m_dir.path() );
+  QBENCHMARK {
+    for ( int i = 0; i < NumFiles; ++i ) {
+      switch ( mode ) {
+      case Plain:
+      {
+        QFile file( m_dir.path() + "/" + fileName( i ) );
+        QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+        QVERIFY( file.write( content( i ) ) >= 0 );
+        break;
+      }
+      case PerFile:
+        QVERIFY( batch.write( fileName( i ), content( i ) ) );
+        QCOMPARE( batch.commit().size(), 1 );
+        break;
+      case Batch:
+        QVERIFY( batch.write( fileName( i ), content( i ) ) );
+        break;
+      }
+    }
+    if ( mode == Batch ) {
+      QCOMPARE( batch.commit().size(), NumFiles );
+    }
+  }
+}
+
+QString WriteBatchBenchmark::fileName( int index )
+{
+  return QString( "list%1/todos/todo%2.xml" ).arg( index % NumDirectories ).arg( index );
+}
+
+QByteArray WriteBatchBenchmark::content( int index )
+{
+  return OpenTodoList::Tests::TestFiles::todoXml(
+        QUuid::createUuidV5( QUuid(), QString::number( index ) ),
+        QString( "Todo %1" ).arg( index ),
+        QString( "Description of todo %1" ).arg( index ) );
+}
+
+QTEST_GUILESS_MAIN(WriteBatchBenchmark)
+
+#include "tst_bench_writebatch.moc"
@@ -0,0 +1,14 @@
+TARGET = tst_bench_writebatch
+
+include(../../tests.pri)
+include(../benchmarks.pri)
+
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+INCLUDEPATH += $$BACKEND_DIR
+
+HEADERS += $$BACKEND_DIR/localxmlwritebatch.h
+
+SOURCES += \
+  $$BACKEND_DIR/localxmlwritebatch.cpp \
+  tst_bench_writebatch.cpp
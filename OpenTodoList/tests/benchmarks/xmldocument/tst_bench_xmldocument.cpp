@@ -0,0 +1,178 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "localxmldocument.h"
+
+#include <QDomDocument>
+#include <QtTest>
+#include <QUuid>
+
+/**
+   @brief Compares LocalXmlDocument with the QDomDocument based code it replaced
+
+   Each iteration reads or writes NumFiles todo files held in memory, so only the XML handling
+   is measured and not the file system. The "dom" rows do what LocalXmlBackend did before.
+ */
+class XmlDocumentBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void initTestCase();
+
+  void read_data();
+  void read();
+  void write_data();
+  void write();
+
+private:
+
+  static const int NumFiles = 1000;
+
+  QList<QByteArray> m_files;
+
+  static void addModes();
+  static QString description( int index );
+
+};
+
+/**
+   @brief Creates the content of the files read by the benchmark
+ */
+void XmlDocumentBenchmark::initTestCase()
+{
+  for ( int i = 0; i < NumFiles; ++i ) {
+    QDomDocument doc;
+    QDomElement root = doc.createElement( "todo" );
+    doc.appendChild( root );
+    root.setAttribute( "id", QUuid::createUuid().toString() );
+    root.setAttribute( "title", QString( "Todo %1" ).arg( i ) );
+    root.setAttribute( "done", i % 3 == 0 ? "true" : "false" );
+    root.setAttribute( "priority", i % 11 - 1 );
+    root.setAttribute( "weight", i * 1.5 );
+    QDomElement descriptionElement = doc.createElement( "description" );
+    root.appendChild( descriptionElement );
+    descriptionElement.appendChild( doc.createTextNode( description( i ) ) );
+    m_files << doc.toByteArray();
+  }
+}
+
+void XmlDocumentBenchmark::read_data()
+{
+  addModes();
+}
+
+/**
+   @brief Parses the files and reads the values of a todo from them
+ */
+void XmlDocumentBenchmark::read()
+{
+  QFETCH( bool, dom );
+  int done = 0;
+  QBENCHMARK {
+    done = 0;
+    for ( const QByteArray &data : m_files ) {
+      if ( dom ) {
+        QDomDocument doc;
+        QVERIFY( doc.setContent( data ) );
+        QDomElement root = doc.documentElement();
+        QUuid uuid( root.attribute( "id" ) );
+        done += root.attribute( "done" ) == "true";
+        QString title = root.attribute( "title" );
+        int priority = root.attribute( "priority" ).toInt();
+        double weight = root.attribute( "weight" ).toDouble();
+        QString text = root.firstChildElement( "description" ).text();
+        Q_UNUSED( uuid ); Q_UNUSED( title ); Q_UNUSED( priority ); Q_UNUSED( weight );
+        Q_UNUSED( text );
+      } else {
+        LocalXmlDocument doc;
+        QVERIFY( doc.setContent( data ) );
+        QUuid uuid( doc.attribute( "id" ) );
+        done += doc.attribute( "done" ) == "true";
+        QString title = doc.attribute( "title" );
+        int priority = doc.attribute( "priority" ).toInt();
+        double weight = doc.attribute( "weight" ).toDouble();
+        QString text = doc.elementText( "description" );
+        Q_UNUSED( uuid ); Q_UNUSED( title ); Q_UNUSED( priority ); Q_UNUSED( weight );
+        Q_UNUSED( text );
+      }
+    }
+  }
+  QCOMPARE( done, ( NumFiles + 2 ) / 3 );
+}
+
+void XmlDocumentBenchmark::write_data()
+{
+  addModes();
+}
+
+/**
+   @brief Reads the files, changes the todos' titles and serializes them again
+
+   This is what saving a todo does: its file is read first, so content unknown to the backend
+   is kept.
+ */
+void XmlDocumentBenchmark::write()
+{
+  QFETCH( bool, dom );
+  qint64 size = 0;
+  QBENCHMARK {
+    size = 0;
+    for ( int i = 0; i < NumFiles; ++i ) {
+      QString title = QString( "Changed todo %1" ).arg( i );
+      if ( dom ) {
+        QDomDocument doc;
+        QVERIFY( doc.setContent( m_files.at( i ) ) );
+        doc.documentElement().setAttribute( "title", title );
+        size += doc.toByteArray().size();
+      } else {
+        LocalXmlDocument doc;
+        QVERIFY( doc.setContent( m_files.at( i ) ) );
+        doc.setAttribute( "title", title );
+        size += doc.toByteArray().size();
+      }
+    }
+  }
+  QVERIFY( size > 0 );
+}
+
+void XmlDocumentBenchmark::addModes()
+{
+  QTest::addColumn<bool>( "dom" );
+  QTest::newRow( "stream" ) << false;
+  QTest::newRow( "dom" ) << true;
+}
+
+/**
+   @brief Returns a description of a few hundred characters for the todo with the @p index
+ */
+QString XmlDocumentBenchmark::description( int index )
+{
+  QStringList lines;
+  for ( int i = 0; i < 8; ++i ) {
+    lines << QString( "Line %1 of the description of todo %2, with <markup> & entities." ).arg(
+               i ).arg( index );
+  }
+  return lines.join( "\n" );
+}
+
+QTEST_GUILESS_MAIN(XmlDocumentBenchmark)
+
+#include "tst_bench_xmldocument.moc"
@@ -0,0 +1,17 @@
+TARGET = tst_bench_xmldocument
+
+include(../../tests.pri)
+include(../benchmarks.pri)
+
+# QtXml is only used to compare with the QDomDocument based code LocalXmlDocument replaced
+QT += xml
+
+BACKEND_DIR = ../../../../plugins/opentodobackends/LocalXmlBackend
+
+INCLUDEPATH += $$BACKEND_DIR
+
+HEADERS += $$BACKEND_DIR/localxmldocument.h
+
+SOURCES += \
+  $$BACKEND_DIR/localxmldocument.cpp \
+  tst_bench_xmldocument.cpp
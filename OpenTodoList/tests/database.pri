@@ -0,0 +1,59 @@
+# Builds the database core of the application into a test.
+#
+# This pulls in everything below src/database and the data model classes the queries work on,
+# but none of the QML plugins or the UI.
+
+include(tests.pri)
+
+QT += qml sql xml
+
+HEADERS += \
+  $$PWD/testdatabase.h \
+  $$PWD/../inc/core/opentodolistinterfaces.h \
+  $$PWD/../src/pluginsloader.h \
+  $$PWD/../src/core/settings.h \
+  $$PWD/../src/core/tracer.h \
+  $$PWD/../src/database/backendwrapper.h \
+  $$PWD/../src/database/changeset.h \
+  $$PWD/../src/database/database.h \
+  $$PWD/../src/database/databaseconnection.h \
+  $$PWD/../src/database/databaseworker.h \
+  $$PWD/../src/database/migrationbatch.h \
+  $$PWD/../src/database/objectcache.h \
+  $$PWD/../src/database/queryscheduler.h \
+  $$PWD/../src/database/querystatistics.h \
+  $$PWD/../src/database/rowcursor.h \
+  $$PWD/../src/database/slowquerylog.h \
+  $$PWD/../src/database/statementcache.h \
+  $$PWD/../src/database/storagequery.h \
+  $$files($$PWD/../src/database/queries/*.h) \
+  $$files($$PWD/../src/database/queries/private/*.h) \
+  $$PWD/../src/datamodel/account.h \
+  $$PWD/../src/datamodel/backend.h \
+  $$PWD/../src/datamodel/objectinfo.h \
+  $$PWD/../src/datamodel/task.h \
+  $$PWD/../src/datamodel/todo.h \
+  $$PWD/../src/datamodel/todolist.h
+
+SOURCES += \
+  $$PWD/../src/core/settings.cpp \
+  $$PWD/../src/core/tracer.cpp \
+  $$PWD/../src/database/backendwrapper.cpp \
+  $$PWD/../src/database/changeset.cpp \
+  $$PWD/../src/database/database.cpp \
+  $$PWD/../src/database/databaseconnection.cpp \
+  $$PWD/../src/database/databaseworker.cpp \
+  $$PWD/../src/database/migrationbatch.cpp \
+  $$PWD/../src/database/objectcache.cpp \
+  $$PWD/../src/database/queryscheduler.cpp \
+  $$PWD/../src/database/querystatistics.cpp \
+  $$PWD/../src/database/rowcursor.cpp \
+  $$PWD/../src/database/slowquerylog.cpp \
+  $$PWD/../src/database/statementcache.cpp \
+  $$PWD/../src/database/storagequery.cpp \
+  $$files($$PWD/../src/database/queries/*.cpp) \
+  $$PWD/../src/datamodel/account.cpp \
+  $$PWD/../src/datamodel/backend.cpp \
+  $$PWD/../src/datamodel/task.cpp \
+  $$PWD/../src/datamodel/todo.cpp \
+  $$PWD/../src/datamodel/todolist.cpp
@@ -0,0 +1,176 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENTODOLIST_TESTS_TESTDATABASE_H
+#define OPENTODOLIST_TESTS_TESTDATABASE_H
+
+#include "database/database.h"
+#include "database/queries/insertaccount.h"
+#include "database/queries/insertbackend.h"
+#include "database/queries/inserttask.h"
+#include "database/queries/inserttodo.h"
+#include "database/queries/inserttodolist.h"
+#include "database/queries/inserttodos.h"
+#include "datamodel/account.h"
+#include "datamodel/backend.h"
+#include "datamodel/task.h"
+#include "datamodel/todo.h"
+#include "datamodel/todolist.h"
+
+#include <QDateTime>
+#include <QScopedPointer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+
+namespace OpenTodoList {
+namespace Tests {
+
+using namespace DataBase;
+using namespace DataModel;
+
+/**
+   @brief A Database using a fresh storage location in a temporary directory
+
+   Provides helpers to fill the database with todo lists, todos and tasks. All of them are
+   inserted synchronously, so they can be read right after the helper returns.
+ */
+class TestDatabase
+{
+public:
+
+  TestDatabase() :
+    m_dir(),
+    m_database(),
+    m_account( QUuid::createUuid() )
+  {
+    qputenv( "OPENTODOLIST_LOCAL_STORAGE_LOCATION", m_dir.path().toUtf8() );
+    m_database.reset( new Database() );
+
+    Backend *backend = new Backend();
+    backend->setName( backendName() );
+    Queries::InsertBackend insertBackend( backend );
+    m_database->runQuery( &insertBackend );
+
+    Account account;
+    account.setUuid( m_account );
+    account.setName( "Test Account" );
+    account.setBackend( backendName() );
+    Queries::InsertAccount insertAccount( &account, false );
+    m_database->runQuery( &insertAccount );
+  }
+
+  static QString backendName() { return "TestBackend"; }
+
+  Database *database() const { return m_database.data(); }
+  QString path() const { return m_dir.path(); }
+
+  QUuid addTodoList( const QString &name ) {
+    TodoList todoList;
+    todoList.setUuid( QUuid::createUuid() );
+    todoList.setAccount( m_account );
+    todoList.setName( name );
+    Queries::InsertTodoList query( &todoList, false );
+    m_database->runQuery( &query );
+    return todoList.uuid();
+  }
+
+  QUuid addTodo( const QUuid &todoList, const QString &title,
+                 const QString &description = QString() ) {
+    Todo todo;
+    todo.setUuid( QUuid::createUuid() );
+    todo.setTodoList( todoList );
+    todo.setTitle( title );
+    todo.setDescription( description );
+    Queries::InsertTodo query( &todo, false );
+    m_database->runQuery( &query );
+    return todo.uuid();
+  }
+
+  /**
+     @brief Adds @p count generated todos to the @p todoList at once
+
+     The todos are titled "Todo <n>", have varying priorities and weights, and every third
+     one is done and has a due date. Returns the UUIDs of the todos.
+   */
+  QList<QUuid> addTodos( const QUuid &todoList, int count ) {
+    QList<Todo*> todos;
+    QList<QUuid> result;
+    for ( int i = 0; i < count; ++i ) {
+      Todo *todo = new Todo();
+      todo->setUuid( QUuid::createUuid() );
+      todo->setTodoList( todoList );
+      todo->setTitle( QString( "Todo %1" ).arg( i ) );
+      todo->setDescription( QString( "Description of todo %1" ).arg( i ) );
+      todo->setPriority( i % 11 - 1 );
+      todo->setWeight( ( i * 7919 ) % count );
+      if ( i % 3 == 0 ) {
+        todo->setDone( true );
+        todo->setDueDate( QDateTime( QDate( 2015, 1, 1 ) ).addSecs( i * 60 ) );
+      }
+      todos << todo;
+      result << todo->uuid();
+    }
+    Queries::InsertTodos query( todos );
+    m_database->runQuery( &query );
+    qDeleteAll( todos );
+    return result;
+  }
+
+  QUuid addTask( const QUuid &todo, const QString &title ) {
+    Task task;
+    task.setUuid( QUuid::createUuid() );
+    task.setTodo( todo );
+    task.setTitle( title );
+    Queries::InsertTask query( &task, false );
+    m_database->runQuery( &query );
+    return task.uuid();
+  }
+
+  /**
+     @brief Whether the SQLite library supports the full text search index
+   */
+  static bool hasFullTextSearch() {
+    bool result = false;
+    {
+      QSqlDatabase db = QSqlDatabase::addDatabase( "QSQLITE", "testHasFullTextSearch" );
+      db.setDatabaseName( ":memory:" );
+      if ( db.open() ) {
+        QSqlQuery query( db );
+        result = query.exec( "SELECT sqlite_compileoption_used( 'ENABLE_FTS5' );" ) &&
+            query.next() && query.value( 0 ).toBool();
+      }
+    }
+    QSqlDatabase::removeDatabase( "testHasFullTextSearch" );
+    return result;
+  }
+
+private:
+
+  QTemporaryDir               m_dir;
+  QScopedPointer< Database >  m_database;
+  QUuid                       m_account;
+
+};
+
+} // namespace Tests
+} // namespace OpenTodoList
+
+#endif // OPENTODOLIST_TESTS_TESTDATABASE_H
@@ -0,0 +1,88 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENTODOLIST_TESTS_TESTFILES_H
+#define OPENTODOLIST_TESTS_TESTFILES_H
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QUuid>
+
+namespace OpenTodoList {
+namespace Tests {
+
+/**
+   @brief Helpers to create the files of the LocalXmlBackend in tests
+
+   The XML helpers return the minimal content (encoded in UTF-8) the backend needs to read a
+   todo list, todo or task file.
+ */
+class TestFiles
+{
+public:
+
+  /**
+     @brief Writes the @p content to the file with the given (absolute) @p fileName
+
+     Missing parent directories are created and an existing file is overwritten in place.
+     Returns true if the whole content has been written.
+   */
+  static bool writeFile( const QString &fileName, const QByteArray &content ) {
+    QFile file( fileName );
+    return QDir().mkpath( QFileInfo( fileName ).absolutePath() ) &&
+        file.open( QIODevice::WriteOnly | QIODevice::Truncate ) &&
+        file.write( content ) == content.size();
+  }
+
+  static QByteArray todoListXml( const QUuid &uuid, const QString &name ) {
+    return QString( "<todoList id=\"%1\" name=\"%2\"/>" ).arg(
+          uuid.toString(), name.toHtmlEscaped() ).toUtf8();
+  }
+
+  /**
+     @brief Returns the content of a todo file
+
+     The @p description is only written if it is not empty.
+   */
+  static QByteArray todoXml( const QUuid &uuid, const QString &title,
+                             const QString &description = QString() ) {
+    QString result = QString( "<todo id=\"%1\" title=\"%2\" done=\"false\" priority=\"-1\"" ).arg(
+          uuid.toString(), title.toHtmlEscaped() );
+    if ( description.isEmpty() ) {
+      result += "/>";
+    } else {
+      result += "><description>" + description.toHtmlEscaped() + "</description></todo>";
+    }
+    return result.toUtf8();
+  }
+
+  static QByteArray taskXml( const QUuid &uuid, const QString &title, int weight ) {
+    return QString( "<task id=\"%1\" title=\"%2\" done=\"false\" weight=\"%3\"/>" ).arg(
+          uuid.toString(), title.toHtmlEscaped() ).arg( weight ).toUtf8();
+  }
+
+};
+
+} // namespace Tests
+} // namespace OpenTodoList
+
+#endif // OPENTODOLIST_TESTS_TESTFILES_H
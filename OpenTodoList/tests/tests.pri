@@ -0,0 +1,16 @@
+# Common settings for all unit tests and benchmarks.
+#
+# Tests are registered with CONFIG += testcase, so they can be run via "make check".
+
+QT += testlib
+QT -= gui
+
+CONFIG += testcase console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += \
+  $$PWD \
+  $$PWD/../inc \
+  $$PWD/../src
+
+HEADERS += $$PWD/testfiles.h
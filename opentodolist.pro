@@ -1,5 +1,8 @@
 TEMPLATE = subdirs
-SUBDIRS = plugins OpenTodoList
+SUBDIRS = plugins OpenTodoList tests
+
+tests.subdir = OpenTodoList/tests
+tests.depends = plugins
 
 qrc.depends =
 qrc.commands = perl $$PWD/bin/mk-qrc.pl \
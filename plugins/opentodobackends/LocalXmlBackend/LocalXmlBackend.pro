@@ -3,13 +3,19 @@ setupPlugin(LocalXmlBackend,opentodobackends)
 
 qtcAddDeployment()
 
-QT += xml
+QT += concurrent
 
 SOURCES += \
-    localxmlbackend.cpp
+    localxmlbackend.cpp \
+    localxmldocument.cpp \
+    localxmlmanifest.cpp \
+    localxmlwritebatch.cpp
 
 HEADERS += \
-    localxmlbackend.h
+    localxmlbackend.h \
+    localxmldocument.h \
+    localxmlmanifest.h \
+    localxmlwritebatch.h
 
 OTHER_FILES += \
     LocalXmlBackend.json
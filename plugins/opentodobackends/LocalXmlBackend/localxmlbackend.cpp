@@ -18,11 +18,17 @@
 
 #include "localxmlbackend.h"
 
+#include <algorithm>
+
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QDirIterator>
-#include <QDomDocument>
+#include <QFileSystemWatcher>
 #include <QStringList>
+#include <QTimer>
+#include <QVariant>
+#include <QtConcurrent>
 #include <QtPlugin>
 
 const QString LocalXmlBackend::TodoListConfigFileName = "config.xml";
@@ -35,11 +41,32 @@ const QString LocalXmlBackend::TodoMetaHash = "LocalXmlBackend::Todo::hash";
 const QString LocalXmlBackend::TaskMetaFileName = "LocalXmlBackend::Task::fileName";
 const QString LocalXmlBackend::TaskMetaHash = "LocalXmlBackend::Task::hash";
 
+namespace {
+
+/**
+   @brief Returns the UUIDs of the @p objects
+ */
+template<typename T>
+QList<QUuid> uuidsOf( const QList<T*> &objects )
+{
+  QList<QUuid> result;
+  result.reserve( objects.size() );
+  for ( T *object : objects ) {
+    result << object->uuid();
+  }
+  return result;
+}
+
+}
+
 LocalXmlBackend::LocalXmlBackend(QObject *parent) :
   QObject( parent ),
   m_database( nullptr ),
   m_localStorageDirectory( QString() ),
-  m_account( nullptr )
+  m_account( nullptr ),
+  m_watcher( nullptr ),
+  m_importTimer( nullptr ),
+  m_importing( false )
 {
   qDebug() << "Creating LocalXmlBackend";
 }
@@ -47,6 +74,7 @@ LocalXmlBackend::LocalXmlBackend(QObject *parent) :
 LocalXmlBackend::~LocalXmlBackend()
 {
   qDebug() << "Deleting LocalXmlBackend";
+  stopWatching();
   if ( m_account ) {
     delete m_account;
   }
@@ -105,54 +133,84 @@ bool LocalXmlBackend::start()
   m_account->setName( tr( "Local Todo Lists" ) );
   m_database->insertAccount( m_account );
 
-  QStringList todoLists = locateTodoLists();
-  for ( const QString &todoListFile : todoLists ) {
-    fixTodoList( todoListFile );
-    ITodoList *todoList = m_database->createTodoList();
-    QDomDocument doc = documentForFile( todoListFile );
-    QByteArray todoListHash;
-    if ( domToTodoList( doc, todoList ) && todoListNeedsUpdate( todoList, todoListFile, todoListHash ) ) {
-      todoList->insertMetaAttribute( TodoListMetaFileName, todoListFile );
-      todoList->insertMetaAttribute( TodoListMetaHash, todoListHash );
-      todoList->setAccount( m_account->uuid() );
-      m_database->insertTodoList( todoList );
-    }
-
-    QStringList todos = locateTodos( todoListFile );
-    for ( const QString &todoFile : todos ) {
-      fixTodo( todoFile );
-      ITodo *todo = m_database->createTodo();
-      doc = documentForFile( todoFile );
-      QByteArray todoHash;
-      if ( domToTodo( doc, todo ) && todoNeedsUpdate( todo, todoFile, todoHash )) {
-        todo->insertMetaAttribute( TodoMetaFileName, todoFile );
-        todo->insertMetaAttribute( TodoMetaHash, todoHash );
-        todo->setTodoList( todoList->uuid() );
-        m_database->insertTodo( todo );
-      }
+  m_writeBatch.setDirectory( m_localStorageDirectory );
+  m_writeBatch.removeStaleFiles();
+  m_manifest.setDirectory( m_localStorageDirectory );
+  m_manifest.load();
+  if ( accounts.isEmpty() ) {
+    // The database has been created from scratch, so nothing read before is in there:
+    m_manifest.clear();
+  }
 
-      QStringList tasks = locateTasks( todoFile );
-      for ( const QString &taskFile : tasks ) {
-        ITask *task = m_database->createTask();
-        doc = documentForFile( taskFile );
-        QByteArray taskHash;
-        if ( domToTask( doc, task ) && taskNeedsUpdate( task, taskFile, taskHash ) ) {
-          task->insertMetaAttribute( TaskMetaFileName, taskFile );
-          task->insertMetaAttribute( TaskMetaHash, taskHash );
-          task->setTodo( todo->uuid() );
-          m_database->insertTask( task );
-        }
-        delete task;
-      }
-      delete todo;
+  // Step 1: Enumerate the files level by level (todo lists, then todos, then tasks). Each file
+  // which changed since the last run is handed over to the thread pool for parsing and hashing
+  // right away, so reading the files overlaps with enumerating the remaining ones.
+  QList<ImportFile> files;
+  enqueueImportFiles( files, ImportFile::TodoListFile, -1, locateTodoLists() );
+  int numTodoLists = files.size();
+  for ( int i = 0; i < numTodoLists; ++i ) {
+    enqueueImportFiles( files, ImportFile::TodoFile, i, locateTodos( files.at( i ).fileName ) );
+  }
+  int numTodos = files.size();
+  for ( int i = numTodoLists; i < numTodos; ++i ) {
+    enqueueImportFiles( files, ImportFile::TaskFile, i, locateTasks( files.at( i ).fileName ) );
+  }
+
+  // Step 2: Collect the results in enumeration order and insert them into the database in
+  // batches. A level's batch is flushed before the first object of the next level is looked
+  // at, so parents always get inserted before their children.
+  QSet<QString> fileNames;
+  ImportBatch batch;
+  for ( int i = 0; i < files.size(); ++i ) {
+    ImportFile &file = files[i];
+    fileNames.insert( file.fileName );
+    if ( file.kind != ImportFile::TodoListFile ) {
+      importTodoLists( batch.todoLists );
+    }
+    if ( file.kind == ImportFile::TaskFile ) {
+      importTodos( batch.todos );
+    }
+    if ( !file.changed ) {
+      continue;
+    }
+
+    ParsedFile parsed = file.parsed.result();
+    file.parsed = QFuture<ParsedFile>();
+    file.entry.hash = parsed.hash;
+    QUuid parentUuid = file.parent >= 0 ? files.at( file.parent ).entry.uuid : QUuid();
+    importDocument( file, parsed.doc, parentUuid, batch );
+    if ( batch.todoLists.size() >= ImportBatchSize ) {
+      importTodoLists( batch.todoLists );
+    }
+    if ( batch.todos.size() >= ImportBatchSize ) {
+      importTodos( batch.todos );
+    }
+    if ( batch.tasks.size() >= ImportBatchSize ) {
+      importTasks( batch.tasks );
     }
-    delete todoList;
   }
+  importTodoLists( batch.todoLists );
+  importTodos( batch.todos );
+  importTasks( batch.tasks );
+
+  // Step 3: Forget about files which are gone and remember the state of the ones read
+  m_manifest.retain( fileNames );
+  if ( m_manifest.isDirty() ) {
+    m_manifest.save();
+  }
+
+  // Step 4: Pick up changes done to the files from now on
+  startWatching( fileNames );
   return true;
 }
 
 bool LocalXmlBackend::stop()
 {
+  stopWatching();
+  commitFiles();
+  if ( m_manifest.isDirty() ) {
+    m_manifest.save();
+  }
   return true;
 }
 
@@ -162,10 +220,470 @@ void LocalXmlBackend::sync()
   deleteTodoLists();
   deleteTodos();
   deleteTasks();
-  // Step 2: Save modified objects
+  m_database->waitForPendingOperations();
+  // Step 2: Save modified objects. Todos and tasks read the file names of their containers
+  // from the database, so the containers must be done before going on with the next level:
   saveTodoLists();
+  m_database->waitForPendingOperations();
   saveTodos();
+  m_database->waitForPendingOperations();
   saveTasks();
+  m_database->waitForPendingOperations();
+  if ( m_manifest.isDirty() ) {
+    m_manifest.save();
+  }
+}
+
+/**
+   @brief Adds the @p fileNames to the list of @p files to be imported
+
+   The files are checked against the manifest. The ones which changed are scheduled for being
+   read in the global thread pool.
+ */
+void LocalXmlBackend::enqueueImportFiles(QList<ImportFile> &files, ImportFile::Kind kind,
+                                         int parent, const QStringList &fileNames)
+{
+  for ( const QString &fileName : fileNames ) {
+    ImportFile file;
+    file.kind = kind;
+    file.fileName = fileName;
+    file.parent = parent;
+    file.entry = m_manifest.stat( fileName );
+    LocalXmlManifest::Entry stored;
+    file.changed = !m_manifest.isUnchanged( fileName, file.entry, &stored );
+    if ( file.changed ) {
+      file.parsed = QtConcurrent::run( this, &LocalXmlBackend::parseFile, fileName );
+    } else {
+      file.entry.uuid = stored.uuid;
+    }
+    files << file;
+  }
+}
+
+/**
+   @brief Reads and hashes the file @p fileName
+
+   This is run in the global thread pool during start up.
+ */
+LocalXmlBackend::ParsedFile LocalXmlBackend::parseFile(const QString &fileName) const
+{
+  ParsedFile result;
+  result.doc = documentForFile( fileName, &result.hash );
+  return result;
+}
+
+/**
+   @brief Turns the @p doc read from the import @p file into an object and adds it to the @p batch
+
+   The object is attached to the parent object with the given @p parentUuid. The @p file's
+   manifest entry is updated with the object's UUID and recorded.
+ */
+void LocalXmlBackend::importDocument(ImportFile &file, LocalXmlDocument &doc,
+                                     const QUuid &parentUuid, ImportBatch &batch)
+{
+  switch ( file.kind ) {
+  case ImportFile::TodoListFile:
+  {
+    if ( fixTodoList( doc, file.fileName ) ) {
+      file.entry = m_manifest.stat( file.fileName );
+      file.entry.hash = hashForFile( file.fileName );
+    }
+    ITodoList *todoList = m_database->createTodoList();
+    if ( documentToTodoList( doc, todoList ) ) {
+      todoList->setAccount( m_account->uuid() );
+      todoList->insertMetaAttribute( TodoListMetaFileName, file.fileName );
+      todoList->insertMetaAttribute( TodoListMetaHash, file.entry.hash );
+      file.entry.uuid = todoList->uuid();
+      m_manifest.insert( file.fileName, file.entry );
+      batch.todoLists << todoList;
+    } else {
+      delete todoList;
+    }
+    break;
+  }
+
+  case ImportFile::TodoFile:
+  {
+    if ( fixTodo( doc, file.fileName ) ) {
+      file.entry = m_manifest.stat( file.fileName );
+      file.entry.hash = hashForFile( file.fileName );
+    }
+    ITodo *todo = m_database->createTodo();
+    if ( documentToTodo( doc, todo ) ) {
+      todo->setTodoList( parentUuid );
+      todo->insertMetaAttribute( TodoMetaFileName, file.fileName );
+      todo->insertMetaAttribute( TodoMetaHash, file.entry.hash );
+      file.entry.uuid = todo->uuid();
+      m_manifest.insert( file.fileName, file.entry );
+      batch.todos << todo;
+    } else {
+      delete todo;
+    }
+    break;
+  }
+
+  case ImportFile::TaskFile:
+  {
+    ITask *task = m_database->createTask();
+    if ( documentToTask( doc, task ) ) {
+      task->setTodo( parentUuid );
+      task->insertMetaAttribute( TaskMetaFileName, file.fileName );
+      task->insertMetaAttribute( TaskMetaHash, file.entry.hash );
+      file.entry.uuid = task->uuid();
+      m_manifest.insert( file.fileName, file.entry );
+      batch.tasks << task;
+    } else {
+      delete task;
+    }
+    break;
+  }
+  }
+}
+
+/**
+   @brief Starts watching the local storage directory for changes
+
+   The directories containing the @p fileNames as well as the files themselves are watched.
+   Changes are collected and imported after ImportDelay milliseconds, so bursts of changes
+   (e.g. from a file synchronization tool) are applied at once.
+ */
+void LocalXmlBackend::startWatching(const QSet<QString> &fileNames)
+{
+  stopWatching();
+
+  m_watcher = new QFileSystemWatcher( this );
+  m_importTimer = new QTimer( this );
+  m_importTimer->setInterval( ImportDelay );
+  m_importTimer->setSingleShot( true );
+  connect( m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+    m_changedFiles.insert( path );
+    m_importTimer->start();
+  } );
+  connect( m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+    m_changedDirectories.insert( path );
+    m_importTimer->start();
+  } );
+  connect( m_importTimer, &QTimer::timeout, this, &LocalXmlBackend::importChanges );
+
+  QDir storageDir( m_localStorageDirectory );
+  QStringList paths;
+  paths << storageDir.absolutePath();
+  for ( const QString &fileName : fileNames ) {
+    QFileInfo fi( storageDir.absoluteFilePath( fileName ) );
+    paths << fi.absoluteFilePath() << fi.absolutePath();
+    ImportFile::Kind kind;
+    if ( classifyFile( fileName, &kind ) ) {
+      // Also watch the (possibly empty) directories children will be created in:
+      QFileInfo childDir( kind == ImportFile::TodoListFile ?
+                            fi.absolutePath() + "/" + TodoDirectoryName :
+                            fi.absolutePath() + "/" + fi.baseName() );
+      if ( kind != ImportFile::TaskFile && childDir.isDir() ) {
+        paths << childDir.absoluteFilePath();
+      }
+    }
+  }
+  watchPaths( paths );
+}
+
+/**
+   @brief Stops watching the local storage directory
+ */
+void LocalXmlBackend::stopWatching()
+{
+  delete m_watcher;
+  m_watcher = nullptr;
+  delete m_importTimer;
+  m_importTimer = nullptr;
+  m_watchedPaths.clear();
+  m_changedFiles.clear();
+  m_changedDirectories.clear();
+}
+
+/**
+   @brief Adds the @p paths not watched yet to the file system watcher
+ */
+void LocalXmlBackend::watchPaths(const QStringList &paths)
+{
+  QStringList newPaths;
+  for ( const QString &path : paths ) {
+    if ( !m_watchedPaths.contains( path ) ) {
+      m_watchedPaths.insert( path );
+      newPaths << path;
+    }
+  }
+  if ( m_watcher && !newPaths.isEmpty() ) {
+    m_watcher->addPaths( newPaths );
+  }
+}
+
+/**
+   @brief Removes all watched paths equal to or within @p path
+ */
+void LocalXmlBackend::unwatchPath(const QString &path)
+{
+  QString prefix = path + "/";
+  QStringList paths;
+  for ( auto it = m_watchedPaths.begin(); it != m_watchedPaths.end(); ) {
+    if ( *it == path || it->startsWith( prefix ) ) {
+      paths << *it;
+      it = m_watchedPaths.erase( it );
+    } else {
+      ++it;
+    }
+  }
+  if ( m_watcher && !paths.isEmpty() ) {
+    m_watcher->removePaths( paths );
+  }
+}
+
+/**
+   @brief Imports the files changed since the last import
+
+   Only the files reported by the file system watcher and the contents of changed
+   directories are looked at. Files which did not change according to the manifest (e.g.
+   because the backend wrote them itself) are skipped. Objects whose files have been
+   removed are deleted from the database.
+ */
+void LocalXmlBackend::importChanges()
+{
+  if ( m_importing ) {
+    // Triggered from within an event loop run by the database during the current import
+    m_importTimer->start();
+    return;
+  }
+  m_importing = true;
+  QDir storageDir( m_localStorageDirectory );
+  QSet<QString> candidates;
+  QSet<QString> removed;
+  QStringList newPaths;
+
+  // The watcher follows the file itself rather than its name, so it stops watching files
+  // which were replaced by renaming another file over them (as file synchronization tools and
+  // LocalXmlWriteBatch do). Such files have to be added again:
+  QSet<QString> watchedFiles;
+  if ( !m_changedFiles.isEmpty() ) {
+    for ( const QString &path : m_watcher->files() ) {
+      watchedFiles.insert( path );
+    }
+  }
+  for ( const QString &path : m_changedFiles ) {
+    QString fileName = storageDir.relativeFilePath( path );
+    if ( QFileInfo( path ).isFile() ) {
+      candidates.insert( fileName );
+      if ( !watchedFiles.contains( path ) ) {
+        m_watchedPaths.remove( path );
+        newPaths << path;
+      }
+    } else {
+      removed.insert( fileName );
+      unwatchPath( path );
+    }
+  }
+  for ( const QString &path : m_changedDirectories ) {
+    QString directory = storageDir.relativeFilePath( path );
+    if ( directory == "." ) {
+      directory.clear();
+    }
+    if ( QFileInfo( path ).isDir() ) {
+      scanDirectory( path, candidates, newPaths );
+      for ( const QString &fileName : m_manifest.fileNames( directory, false ) ) {
+        if ( !QFileInfo( storageDir.absoluteFilePath( fileName ) ).exists() ) {
+          removed.insert( fileName );
+        }
+      }
+    } else {
+      for ( const QString &fileName : m_manifest.fileNames( directory, true ) ) {
+        removed.insert( fileName );
+      }
+      unwatchPath( path );
+    }
+  }
+  m_changedFiles.clear();
+  m_changedDirectories.clear();
+  watchPaths( newPaths );
+
+  // Read the files which changed, parents before children:
+  QList<ImportFile> files;
+  for ( const QString &fileName : candidates ) {
+    ImportFile file;
+    if ( !classifyFile( fileName, &file.kind, &file.parentFileName ) ) {
+      continue;
+    }
+    file.fileName = fileName;
+    file.parent = -1;
+    file.entry = m_manifest.stat( fileName );
+    file.changed = !m_manifest.isUnchanged( fileName, file.entry );
+    if ( file.changed ) {
+      files << file;
+    }
+  }
+  std::stable_sort( files.begin(), files.end(), [](const ImportFile &a, const ImportFile &b) {
+    return a.kind < b.kind;
+  } );
+  ImportBatch batch;
+  for ( ImportFile &file : files ) {
+    if ( file.kind != ImportFile::TodoListFile ) {
+      importTodoLists( batch.todoLists );
+    }
+    if ( file.kind == ImportFile::TaskFile ) {
+      importTodos( batch.todos );
+    }
+    LocalXmlDocument doc = documentForFile( file.fileName, &file.entry.hash );
+    QUuid parentUuid = m_manifest.entry( file.parentFileName ).uuid;
+    importDocument( file, doc, parentUuid, batch );
+  }
+  importTodoLists( batch.todoLists );
+  importTodos( batch.todos );
+  importTasks( batch.tasks );
+
+  // Remove the objects whose files are gone, children before parents:
+  QList<QUuid> removedUuids[3];
+  for ( const QString &fileName : removed ) {
+    ImportFile::Kind kind;
+    LocalXmlManifest::Entry entry = m_manifest.entry( fileName );
+    if ( !entry.uuid.isNull() && classifyFile( fileName, &kind ) ) {
+      removedUuids[kind] << entry.uuid;
+    }
+    m_manifest.remove( fileName );
+  }
+  for ( ITask *task : m_database->getTasks( removedUuids[ImportFile::TaskFile] ) ) {
+    m_database->deleteTaskAsync( task );
+  }
+  for ( ITodo *todo : m_database->getTodos( removedUuids[ImportFile::TodoFile] ) ) {
+    m_database->deleteTodoAsync( todo );
+  }
+  for ( ITodoList *todoList : m_database->getTodoLists( removedUuids[ImportFile::TodoListFile] ) ) {
+    m_database->deleteTodoListAsync( todoList );
+  }
+  m_database->waitForPendingOperations();
+
+  if ( !files.isEmpty() || !removed.isEmpty() ) {
+    qDebug() << "Imported" << files.size() << "changed and" << removed.size()
+             << "removed files in" << name();
+  }
+  if ( m_manifest.isDirty() ) {
+    m_manifest.save();
+  }
+  m_importing = false;
+}
+
+/**
+   @brief Collects the XML files in the @p directory
+
+   The files are added to the @p fileNames (relative to the local storage directory).
+   Sub-directories not watched yet are scanned recursively; they and the files found in
+   there are added to the @p newPaths to watch.
+ */
+void LocalXmlBackend::scanDirectory(const QString &directory, QSet<QString> &fileNames,
+                                    QStringList &newPaths) const
+{
+  QDir storageDir( m_localStorageDirectory );
+  QDir dir( directory );
+  for ( const QFileInfo &fi : dir.entryInfoList( { "*.xml" }, QDir::Files ) ) {
+    fileNames.insert( storageDir.relativeFilePath( fi.absoluteFilePath() ) );
+    if ( !m_watchedPaths.contains( fi.absoluteFilePath() ) ) {
+      newPaths << fi.absoluteFilePath();
+    }
+  }
+  for ( const QFileInfo &fi : dir.entryInfoList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+    if ( !m_watchedPaths.contains( fi.absoluteFilePath() ) ) {
+      newPaths << fi.absoluteFilePath();
+      scanDirectory( fi.absoluteFilePath(), fileNames, newPaths );
+    }
+  }
+}
+
+/**
+   @brief Determines the kind of file from the @p fileName's location
+
+   The @p fileName is relative to the local storage directory. If given, @p parentFileName is
+   set to the file holding the parent object. Returns false if the file is not one read by
+   the backend.
+ */
+bool LocalXmlBackend::classifyFile(const QString &fileName, ImportFile::Kind *kind,
+                                   QString *parentFileName)
+{
+  QStringList parts = fileName.split( '/' );
+  QString parent;
+  if ( parts.size() == 2 && parts.at( 1 ) == TodoListConfigFileName ) {
+    *kind = ImportFile::TodoListFile;
+  } else if ( parts.size() == 3 && parts.at( 1 ) == TodoDirectoryName &&
+              parts.at( 2 ).endsWith( ".xml" ) ) {
+    *kind = ImportFile::TodoFile;
+    parent = parts.at( 0 ) + "/" + TodoListConfigFileName;
+  } else if ( parts.size() == 4 && parts.at( 1 ) == TodoDirectoryName &&
+              parts.at( 3 ).endsWith( ".xml" ) ) {
+    *kind = ImportFile::TaskFile;
+    parent = parts.mid( 0, 3 ).join( '/' ) + ".xml";
+  } else {
+    return false;
+  }
+  if ( parentFileName ) {
+    *parentFileName = parent;
+  }
+  return true;
+}
+
+/**
+   @brief Inserts the @p todoLists which differ from the ones in the database
+
+   The todo lists are deleted afterwards and the list is cleared.
+ */
+void LocalXmlBackend::importTodoLists(QList<ITodoList*> &todoLists)
+{
+  if ( todoLists.isEmpty() ) {
+    return;
+  }
+  QHash<QUuid, ITodoList*> existing = m_database->getTodoLists( uuidsOf( todoLists ) );
+  QList<ITodoList*> changed;
+  for ( ITodoList *todoList : todoLists ) {
+    if ( todoListNeedsUpdate( existing.value( todoList->uuid() ),
+                              todoList->metaAttributes().value( TodoListMetaHash ).toByteArray() ) ) {
+      changed << todoList;
+    }
+  }
+  m_database->insertTodoLists( changed );
+  qDeleteAll( existing );
+  qDeleteAll( todoLists );
+  todoLists.clear();
+}
+
+void LocalXmlBackend::importTodos(QList<ITodo*> &todos)
+{
+  if ( todos.isEmpty() ) {
+    return;
+  }
+  QHash<QUuid, ITodo*> existing = m_database->getTodos( uuidsOf( todos ) );
+  QList<ITodo*> changed;
+  for ( ITodo *todo : todos ) {
+    if ( todoNeedsUpdate( existing.value( todo->uuid() ),
+                          todo->metaAttributes().value( TodoMetaHash ).toByteArray() ) ) {
+      changed << todo;
+    }
+  }
+  m_database->insertTodos( changed );
+  qDeleteAll( existing );
+  qDeleteAll( todos );
+  todos.clear();
+}
+
+void LocalXmlBackend::importTasks(QList<ITask*> &tasks)
+{
+  if ( tasks.isEmpty() ) {
+    return;
+  }
+  QHash<QUuid, ITask*> existing = m_database->getTasks( uuidsOf( tasks ) );
+  QList<ITask*> changed;
+  for ( ITask *task : tasks ) {
+    if ( taskNeedsUpdate( existing.value( task->uuid() ),
+                          task->metaAttributes().value( TaskMetaHash ).toByteArray() ) ) {
+      changed << task;
+    }
+  }
+  m_database->insertTasks( changed );
+  qDeleteAll( existing );
+  qDeleteAll( tasks );
+  tasks.clear();
 }
 
 /**
@@ -217,120 +735,98 @@ QStringList LocalXmlBackend::locateTasks(const QString &todo) const
   return result;
 }
 
-bool LocalXmlBackend::todoListToDom(const OpenTodoList::ITodoList *list, QDomDocument &doc)
+bool LocalXmlBackend::todoListToDocument(const OpenTodoList::ITodoList *list, LocalXmlDocument &doc)
 {
-  QDomElement root = doc.documentElement();
-  if ( !root.isElement() ) {
-    root = doc.createElement( "todoList" );
-    doc.appendChild( root );
+  if ( doc.isNull() ) {
+    doc.setRootName( "todoList" );
   }
-  root.setAttribute( "id", list->uuid().toString() );
-  root.setAttribute( "name", list->name() );
+  doc.setAttribute( "id", list->uuid().toString() );
+  doc.setAttribute( "name", list->name() );
   return true;
 }
 
-bool LocalXmlBackend::domToTodoList(const QDomDocument &doc, OpenTodoList::ITodoList *list)
+bool LocalXmlBackend::documentToTodoList(const LocalXmlDocument &doc, OpenTodoList::ITodoList *list)
 {
-  QDomElement root = doc.documentElement();
-  if ( !root.isElement() ) {
+  if ( doc.isNull() ) {
     return false;
   }
-  list->setUuid( QUuid( root.attribute( "id", list->uuid().toString() ) ) );
-  list->setName( root.attribute( "name", list->name() ) );
+  list->setUuid( QUuid( doc.attribute( "id", list->uuid().toString() ) ) );
+  list->setName( doc.attribute( "name", list->name() ) );
   return true;
 }
 
-bool LocalXmlBackend::todoToDom(const OpenTodoList::ITodo *todo, QDomDocument &doc)
+bool LocalXmlBackend::todoToDocument(const OpenTodoList::ITodo *todo, LocalXmlDocument &doc)
 {
-  QDomElement root = doc.documentElement();
-  if ( !root.isElement() ) {
-    root = doc.createElement( "todo" );
-    doc.appendChild( root );
+  if ( doc.isNull() ) {
+    doc.setRootName( "todo" );
   }
-  root.setAttribute( "id", todo->uuid().toString() );
-  root.setAttribute( "title", todo->title() );
-  root.setAttribute( "done", todo->done() ? "true" : "false" );
-  root.setAttribute( "priority", todo->priority() );
-  root.setAttribute( "weight", todo->weight() );
+  doc.setAttribute( "id", todo->uuid().toString() );
+  doc.setAttribute( "title", todo->title() );
+  doc.setAttribute( "done", todo->done() ? "true" : "false" );
+  doc.setAttribute( "priority", todo->priority() );
+  doc.setAttribute( "weight", todo->weight() );
   if ( todo->dueDate().isValid() ) {
-    root.setAttribute( "dueDate", todo->dueDate().toString() );
+    doc.setAttribute( "dueDate", todo->dueDate().toString() );
   } else {
-    root.removeAttribute( "dueDate" );
+    doc.removeAttribute( "dueDate" );
   }
-  QDomElement descriptionElement = root.firstChildElement( "description" );
-  if ( !descriptionElement.isElement() ) {
-    descriptionElement = doc.createElement( "description" );
-    root.appendChild( descriptionElement );
-  }
-  while ( !descriptionElement.firstChild().isNull() ) {
-    descriptionElement.removeChild( descriptionElement.firstChild() );
-  }
-  QDomText descriptionText = doc.createTextNode( todo->description() );
-  descriptionElement.appendChild( descriptionText );
+  doc.setElementText( "description", todo->description() );
   return true;
 }
 
-bool LocalXmlBackend::domToTodo(const QDomDocument &doc, OpenTodoList::ITodo *todo)
+bool LocalXmlBackend::documentToTodo(const LocalXmlDocument &doc, OpenTodoList::ITodo *todo)
 {
-  QDomElement root = doc.documentElement();
-
-  if ( !root.isElement() ) {
+  if ( doc.isNull() ) {
     return false;
   }
 
-  todo->setUuid( QUuid( root.attribute( "id" ) ) );
-  todo->setTitle( root.attribute( "title" ) );
-  if ( root.hasAttribute( "done" ) ) {
-    todo->setDone( root.attribute( "done", "true" ) == "true" );
+  todo->setUuid( QUuid( doc.attribute( "id" ) ) );
+  todo->setTitle( doc.attribute( "title" ) );
+  if ( doc.hasAttribute( "done" ) ) {
+    todo->setDone( doc.attribute( "done", "true" ) == "true" );
   } else {
     // TODO: Remove this in 0.3 release
-    todo->setDone( root.attribute( "progress", 0 ).toInt() >= 100 );
+    todo->setDone( doc.attribute( "progress", "0" ).toInt() >= 100 );
   }
 
-  todo->setPriority( qBound( -1, root.attribute( "priority", QString::number(todo->priority()) ).toInt(), 10 ) );
-  if ( root.hasAttribute( "dueDate" ) ) {
-    todo->setDueDate( QDateTime::fromString( root.attribute( "dueDate" ) ) );
+  todo->setPriority( qBound( -1, doc.attribute( "priority", QString::number(todo->priority()) ).toInt(), 10 ) );
+  if ( doc.hasAttribute( "dueDate" ) ) {
+    todo->setDueDate( QDateTime::fromString( doc.attribute( "dueDate" ) ) );
   } else {
     todo->setDueDate( QDateTime() );
   }
-  todo->setWeight( root.attribute( "weight", QString::number( todo->weight() ) ).toDouble() );
+  todo->setWeight( doc.attribute( "weight", QString::number( todo->weight() ) ).toDouble() );
 
-  QDomElement description = root.firstChildElement( "description" );
-  if ( description.isElement() ) {
-    todo->setDescription( description.text() );
+  if ( doc.hasElement( "description" ) ) {
+    todo->setDescription( doc.elementText( "description" ) );
   }
   return true;
 }
 
-bool LocalXmlBackend::taskToDom(const ITask *task, QDomDocument &doc)
+bool LocalXmlBackend::taskToDocument(const ITask *task, LocalXmlDocument &doc)
 {
-  QDomElement root = doc.documentElement();
-
-  if ( !root.isElement() ) {
-    root = doc.createElement( "task" );
-    doc.appendChild( root );
+  if ( doc.isNull() ) {
+    doc.setRootName( "task" );
   }
 
-  root.setAttribute( "id", task->uuid().toString() );
-  root.setAttribute( "done", task->done() ? "true" : "false" );
-  root.setAttribute( "title", task->title() );
-  root.setAttribute( "weight", task->weight() );
+  doc.setAttribute( "id", task->uuid().toString() );
+  doc.setAttribute( "done", task->done() ? "true" : "false" );
+  doc.setAttribute( "title", task->title() );
+  doc.setAttribute( "weight", task->weight() );
 
   return true;
 }
 
-bool LocalXmlBackend::domToTask(const QDomDocument &doc, ITask *task)
+bool LocalXmlBackend::documentToTask(const LocalXmlDocument &doc, ITask *task)
 {
-  QDomElement root = doc.documentElement();
-
-  if ( !root.isElement() ) {
+  if ( doc.isNull() ) {
     return false;
   }
 
-  task->setUuid( QUuid( root.attribute( "id" ) ));
-  task->setDone( root.attribute( "done" ) == "true" );
-  task->setTitle( root.attribute( "title" ) );
-  task->setWeight( root.attribute( "weight" ).toDouble() );
+  task->setUuid( QUuid( doc.attribute( "id" ) ));
+  task->setDone( doc.attribute( "done" ) == "true" );
+  task->setTitle( doc.attribute( "title" ) );
+  task->setWeight( doc.attribute( "weight" ).toDouble() );
 
   return true;
 }
@@ -338,18 +834,20 @@ bool LocalXmlBackend::domToTask(const QDomDocument &doc, ITask *task)
 void LocalXmlBackend::deleteTodoLists()
 {
   QList<ITodoList*> todoLists;
+  QVariant cursor;
   do {
-    todoLists = m_database->getTodoLists( IDatabase::QueryDisposed, 100 );
+    todoLists = m_database->getTodoLists( IDatabase::QueryDisposed, 100, cursor );
     for ( ITodoList *todoList : todoLists ) {
-      QString fileName = m_localStorageDirectory + "/" +
+      QString relativeFileName =
           todoList->metaAttributes().value( TodoListMetaFileName, QString() ).toString();
+      QString fileName = m_localStorageDirectory + "/" + relativeFileName;
       QFileInfo fi( fileName );
       if ( fi.exists() ) {
         QDir dir = fi.absoluteDir();
         dir.removeRecursively();
       }
-      m_database->deleteTodoList( todoList );
-      delete todoList;
+      m_manifest.removeDirectory( QFileInfo( relativeFileName ).path() );
+      m_database->deleteTodoListAsync( todoList );
     }
   } while ( !todoLists.isEmpty() );
 }
@@ -357,23 +855,26 @@ void LocalXmlBackend::deleteTodoLists()
 void LocalXmlBackend::deleteTodos()
 {
   QList<ITodo*> todos;
+  QVariant cursor;
   do {
-    todos = m_database->getTodos( IDatabase::QueryDisposed, 100 );
+    todos = m_database->getTodos( IDatabase::QueryDisposed, 100, cursor );
     for ( ITodo *todo : todos ) {
-      QString fileName = m_localStorageDirectory + "/" +
-          todo->metaAttributes().value( TodoMetaFileName, QString() ).toString();
+      QString relativeFileName = todo->metaAttributes().value( TodoMetaFileName, QString() ).toString();
+      QString fileName = m_localStorageDirectory + "/" + relativeFileName;
       QFileInfo fi( fileName );
       if ( fi.exists() ) {
         QFile file( fileName );
         file.remove();
       }
+      m_manifest.remove( relativeFileName );
       QFileInfo dfi( fi.absolutePath() + fi.baseName() );
       if ( dfi.exists() && dfi.isDir() ) {
         QDir dir( dfi.absoluteFilePath() );
         dir.removeRecursively();
+        m_manifest.removeDirectory(
+              QDir( m_localStorageDirectory ).relativeFilePath( dfi.absoluteFilePath() ) );
       }
-      m_database->deleteTodo( todo );
-      delete todo;
+      m_database->deleteTodoAsync( todo );
     }
   } while ( !todos.isEmpty() );
 }
@@ -381,18 +882,19 @@ void LocalXmlBackend::deleteTodos()
 void LocalXmlBackend::deleteTasks()
 {
   QList<ITask*> tasks;
+  QVariant cursor;
   do {
-    tasks = m_database->getTasks( IDatabase::QueryDisposed, 100 );
+    tasks = m_database->getTasks( IDatabase::QueryDisposed, 100, cursor );
     for ( ITask* task : tasks ) {
-      QString fileName = m_localStorageDirectory + "/" +
-          task->metaAttributes().value( TaskMetaFileName ).toString();
+      QString relativeFileName = task->metaAttributes().value( TaskMetaFileName ).toString();
+      QString fileName = m_localStorageDirectory + "/" + relativeFileName;
       QFileInfo fi( fileName );
       if ( fi.exists() && fi.isFile() ) {
         QFile file( fileName );
         file.remove();
       }
-      m_database->deleteTask( task );
-      delete task;
+      m_manifest.remove( relativeFileName );
+      m_database->deleteTaskAsync( task );
     }
   } while ( !tasks.isEmpty() );
 }
@@ -400,8 +902,9 @@ void LocalXmlBackend::deleteTasks()
 void LocalXmlBackend::saveTodoLists()
 {
   QList<ITodoList*> todoLists;
+  QVariant cursor;
   do {
-    todoLists = m_database->getTodoLists( IDatabase::QueryDirty, 100 );
+    todoLists = m_database->getTodoLists( IDatabase::QueryDirty, 100, cursor );
     for ( ITodoList *todoList : todoLists ) {
       QString fileName = todoList->metaAttributes().value( TodoListMetaFileName ).toString();
       if ( fileName.isEmpty() ) {
@@ -418,21 +921,30 @@ void LocalXmlBackend::saveTodoLists()
         }
       }
       saveTodoList( todoList );
-      m_database->onTodoListSaved(todoList);
-      delete todoList;
+      m_database->onTodoListSavedAsync( todoList );
     }
   } while ( !todoLists.isEmpty() );
+  commitFiles();
 }
 
 void LocalXmlBackend::saveTodos()
 {
   QList<ITodo*> todos;
+  QVariant cursor;
   do {
-    todos = m_database->getTodos( IDatabase::QueryDirty, 100 );
+    todos = m_database->getTodos( IDatabase::QueryDirty, 100, cursor );
+    // Look up the todo lists of all todos which are not yet stored in a file at once:
+    QList<QUuid> todoListUuids;
+    for ( ITodo *todo : todos ) {
+      if ( todo->metaAttributes().value( TodoMetaFileName ).toString().isEmpty() ) {
+        todoListUuids << todo->todoList();
+      }
+    }
+    QHash<QUuid, ITodoList*> todoLists = m_database->getTodoLists( todoListUuids );
     for ( ITodo *todo : todos ) {
       QString fileName = todo->metaAttributes().value( TodoMetaFileName ).toString();
       if ( fileName.isEmpty() ) {
-        ITodoList* todoList = m_database->getTodoList( todo->todoList() );
+        ITodoList* todoList = todoLists.value( todo->todoList() );
         if ( todoList ) {
           QString todoListFileName = m_localStorageDirectory + "/" +
               todoList->metaAttributes().value( TodoListMetaFileName ).toString();
@@ -447,25 +959,34 @@ void LocalXmlBackend::saveTodos()
               todo->setMetaAttributes( attrs );
             }
           }
-          delete todoList;
         }
       }
       saveTodo( todo );
-      m_database->onTodoSaved(todo);
-      delete todo;
+      m_database->onTodoSavedAsync( todo );
     }
+    qDeleteAll( todoLists );
   } while ( !todos.isEmpty() );
+  commitFiles();
 }
 
 void LocalXmlBackend::saveTasks()
 {
   QList<ITask*> tasks;
+  QVariant cursor;
   do {
-    tasks = m_database->getTasks( IDatabase::QueryDirty, 100 );
+    tasks = m_database->getTasks( IDatabase::QueryDirty, 100, cursor );
+    // Look up the todos of all tasks which are not yet stored in a file at once:
+    QList<QUuid> todoUuids;
+    for ( ITask *task : tasks ) {
+      if ( task->metaAttributes().value( TaskMetaFileName ).toString().isEmpty() ) {
+        todoUuids << task->todo();
+      }
+    }
+    QHash<QUuid, ITodo*> todos = m_database->getTodos( todoUuids );
     for ( ITask *task : tasks ) {
       QString fileName = task->metaAttributes().value( TaskMetaFileName ).toString();
       if ( fileName.isEmpty() ) {
-        ITodo* todo = m_database->getTodo( task->todo() );
+        ITodo* todo = todos.value( task->todo() );
         if ( todo ) {
           QString todoFileName = m_localStorageDirectory + "/" +
               todo->metaAttributes().value( TodoMetaFileName ).toString();
@@ -480,24 +1001,27 @@ void LocalXmlBackend::saveTasks()
               task->setMetaAttributes( attrs );
             }
           }
-          delete todo;
         }
       }
       saveTask( task );
-      m_database->onTaskSaved( task );
-      delete task;
+      m_database->onTaskSavedAsync( task );
     }
+    qDeleteAll( todos );
   } while ( !tasks.isEmpty() );
+  commitFiles();
 }
 
 void LocalXmlBackend::saveTodoList(ITodoList *todoList)
 {
   QString fileName = todoList->metaAttributes().value( TodoListMetaFileName ).toString();
   if ( !fileName.isEmpty() ) {
-    QDomDocument doc = documentForFile( fileName );
-    if ( todoListToDom( todoList, doc ) ) {
-      documentToFile( doc, fileName );
-      todoList->insertMetaAttribute( TodoListMetaHash, hashForFile( fileName ) );
+    LocalXmlDocument doc = currentDocumentForFile( fileName );
+    if ( todoListToDocument( todoList, doc ) ) {
+      LocalXmlManifest::Entry entry;
+      entry.uuid = todoList->uuid();
+      entry.hash = documentToFile( doc, fileName );
+      todoList->insertMetaAttribute( TodoListMetaHash, entry.hash );
+      m_pendingEntries.insert( fileName, entry );
     }
   }
 }
@@ -506,10 +1030,13 @@ void LocalXmlBackend::saveTodo(ITodo *todo)
 {
   QString fileName = todo->metaAttributes().value( TodoMetaFileName ).toString();
   if ( !fileName.isEmpty() ) {
-    QDomDocument doc = documentForFile( fileName );
-    if ( todoToDom( todo, doc ) ) {
-      documentToFile( doc, fileName );
-      todo->insertMetaAttribute( TodoMetaHash, hashForFile( fileName ) );
+    LocalXmlDocument doc = currentDocumentForFile( fileName );
+    if ( todoToDocument( todo, doc ) ) {
+      LocalXmlManifest::Entry entry;
+      entry.uuid = todo->uuid();
+      entry.hash = documentToFile( doc, fileName );
+      todo->insertMetaAttribute( TodoMetaHash, entry.hash );
+      m_pendingEntries.insert( fileName, entry );
     }
   }
 }
@@ -518,90 +1045,144 @@ void LocalXmlBackend::saveTask(ITask *task)
 {
   QString fileName = task->metaAttributes().value( TaskMetaFileName ).toString();
   if ( !fileName.isEmpty() ) {
-    QDomDocument doc = documentForFile( fileName );
-    if ( taskToDom( task, doc ) ) {
-      documentToFile( doc, fileName );
-      task->insertMetaAttribute( TaskMetaHash, hashForFile( fileName ) );
+    LocalXmlDocument doc = currentDocumentForFile( fileName );
+    if ( taskToDocument( task, doc ) ) {
+      LocalXmlManifest::Entry entry;
+      entry.uuid = task->uuid();
+      entry.hash = documentToFile( doc, fileName );
+      task->insertMetaAttribute( TaskMetaHash, entry.hash );
+      m_pendingEntries.insert( fileName, entry );
     }
   }
 }
 
 /**
    @brief Ensure the todo list is compatible with 0.2 app version
+
+   Fixes the @p doc read from the @p todoList file and writes it back if needed. Returns true
+   if the file has been changed.
+
    @todo Remove this in 0.3 release
  */
-void LocalXmlBackend::fixTodoList(const QString &todoList)
+bool LocalXmlBackend::fixTodoList(LocalXmlDocument &doc, const QString &todoList)
 {
-  QDomDocument doc = documentForFile( todoList );
-  QDomElement root = doc.documentElement();
-  if ( !root.hasAttribute( "id" ) ) {
-    root.setAttribute( "id", QUuid::createUuid().toString() );
+  if ( !doc.isNull() && !doc.hasAttribute( "id" ) ) {
+    doc.setAttribute( "id", QUuid::createUuid().toString() );
     documentToFile( doc, todoList );
+    commitFiles();
     qDebug() << "Todo list" << todoList << "updated!";
+    return true;
   }
+  return false;
 }
 
 /**
    @brief Ensure the todo is compatible with 0.2 app version
+
+   Fixes the @p doc read from the @p todo file and writes it back if needed. Returns true
+   if the file has been changed.
+
    @todo Remove this in 0.3 release
  */
-void LocalXmlBackend::fixTodo(const QString &todo)
+bool LocalXmlBackend::fixTodo(LocalXmlDocument &doc, const QString &todo)
 {
-  QDomDocument doc = documentForFile( todo );
-  QDomElement root = doc.documentElement();
+  if ( doc.isNull() ) {
+    return false;
+  }
   bool changed = false;
-  if ( !root.hasAttribute( "id" ) ) {
-    root.setAttribute( "id", QUuid::createUuid().toString() );
+  if ( !doc.hasAttribute( "id" ) ) {
+    doc.setAttribute( "id", QUuid::createUuid().toString() );
     changed = true;
   }
-  if ( !root.hasAttribute( "done" ) ) {
-    root.setAttribute( "done", root.attribute( "progress", "0" ).toInt() == 100 ? "true" : "false" );
+  if ( !doc.hasAttribute( "done" ) ) {
+    doc.setAttribute( "done", doc.attribute( "progress", "0" ).toInt() == 100 ? "true" : "false" );
     changed = true;
   }
-  if ( !root.hasAttribute( "weight" ) ) {
-    root.setAttribute( "weight",  ( qrand() % 10000 / 100.0 )  );
+  if ( !doc.hasAttribute( "weight" ) ) {
+    doc.setAttribute( "weight",  ( qrand() % 10000 / 100.0 )  );
     changed = true;
   }
   if ( changed ) {
     documentToFile( doc, todo );
+    commitFiles();
     qDebug() << "Todo" << todo << "updated!";
   }
+  return changed;
 }
 
-QDomDocument LocalXmlBackend::documentForFile(const QString &fileName) const
+/**
+   @brief Reads the XML document stored in the file @p fileName
+
+   If @p hash is given, the hash of the file's content is computed from the data read as
+   well, so the file does not have to be read twice.
+ */
+LocalXmlDocument LocalXmlBackend::documentForFile(const QString &fileName, QByteArray *hash) const
 {
   QString fullName = m_localStorageDirectory + "/" + fileName;
   QFile file( fullName );
   if ( file.exists() ) {
     if ( file.open( QIODevice::ReadOnly ) ) {
-      QDomDocument doc;
+      QByteArray data = file.readAll();
+      file.close();
+      if ( hash ) {
+        *hash = hashForData( data );
+      }
+      LocalXmlDocument doc;
       QString errorMsg;
       int errorLine, errorColumn;
-      if ( doc.setContent(  &file, &errorMsg, &errorLine, &errorColumn ) ) {
-        file.close();
+      if ( doc.setContent( data, &errorMsg, &errorLine, &errorColumn ) ) {
         return doc;
       } else {
         qWarning() << "Error reading XML document:" << errorMsg << "in line" << errorLine
                    << "in column" << errorColumn;
       }
-      file.close();
     } else {
       qWarning() << "Unable to open" << file.fileName() << "for reading!";
     }
   }
-  return QDomDocument();
+  return LocalXmlDocument();
 }
 
-void LocalXmlBackend::documentToFile(const QDomDocument &doc, const QString &fileName) const
+/**
+   @brief Returns the document stored in @p fileName including changes not committed yet
+
+   If the file has been written in the current batch, the batch is committed first.
+ */
+LocalXmlDocument LocalXmlBackend::currentDocumentForFile(const QString &fileName)
 {
-  QString fullName = m_localStorageDirectory + "/" + fileName;
-  QFile file( fullName );
-  if ( file.open( QIODevice::WriteOnly ) ) {
-    file.write( doc.toByteArray( 2 ) );
-    file.close();
-  } else {
-    qWarning() << "Failed to open file" << fullName << "for writing:" << file.errorString();
+  if ( m_writeBatch.contains( fileName ) ) {
+    commitFiles();
+  }
+  return documentForFile( fileName );
+}
+
+/**
+   @brief Writes the @p doc to the file @p fileName
+
+   The file is written as part of the current batch and replaced on the next call to
+   commitFiles(). Returns the hash of the data written.
+ */
+QByteArray LocalXmlBackend::documentToFile(const LocalXmlDocument &doc, const QString &fileName)
+{
+  QByteArray data = doc.toByteArray();
+  if ( m_writeBatch.write( fileName, data ) ) {
+    return hashForData( data );
   }
+  return QByteArray();
+}
+
+/**
+   @brief Replaces the files written in the current batch and updates the manifest accordingly
+ */
+void LocalXmlBackend::commitFiles()
+{
+  for ( const QString &fileName : m_writeBatch.commit() ) {
+    auto it = m_pendingEntries.constFind( fileName );
+    if ( it != m_pendingEntries.constEnd() ) {
+      m_manifest.record( fileName, it.value().uuid, it.value().hash );
+    }
+  }
+  m_pendingEntries.clear();
 }
 
 QByteArray LocalXmlBackend::hashForFile(const QString &fileName) const
@@ -617,38 +1198,34 @@ QByteArray LocalXmlBackend::hashForFile(const QString &fileName) const
   return QByteArray();
 }
 
-bool LocalXmlBackend::todoListNeedsUpdate(ITodoList *todoList, const QString &fileName, QByteArray &hash) const
+/**
+   @brief Returns the hash of the @p data (in the same format as hashForFile())
+ */
+QByteArray LocalXmlBackend::hashForData(const QByteArray &data)
 {
-  bool result = true;
-  hash = hashForFile( fileName );
-  ITodoList *existingTodoList = m_database->getTodoList( todoList->uuid() );
-  if ( existingTodoList ) {
-    result = hash != existingTodoList->metaAttributes().value( TodoListMetaHash ).toByteArray();
-    delete existingTodoList;
-  }
-  return result;
+  return QCryptographicHash::hash( data, QCryptographicHash::Sha3_512 ).toHex();
 }
 
-bool LocalXmlBackend::todoNeedsUpdate(ITodo *todo, const QString &fileName, QByteArray &hash) const
+/**
+   @brief Checks whether a todo list needs to be written to the database
+
+   Compares the @p hash of the todo list's file with the one stored with the @p existing
+   todo list (if any).
+ */
+bool LocalXmlBackend::todoListNeedsUpdate(const ITodoList *existing, const QByteArray &hash) const
 {
-  bool result = true;
-  hash = hashForFile( fileName );
-  ITodo *existingTodo = m_database->getTodo( todo->uuid() );
-  if ( existingTodo ) {
-    result = existingTodo->metaAttributes().value( TodoMetaHash ).toByteArray() != hash;
-    delete existingTodo;
-  }
-  return result;
+  return existing == nullptr ||
+      hash != existing->metaAttributes().value( TodoListMetaHash ).toByteArray();
 }
 
-bool LocalXmlBackend::taskNeedsUpdate(ITask *task, const QString &fileName, QByteArray &hash) const
+bool LocalXmlBackend::todoNeedsUpdate(const ITodo *existing, const QByteArray &hash) const
 {
-  bool result = true;
-  hash = hashForFile( fileName );
-  ITask *existingTask = m_database->getTask( task->uuid() );
-  if ( existingTask ) {
-    result = existingTask->metaAttributes().value( TaskMetaHash ).toByteArray() != hash;
-    delete existingTask;
-  }
-  return result;
+  return existing == nullptr ||
+      existing->metaAttributes().value( TodoMetaHash ).toByteArray() != hash;
+}
+
+bool LocalXmlBackend::taskNeedsUpdate(const ITask *existing, const QByteArray &hash) const
+{
+  return existing == nullptr ||
+      existing->metaAttributes().value( TaskMetaHash ).toByteArray() != hash;
 }
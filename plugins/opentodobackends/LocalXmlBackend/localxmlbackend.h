@@ -20,8 +20,15 @@
 #define LOCALXMLBACKEND_H
 
 #include "opentodolistinterfaces.h"
+#include "localxmldocument.h"
+#include "localxmlmanifest.h"
+#include "localxmlwritebatch.h"
 
-#include <QDomDocument>
+#include <QFuture>
+#include <QSet>
+
+class QFileSystemWatcher;
+class QTimer;
 
 using namespace OpenTodoList;
 
@@ -30,7 +37,7 @@ class LocalXmlBackend : public QObject, public OpenTodoList::IBackend
     Q_OBJECT
     Q_INTERFACES(OpenTodoList::IBackend)
 #if QT_VERSION >= 0x050000
-    Q_PLUGIN_METADATA(IID "net.rpdev.OpenTodoList.Backend/1.0" FILE "LocalXmlBackend.json")
+    Q_PLUGIN_METADATA(IID "net.rpdev.OpenTodoList.Backend/2.0" FILE "LocalXmlBackend.json")
 #endif // QT_VERSION >= 0x050000
     
 public:
@@ -50,25 +57,90 @@ public:
 
 private:
 
+    /**
+       @brief The result of reading a single file
+     */
+    struct ParsedFile {
+      LocalXmlDocument doc;
+      QByteArray   hash;
+    };
+
+    /**
+       @brief A file found while importing the local storage directory on start up
+     */
+    struct ImportFile {
+      enum Kind {
+        TodoListFile,
+        TodoFile,
+        TaskFile
+      };
+
+      Kind                    kind;
+      QString                 fileName;
+      int                     parent;   //!< Index of the file holding the parent object (or -1)
+      QString                 parentFileName;
+      bool                    changed;  //!< Whether the file changed since it has been recorded
+      LocalXmlManifest::Entry entry;
+      QFuture<ParsedFile>     parsed;   //!< The pending result of reading a changed file
+    };
+
+    /**
+       @brief Objects read from files waiting to be inserted into the database
+     */
+    struct ImportBatch {
+      QList<OpenTodoList::ITodoList*> todoLists;
+      QList<OpenTodoList::ITodo*>     todos;
+      QList<OpenTodoList::ITask*>     tasks;
+    };
+
     OpenTodoList::IDatabase         *m_database;
     QString                          m_localStorageDirectory;
 
     OpenTodoList::IAccount          *m_account;
+    LocalXmlManifest                 m_manifest;
+    LocalXmlWriteBatch               m_writeBatch;
+    QHash<QString, LocalXmlManifest::Entry> m_pendingEntries;
+
+    QFileSystemWatcher              *m_watcher;
+    QTimer                          *m_importTimer;
+    QSet<QString>                    m_watchedPaths;
+    QSet<QString>                    m_changedFiles;
+    QSet<QString>                    m_changedDirectories;
+    bool                             m_importing;
 
     QStringList locateTodoLists() const;
     QStringList locateTodos( const QString &todoList ) const;
     QStringList locateTasks( const QString &todo ) const;
 
+    void enqueueImportFiles( QList<ImportFile> &files, ImportFile::Kind kind, int parent,
+                             const QStringList &fileNames );
+    ParsedFile parseFile( const QString &fileName ) const;
+    void importDocument( ImportFile &file, LocalXmlDocument &doc, const QUuid &parentUuid,
+                         ImportBatch &batch );
+    void importTodoLists( QList<OpenTodoList::ITodoList*> &todoLists );
+    void importTodos( QList<OpenTodoList::ITodo*> &todos );
+    void importTasks( QList<OpenTodoList::ITask*> &tasks );
+
+    void startWatching( const QSet<QString> &fileNames );
+    void stopWatching();
+    void watchPaths( const QStringList &paths );
+    void unwatchPath( const QString &path );
+    void importChanges();
+    void scanDirectory( const QString &directory, QSet<QString> &fileNames,
+                        QStringList &newPaths ) const;
+    static bool classifyFile( const QString &fileName, ImportFile::Kind *kind,
+                              QString *parentFileName = nullptr );
+
     static bool todoListToFile( const OpenTodoList::ITodoList *todoList );
     static bool todoToFile( const OpenTodoList::ITodo *todo );
     static bool taskToFile( const OpenTodoList::ITask *task );
 
-    static bool todoListToDom( const OpenTodoList::ITodoList *list, QDomDocument &doc );
-    static bool domToTodoList( const QDomDocument &doc, OpenTodoList::ITodoList *list );
-    static bool todoToDom( const OpenTodoList::ITodo *todo, QDomDocument &doc );
-    static bool domToTodo(const QDomDocument &doc, OpenTodoList::ITodo *todo );
-    static bool taskToDom( const OpenTodoList::ITask *task, QDomDocument &doc );
-    static bool domToTask( const QDomDocument &doc, OpenTodoList::ITask *task );
+    static bool todoListToDocument( const OpenTodoList::ITodoList *list, LocalXmlDocument &doc );
+    static bool documentToTodoList( const LocalXmlDocument &doc, OpenTodoList::ITodoList *list );
+    static bool todoToDocument( const OpenTodoList::ITodo *todo, LocalXmlDocument &doc );
+    static bool documentToTodo( const LocalXmlDocument &doc, OpenTodoList::ITodo *todo );
+    static bool taskToDocument( const OpenTodoList::ITask *task, LocalXmlDocument &doc );
+    static bool documentToTask( const LocalXmlDocument &doc, OpenTodoList::ITask *task );
 
     void deleteTodoLists();
     void deleteTodos();
@@ -82,17 +154,23 @@ private:
     void saveTodo(OpenTodoList::ITodo *todo);
     void saveTask(OpenTodoList::ITask *task);
 
-    void fixTodoList( const QString &todoList );
-    void fixTodo( const QString &todo );
+    bool fixTodoList( LocalXmlDocument &doc, const QString &todoList );
+    bool fixTodo( LocalXmlDocument &doc, const QString &todo );
 
-    QDomDocument documentForFile( const QString &fileName ) const;
-    void documentToFile( const QDomDocument &doc, const QString &fileName ) const;
+    LocalXmlDocument documentForFile( const QString &fileName, QByteArray *hash = nullptr ) const;
+    LocalXmlDocument currentDocumentForFile( const QString &fileName );
+    QByteArray documentToFile( const LocalXmlDocument &doc, const QString &fileName );
+    void commitFiles();
     QByteArray hashForFile( const QString &fileName ) const;
+    static QByteArray hashForData( const QByteArray &data );
+
+    bool todoListNeedsUpdate( const OpenTodoList::ITodoList *existing, const QByteArray &hash ) const;
+    bool todoNeedsUpdate( const OpenTodoList::ITodo *existing, const QByteArray &hash ) const;
+    bool taskNeedsUpdate( const OpenTodoList::ITask *existing, const QByteArray &hash ) const;
 
-    bool todoListNeedsUpdate( OpenTodoList::ITodoList *todoList, const QString &fileName, QByteArray &hash ) const;
-    bool todoNeedsUpdate( OpenTodoList::ITodo *todo, const QString &fileName, QByteArray &hash ) const;
-    bool taskNeedsUpdate( OpenTodoList::ITask *task, const QString &fileName, QByteArray &hash ) const;
 
+    static const int ImportBatchSize = 256;
+    static const int ImportDelay = 250;
 
     static const QString TodoListConfigFileName;
     static const QString TodoDirectoryName;
@@ -0,0 +1,323 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "localxmldocument.h"
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+/**
+   @brief Creates a null document
+
+   Set the rootName() or read a document using setContent() before using it.
+ */
+LocalXmlDocument::LocalXmlDocument() :
+  m_rootName(),
+  m_attributes(),
+  m_elements()
+{
+}
+
+/**
+   @brief Returns true if the document has no root element
+ */
+bool LocalXmlDocument::isNull() const
+{
+  return m_rootName.isEmpty();
+}
+
+/**
+   @brief The name of the root element
+ */
+QString LocalXmlDocument::rootName() const
+{
+  return m_rootName;
+}
+
+/**
+   @brief Sets the @p name of the root element
+ */
+void LocalXmlDocument::setRootName(const QString &name)
+{
+  m_rootName = name;
+}
+
+/**
+   @brief Returns true if the root element has an attribute with the given @p name
+ */
+bool LocalXmlDocument::hasAttribute(const QString &name) const
+{
+  return indexOfAttribute( name ) >= 0;
+}
+
+/**
+   @brief Returns the value of the root element's attribute @p name
+
+   If the attribute does not exist, @p defaultValue is returned.
+ */
+QString LocalXmlDocument::attribute(const QString &name, const QString &defaultValue) const
+{
+  int index = indexOfAttribute( name );
+  if ( index >= 0 ) {
+    return m_attributes.at( index ).value().toString();
+  }
+  return defaultValue;
+}
+
+/**
+   @brief Sets the root element's attribute @p name to @p value
+
+   Existing attributes keep their position, new ones are appended.
+ */
+void LocalXmlDocument::setAttribute(const QString &name, const QString &value)
+{
+  int index = indexOfAttribute( name );
+  if ( index >= 0 ) {
+    m_attributes[index] = QXmlStreamAttribute( name, value );
+  } else {
+    m_attributes.append( name, value );
+  }
+}
+
+void LocalXmlDocument::setAttribute(const QString &name, int value)
+{
+  setAttribute( name, QString::number( value ) );
+}
+
+/**
+   @brief Sets the root element's attribute @p name to the floating point @p value
+
+   The value is written with 16 significant digits like QDomElement did, so e.g. the weights
+   of todos placed in between others do not lose precision when being saved.
+ */
+void LocalXmlDocument::setAttribute(const QString &name, double value)
+{
+  setAttribute( name, QString::number( value, 'g', 16 ) );
+}
+
+/**
+   @brief Removes the root element's attribute @p name
+ */
+void LocalXmlDocument::removeAttribute(const QString &name)
+{
+  int index = indexOfAttribute( name );
+  if ( index >= 0 ) {
+    m_attributes.remove( index );
+  }
+}
+
+/**
+   @brief Returns true if the root element has a child element with the given @p name
+ */
+bool LocalXmlDocument::hasElement(const QString &name) const
+{
+  return indexOfElement( name ) >= 0;
+}
+
+/**
+   @brief Returns the text contained in the root element's first child element @p name
+ */
+QString LocalXmlDocument::elementText(const QString &name) const
+{
+  int index = indexOfElement( name );
+  if ( index >= 0 ) {
+    return m_elements.at( index ).text;
+  }
+  return QString();
+}
+
+/**
+   @brief Sets the content of the root element's first child element @p name to @p text
+
+   The element is appended to the root element if it does not exist yet. Any nested content
+   of the element is replaced, its attributes are kept.
+ */
+void LocalXmlDocument::setElementText(const QString &name, const QString &text)
+{
+  int index = indexOfElement( name );
+  if ( index < 0 ) {
+    Element element;
+    element.name = name;
+    m_elements.append( element );
+    index = m_elements.size() - 1;
+  }
+  Element &element = m_elements[index];
+  element.text = text;
+  element.xml.clear();
+}
+
+/**
+   @brief Reads the document from the XML @p data
+
+   On failure, the document is null afterwards and the error is reported via @p errorMsg,
+   @p errorLine and @p errorColumn (if given).
+ */
+bool LocalXmlDocument::setContent(const QByteArray &data, QString *errorMsg,
+                                  int *errorLine, int *errorColumn)
+{
+  m_rootName.clear();
+  m_attributes.clear();
+  m_elements.clear();
+
+  QXmlStreamReader reader( data );
+  reader.setNamespaceProcessing( false );
+  while ( !reader.atEnd() ) {
+    reader.readNext();
+    if ( reader.isStartElement() ) {
+      if ( m_rootName.isEmpty() ) {
+        m_rootName = reader.qualifiedName().toString();
+        m_attributes = reader.attributes();
+      } else {
+        readElement( reader );
+      }
+    }
+  }
+
+  if ( reader.hasError() ) {
+    if ( errorMsg ) {
+      *errorMsg = reader.errorString();
+    }
+    if ( errorLine ) {
+      *errorLine = reader.lineNumber();
+    }
+    if ( errorColumn ) {
+      *errorColumn = reader.columnNumber();
+    }
+    m_rootName.clear();
+    m_attributes.clear();
+    m_elements.clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+   @brief Returns the document serialized as (indented) XML
+ */
+QByteArray LocalXmlDocument::toByteArray() const
+{
+  QByteArray result;
+  if ( isNull() ) {
+    return result;
+  }
+  QXmlStreamWriter writer( &result );
+  writer.setAutoFormatting( true );
+  writer.setAutoFormattingIndent( 2 );
+  writer.writeStartDocument();
+  writer.writeStartElement( m_rootName );
+  writer.writeAttributes( m_attributes );
+  for ( const Element &element : m_elements ) {
+    writeElement( writer, element );
+  }
+  writer.writeEndElement();
+  writer.writeEndDocument();
+  return result;
+}
+
+int LocalXmlDocument::indexOfAttribute(const QString &name) const
+{
+  for ( int i = 0; i < m_attributes.size(); ++i ) {
+    if ( m_attributes.at( i ).qualifiedName() == name ) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int LocalXmlDocument::indexOfElement(const QString &name) const
+{
+  for ( int i = 0; i < m_elements.size(); ++i ) {
+    if ( m_elements.at( i ).name == name ) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+   @brief Reads the child element the @p reader is positioned at
+
+   Elements with text only are stored as such. If the element has nested content, the
+   element is additionally serialized as is, so it can be written back unchanged.
+ */
+void LocalXmlDocument::readElement(QXmlStreamReader &reader)
+{
+  Element element;
+  element.name = reader.qualifiedName().toString();
+  element.attributes = reader.attributes();
+
+  QString xml;
+  QXmlStreamWriter writer( &xml );
+  writer.writeCurrentToken( reader );
+  bool nested = false;
+  int depth = 0;
+  while ( !reader.atEnd() ) {
+    reader.readNext();
+    if ( reader.isStartElement() ) {
+      ++depth;
+      nested = true;
+    } else if ( reader.isEndElement() ) {
+      --depth;
+    } else if ( reader.isCharacters() ) {
+      element.text += reader.text();
+      if ( reader.isWhitespace() ) {
+        continue;
+      }
+    } else if ( reader.isComment() || reader.isProcessingInstruction() ) {
+      nested = true;
+    } else if ( reader.hasError() ) {
+      return;
+    }
+    writer.writeCurrentToken( reader );
+    if ( depth < 0 ) {
+      break;
+    }
+  }
+
+  if ( nested ) {
+    element.xml = xml;
+  }
+  m_elements.append( element );
+}
+
+/**
+   @brief Writes the @p element using the @p writer
+ */
+void LocalXmlDocument::writeElement(QXmlStreamWriter &writer, const Element &element)
+{
+  if ( element.xml.isEmpty() ) {
+    writer.writeStartElement( element.name );
+    writer.writeAttributes( element.attributes );
+    writer.writeCharacters( element.text );
+    writer.writeEndElement();
+  } else {
+    // Replay the serialized element token by token, so it is indented like the rest
+    QXmlStreamReader reader( element.xml );
+    reader.setNamespaceProcessing( false );
+    while ( !reader.atEnd() ) {
+      reader.readNext();
+      if ( reader.hasError() ) {
+        break;
+      }
+      if ( reader.isStartDocument() || reader.isEndDocument() || reader.isWhitespace() ) {
+        continue;
+      }
+      writer.writeCurrentToken( reader );
+    }
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCALXMLDOCUMENT_H
+#define LOCALXMLDOCUMENT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QXmlStreamAttributes>
+
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+/**
+   @brief A flat XML document as used by the LocalXmlBackend
+
+   The files of the LocalXmlBackend consist of a root element with attributes and a (usually
+   small) number of child elements. This class reads and writes such files using
+   QXmlStreamReader and QXmlStreamWriter instead of building a full DOM tree.
+
+   The attributes of the root element and the text of its child elements can be accessed
+   and modified. Child elements with nested content are kept as serialized XML and written
+   back unchanged, so elements and attributes unknown to the backend survive a
+   read-modify-write cycle.
+ */
+class LocalXmlDocument
+{
+public:
+
+  LocalXmlDocument();
+
+  bool isNull() const;
+  QString rootName() const;
+  void setRootName( const QString &name );
+
+  bool hasAttribute( const QString &name ) const;
+  QString attribute( const QString &name, const QString &defaultValue = QString() ) const;
+  void setAttribute( const QString &name, const QString &value );
+  void setAttribute( const QString &name, int value );
+  void setAttribute( const QString &name, double value );
+  void removeAttribute( const QString &name );
+
+  bool hasElement( const QString &name ) const;
+  QString elementText( const QString &name ) const;
+  void setElementText( const QString &name, const QString &text );
+
+  bool setContent( const QByteArray &data, QString *errorMsg = nullptr,
+                   int *errorLine = nullptr, int *errorColumn = nullptr );
+  QByteArray toByteArray() const;
+
+private:
+
+  /**
+     @brief A child element of the root element
+   */
+  struct Element {
+    QString              name;
+    QXmlStreamAttributes attributes;
+    QString              text;  //!< All text contained in the element
+    QString              xml;   //!< The serialized element if it has nested content
+  };
+
+  QString              m_rootName;
+  QXmlStreamAttributes m_attributes;
+  QList<Element>       m_elements;
+
+  int indexOfAttribute( const QString &name ) const;
+  int indexOfElement( const QString &name ) const;
+  void readElement( QXmlStreamReader &reader );
+  static void writeElement( QXmlStreamWriter &writer, const Element &element );
+
+};
+
+#endif // LOCALXMLDOCUMENT_H
@@ -0,0 +1,328 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "localxmlmanifest.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+const QString LocalXmlManifest::FileName = ".manifest";
+
+LocalXmlManifest::Entry::Entry() :
+  size( -1 ),
+  modified( 0 ),
+  inode( 0 ),
+  uuid(),
+  hash()
+{
+}
+
+/**
+   @brief Checks whether the @p other entry describes the same, unmodified file
+
+   Only the metadata (size, modification time and inode) is compared.
+ */
+bool LocalXmlManifest::Entry::sameFile(const Entry &other) const
+{
+  return exists() && size == other.size && modified == other.modified && inode == other.inode;
+}
+
+/**
+   @brief Constructor
+
+   The manifest describes the files in the given @p directory. Call load() to read the
+   manifest stored in the directory.
+ */
+LocalXmlManifest::LocalXmlManifest(const QString &directory) :
+  m_directory( directory ),
+  m_entries(),
+  m_dirty( false )
+{
+}
+
+/**
+   @brief The directory the manifest describes
+ */
+QString LocalXmlManifest::directory() const
+{
+  return m_directory;
+}
+
+/**
+   @brief Sets the @p directory the manifest describes
+
+   This drops all entries of the manifest.
+ */
+void LocalXmlManifest::setDirectory(const QString &directory)
+{
+  m_directory = directory;
+  m_entries.clear();
+  m_dirty = false;
+}
+
+/**
+   @brief Reads the manifest from the directory
+
+   If the manifest cannot be read (e.g. because it does not exist yet or has been written by
+   an incompatible version), the manifest is empty afterwards and false is returned.
+ */
+bool LocalXmlManifest::load()
+{
+  m_entries.clear();
+  m_dirty = false;
+  QFile file( m_directory + "/" + FileName );
+  if ( !file.open( QIODevice::ReadOnly ) ) {
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  quint32 magic = 0;
+  quint32 version = 0;
+  qint32 count = 0;
+  stream >> magic >> version >> count;
+  if ( magic != Magic || version != Version || count < 0 ) {
+    qWarning() << "Ignoring incompatible manifest" << file.fileName();
+    return false;
+  }
+  m_entries.reserve( count );
+  for ( qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+    QString fileName;
+    Entry entry;
+    stream >> fileName >> entry.size >> entry.modified >> entry.inode >> entry.uuid
+           >> entry.hash;
+    m_entries.insert( fileName, entry );
+  }
+  if ( stream.status() != QDataStream::Ok ) {
+    qWarning() << "Failed to read manifest" << file.fileName();
+    m_entries.clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+   @brief Writes the manifest into the directory
+
+   The manifest is replaced atomically, so a crash while saving leaves the previous version
+   intact.
+ */
+bool LocalXmlManifest::save()
+{
+  QSaveFile file( m_directory + "/" + FileName );
+  if ( !file.open( QIODevice::WriteOnly ) ) {
+    qWarning() << "Failed to open manifest" << file.fileName() << "for writing:"
+               << file.errorString();
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_0 );
+  stream << Magic << Version << static_cast< qint32 >( m_entries.size() );
+  for ( auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it ) {
+    const Entry &entry = it.value();
+    stream << it.key() << entry.size << entry.modified << entry.inode << entry.uuid
+           << entry.hash;
+  }
+  if ( !file.commit() ) {
+    qWarning() << "Failed to write manifest" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+  m_dirty = false;
+  return true;
+}
+
+/**
+   @brief Whether the manifest has been changed since it has been loaded or saved
+ */
+bool LocalXmlManifest::isDirty() const
+{
+  return m_dirty;
+}
+
+/**
+   @brief Returns the current metadata of the file @p fileName
+
+   The @p fileName is relative to the directory of the manifest. If the file does not exist,
+   the returned entry's exists() method returns false.
+ */
+LocalXmlManifest::Entry LocalXmlManifest::stat(const QString &fileName) const
+{
+  Entry result;
+  QString fullName = m_directory + "/" + fileName;
+#ifdef Q_OS_UNIX
+  struct stat st;
+  if ( ::stat( QFile::encodeName( fullName ).constData(), &st ) == 0 ) {
+    result.size = st.st_size;
+    result.inode = st.st_ino;
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    result.modified = static_cast< qint64 >( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(Q_OS_MAC)
+    result.modified = static_cast< qint64 >( st.st_mtimespec.tv_sec ) * 1000000000 +
+        st.st_mtimespec.tv_nsec;
+#else
+    result.modified = static_cast< qint64 >( st.st_mtime ) * 1000000000;
+#endif
+  }
+#else
+  QFileInfo fi( fullName );
+  if ( fi.exists() ) {
+    result.size = fi.size();
+    result.modified = fi.lastModified().toMSecsSinceEpoch() * 1000000;
+  }
+#endif
+  return result;
+}
+
+/**
+   @brief Checks whether the file @p fileName is unchanged since it has been recorded
+
+   The @p current metadata of the file (see stat()) is compared with the recorded one. If
+   @p stored is given, the recorded entry is written to it.
+ */
+bool LocalXmlManifest::isUnchanged(const QString &fileName, const Entry &current,
+                                   Entry *stored) const
+{
+  auto it = m_entries.constFind( fileName );
+  if ( it == m_entries.constEnd() ) {
+    return false;
+  }
+  if ( stored ) {
+    *stored = it.value();
+  }
+  return it.value().sameFile( current );
+}
+
+/**
+   @brief Records the @p entry for the file @p fileName
+ */
+void LocalXmlManifest::insert(const QString &fileName, const Entry &entry)
+{
+  m_entries.insert( fileName, entry );
+  m_dirty = true;
+}
+
+/**
+   @brief Records the current state of the file @p fileName
+
+   The file contains the object with the given @p uuid, its content has the given @p hash.
+ */
+void LocalXmlManifest::record(const QString &fileName, const QUuid &uuid, const QByteArray &hash)
+{
+  Entry entry = stat( fileName );
+  if ( entry.exists() ) {
+    entry.uuid = uuid;
+    entry.hash = hash;
+    insert( fileName, entry );
+  } else {
+    remove( fileName );
+  }
+}
+
+/**
+   @brief Returns the recorded entry of the file @p fileName
+
+   If the file is not in the manifest, an entry for a non-existing file is returned.
+ */
+LocalXmlManifest::Entry LocalXmlManifest::entry(const QString &fileName) const
+{
+  return m_entries.value( fileName );
+}
+
+/**
+   @brief Returns the names of the recorded files within the given @p directory
+
+   The @p directory is relative to the one of the manifest; pass an empty string for the
+   manifest's directory itself. If @p recursive is false, only files directly located in the
+   @p directory are returned.
+ */
+QStringList LocalXmlManifest::fileNames(const QString &directory, bool recursive) const
+{
+  QString prefix = directory.isEmpty() || directory.endsWith( '/' ) ? directory : directory + "/";
+  QStringList result;
+  for ( auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it ) {
+    if ( it.key().startsWith( prefix ) &&
+         ( recursive || it.key().indexOf( '/', prefix.length() ) < 0 ) ) {
+      result << it.key();
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Removes the entry of the file @p fileName
+ */
+void LocalXmlManifest::remove(const QString &fileName)
+{
+  if ( m_entries.remove( fileName ) > 0 ) {
+    m_dirty = true;
+  }
+}
+
+/**
+   @brief Removes the entries of all files within the given @p directory
+
+   The @p directory is relative to the one of the manifest.
+ */
+void LocalXmlManifest::removeDirectory(const QString &directory)
+{
+  QString prefix = directory.endsWith( '/' ) ? directory : directory + "/";
+  for ( auto it = m_entries.begin(); it != m_entries.end(); ) {
+    if ( it.key().startsWith( prefix ) ) {
+      it = m_entries.erase( it );
+      m_dirty = true;
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+   @brief Removes the entries of all files not in @p fileNames
+ */
+void LocalXmlManifest::retain(const QSet<QString> &fileNames)
+{
+  for ( auto it = m_entries.begin(); it != m_entries.end(); ) {
+    if ( !fileNames.contains( it.key() ) ) {
+      it = m_entries.erase( it );
+      m_dirty = true;
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+   @brief Forgets about all files
+
+   Use this if the recorded state cannot be trusted anymore, e.g. because the objects read from
+   the files previously are not available in the database.
+ */
+void LocalXmlManifest::clear()
+{
+  if ( !m_entries.isEmpty() ) {
+    m_entries.clear();
+    m_dirty = true;
+  }
+}
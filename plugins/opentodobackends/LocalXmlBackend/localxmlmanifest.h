@@ -0,0 +1,91 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCALXMLMANIFEST_H
+#define LOCALXMLMANIFEST_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QUuid>
+
+/**
+   @brief Remembers the state of the files of the LocalXmlBackend
+
+   The manifest records the size, modification time and inode of each file the backend has
+   read or written, together with the UUID of the object stored in it and the hash of its
+   content. On start up, files whose metadata did not change since they have been recorded
+   are skipped without opening them.
+
+   The manifest is stored in the local storage directory of the backend.
+ */
+class LocalXmlManifest
+{
+public:
+
+  /**
+     @brief The recorded state of a single file
+   */
+  struct Entry {
+    qint64     size;      //!< The size of the file in bytes (-1 if it does not exist)
+    qint64     modified;  //!< The modification time (in ns since the epoch)
+    quint64    inode;     //!< The inode of the file (0 if not available)
+    QUuid      uuid;      //!< The UUID of the object stored in the file
+    QByteArray hash;      //!< The hash of the file's content
+
+    Entry();
+    bool exists() const { return size >= 0; }
+    bool sameFile( const Entry &other ) const;
+  };
+
+  static const QString FileName;
+
+  explicit LocalXmlManifest( const QString &directory = QString() );
+
+  QString directory() const;
+  void setDirectory( const QString &directory );
+
+  bool load();
+  bool save();
+  bool isDirty() const;
+
+  Entry stat( const QString &fileName ) const;
+  bool isUnchanged( const QString &fileName, const Entry &current, Entry *stored = nullptr ) const;
+  Entry entry( const QString &fileName ) const;
+  QStringList fileNames( const QString &directory, bool recursive ) const;
+  void insert( const QString &fileName, const Entry &entry );
+  void record( const QString &fileName, const QUuid &uuid, const QByteArray &hash );
+  void remove( const QString &fileName );
+  void removeDirectory( const QString &directory );
+  void retain( const QSet<QString> &fileNames );
+  void clear();
+
+private:
+
+  QString                 m_directory;
+  QHash<QString, Entry>   m_entries;
+  bool                    m_dirty;
+
+  static const quint32 Magic = 0x4f544c4d; // "OTLM"
+  static const quint32 Version = 1;
+
+};
+
+#endif // LOCALXMLMANIFEST_H
@@ -0,0 +1,239 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "localxmlwritebatch.h"
+
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStringList>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#endif
+
+const QString LocalXmlWriteBatch::TempSuffix = ".otl-tmp";
+
+/**
+   @brief Constructor
+
+   File names passed to the batch are relative to the @p directory.
+ */
+LocalXmlWriteBatch::LocalXmlWriteBatch(const QString &directory) :
+  m_directory( directory ),
+  m_fileNames(),
+  m_pending()
+{
+}
+
+/**
+   @brief Destructor
+
+   Pending files which have not been committed are discarded.
+ */
+LocalXmlWriteBatch::~LocalXmlWriteBatch()
+{
+  discard();
+}
+
+/**
+   @brief The directory the file names are relative to
+ */
+QString LocalXmlWriteBatch::directory() const
+{
+  return m_directory;
+}
+
+/**
+   @brief Sets the @p directory the file names are relative to
+
+   Pending files are discarded.
+ */
+void LocalXmlWriteBatch::setDirectory(const QString &directory)
+{
+  discard();
+  m_directory = directory;
+}
+
+/**
+   @brief Writes the @p data to a temporary file for @p fileName
+
+   The data is flushed to disk before returning. The file @p fileName itself is replaced on
+   the next call to commit().
+ */
+bool LocalXmlWriteBatch::write(const QString &fileName, const QByteArray &data)
+{
+  QFile file( m_directory + "/" + fileName + TempSuffix );
+  if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+    qWarning() << "Failed to open file" << file.fileName() << "for writing:"
+               << file.errorString();
+    return false;
+  }
+  if ( file.write( data ) != data.size() || !file.flush() || !flush( file.handle() ) ) {
+    qWarning() << "Failed to write file" << file.fileName() << ":" << file.errorString();
+    file.close();
+    file.remove();
+    return false;
+  }
+  file.close();
+  if ( !m_pending.contains( fileName ) ) {
+    m_pending.insert( fileName );
+    m_fileNames.append( fileName );
+  }
+  return true;
+}
+
+/**
+   @brief Returns true if new content for @p fileName is waiting to be committed
+ */
+bool LocalXmlWriteBatch::contains(const QString &fileName) const
+{
+  return m_pending.contains( fileName );
+}
+
+/**
+   @brief Returns true if there are no files waiting to be committed
+ */
+bool LocalXmlWriteBatch::isEmpty() const
+{
+  return m_fileNames.isEmpty();
+}
+
+/**
+   @brief Replaces the files written with their new content
+
+   Each directory containing a replaced file is flushed once afterwards. Returns the names
+   of the files which have been replaced.
+ */
+QStringList LocalXmlWriteBatch::commit()
+{
+  QStringList result;
+  QSet<QString> directories;
+  for ( const QString &fileName : m_fileNames ) {
+    QString target = m_directory + "/" + fileName;
+    if ( replace( target + TempSuffix, target ) ) {
+      result << fileName;
+      directories.insert( QFileInfo( target ).absolutePath() );
+    } else {
+      qWarning() << "Failed to replace file" << target;
+      QFile::remove( target + TempSuffix );
+    }
+  }
+  m_fileNames.clear();
+  m_pending.clear();
+  for ( const QString &directory : directories ) {
+    flushDirectory( directory );
+  }
+  return result;
+}
+
+/**
+   @brief Removes the temporary files of all files not committed yet
+ */
+void LocalXmlWriteBatch::discard()
+{
+  for ( const QString &fileName : m_fileNames ) {
+    QFile::remove( m_directory + "/" + fileName + TempSuffix );
+  }
+  m_fileNames.clear();
+  m_pending.clear();
+}
+
+/**
+   @brief Removes temporary files left over in the directory
+
+   Returns the number of files removed.
+ */
+int LocalXmlWriteBatch::removeStaleFiles() const
+{
+  int result = 0;
+  if ( m_directory.isEmpty() ) {
+    return result;
+  }
+  QDirIterator it( m_directory, { "*" + TempSuffix }, QDir::Files | QDir::Hidden,
+                   QDirIterator::Subdirectories );
+  while ( it.hasNext() ) {
+    QString fileName = it.next();
+    if ( QFile::remove( fileName ) ) {
+      qDebug() << "Removed stale temporary file" << fileName;
+      ++result;
+    }
+  }
+  return result;
+}
+
+/**
+   @brief Flushes the data written to the file @p handle to disk
+ */
+bool LocalXmlWriteBatch::flush(int handle)
+{
+#if defined(Q_OS_UNIX)
+  return ::fsync( handle ) == 0;
+#elif defined(Q_OS_WIN)
+  return ::_commit( handle ) == 0;
+#else
+  Q_UNUSED( handle );
+  return true;
+#endif
+}
+
+/**
+   @brief Replaces the @p target file with the @p source file
+
+   On Unix, this is an atomic rename. Elsewhere, the target is removed first.
+ */
+bool LocalXmlWriteBatch::replace(const QString &source, const QString &target)
+{
+#ifdef Q_OS_UNIX
+  return ::rename( QFile::encodeName( source ).constData(),
+                   QFile::encodeName( target ).constData() ) == 0;
+#else
+  QFile::remove( target );
+  return QFile::rename( source, target );
+#endif
+}
+
+/**
+   @brief Flushes the entries of the @p directory to disk
+
+   This makes renames done in the directory durable. This is a no-op on systems where
+   directories cannot be opened.
+ */
+bool LocalXmlWriteBatch::flushDirectory(const QString &directory)
+{
+#ifdef Q_OS_UNIX
+  int fd = ::open( QFile::encodeName( directory ).constData(), O_RDONLY );
+  if ( fd < 0 ) {
+    return false;
+  }
+  bool result = ::fsync( fd ) == 0;
+  ::close( fd );
+  return result;
+#else
+  Q_UNUSED( directory );
+  return true;
+#endif
+}
@@ -0,0 +1,70 @@
+/*
+ *  OpenTodoList - A todo and task manager
+ *  Copyright (C) 2014 - 2015  Martin Höher <martin@rpdev.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCALXMLWRITEBATCH_H
+#define LOCALXMLWRITEBATCH_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+   @brief Writes files of the LocalXmlBackend crash safe
+
+   Files are not overwritten in place. Instead, their new content is written to a temporary
+   file next to them and flushed to disk. On commit(), all temporary files are renamed to
+   their target names and each directory touched is flushed once. A crash at any point
+   hence leaves either the old or the new version of a file behind, never a truncated one.
+
+   Left over temporary files (from a crash before commit()) can be removed using
+   removeStaleFiles().
+ */
+class LocalXmlWriteBatch
+{
+public:
+
+  static const QString TempSuffix;
+
+  explicit LocalXmlWriteBatch( const QString &directory = QString() );
+  ~LocalXmlWriteBatch();
+
+  QString directory() const;
+  void setDirectory( const QString &directory );
+
+  bool write( const QString &fileName, const QByteArray &data );
+  bool contains( const QString &fileName ) const;
+  bool isEmpty() const;
+  QStringList commit();
+  void discard();
+
+  int removeStaleFiles() const;
+
+private:
+
+  QString       m_directory;
+  QStringList   m_fileNames; //!< Files written, in order of their first write
+  QSet<QString> m_pending;   //!< The same file names, for fast lookups
+
+  static bool flush( int handle );
+  static bool replace( const QString &source, const QString &target );
+  static bool flushDirectory( const QString &directory );
+
+};
+
+#endif // LOCALXMLWRITEBATCH_H